@@ -1,6 +1,7 @@
 #version 440
 
 #include "../fragments/fs_common_inputs.glsl"
+#include "../fragments/normal_mapping.glsl"
 
 layout(location = 4) in mat3 inTBN;
 
@@ -42,8 +43,7 @@ const float LOG_MAX = 2.40823996531;
 void main() {
     
     // Read our tangent from the map, and convert from the [0,1] range to [-1,1] range
-    vec3 normal = texture(s_NormalMap, inUV).rgb;
-    normal = normal * 2.0 - 1.0;
+    vec3 normal = ReadTangentNormal(s_NormalMap, inUV);
     
     // Here we apply the TBN matrix to transform the normal from tangent space to world space
     normal = normalize(inTBN * normal);
@@ -16,16 +16,6 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     uniform uint  u_Flags;
 };
 
-// Stores uniforms that change every object/instance
-layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
-    // Complete MVP
-    uniform mat4 u_ModelViewProjection;
-    // Just the model transform, we'll do worldspace lighting
-    uniform mat4 u_Model;
-    // Normal Matrix for transforming normals
-    uniform mat4 u_NormalMatrix;
-};
-
 #define FLAG_ENABLE_NO_LIGHT (1 << 1)
 #define FLAG_ENABLE_AMBIENT_LIGHT (1 << 2)
 #define FLAG_ENABLE_SPECULAR_LIGHT (1 << 3)
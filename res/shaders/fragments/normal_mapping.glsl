@@ -0,0 +1,6 @@
+// Reads a tangent space normal from a normal map, and converts it from the [0,1] range to the [-1,1] range
+// Z is rebuilt from X and Y, so normal maps can be stored with only 2 channels (ex: BC5 compressed)
+vec3 ReadTangentNormal(sampler2D normalMap, vec2 uv) {
+    vec2 xy = texture(normalMap, uv).rg * 2.0 - 1.0;
+    return vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+}
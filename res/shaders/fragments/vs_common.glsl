@@ -8,6 +8,15 @@ layout(location = 3) in vec2 inUV;
 layout(location = 4) in vec3 inTangent;
 layout(location = 5) in vec3 inBiTangent;
 
+// Per-instance inputs, these are streamed from the render layer's instance buffer
+// Draws that don't have an instance buffer get the identity matrix (see RenderLayer::OnAppLoad),
+// or can feed their own transform with VertexArrayObject::SetConstantAttribute
+// Attributes 0-5 are used by our common inputs, so let's skip to 8 to leave some space
+// This will consume 4 slots, since it's essentially 4 vec4s in memory
+layout(location = 8) in mat4 inModelTransform;
+// This will consume 3 slots in memory
+layout(location = 12) in mat3 inNormalMatrix;
+
 // Standard vertex shader outputs
 layout(location = 0) out vec3 outWorldPos;
 layout(location = 1) out vec3 outColor;
@@ -5,19 +5,19 @@
 
 void main() {
 
-	gl_Position = u_ModelViewProjection * vec4(inPosition, 1.0);
-
 	// Lecture 5
 	// Pass vertex pos in world space to frag shader
-	outWorldPos = (u_Model * vec4(inPosition, 1.0)).xyz;
+	outWorldPos = (inModelTransform * vec4(inPosition, 1.0)).xyz;
+
+	gl_Position = u_ViewProjection * vec4(outWorldPos, 1.0);
 
 	// Normals
-	outNormal = mat3(u_NormalMatrix) * inNormal;
+	outNormal = inNormalMatrix * inNormal;
 
     // We use a TBN matrix for tangent space normal mapping
-    vec3 T = normalize(vec3(mat3(u_NormalMatrix) * inTangent));
-    vec3 B = normalize(vec3(mat3(u_NormalMatrix) * inBiTangent));
-    vec3 N = normalize(vec3(mat3(u_NormalMatrix) * inNormal));
+    vec3 T = normalize(vec3(inNormalMatrix * inTangent));
+    vec3 B = normalize(vec3(inNormalMatrix * inBiTangent));
+    vec3 N = normalize(vec3(inNormalMatrix * inNormal));
     mat3 TBN = mat3(T, B, N);
 
     // We can pass the TBN matrix to the fragment shader to save computation
@@ -2,6 +2,7 @@
 
 // Include our common vertex shader attributes and uniforms
 #include "../fragments/vs_common.glsl"
+#include "../fragments/normal_mapping.glsl"
 
 // For more detailed explanations, see
 // https://learnopengl.com/Advanced-Lighting/Normal-Mapping
@@ -19,24 +20,23 @@ void main() {
     // object space
     vec3 displacedPos = inPosition + (inNormal * displacement);
 
-    // Transform to world position
-	gl_Position = u_ModelViewProjection * vec4(displacedPos, 1.0);
-
 	// Pass vertex pos in world space to frag shader
-	outWorldPos = (u_Model * vec4(displacedPos, 1.0)).xyz;
+	outWorldPos = (inModelTransform * vec4(displacedPos, 1.0)).xyz;
+
+    // Transform to clip space
+	gl_Position = u_ViewProjection * vec4(outWorldPos, 1.0);
 
     // We use a TBN matrix for tangent space normal mapping
-    vec3 T = normalize(vec3(mat3(u_NormalMatrix) * inTangent));
-    vec3 B = normalize(vec3(mat3(u_NormalMatrix) * inBiTangent));
-    vec3 N = normalize(vec3(mat3(u_NormalMatrix) * inNormal));
+    vec3 T = normalize(vec3(inNormalMatrix * inTangent));
+    vec3 B = normalize(vec3(inNormalMatrix * inBiTangent));
+    vec3 N = normalize(vec3(inNormalMatrix * inNormal));
     mat3 TBN = mat3(T, B, N);
 
     // We can pass the TBN matrix to the fragment shader to save computation
     outTBN = TBN;
 
     // Read our tangent from the map, and convert from the [0,1] range to [-1,1] range
-    vec3 normal = texture(s_NormalMap, inUV).rgb;
-    normal = normal * 2.0 - 1.0;
+    vec3 normal = ReadTangentNormal(s_NormalMap, inUV);
     
     // Here we apply the TBN matrix to transform the normal from tangent space to world space
     normal = normalize(TBN * normal);
@@ -11,12 +11,11 @@ uniform float u_Scale;
 
 void main() {
 
-	gl_Position = u_ModelViewProjection * vec4(inPosition, 1.0);
-
 	// Pass vertex pos in world space to frag shader
-	outWorldPos = (u_Model * vec4(inPosition, 1.0)).xyz;
+	outWorldPos = (inModelTransform * vec4(inPosition, 1.0)).xyz;
+	gl_Position = u_ViewProjection * vec4(outWorldPos, 1.0);
 	// Normals
-	outNormal = mat3(u_NormalMatrix) * inNormal;
+	outNormal = inNormalMatrix * inNormal;
 	// Pass our UV coords to the fragment shader
 	outUV = inUV;
 	///////////
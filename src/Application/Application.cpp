@@ -18,6 +18,8 @@
 #include "Graphics/Buffers/VertexBuffer.h"
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/ShaderProgram.h"
+#include "Graphics/ShaderReloader.h"
+#include "Gameplay/SceneStreamer.h"
 #include "Graphics/Textures/Texture1D.h"
 #include "Graphics/Textures/Texture2D.h"
 #include "Graphics/Textures/Texture3D.h"
@@ -72,6 +74,7 @@ Application::Application() :
 	_windowTitle("INFR - 2350U"),
 	_currentScene(nullptr),
 	_targetScene(nullptr),
+	_sceneStreamer(nullptr),
 	_renderOutput(nullptr)
 { }
 
@@ -82,10 +85,23 @@ Application& Application::Get() {
 	return *_singleton;
 }
 
-void Application::Start(int argCount, char** arguments) {
+int Application::Start(int argCount, char** arguments) {
 	LOG_ASSERT(_singleton == nullptr, "Application has already been started!");
 	_singleton = new Application();
-	_singleton->_Run();
+
+	// --test and --bench can be followed by a filter to only run some of the cases
+	for (int ix = 1; ix < argCount; ix++) {
+		std::string arg = arguments[ix];
+		if (arg == "--test" || arg == "--bench") {
+			_singleton->_testSettings.Enabled = true;
+			_singleton->_testSettings.Kind = arg == "--test" ? TestKind::Test : TestKind::Benchmark;
+			if (ix + 1 < argCount && arguments[ix + 1][0] != '-') {
+				_singleton->_testSettings.Filter = arguments[++ix];
+			}
+		}
+	}
+
+	return _singleton->_Run();
 }
 
 GLFWwindow* Application::GetWindow() { return _window; }
@@ -119,6 +135,16 @@ bool Application::LoadScene(const std::string& path) {
 			ResourceManager::LoadManifest(manifestPath);
 		}
 
+		// Binary scenes are streamed in over the next few frames, the current scene keeps running until they're done
+		if (std::filesystem::path(path).extension() == Gameplay::SceneStreamer::FILE_EXTENSION) {
+			Gameplay::SceneStreamer::Sptr streamer = Gameplay::SceneStreamer::Open(path);
+			if (streamer != nullptr) {
+				_targetScene = nullptr;
+				_sceneStreamer = streamer;
+			}
+			return streamer != nullptr;
+		}
+
 		Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
 		LoadScene(scene);
 		return scene != nullptr;
@@ -127,6 +153,8 @@ bool Application::LoadScene(const std::string& path) {
 }
 
 void Application::LoadScene(const Gameplay::Scene::Sptr& scene) {
+	// Any scene we were streaming in has been superseded
+	_sceneStreamer = nullptr;
 	_targetScene = scene;
 }
 
@@ -142,8 +170,12 @@ void Application::SaveSettings()
 	FileHelpers::WriteContentsToFile(settingsPath.string(), _appSettings.dump(1, '\t'));
 }
 
-void Application::_Run()
+int Application::_Run()
 {
+	if (_testSettings.Enabled) {
+		return _RunTests();
+	}
+
 	// TODO: Register layers
 	_layers.push_back(std::make_shared<GLAppLayer>());
 	_layers.push_back(std::make_shared<DefaultSceneLayer>());
@@ -183,6 +215,12 @@ void Application::_Run()
 
 	// Infinite loop as long as the application is running
 	while (_isRunning) {
+		// Keep streaming in any binary scene we're loading, and switch to it once it's complete
+		if (_sceneStreamer != nullptr && _sceneStreamer->Step()) {
+			Gameplay::Scene::Sptr scene = _sceneStreamer->GetScene();
+			LoadScene(scene);
+		}
+
 		// Handle scene switching
 		if (_targetScene != nullptr) {
 			_HandleSceneChange();
@@ -196,6 +234,11 @@ void Application::_Run()
 			_isRunning = false;
 		}
 
+		// Rebuild any shaders whose source files have changed
+		ShaderReloader::Poll();
+		// Finish off any resources that were decoded in the background
+		ResourceManager::PumpUploads();
+
 		// Grab the timing singleton instance as a reference
 		Timing& timing = Timing::_singleton;
 
@@ -346,6 +389,29 @@ void Application::_Run()
 
 	// Unload all our layers
 	_Unload();
+
+	return 0;
+}
+
+int Application::_RunTests()
+{
+	// Our cases only need an OpenGL context, so we skip the scene, rendering and editor layers
+	_layers.push_back(std::make_shared<GLAppLayer>());
+
+	// Stick to the defaults so that test runs never touch the settings file
+	_appSettings = _GetDefaultAppSettings();
+	_windowSize.x = JsonGet(_appSettings, "window_width", DEFAULT_WINDOW_WIDTH);
+	_windowSize.y = JsonGet(_appSettings, "window_height", DEFAULT_WINDOW_HEIGHT);
+	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
+
+	_RegisterClasses();
+	_Load();
+
+	int failed = TestRegistry::Run(_testSettings.Kind, _testSettings.Filter);
+
+	_Unload();
+
+	return failed;
 }
 
 void Application::_RegisterClasses()
@@ -480,6 +546,9 @@ void Application::_PostRender() {
 }
 
 void Application::_Unload() {
+	// Stop watching shader files before our layers tear down the GL context
+	ShaderReloader::Shutdown();
+
 	// Note that we use a reverse iterator for unloading
 	for (auto it = _layers.crbegin(); it != _layers.crend(); it++) {
 		const auto& layer = *it;
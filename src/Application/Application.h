@@ -5,9 +5,14 @@
 #include "Utils/Macros.h"
 #include "Application/ApplicationLayer.h"
 #include "Gameplay/Scene.h"
+#include "Tests/TestRegistry.h"
 
 struct GLFWwindow;
 
+namespace Gameplay {
+	class SceneStreamer;
+}
+
 /**
  * The application will be the main container for all of our shared game engine features,
  * such as windows, input, rendering, etc...
@@ -31,8 +36,13 @@ public:
 	/**
 	 * Called by the entry point to begin the application, creating the singleton 
 	 * intance and performing any library initialization
+	 * 
+	 * Passing --test or --bench, optionally followed by a filter, will run the matching
+	 * test or benchmark cases from src/Tests instead of opening the editor
+	 * 
+	 * @returns The exit code for the process, the number of failed cases when running tests
 	 */
-	static void Start(int argCount, char** arguments);
+	static int Start(int argCount, char** arguments);
 
 	/**
 	 * Gets the GLFW window for the application
@@ -67,7 +77,8 @@ public:
 	void Quit();
 
 	/**
-	 * Loads a new scene into the application using a path on disk
+	 * Loads a new scene into the application using a path on disk. Binary (.bscene) scenes are
+	 * streamed in over the following frames, the current scene stays active until they finish
 	 * 
 	 * @param path The path to the scene file to load
 	 * @returns True if the file was found and the scene loaded, false if otherwise
@@ -126,6 +137,13 @@ protected:
 	// Not an idea way of distinguising, since we need to build editor into our game, but good 'nuff for GDW
 	bool        _isEditor;
 
+	// Set from the command line when we should run test or benchmark cases instead of the game
+	struct {
+		bool        Enabled = false;
+		TestKind    Kind = TestKind::Test;
+		std::string Filter;
+	} _testSettings;
+
 	// The primary viewport that the game will render into, in client window bounds
 	glm::uvec4  _primaryViewport;
 
@@ -136,13 +154,16 @@ protected:
 	Gameplay::Scene::Sptr _currentScene;
 	// The scene to switch to at the start of the next frame
 	Gameplay::Scene::Sptr _targetScene;
+	// Streams in a binary scene over several frames, the scene becomes the target scene once it's done
+	std::shared_ptr<Gameplay::SceneStreamer> _sceneStreamer;
 
 	// Stores all the layers of the application, in the order they should be invoked
 	std::vector<ApplicationLayer::Sptr> _layers;
 
 	Framebuffer::Sptr _renderOutput;
 
-	void _Run();
+	int  _Run();
+	int  _RunTests();
 	void _RegisterClasses();
 	void _Load();
 	void _Update();
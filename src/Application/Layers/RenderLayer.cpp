@@ -7,6 +7,10 @@
 #include "../Timing.h"
 #include "Gameplay/Components/ComponentManager.h"
 #include "Gameplay/Components/RenderComponent.h"
+#include "Logging.h"
+
+#include <algorithm>
+#include <cstring>
 
 // GLM math library
 #include <GLM/glm.hpp>
@@ -21,9 +25,16 @@ RenderLayer::RenderLayer() :
 	_primaryFBO(nullptr),
 	_blitFbo(true),
 	_frameUniforms(nullptr),
-	_instanceUniforms(nullptr),
+	_instanceBuffer(nullptr),
+	_instanceAttributes(),
+	_instancedMeshes(),
 	_renderFlags(RenderFlags::None),
-	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
+	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f }),
+	_lodPixelError(1.0f),
+	_isFrustumCullingEnabled(true),
+	_renderStats(),
+	_renderQueue(),
+	_materialIds()
 {
 	Name = "Rendering";
 	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnRender | AppLayerFunctions::OnWindowResize;
@@ -57,10 +68,6 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
 
-	// The current material that is bound for rendering
-	Material::Sptr currentMat = nullptr;
-	ShaderProgram::Sptr shader = nullptr;
-
 	// Bind the skybox texture to a reserved texture slot
 	// See Material.h and Material.cpp for how we're reserving texture slots
 	TextureCube::Sptr environment = app.CurrentScene()->GetSkyboxTexture();
@@ -84,26 +91,47 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Here we'll bind all the UBOs to their corresponding slots
 	app.CurrentScene()->PreRender();
 	_frameUniforms->Bind(FRAME_UBO_BINDING);
-	_instanceUniforms->Bind(INSTANCE_UBO_BINDING);
 
 	// Draw physics debug
 	app.CurrentScene()->DrawPhysicsDebug();
 
+	_renderStats = RenderStats();
+
+	// The camera may be parented to another object, so we need it's world space position rather than it's local one
+	const glm::vec3 cameraPos = glm::vec3(camera->GetGameObject()->GetTransform()[3]);
+
 	// Upload frame level uniforms
 	auto& frameData = _frameUniforms->GetData();
 	frameData.u_Projection = camera->GetProjection();
 	frameData.u_View = camera->GetView();
 	frameData.u_ViewProjection = camera->GetViewProjection();
-	frameData.u_CameraPos = glm::vec4(camera->GetGameObject()->GetPosition(), 1.0f);
+	frameData.u_CameraPos = glm::vec4(cameraPos, 1.0f);
 	frameData.u_Time = static_cast<float>(Timing::Current().TimeSinceSceneLoad());
 	frameData.u_DeltaTime = Timing::Current().DeltaTime();
 	frameData.u_RenderFlags = _renderFlags;
 	_frameUniforms->Update();
+	_renderStats.BytesUploaded += sizeof(FrameLevelUniforms);
 
 	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
 
-	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+	// The number of pixels that one world unit covers at a distance of 1 (or at any distance for
+	// orthographic cameras), used for selecting levels of detail
+	const bool isOrtho = camera->GetOrthoEnabled();
+	const float pixelScale = camera->GetProjection()[1][1] * 0.5f * _primaryFBO->GetHeight();
+
+	// Anything that falls completely outside of the camera's view can be skipped
+	const Frustum frustum = Frustum(camera->GetViewProjection());
+
+	// Forget our copies of any meshes that have been destroyed, a new VAO may end up at the same address
+	for (auto it = _instancedMeshes.begin(); it != _instancedMeshes.end(); ) {
+		it = it->second.Source.expired() ? _instancedMeshes.erase(it) : std::next(it);
+	}
+
+	// Gather everything we need to draw into the render queue, so that we can sort the draws
+	// to minimize the state changes between them
+	_renderQueue.clear();
+	_materialIds.clear();
+	app.CurrentScene()->Components().Each<RenderComponent>([&](RenderComponent* renderable) {
 		// Early bail if mesh not set
 		if (renderable->GetMesh() == nullptr) {
 			return;
@@ -119,29 +147,116 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 			}
 		}
 
-		// If the material has changed, we need to bind the new shader and set up our material and frame data
-		// Note: This is a good reason why we should be sorting the render components in ComponentManager
-		if (renderable->GetMaterial() != currentMat) {
-			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+		// Grab the game object so we can do some stuff with it
+		GameObject* object = renderable->GetGameObject();
+
+		// Cull against the world space bounds, which the object only recalculates when it moves
+		const MeshResource::Sptr& meshResource = renderable->GetMeshResource();
+		if (_isFrustumCullingEnabled && meshResource->HasBounds) {
+			glm::vec3 worldMin, worldMax;
+			object->GetWorldBounds(meshResource->BoundsMin, meshResource->BoundsMax, worldMin, worldMax);
+			if (!frustum.IntersectsBox(worldMin, worldMax)) {
+				_renderStats.Culled++;
+				return;
+			}
+		}
+		_renderStats.Visible++;
+
+		// Pick the least detailed version of the mesh that will look the same from where the camera is
+		VertexArrayObject::Sptr mesh = renderable->GetMesh();
+		if (!meshResource->Lods.empty()) {
+			const glm::mat4& transform = object->GetTransform();
+			float scale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+			glm::vec3 center = glm::vec3(transform * glm::vec4((meshResource->BoundsMin + meshResource->BoundsMax) * 0.5f, 1.0f));
+			float radius = glm::length(meshResource->BoundsMax - meshResource->BoundsMin) * 0.5f * scale;
+
+			float pixelsPerUnit = pixelScale * scale;
+			if (!isOrtho) {
+				// Measure to the nearest point of the bounding sphere, so we never under-estimate the error
+				pixelsPerUnit /= glm::max(glm::length(center - cameraPos) - radius, 0.01f);
+			}
+			mesh = meshResource->SelectLod(pixelsPerUnit, _lodPixelError);
+		}
+
+		DrawCommand command;
+		command.Mat     = renderable->GetMaterial().get();
+		command.Object  = object;
+		command.Mesh    = _GetInstancedMesh(mesh);
+		command.SortKey = _MakeSortKey(command.Mat, command.Mesh->Vao.get(), glm::length(glm::vec3(object->GetTransform()[3]) - cameraPos));
+		_renderQueue.push_back(command);
+	});
+	std::sort(_renderQueue.begin(), _renderQueue.end(), [](const DrawCommand& a, const DrawCommand& b) {
+		return a.SortKey < b.SortKey;
+	});
+
+	// Grab this frame's region of the instance buffer, this will only block if the GPU is still
+	// drawing from it
+	_instanceBuffer->ResetStats();
+	InstanceData* instances = reinterpret_cast<InstanceData*>(_instanceBuffer->BeginFrame(static_cast<uint32_t>(_renderQueue.size())));
+	const uint32_t regionStart = _instanceBuffer->GetFrameOffset();
+
+	// The state that is currently bound for rendering, we only change what differs between draws
+	ShaderProgram* currentShader = nullptr;
+	Material* currentMat = nullptr;
+	InstancedMesh* currentMesh = nullptr;
+
+	// Render all our objects, objects that share a mesh and material will be next to each other
+	// in the queue, so we can draw each of those runs with a single instanced draw
+	for (size_t runStart = 0; runStart < _renderQueue.size(); ) {
+		const DrawCommand& command = _renderQueue[runStart];
+		Material* material = command.Mat;
+		ShaderProgram* shader = material->GetShader().get();
+
+		size_t runEnd = runStart + 1;
+		while (runEnd < _renderQueue.size() && _renderQueue[runEnd].Mesh == command.Mesh && _renderQueue[runEnd].Mat == material) {
+			runEnd++;
+		}
+
+		// Write the instance data straight into the mapped buffer
+		for (size_t ix = runStart; ix < runEnd; ix++) {
+			const GameObject* object = _renderQueue[ix].Object;
+			instances[ix].Model = object->GetTransform();
+			instances[ix].NormalMatrix = glm::mat4(object->GetNormalMatrix());
+		}
 
+		if (shader != currentShader) {
+			currentShader = shader;
 			shader->Bind();
-			currentMat->Apply();
+			_renderStats.ShaderBinds++;
 		}
 
-		// Grab the game object so we can do some stuff with it
-		GameObject* object = renderable->GetGameObject();
+		// Materials set their uniforms directly on their shader program, so they don't care what is bound
+		if (material != currentMat) {
+			currentMat = material;
+			material->Apply();
+			_renderStats.MaterialApplies++;
+			_renderStats.MaterialGlCalls += material->GetLastApplyCallCount();
+		}
+
+		if (command.Mesh != currentMesh) {
+			currentMesh = command.Mesh;
+			// Our instance buffer may have been re-allocated since we last drew this mesh
+			if (currentMesh->Instances->GetBuffer() != _instanceBuffer->GetBuffer()) {
+				currentMesh->Vao->ReplaceVertexBuffer(currentMesh->Instances, _instanceBuffer->GetBuffer());
+			}
+			currentMesh->Vao->Bind();
+			_renderStats.VaoBinds++;
+		}
 
-		// Use our uniform buffer for our instance level uniforms
-		auto& instanceData = _instanceUniforms->GetData();
-		instanceData.u_Model = object->GetTransform();
-		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
-		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
-		_instanceUniforms->Update();
+		// Draw the objects
+		const uint32_t instanceCount = static_cast<uint32_t>(runEnd - runStart);
+		currentMesh->Vao->DrawInstancedBound(instanceCount, regionStart + static_cast<uint32_t>(runStart));
+		_renderStats.DrawCalls++;
+		_renderStats.Instances += instanceCount;
 
-		// Draw the object
-		renderable->GetMesh()->Draw();
-	});
+		runStart = runEnd;
+	}
+	VertexArrayObject::Unbind();
+
+	// We'll wait on this frame's fence before we write to this region of the instance buffer again
+	_instanceBuffer->EndFrame();
+	_renderStats.BytesUploaded += _instanceBuffer->GetStats().BytesWritten;
+	_renderStats.SyncWaits += _instanceBuffer->GetStats().SyncWaits;
 
 	// Use our cubemap to draw our skybox
 	app.CurrentScene()->DrawSkybox();
@@ -189,7 +304,30 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 
 	// Create our common uniform buffers
 	_frameUniforms = std::make_shared<UniformBuffer<FrameLevelUniforms>>(BufferUsage::DynamicDraw);
-	_instanceUniforms = std::make_shared<UniformBuffer<InstanceLevelUniforms>>(BufferUsage::DynamicDraw);
+
+	// Sending our 2 matrices as instanced attributes, see fragments/vs_common.glsl
+	_instanceAttributes = {
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 0, 4, AttributeType::Float, sizeof(InstanceData), 0, AttribUsage::User0),
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 1, 4, AttributeType::Float, sizeof(InstanceData), 4 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 2, 4, AttributeType::Float, sizeof(InstanceData), 8 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 3, 4, AttributeType::Float, sizeof(InstanceData), 12 * sizeof(float), AttribUsage::User0),
+
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 4, 3, AttributeType::Float, sizeof(InstanceData), 16 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 5, 3, AttributeType::Float, sizeof(InstanceData), 20 * sizeof(float), AttribUsage::User0),
+		BufferAttribute(INSTANCE_ATTRIB_SLOT + 6, 3, AttributeType::Float, sizeof(InstanceData), 24 * sizeof(float), AttribUsage::User0),
+	};
+	_instanceBuffer = RingBuffer::Create(sizeof(InstanceData), 1024);
+
+	// Anything drawn with our shaders without an instance buffer reads the current generic attribute
+	// values instead, so we give them an identity transform rather than leaving them at (0, 0, 0, 1)
+	for (int ix = 0; ix < 4; ix++) {
+		glm::vec4 column = glm::vec4(0.0f);
+		column[ix] = 1.0f;
+		glVertexAttrib4fv(INSTANCE_ATTRIB_SLOT + ix, &column.x);
+		if (ix < 3) {
+			glVertexAttrib4fv(INSTANCE_ATTRIB_SLOT + 4 + ix, &column.x);
+		}
+	}
 }
 
 const Framebuffer::Sptr& RenderLayer::GetPrimaryFBO() const {
@@ -223,3 +361,65 @@ void RenderLayer::SetRenderFlags(RenderFlags value) {
 RenderFlags RenderLayer::GetRenderFlags() const {
 	return _renderFlags;
 }
+
+const RenderLayer::RenderStats& RenderLayer::GetRenderStats() const {
+	return _renderStats;
+}
+
+RenderLayer::InstancedMesh* RenderLayer::_GetInstancedMesh(const VertexArrayObject::Sptr& mesh) {
+	InstancedMesh& result = _instancedMeshes[mesh.get()];
+	if (result.Vao == nullptr) {
+		// Our instance attributes will take priority over any the mesh feeds into the same slots
+		for (const VertexArrayObject::VertexBufferBinding* binding : mesh->GetVertexBuffers()) {
+			for (const BufferAttribute& attrib : binding->GetAttributes()) {
+				if (attrib.Slot >= INSTANCE_ATTRIB_SLOT && attrib.Slot < INSTANCE_ATTRIB_SLOT + _instanceAttributes.size()) {
+					LOG_WARN("Mesh \"{}\" uses attribute {}, which is reserved for instance data", mesh->GetDebugName(), attrib.Slot);
+				}
+			}
+		}
+
+		result.Source = mesh;
+		result.Vao = mesh->Clone();
+		result.Vao->SetDebugName(mesh->GetDebugName() + " - instanced");
+		result.Instances = result.Vao->AddVertexBuffer(_instanceBuffer->GetBuffer(), _instanceAttributes, true);
+	}
+	return &result;
+}
+
+uint64_t RenderLayer::_MakeSortKey(Gameplay::Material* material, VertexArrayObject* mesh, float distance) {
+	// Materials don't have IDs of their own, so we number them in the order we see them each frame
+	auto it = _materialIds.find(material);
+	if (it == _materialIds.end()) {
+		it = _materialIds.emplace(material, static_cast<uint32_t>(_materialIds.size())).first;
+	}
+
+	// The bits of a positive float sort the same way as its value, so the top 16 bits give us a
+	// coarse depth that still sorts front to back
+	uint32_t depthBits;
+	distance = glm::max(distance, 0.0f);
+	memcpy(&depthBits, &distance, sizeof(float));
+
+	// Handles and IDs that don't fit in their fields will alias, which only costs us some extra state changes
+	const ShaderProgram::Sptr& shader = material->GetShader();
+	return
+		((uint64_t)((shader != nullptr ? shader->GetHandle() : 0) & 0xFFFF) << 48) |
+		((uint64_t)(it->second & 0xFFFF) << 32) |
+		((uint64_t)(mesh->GetHandle() & 0xFFFF) << 16) |
+		(uint64_t)(depthBits >> 16);
+}
+
+void RenderLayer::SetLodPixelError(float value) {
+	_lodPixelError = value;
+}
+
+float RenderLayer::GetLodPixelError() const {
+	return _lodPixelError;
+}
+
+void RenderLayer::SetFrustumCullingEnabled(bool value) {
+	_isFrustumCullingEnabled = value;
+}
+
+bool RenderLayer::IsFrustumCullingEnabled() const {
+	return _isFrustumCullingEnabled;
+}
@@ -2,6 +2,16 @@
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
 #include "Graphics/Buffers/UniformBuffer.h"
+#include "Graphics/Buffers/RingBuffer.h"
+#include "Graphics/VertexArrayObject.h"
+#include "Utils/Frustum.h"
+
+#include <unordered_map>
+
+namespace Gameplay {
+	class GameObject;
+	class Material;
+}
 
 ENUM_FLAGS(RenderFlags, uint32_t,
 	None = 0,
@@ -41,16 +51,38 @@ public:
 		RenderFlags u_RenderFlags;
 	};
 
-	// Structure for our instance-level uniforms, matches layout from
-	// fragments/frame_uniforms.glsl
-	// For use with a UBO.
-	struct InstanceLevelUniforms {
-		// Complete MVP
-		glm::mat4 u_ModelViewProjection;
+	// Structure for our per-instance data, matches the instanced attributes from
+	// fragments/vs_common.glsl
+	// For use with an instanced vertex buffer.
+	struct InstanceData {
 		// Just the model transform, we'll do worldspace lighting
-		glm::mat4 u_Model;
-		// Normal Matrix for transforming normals
-		glm::mat4 u_NormalMatrix;
+		glm::mat4 Model;
+		// Normal Matrix for transforming normals, only the upper 3x3 is used
+		glm::mat4 NormalMatrix;
+	};
+
+	// Counts how much work the render layer did in the last frame
+	struct RenderStats {
+		// The number of draw calls that were issued
+		uint32_t DrawCalls = 0;
+		// The number of objects that were drawn, objects sharing a mesh and material are drawn with one call
+		uint32_t Instances = 0;
+		// The number of times we had to switch shader programs
+		uint32_t ShaderBinds = 0;
+		// The number of times we had to apply a material's uniforms and textures
+		uint32_t MaterialApplies = 0;
+		// The number of uniform and texture GL calls issued by material applies
+		uint32_t MaterialGlCalls = 0;
+		// The number of times we had to switch VAOs
+		uint32_t VaoBinds = 0;
+		// The number of objects that were outside of the camera's frustum and skipped
+		uint32_t Culled = 0;
+		// The number of objects that passed culling and were added to the render queue
+		uint32_t Visible = 0;
+		// The number of bytes of instance and frame data that were written for the GPU
+		uint64_t BytesUploaded = 0;
+		// The number of times we had to wait for the GPU to finish with the instance buffer
+		uint32_t SyncWaits = 0;
 	};
 
 	RenderLayer();
@@ -70,6 +102,24 @@ public:
 	void SetRenderFlags(RenderFlags value);
 	RenderFlags GetRenderFlags() const;
 
+	/// <summary>
+	/// Sets the largest error, in pixels, that a mesh's level of detail can have before we
+	/// switch to a more detailed one. Set to 0 to always draw the full meshes
+	/// </summary>
+	void SetLodPixelError(float value);
+	float GetLodPixelError() const;
+
+	/// <summary>
+	/// Sets whether objects outside of the camera's view frustum will be skipped
+	/// </summary>
+	void SetFrustumCullingEnabled(bool value);
+	bool IsFrustumCullingEnabled() const;
+
+	/// <summary>
+	/// Gets the draw and state change counters from the last frame that was rendered
+	/// </summary>
+	const RenderStats& GetRenderStats() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
@@ -82,10 +132,47 @@ protected:
 	bool              _blitFbo;
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
+	float             _lodPixelError;
+	bool              _isFrustumCullingEnabled;
+	RenderStats       _renderStats;
+
+	// Our own copy of a mesh's VAO with the instance buffer attached. Mesh VAOs are shared with anything
+	// else that wants to draw them, so we never add our instance attributes to them directly
+	struct InstancedMesh {
+		// The VAO that this is a copy of, so that we can tell when it has been destroyed
+		VertexArrayObject::Wptr                 Source;
+		VertexArrayObject::Sptr                 Vao;
+		// The binding in Vao that feeds the instance attributes
+		VertexArrayObject::VertexBufferBinding* Instances;
+	};
+
+	// A single draw in the render queue
+	struct DrawCommand {
+		// Draws are sorted by shader, then material, then VAO, then front to back
+		uint64_t                   SortKey;
+		Gameplay::Material*        Mat;
+		Gameplay::GameObject*      Object;
+		// The VAO to draw, this may be one of the mesh's levels of detail
+		InstancedMesh*             Mesh;
+	};
+
+	// The draws for the current frame, kept around between frames so we don't re-allocate
+	std::vector<DrawCommand> _renderQueue;
+	// Gives each material in the current frame a small ID for the sort keys, in the order they were first seen
+	std::unordered_map<Gameplay::Material*, uint32_t> _materialIds;
+
+	uint64_t _MakeSortKey(Gameplay::Material* material, VertexArrayObject* mesh, float distance);
 
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
 
-	const int INSTANCE_UBO_BINDING = 1;
-	UniformBuffer<InstanceLevelUniforms>::Sptr _instanceUniforms;
+	// All of a frame's instance data is written once into a persistently mapped ring buffer, and each
+	// draw picks out its range with the base instance
+	static const uint32_t INSTANCE_ATTRIB_SLOT = 8;
+	RingBuffer::Sptr             _instanceBuffer;
+	std::vector<BufferAttribute> _instanceAttributes;
+	// The instanced copies of every mesh we've drawn, keyed by the mesh's VAO
+	std::unordered_map<VertexArrayObject*, InstancedMesh> _instancedMeshes;
+
+	InstancedMesh* _GetInstancedMesh(const VertexArrayObject::Sptr& mesh);
 };
\ No newline at end of file
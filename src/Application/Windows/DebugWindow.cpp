@@ -37,4 +37,17 @@ void DebugWindow::RenderMenuBar()
 	if (changed) {
 		renderLayer->SetRenderFlags(flags);
 	}
+
+	bool culling = renderLayer->IsFrustumCullingEnabled();
+	if (ImGui::Checkbox("Frustum Culling", &culling)) {
+		renderLayer->SetFrustumCullingEnabled(culling);
+	}
+
+	ImGui::Separator();
+
+	const RenderLayer::RenderStats& stats = renderLayer->GetRenderStats();
+	ImGui::Text("Draws: %u  Instances: %u  Shader binds: %u  Material applies: %u (%u GL calls)  VAO binds: %u",
+		stats.DrawCalls, stats.Instances, stats.ShaderBinds, stats.MaterialApplies, stats.MaterialGlCalls, stats.VaoBinds);
+	ImGui::Text("Visible: %u  Culled: %u  Uploaded: %llu bytes  Sync waits: %u",
+		stats.Visible, stats.Culled, (unsigned long long)stats.BytesUploaded, stats.SyncWaits);
 }
@@ -3,6 +3,7 @@
 #include "IComponent.h"
 #include <typeindex>
 #include <optional>
+#include <algorithm>
 #include <Logging.h>
 
 namespace Gameplay {
@@ -42,7 +43,7 @@ namespace Gameplay {
 					result->_weakSelfPtr = result;
 
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPool(result.get());
 					return result;
 				}
 			}
@@ -71,7 +72,7 @@ namespace Gameplay {
 					result->_realType = typeIndex.value();
 					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_AddToPool(result.get());
 					return result;
 				}
 			}
@@ -98,7 +99,7 @@ namespace Gameplay {
 				result->_realType = type;
 				result->_weakSelfPtr = result;
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
+				_AddToPool(result.get());
 				return result;
 			}
 			return nullptr;
@@ -140,7 +141,7 @@ namespace Gameplay {
 			component->_weakSelfPtr = component;
 
 			// Add to global component list for that type
-			_Components[type].push_back(component);
+			_AddToPool(component.get());
 
 			// Return the result
 			return component;
@@ -161,50 +162,68 @@ namespace Gameplay {
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
-			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
-			});
-
-			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
-			} else {
-				return nullptr;
+			// Look up the component, and make sure it's the type that we're expecting
+			auto it = _ComponentsByGuid.find(id);
+			if (it != _ComponentsByGuid.end() && it->second->_realType == type) {
+				return std::static_pointer_cast<ComponentType>(it->second->_weakSelfPtr.lock());
 			}
+			return nullptr;
 		}
 
 		/// <summary>
-		/// Iterates over all components of the given type and invokes a method with them
+		/// Iterates over all components of the given type and invokes a method with them. The callback
+		/// is given a raw pointer to each component, which is only valid for the duration of the call
+		/// (use SelfRef if you need to hold on to it)
+		///
+		/// The callback may create or destroy components. Components destroyed during the walk are only
+		/// marked as removed, and the pools are compacted when the outermost Each returns, so nothing
+		/// moves under the walk. Every component that is still alive when it's turn comes is visited
+		/// exactly once, and components created by the callback are visited at the end of the walk
 		/// </summary>
 		/// <typeparam name="ComponentType">The type of component to iterate on</typeparam>
+		/// <typeparam name="Callback">The type of the callback, should be callable with a ComponentType*</typeparam>
 		/// <param name="callback">The callback to invoke with the components</param>
 		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
 		template <
 			typename ComponentType,
+			typename Callback,
 			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
-		void Each(std::function<void(const std::shared_ptr<ComponentType>&)> callback, bool includeDisabled = false) {
+		void Each(Callback&& callback, bool includeDisabled = false) {
 			// We can use typeid and type_index to get a unique ID for our types
 			std::type_index type = std::type_index(typeid(ComponentType));
 			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
 
-			// Iterate over all the components in the store
-			for (auto& wptr : _Components[type]) {
-				// Lock the weak pointer to get a shared pointer (maybe)
-				std::shared_ptr<IComponent> sptr = wptr.lock();
-				// If the pointer is alive and matches our enabled criteria, invoke the callback
-				if (sptr && sptr->IsEnabled | includeDisabled) {
-					// Upcast to component type and invoke the callback
-					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+			// Walk the pool by index, since it may reallocate if the callback creates components. Destroyed
+			// components leave a nullptr behind until the walk is done
+			std::vector<IComponent*>& pool = _Components[type];
+			_iterationDepth++;
+			for (size_t ix = 0; ix < pool.size(); ix++) {
+				IComponent* component = pool[ix];
+				if (component != nullptr && (component->IsEnabled || includeDisabled)) {
+					// The pool only stores components of this exact type, so we don't need to dynamic cast
+					callback(static_cast<ComponentType*>(component));
 				}
 			}
+			_iterationDepth--;
+			if (_iterationDepth == 0) {
+				_CompactPools();
+			}
+		}
+
+		/// <summary>
+		/// Gets the number of live components of the given type
+		/// </summary>
+		/// <typeparam name="ComponentType">The type of component to count</typeparam>
+		template <
+			typename ComponentType,
+			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
+		size_t Count() {
+			const std::vector<IComponent*>& pool = _Components[std::type_index(typeid(ComponentType))];
+			if (_iterationDepth > 0) {
+				// Components destroyed during an Each are still holding their slots
+				return pool.size() - std::count(pool.begin(), pool.end(), nullptr);
+			}
+			return pool.size();
 		}
 
 		/// <summary>
@@ -234,7 +253,16 @@ namespace Gameplay {
 		/// Removes all components of all types from the registry, whether they are referenced elsewhere or not
 		/// </summary>
 		inline void FlushAll() {
-			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			for (auto& [type, pool] : _Components) {
+				for (IComponent* component : pool) {
+					if (component != nullptr) {
+						component->_poolIndex = IComponent::INVALID_POOL_INDEX;
+					}
+				}
+			}
+			_Components = std::unordered_map<std::type_index, std::vector<IComponent*>>();
+			_dirtyPools.clear();
+			_ComponentsByGuid.clear();
 		}
 
 	private:
@@ -250,10 +278,18 @@ namespace Gameplay {
 		// Stores functions to load components from JSON, indexed on the type that they load
 		inline static std::unordered_map<std::type_index, CreateComponentFunc> _TypeCreateRegistry;
 
-		// Weak pointers let us store a reference to an object stored by a shared pointer, without
-		// actually increasing the reference count. Thus components will be destroyed at the correct
-		// time (when the only reference is the one stored here).
-		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		// Dense pools of every live component, indexed on their concrete type. The components are owned
+		// by their game objects, and remove themselves from the pools when they are destroyed, so raw
+		// pointers are safe here. Each component stores its index in its pool so it can be removed in
+		// constant time
+		std::unordered_map<std::type_index, std::vector<IComponent*>> _Components;
+		// Maps every component in the pools from it's GUID, so that component references can be resolved quickly
+		std::unordered_map<Guid, IComponent*> _ComponentsByGuid;
+		// The number of Each calls that are currently walking the pools, while this is non-zero removed
+		// components are replaced with nullptr instead of being swapped out
+		int _iterationDepth = 0;
+		// The pools that have had components removed during the current walk, and need to be compacted
+		std::vector<std::vector<IComponent*>*> _dirtyPools;
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
@@ -278,26 +314,65 @@ namespace Gameplay {
 			return component;
 		}
 
+		/// <summary>
+		/// Adds a component to the end of the pool for it's concrete type
+		/// </summary>
+		/// <param name="component">The component to add, it's real type must already be set</param>
+		inline void _AddToPool(IComponent* component) {
+			std::vector<IComponent*>& pool = _Components[component->_realType];
+			component->_poolIndex = pool.size();
+			pool.push_back(component);
+			_ComponentsByGuid[component->GetGUID()] = component;
+		}
+
 		/// <summary>
 		/// Removes a given component from the global pools. To be used in the IComponent destructor
 		/// </summary>
-		/// <typeparam name="ComponentType">The type of component to destroy</typeparam>
 		/// <param name="component">A raw pointer to the component to remove (should be called from IComponent destructor)</param>
-		/// <returns>True if the element was removed, false if not</returns>
-		inline void Remove(const IComponent* component) {
+		inline void Remove(IComponent* component) {
 			// Make sure the component's type was one that was registered
 			LOG_ASSERT(_TypeLoadRegistry[component->_realType] != nullptr, "You must register component types before creating them!");
 
-			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
+			// Components that were never added, or were flushed, will not be in the pool
+			std::vector<IComponent*>& pool = _Components[component->_realType];
+			size_t index = component->_poolIndex;
+			if (index >= pool.size() || pool[index] != component) {
+				return;
+			}
+
+			if (_iterationDepth > 0) {
+				// An Each is walking the pools, swapping the last component into the hole could make it skip
+				// or revisit components, so leave a hole and compact the pool once the walk is done
+				pool[index] = nullptr;
+				if (std::find(_dirtyPools.begin(), _dirtyPools.end(), &pool) == _dirtyPools.end()) {
+					_dirtyPools.push_back(&pool);
+				}
+			} else {
+				// Move the last component into the hole, so the pool stays dense
+				pool[index] = pool.back();
+				pool[index]->_poolIndex = index;
+				pool.pop_back();
+			}
+			component->_poolIndex = IComponent::INVALID_POOL_INDEX;
+
+			auto guidIt = _ComponentsByGuid.find(component->GetGUID());
+			if (guidIt != _ComponentsByGuid.end() && guidIt->second == component) {
+				_ComponentsByGuid.erase(guidIt);
+			}
+		}
 
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			if (it != componentStore.end()) {
-				componentStore.erase(it);
+		/// <summary>
+		/// Removes the holes left in the pools by components that were destroyed during an Each, keeping
+		/// the remaining components in order
+		/// </summary>
+		inline void _CompactPools() {
+			for (std::vector<IComponent*>* pool : _dirtyPools) {
+				pool->erase(std::remove(pool->begin(), pool->end(), nullptr), pool->end());
+				for (size_t ix = 0; ix < pool->size(); ix++) {
+					(*pool)[ix]->_poolIndex = ix;
+				}
 			}
+			_dirtyPools.clear();
 		}
 	};
 }
\ No newline at end of file
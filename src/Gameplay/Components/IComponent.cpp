@@ -28,6 +28,7 @@ namespace Gameplay {
 		IResource(),
 		IsEnabled(true),
 		_realType(typeid(IComponent)),
+		_poolIndex(INVALID_POOL_INDEX),
 		_context(nullptr)
 	{ }
 
@@ -161,6 +161,9 @@ namespace Gameplay {
 		friend class GameObject;
 
 		std::type_index _realType;
+		// The index of this component in the ComponentManager's pool for it's type
+		size_t _poolIndex;
+		static constexpr size_t INVALID_POOL_INDEX = static_cast<size_t>(-1);
 		GameObject* _context;
 
 		// By storing a weak pointer to ourselves, we can pass a pointer to this
@@ -16,8 +16,9 @@
 namespace Gameplay {
 	GameObject::GameObject() :
 		IResource(),
-		Name("Unknown"),
 		HideInHierarchy(false),
+		_name("Unknown"),
+		_sceneOrder(0),
 		_components(std::vector<IComponent::Sptr>()),
 		_scene(nullptr),
 		_position(ZERO),
@@ -28,7 +29,13 @@ namespace Gameplay {
 		_isLocalTransformDirty(true),
 		_worldTransform(MAT4_IDENTITY),
 		_inverseWorldTransform(MAT4_IDENTITY),
+		_normalMatrix(MAT3_IDENTITY),
 		_isWorldTransformDirty(true),
+		_boundsLocalMin(ZERO),
+		_boundsLocalMax(ZERO),
+		_worldBoundsMin(ZERO),
+		_worldBoundsMax(ZERO),
+		_isWorldBoundsDirty(true),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
 	{ }
@@ -36,41 +43,59 @@ namespace Gameplay {
 	void GameObject::_RecalcLocalTransform() const
 	{
 		if (_isLocalTransformDirty) {
-			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
+			// We know the transform is made from a translation, rotation and scale, so we can build the inverse directly
+			ComposeTRS(_position, _rotation, _scale, _localTransform, _inverseLocalTransform);
 			_isLocalTransformDirty = false;
-			_isWorldTransformDirty = true;
-
-			// Dirty all the child objects world transforms
-			for (const auto& childPtr : _children) {
-				GameObject::Sptr childSptr = childPtr;
-				if (childSptr != nullptr) {
-					childSptr->_isWorldTransformDirty = true;
-				}
-			}
 		}
 	}
 
 	void GameObject::_RecalcWorldTransform() const {
+		// Since dirtying an object dirties all it's descendants, if we're clean then so are all our parents
+		if (!_isWorldTransformDirty && !_isLocalTransformDirty) {
+			return;
+		}
+
 		// Start by determining our local transform if required
 		_RecalcLocalTransform();
 
-		// If our world transform has been marked as dirty, we need to recalculate it!
-		if (_isWorldTransformDirty) {
-			GameObject::Sptr parent = _parent;
+		GameObject::Sptr parent = _parent;
 
-			// If out parent exists, we apply our local transformation relative to the parent's world transformation
-			if (parent != nullptr) {
-				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
-			}
+		// If out parent exists, we apply our local transformation relative to the parent's world transformation
+		if (parent != nullptr) {
+			parent->_RecalcWorldTransform();
+			MultiplyMat4(parent->_worldTransform, _localTransform, _worldTransform);
+			// (P * L)^-1 = L^-1 * P^-1, so we never need a general inverse
+			MultiplyMat4(_inverseLocalTransform, parent->_inverseWorldTransform, _inverseWorldTransform);
+		}
 
-			// If our parent is null, we can simply use the local transform as the world transform
-			else {
-				_worldTransform = _localTransform;
-				_inverseWorldTransform = _inverseLocalTransform;
+		// If our parent is null, we can simply use the local transform as the world transform
+		else {
+			_worldTransform = _localTransform;
+			_inverseWorldTransform = _inverseLocalTransform;
+		}
+
+		// The normal matrix is the transpose of the inverse, which we already have
+		_normalMatrix = glm::transpose(glm::mat3(_inverseWorldTransform));
+		_isWorldTransformDirty = false;
+		_isWorldBoundsDirty = true;
+	}
+
+	void GameObject::_MarkLocalTransformDirty() {
+		_isLocalTransformDirty = true;
+		_MarkWorldTransformDirty();
+	}
+
+	void GameObject::_MarkWorldTransformDirty() {
+		// If we're already dirty, our descendants must be as well
+		if (_isWorldTransformDirty) {
+			return;
+		}
+		_isWorldTransformDirty = true;
+		for (const auto& childPtr : _children) {
+			GameObject::Sptr childSptr = childPtr;
+			if (childSptr != nullptr) {
+				childSptr->_MarkWorldTransformDirty();
 			}
-			_isWorldTransformDirty = false;
 		}
 	}
 
@@ -113,7 +138,7 @@ namespace Gameplay {
 
 	void GameObject::SetPostion(const glm::vec3& position) {
 		_position = position;
-		_isLocalTransformDirty = true;
+		_MarkLocalTransformDirty();
 	}
 
 	const glm::vec3& GameObject::GetPosition() const {
@@ -122,7 +147,7 @@ namespace Gameplay {
 
 	void GameObject::SetRotation(const glm::quat& value) {
 		_rotation = value;
-		_isLocalTransformDirty = true;
+		_MarkLocalTransformDirty();
 	}
 
 	const glm::quat& GameObject::GetRotation() const {
@@ -131,7 +156,7 @@ namespace Gameplay {
 
 	void GameObject::SetRotation(const glm::vec3& eulerAngles) {
 		_rotation = glm::quat(glm::radians(eulerAngles));
-		_isLocalTransformDirty = true;
+		_MarkLocalTransformDirty();
 	}
 
 	glm::vec3 GameObject::GetRotationEuler() const {
@@ -140,7 +165,7 @@ namespace Gameplay {
 
 	void GameObject::SetScale(const glm::vec3& value) {
 		_scale = value;
-		_isLocalTransformDirty = true;
+		_MarkLocalTransformDirty();
 	}
 
 	const glm::vec3& GameObject::GetScale() const {
@@ -152,11 +177,40 @@ namespace Gameplay {
 		return _worldTransform;
 	}
 
+	void GameObject::GetWorldBounds(const glm::vec3& localMin, const glm::vec3& localMax, glm::vec3& outMin, glm::vec3& outMax) const {
+		_RecalcWorldTransform();
+
+		if (_isWorldBoundsDirty || localMin != _boundsLocalMin || localMax != _boundsLocalMax) {
+			// Transform the center, and project the extents onto the world axes (Arvo's method)
+			glm::vec3 center  = (localMin + localMax) * 0.5f;
+			glm::vec3 extents = (localMax - localMin) * 0.5f;
+			glm::vec3 worldCenter = glm::vec3(_worldTransform * glm::vec4(center, 1.0f));
+			glm::vec3 worldExtents =
+				glm::abs(glm::vec3(_worldTransform[0])) * extents.x +
+				glm::abs(glm::vec3(_worldTransform[1])) * extents.y +
+				glm::abs(glm::vec3(_worldTransform[2])) * extents.z;
+
+			_worldBoundsMin = worldCenter - worldExtents;
+			_worldBoundsMax = worldCenter + worldExtents;
+			_boundsLocalMin = localMin;
+			_boundsLocalMax = localMax;
+			_isWorldBoundsDirty = false;
+		}
+
+		outMin = _worldBoundsMin;
+		outMax = _worldBoundsMax;
+	}
+
 	const glm::mat4& GameObject::GetInverseTransform() const {
 		_RecalcWorldTransform();
 		return _inverseWorldTransform;
 	}
 
+	const glm::mat3& GameObject::GetNormalMatrix() const {
+		_RecalcWorldTransform();
+		return _normalMatrix;
+	}
+
 	const glm::mat4& GameObject::GetLocalTransform() const
 	{
 		_RecalcLocalTransform();
@@ -212,8 +266,6 @@ namespace Gameplay {
 			}
 		}
 
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 		_PurgeDeletedChildren();
 	}
 
@@ -275,9 +327,10 @@ namespace Gameplay {
 			// applies to the child
 			_children.push_back(child);
 			child->_parent = _selfRef.lock();
-			child->_isWorldTransformDirty = true;
+			child->_MarkWorldTransformDirty();
+			_scene->_isHierarchyDirty = true;
 		} else {
-			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->Name);
+			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->_name);
 		}
 	}
 
@@ -288,7 +341,9 @@ namespace Gameplay {
 		if (it != _children.end()) { 
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
+			child->_MarkWorldTransformDirty();
 			_children.erase(it);
+			_scene->_isHierarchyDirty = true;
 			return true;
 		} else {
 			return false;
@@ -311,16 +366,16 @@ namespace Gameplay {
 		ImGui::PushID(this); // Push a new ImGui ID scope for this object
 		// Since we're allowing names to change, we need to use the ### to have a static ID for the header
 		static char buffer[256];
-		sprintf_s(buffer, 256, "%s###GO_HEADER", Name.c_str());
+		sprintf_s(buffer, 256, "%s###GO_HEADER", _name.c_str());
 		if (ImGui::CollapsingHeader(buffer)) {
 			ImGui::Indent();
 
 			// Draw a textbox for our name
 			static char nameBuff[256];
-			memcpy(nameBuff, Name.c_str(), Name.size());
-			nameBuff[Name.size()] = '\0';
+			memcpy(nameBuff, _name.c_str(), _name.size());
+			nameBuff[_name.size()] = '\0';
 			if (ImGui::InputText("", nameBuff, 256)) {
-				Name = nameBuff;
+				SetName(nameBuff);
 			}
 			ImGui::SameLine();
 			if (ImGuiHelper::WarningButton("Delete")) {
@@ -350,7 +405,9 @@ namespace Gameplay {
 			}
 
 			// Render position label
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f);
+			if (LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f)) {
+				_MarkLocalTransformDirty();
+			}
 			
 			// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 			glm::vec3 euler = GetRotationEuler();
@@ -376,7 +433,9 @@ namespace Gameplay {
 			}
 			
 			// Draw the scale
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f);
+			if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f)) {
+				_MarkLocalTransformDirty();
+			}
 
 			ImGui::Separator();
 			ImGui::TextUnformatted("Components");
@@ -444,6 +503,21 @@ namespace Gameplay {
 		return _selfRef.lock();
 	}
 
+	void GameObject::SetName(const std::string& name) {
+		if (name == _name) {
+			return;
+		}
+		std::string oldName = _name;
+		_name = name;
+		if (_scene != nullptr) {
+			_scene->_OnObjectRenamed(this, oldName);
+		}
+	}
+
+	const std::string& GameObject::GetName() const {
+		return _name;
+	}
+
 	GameObject::Sptr GameObject::FromJson(Scene* scene, const nlohmann::json& data)
 	{
 		// We need to manually construct since the GameObject constructor is
@@ -452,7 +526,7 @@ namespace Gameplay {
 		result->_scene = scene;
 
 		// Load in basic info
-		result->Name = data["name"];
+		result->_name = data["name"];
 		result->_guid = Guid(data["guid"]);
 		result->_parent = WeakRef(Guid(data.contains("parent") ? data["parent"] : "null"), nullptr);
 		result->_position = (data["position"]);
@@ -466,24 +540,28 @@ namespace Gameplay {
 		// on the keys and values from the components object
 		nlohmann::json components = data["components"];
 		for (auto& [typeName, value] : components.items()) {
-			// We need to reference the component registry to load our components
-			// based on the type name (note that all component types need to be
-			// registered at the start of the application)
-			IComponent::Sptr component = scene->Components().Load(typeName, value);
-			component->_context = result.get();
-
-			// Add component to object and allow it to perform self initialization
-			result->_components.push_back(component);
-			component->OnLoad();
+			result->_AddLoadedComponent(typeName, value);
 		}
 
 		return result;
 	}
 
+	void GameObject::_AddLoadedComponent(const std::string& typeName, const nlohmann::json& data) {
+		// We need to reference the component registry to load our components
+		// based on the type name (note that all component types need to be
+		// registered at the start of the application)
+		IComponent::Sptr component = _scene->Components().Load(typeName, data);
+		component->_context = this;
+
+		// Add component to object and allow it to perform self initialization
+		_components.push_back(component);
+		component->OnLoad();
+	}
+
 	nlohmann::json GameObject::ToJson() const {
 		GameObject::Sptr parent = _parent;
 		nlohmann::json result = {
-			{ "name", Name },
+			{ "name", _name },
 			{ "guid", _guid.str() },
 			{ "position", _position },
 			{ "rotation", _rotation },
@@ -133,9 +133,6 @@ namespace Gameplay {
 			void Reset();
 		};
 
-		// Human readable name for the object
-		std::string             Name;
-
 		// Hack to hide instances from the hierarchy (like when adding lots of instances)
 		bool HideInHierarchy = false;
 
@@ -221,9 +218,25 @@ namespace Gameplay {
 		/// </summary>
 		const glm::mat4& GetInverseTransform() const;
 
+		/// <summary>
+		/// Gets or recalculates the matrix for transforming normals from local space to world space
+		/// (the inverse transpose of the world transform's rotation and scale)
+		/// </summary>
+		const glm::mat3& GetNormalMatrix() const;
+
 		const glm::mat4& GetLocalTransform() const;
 		const glm::mat4& GetInverseLocalTransform() const;
 
+		/// <summary>
+		/// Gets the world space axis aligned bounding box of a box in this object's local space. The result
+		/// is cached, and only recalculated when the world transform or the local box changes
+		/// </summary>
+		/// <param name="localMin">The minimum corner of the box, in local space</param>
+		/// <param name="localMax">The maximum corner of the box, in local space</param>
+		/// <param name="outMin">Will store the minimum corner of the box in world space</param>
+		/// <param name="outMax">Will store the maximum corner of the box in world space</param>
+		void GetWorldBounds(const glm::vec3& localMin, const glm::vec3& localMax, glm::vec3& outMin, glm::vec3& outMax) const;
+
 		/// <summary>
 		/// Allows components to render GUI elements to the screen
 		/// </summary>
@@ -323,6 +336,16 @@ namespace Gameplay {
 
 		std::shared_ptr<GameObject> SelfRef();
 
+		/// <summary>
+		/// Renames this object, keeping the scene's name lookup up to date
+		/// </summary>
+		/// <param name="name">The new name for the object</param>
+		void SetName(const std::string& name);
+		/// <summary>
+		/// Gets the human readable name of this object
+		/// </summary>
+		const std::string& GetName() const;
+
 		/// <summary>
 		/// Loads a render object from a JSON blob
 		/// </summary>
@@ -334,9 +357,15 @@ namespace Gameplay {
 
 	private:
 		friend class Scene;
+		friend class SceneStreamer;
 		friend class InspectorWindow;
 		friend class HierarchyWindow;
 
+		// Human readable name for the object, only changed through SetName so the scene's lookup stays in sync
+		std::string _name;
+		// Increases with every object added to the scene, so it sorts objects in scene order
+		uint64_t _sceneOrder;
+
 		// Rotation of the object as a quaternion
 		glm::quat _rotation;
 		// Position of the object
@@ -349,10 +378,19 @@ namespace Gameplay {
 		mutable glm::mat4 _inverseLocalTransform;
 		mutable bool _isLocalTransformDirty;
 
+		// If an object's world transform is dirty, so are the world transforms of all of it's descendants
 		mutable glm::mat4 _worldTransform;
 		mutable glm::mat4 _inverseWorldTransform;
+		mutable glm::mat3 _normalMatrix;
 		mutable bool _isWorldTransformDirty;
 
+		// Cached world space bounds, see GetWorldBounds
+		mutable glm::vec3 _boundsLocalMin;
+		mutable glm::vec3 _boundsLocalMax;
+		mutable glm::vec3 _worldBoundsMin;
+		mutable glm::vec3 _worldBoundsMax;
+		mutable bool _isWorldBoundsDirty;
+
 		// For the hierarchy
 		WeakRef _parent;
 		std::vector<WeakRef> _children;
@@ -375,7 +413,19 @@ namespace Gameplay {
 		void _RecalcLocalTransform() const;
 		void _RecalcWorldTransform() const;
 
+		// Marks the local transform as dirty, along with the world transforms of this object and it's descendants
+		void _MarkLocalTransformDirty();
+		// Marks the world transforms of this object and it's descendants as dirty
+		void _MarkWorldTransformDirty();
+
 		void _PurgeDeletedChildren();
+
+		/// <summary>
+		/// Loads a component from it's JSON representation and attaches it to this object
+		/// </summary>
+		/// <param name="typeName">The registered type name of the component</param>
+		/// <param name="data">The component's JSON blob, including the base component data</param>
+		void _AddLoadedComponent(const std::string& typeName, const nlohmann::json& data);
 	};
 
 }
\ No newline at end of file
@@ -7,12 +7,23 @@
 #include "Utils/ImGuiHelper.h"
 #include "Graphics/Textures/Texture1D.h"
 #include "Graphics/Textures/Texture3D.h"
+#include <algorithm>
+#include <atomic>
 
 namespace Gameplay {
+	// Source of material state keys, 0 is reserved for "no material applied"
+	static std::atomic<uint64_t> NextStateKey(1);
+
 	Material::Material(const ShaderProgram::Sptr& shader) :
 		IResource(),
 		_shader(shader),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_valueUniforms(),
+		_textureUniforms(),
+		_isApplyListDirty(true),
+		_stateKey(NextStateKey++),
+		_lastApplyCallCount(0),
+		_shaderGeneration(0)
 	{
 		_PopulateUniforms();
 	}
@@ -20,13 +31,23 @@ namespace Gameplay {
 	Material::Material() :
 		IResource(),
 		_shader(nullptr),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_valueUniforms(),
+		_textureUniforms(),
+		_isApplyListDirty(true),
+		_stateKey(NextStateKey++),
+		_lastApplyCallCount(0),
+		_shaderGeneration(0)
 	{ }
 
 	void Material::Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize)
 	{
-		// Try and find the matching uniform
+		// Try and find the matching uniform, it may be inserted into the map if this is a new name
+		const size_t uniformCount = _uniforms.size();
 		UniformData& uniform = _GetUniform(name);
+		if (_uniforms.size() != uniformCount) {
+			_isApplyListDirty = true;
+		}
 
 		// We have a uniform, let's see if we can update it
 		if (uniform.Location != -2) {
@@ -48,6 +69,7 @@ namespace Gameplay {
 				else {
 					memcpy(uniform.Value, value, ShaderDataTypeSize(type));
 				}
+				_MarkDirty();
 			}
 		}
 		// We couldn't find that uniform, log a warning
@@ -61,39 +83,45 @@ namespace Gameplay {
 	}
 
 	void Material::Apply() {
+		_lastApplyCallCount = 0;
 		if (_shader != nullptr) {
-			// Skip the reserved # of texture slots
-			int textureSlot = 0;
-			
-			// Iterate over the uniforms map
-			for (auto&[name, data] : _uniforms) {
-				// The typecode is basically the underlying type of the uniform
-				// ex: float, matrix, texture, etc...
-				ShaderDataTypecode typeCode = GetShaderDataTypeCode(data.Type);
-
-				// If the uniform is a texture, we try and bind it, then move to the next slot
-				if (typeCode == ShaderDataTypecode::Texture) {
-					if (textureSlot >= MAX_TEXTURE_SLOTS) {
-						LOG_WARN("Ignoring material binding, exceeds allowed number of textures");
-					}
-					else {
-						ITexture::Sptr texture = data.TextureAsset;
-						if (texture != nullptr) {
-							texture->Bind(textureSlot);
-						}
-						else {
-							ITexture::Unbind(textureSlot);
-						}
-						// Send the slot to the shader
-						_shader->SetUniform(data.Location, data.Type, &textureSlot);
-						textureSlot++;
-					}
+			if (_shader->GetLinkGeneration() != _shaderGeneration) {
+				_RemapUniforms();
+			}
+			if (_isApplyListDirty) {
+				_BuildApplyList();
+			}
+
+			// Textures are bound to global state, so we need to bind them every time
+			for (size_t ix = 0; ix < _textureUniforms.size(); ix++) {
+				const ITexture::Sptr& texture = _textureUniforms[ix]->TextureAsset;
+				if (texture != nullptr) {
+					texture->Bind((int)ix);
 				}
-				// The uniform is a plain ol' value type, send it in
 				else {
-					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, data.ArraySize);
+					ITexture::Unbind((int)ix);
 				}
 			}
+			_lastApplyCallCount += (uint32_t)_textureUniforms.size();
+
+			// Uniforms are stored in the program object, so if the program still holds our values we're done
+			if (_shader->GetMaterialStateKey() == _stateKey) {
+				return;
+			}
+
+			// Send the slots for each texture to the shader
+			for (int ix = 0; ix < (int)_textureUniforms.size(); ix++) {
+				_shader->SetUniform(_textureUniforms[ix]->Location, _textureUniforms[ix]->Type, &ix);
+			}
+			_lastApplyCallCount += (uint32_t)_textureUniforms.size();
+
+			// Send in all the plain ol' value types
+			for (UniformData* data : _valueUniforms) {
+				_shader->SetUniform(data->Location, data->Type, data->ArraySize > 1 ? data->ArrayBlock : data->Value, (int)data->ArraySize);
+			}
+			_lastApplyCallCount += (uint32_t)_valueUniforms.size();
+
+			_shader->SetMaterialStateKey(_stateKey);
 		}
 	}
 
@@ -109,7 +137,9 @@ namespace Gameplay {
 			// Draw all of our valid uniforms
 			for (auto&[key, value] : _uniforms) {
 				if (value.Location != -2 && value.Location != -1) {
-					value.RenderImGui();
+					if (value.RenderImGui()) {
+						_MarkDirty();
+					}
 				}
 			}
 
@@ -145,6 +175,8 @@ namespace Gameplay {
 				}
 			}
 		}
+		result->_isApplyListDirty = true;
+		result->_MarkDirty();
 		return result;
 	}
 
@@ -192,6 +224,77 @@ namespace Gameplay {
 		for (const auto& [key, value] : uniforms) {
 			_uniforms[key] = _GetUniform(key);
 		}
+		_shaderGeneration = _shader->GetLinkGeneration();
+		_isApplyListDirty = true;
+	}
+
+	void Material::_RemapUniforms()
+	{
+		for (auto& [name, data] : _uniforms) {
+			ShaderProgram::UniformInfo uniform;
+			if (!_shader->FindUniform(name, &uniform) || 
+				(GetShaderDataTypeCode(uniform.Type) == ShaderDataTypecode::Texture && uniform.Binding >= MAX_TEXTURE_SLOTS)) {
+				// Keep the value around, in case the uniform comes back in a later reload
+				data.Location = -1;
+			}
+			else if (uniform.Type == data.Type && (size_t)uniform.ArraySize == data.ArraySize) {
+				data.Location = uniform.Location;
+				data.BindingSlot = uniform.Binding;
+			}
+			else {
+				if (data.Type != ShaderDataType::None) {
+					LOG_WARN("Uniform \"{}\" in material \"{}\" changed type or size, resetting its value", name, Name);
+				}
+				data = UniformData(name, _shader);
+			}
+		}
+
+		// Pick up any uniforms that are new to the shader
+		for (const auto& [key, value] : _shader->GetUniforms()) {
+			if (_uniforms.count(key) == 0) {
+				_GetUniform(key);
+			}
+		}
+
+		_shaderGeneration = _shader->GetLinkGeneration();
+		_isApplyListDirty = true;
+	}
+
+	void Material::_MarkDirty()
+	{
+		_stateKey = NextStateKey++;
+	}
+
+	void Material::_BuildApplyList()
+	{
+		_valueUniforms.clear();
+		_textureUniforms.clear();
+
+		// Pointers into the map are stable, since unordered_map never moves its nodes
+		for (auto& [name, data] : _uniforms) {
+			if (data.Location < 0) {
+				continue;
+			}
+			if (data.IsTextureResource()) {
+				if (_textureUniforms.size() >= MAX_TEXTURE_SLOTS) {
+					LOG_WARN("Ignoring binding for \"{}\" in material \"{}\", exceeds allowed number of textures", name, Name);
+				} else {
+					_textureUniforms.push_back(&data);
+				}
+			} else {
+				_valueUniforms.push_back(&data);
+			}
+		}
+
+		// Sort by location so that we walk the program's uniform storage in order
+		auto byLocation = [](const UniformData* a, const UniformData* b) { return a->Location < b->Location; };
+		std::sort(_valueUniforms.begin(), _valueUniforms.end(), byLocation);
+		std::sort(_textureUniforms.begin(), _textureUniforms.end(), byLocation);
+
+		_isApplyListDirty = false;
+
+		// The texture slots may have moved around, so everything needs to be re-sent
+		_MarkDirty();
 	}
 
 	bool Material::UniformData::RenderImGui() {
@@ -62,10 +62,17 @@ namespace Gameplay {
 
 		/// <summary>
 		/// Handles applying this material's state to the OpenGL pipeline
-		/// Will bind the shader, update material uniforms, and bind textures
+		/// Will update material uniforms and bind textures. Uniforms are only re-sent if they
+		/// have changed, or if another material has been applied to the shader since this one
+		/// If the shader has been relinked (ex: hot reloaded) our values are remapped to its new uniforms
 		/// </summary>
 		virtual void Apply();
 
+		/// <summary>
+		/// Gets the number of GL calls that were issued by the last call to Apply
+		/// </summary>
+		uint32_t GetLastApplyCallCount() const { return _lastApplyCallCount; }
+
 		/// <summary>
 		/// Renders some UI controls for manipulating a material at runtime
 		/// </summary>
@@ -175,7 +182,40 @@ namespace Gameplay {
 		/// </summary>
 		std::unordered_map<std::string, UniformData> _uniforms;
 
+		/// <summary>
+		/// The valid value uniforms, sorted by location. Rebuilt when the set of uniforms changes
+		/// </summary>
+		std::vector<UniformData*> _valueUniforms;
+		/// <summary>
+		/// The valid texture uniforms, sorted by location. Each texture is bound to the slot matching its index
+		/// </summary>
+		std::vector<UniformData*> _textureUniforms;
+		bool                      _isApplyListDirty;
+		/// <summary>
+		/// Unique key for the current uniform values, a new key is taken whenever a value changes
+		/// </summary>
+		uint64_t                  _stateKey;
+		uint32_t                  _lastApplyCallCount;
+		/// <summary>
+		/// The link generation of the shader when our uniform locations were last looked up
+		/// </summary>
+		uint32_t                  _shaderGeneration;
+
 		UniformData& _GetUniform(const std::string& name);
 		void _PopulateUniforms();
+		/// <summary>
+		/// Looks up our uniforms again after the shader has been relinked, keeping the values of any
+		/// uniforms that still exist with the same type and size
+		/// </summary>
+		void _RemapUniforms();
+
+		/// <summary>
+		/// Flags that our uniform values have changed and need to be re-sent on the next Apply
+		/// </summary>
+		void _MarkDirty();
+		/// <summary>
+		/// Rebuilds the location sorted apply lists from the uniform map
+		/// </summary>
+		void _BuildApplyList();
 	};
 }
\ No newline at end of file
@@ -1,14 +1,47 @@
 #include "MeshResource.h"
 #include <filesystem>
 
-#include "Utils/ObjLoader.h"
+#include "Utils/OptimizedObjLoader.h"
 
 namespace Gameplay {
+	/// <summary>
+	/// Everything we need to create our VAO, read from disk on a worker thread
+	/// </summary>
+	struct MeshResource::DecodedMesh {
+		OptimizedObjLoader::BinaryMeshView View;
+		glm::vec3 BoundsMin = glm::vec3(0.0f);
+		glm::vec3 BoundsMax = glm::vec3(0.0f);
+		bool      HasBounds = false;
+	};
+
+	/// <summary>
+	/// Finds the bounds of the vertices in a mesh builder
+	/// </summary>
+	/// <returns>True if the mesh had any vertices</returns>
+	static bool CalculateBounds(const MeshBuilder<VertexPosNormTexColTangents>& mesh, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+		boundsMin = glm::vec3(0.0f);
+		boundsMax = glm::vec3(0.0f);
+		if (mesh.GetVertexCount() == 0) {
+			return false;
+		}
+		const VertexPosNormTexColTangents* vertices = mesh.GetVertexDataPtr();
+		boundsMin = boundsMax = vertices[0].Position;
+		for (size_t ix = 1; ix < mesh.GetVertexCount(); ix++) {
+			boundsMin = glm::min(boundsMin, vertices[ix].Position);
+			boundsMax = glm::max(boundsMax, vertices[ix].Position);
+		}
+		return true;
+	}
+
 	MeshResource::MeshResource() :
 		IResource(),
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
+		Lods(),
+		BoundsMin(glm::vec3(0.0f)),
+		BoundsMax(glm::vec3(0.0f)),
+		HasBounds(false),
 		BulletTriMesh(nullptr)
 	{ }
 
@@ -17,9 +50,13 @@ namespace Gameplay {
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
+		Lods(),
+		BoundsMin(glm::vec3(0.0f)),
+		BoundsMax(glm::vec3(0.0f)),
+		HasBounds(false),
 		BulletTriMesh(nullptr)
 	{
-		Mesh = ObjLoader::LoadFromFile(filename);
+		_LoadFromFile();
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -51,31 +88,144 @@ namespace Gameplay {
 				MeshFactory::AddParameterized(mesh, p);
 			}
 			MeshFactory::CalculateTBN(mesh);
-			result->Mesh = mesh.Bake();
+			result->_Bake(mesh);
 		} else {
 			result->Filename = JsonGet<std::string>(blob, "filename", "null");
 			if (result->Filename != "null" && std::filesystem::exists(result->Filename)) {
-				#ifdef OPTIMIZED_OBJ_LOADER
-				result->Mesh = OptimizedObjLoader::LoadFromFile(result->Filename);
-				#else
-				result->Mesh = ObjLoader::LoadFromFile(result->Filename);
-				#endif
-
+				result->_LoadFromFile();
 			}
 		}
 		return result;
 	}
 
+	MeshResource::Sptr MeshResource::FromJsonAsync(const nlohmann::json& blob)
+	{
+		// Generated meshes are cheap enough to just build on the spot
+		if (blob.contains("params") && blob["params"].is_array()) {
+			return FromJson(blob);
+		}
+
+		// Until we're uploaded Mesh is null, which the renderer already skips
+		MeshResource::Sptr result = std::make_shared<MeshResource>();
+		result->Filename = JsonGet<std::string>(blob, "filename", "null");
+		return result;
+	}
+
+	bool MeshResource::DecodeAsync()
+	{
+		if (Filename == "null" || !std::filesystem::exists(Filename)) {
+			return false;
+		}
+
+		std::unique_ptr<DecodedMesh> decoded = std::make_unique<DecodedMesh>();
+
+		// Converting a new OBJ file happens here too, so first runs don't stall the main thread either
+		std::string binFile = OptimizedObjLoader::ResolveBinaryFile(Filename);
+		if (binFile.empty()) {
+			return false;
+		}
+		decoded->View = OptimizedObjLoader::InspectBinaryFile(binFile);
+		if (!decoded->View.IsValid()) {
+			return false;
+		}
+		OptimizedObjLoader::MeshDetails details;
+		OptimizedObjLoader::CalculateBounds(decoded->View, details);
+		decoded->BoundsMin = details.BoundsMin;
+		decoded->BoundsMax = details.BoundsMax;
+		decoded->HasBounds = details.HasBounds;
+
+		_decoded = std::move(decoded);
+		return true;
+	}
+
+	void MeshResource::FinishAsyncLoad()
+	{
+		if (_decoded == nullptr) {
+			return;
+		}
+
+		OptimizedObjLoader::MeshDetails details;
+		VertexArrayObject::Sptr mesh = OptimizedObjLoader::UploadBinaryView(_decoded->View, &details);
+		Lods.clear();
+		for (const auto& level : details.Lods) {
+			VertexArrayObject::Sptr lodMesh = mesh->Clone();
+			lodMesh->SetIndexBuffer(level.Indices);
+			Lods.push_back({ lodMesh, level.Error });
+		}
+		Mesh = mesh;
+
+		BoundsMin = _decoded->BoundsMin;
+		BoundsMax = _decoded->BoundsMax;
+		HasBounds = _decoded->HasBounds;
+
+		// Frees the mapping, and the decompressed copy of the mesh if the file was compressed
+		_decoded = nullptr;
+	}
+
 	void MeshResource::GenerateMesh() {
 		MeshBuilder<VertexPosNormTexColTangents> mesh;
 		for (auto& param : MeshBuilderParams) {
 			MeshFactory::AddParameterized(mesh, param);
 		}
 		MeshFactory::CalculateTBN(mesh);
-		Mesh = mesh.Bake();
+		_Bake(mesh);
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
 		MeshBuilderParams.push_back(param);
 	}
+
+	const VertexArrayObject::Sptr& MeshResource::SelectLod(float pixelsPerUnit, float maxPixelError) const {
+		// Levels get less detailed as we go, so walk backwards and take the first one that's accurate enough
+		for (auto it = Lods.rbegin(); it != Lods.rend(); it++) {
+			if (it->Error * pixelsPerUnit <= maxPixelError) {
+				return it->Mesh;
+			}
+		}
+		return Mesh;
+	}
+
+	void MeshResource::_LoadFromFile() {
+		Lods.clear();
+		HasBounds = false;
+
+		// The binary files store pre-generated levels of detail, so we only need to upload them
+		OptimizedObjLoader::MeshDetails details;
+		Mesh = OptimizedObjLoader::LoadFromFile(Filename, &details);
+		if (Mesh != nullptr) {
+			BoundsMin = details.BoundsMin;
+			BoundsMax = details.BoundsMax;
+			HasBounds = details.HasBounds;
+			for (const auto& level : details.Lods) {
+				VertexArrayObject::Sptr lodMesh = Mesh->Clone();
+				lodMesh->SetIndexBuffer(level.Indices);
+				Lods.push_back({ lodMesh, level.Error });
+			}
+		}
+	}
+
+	void MeshResource::_Bake(MeshBuilder<VertexPosNormTexColTangents>& mesh) {
+		// File meshes are optimized when they're converted to binary files, generated ones need it here.
+		// This has to happen before we generate our LODs, since it re-orders the vertices
+		mesh.Optimize();
+
+		// Find the bounds of the mesh
+		HasBounds = CalculateBounds(mesh, BoundsMin, BoundsMax);
+		_Upload(mesh, mesh.GenerateLods());
+	}
+
+	void MeshResource::_Upload(MeshBuilder<VertexPosNormTexColTangents>& mesh, const std::vector<MeshSimplifier::Lod>& lods) {
+		Mesh = mesh.Bake();
+		Lods.clear();
+
+		// The levels of detail share the vertex buffer of the full mesh, and only need their own indices
+		for (const MeshSimplifier::Lod& lod : lods) {
+			IndexBuffer::Sptr indices = IndexBuffer::Create();
+			indices->LoadData(lod.Indices.data(), static_cast<uint32_t>(lod.Indices.size()));
+
+			VertexArrayObject::Sptr lodMesh = Mesh->Clone();
+			lodMesh->SetIndexBuffer(indices);
+			Lods.push_back({ lodMesh, lod.Error });
+		}
+	}
 }
\ No newline at end of file
@@ -16,6 +16,16 @@ namespace Gameplay {
 	public:
 		typedef std::shared_ptr<MeshResource> Sptr;
 
+		/// <summary>
+		/// A simplified version of the mesh, which shares the vertex buffer of the full mesh
+		/// </summary>
+		struct Lod {
+			// The VAO to draw for this level of detail
+			VertexArrayObject::Sptr Mesh;
+			// The approximate distance between this level and the full mesh, in object space units
+			float                   Error;
+		};
+
 		// Default constructor
 		MeshResource();
 		/// <summary>
@@ -40,7 +50,20 @@ namespace Gameplay {
 		/// The VAO for rendering this mesh in OpenGL
 		/// </summary>
 		VertexArrayObject::Sptr         Mesh;
-
+		/// <summary>
+		/// The simplified levels of detail for Mesh, from most to least detailed. Will be empty
+		/// for meshes that are too small or could not be simplified
+		/// </summary>
+		std::vector<Lod>                Lods;
+		/// <summary>
+		/// The object space bounds of the mesh, only valid if HasBounds is true
+		/// </summary>
+		glm::vec3                       BoundsMin;
+		glm::vec3                       BoundsMax;
+		/// <summary>
+		/// True if the bounds have been calculated for Mesh. Meshes without bounds are never culled
+		/// </summary>
+		bool                            HasBounds;
 
 		/// <summary>
 		/// The optional mesh resource for generating colliders from this mesh
@@ -61,9 +84,38 @@ namespace Gameplay {
 		/// <param name="param">The parameter to add</param>
 		void AddParam(const MeshBuilderParam& param);
 
+		/// <summary>
+		/// Selects the least detailed version of the mesh that will appear within the given number
+		/// of pixels of the full mesh, or the full mesh if no levels of detail are accurate enough
+		/// </summary>
+		/// <param name="pixelsPerUnit">The number of pixels that one object space unit covers on screen</param>
+		/// <param name="maxPixelError">The largest error, in pixels, that we can get away with</param>
+		/// <returns>The VAO to draw</returns>
+		const VertexArrayObject::Sptr& SelectLod(float pixelsPerUnit, float maxPixelError = 1.0f) const;
+
 		// Inherited from IResource
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+		/// <summary>
+		/// Creates a mesh resource without a VAO for ResourceManager::LoadAsync, the file is parsed in
+		/// DecodeAsync and the VAO is uploaded in FinishAsyncLoad. Generated meshes are created immediately
+		/// </summary>
+		static MeshResource::Sptr FromJsonAsync(const nlohmann::json& blob);
+
+		virtual bool DecodeAsync() override;
+		virtual void FinishAsyncLoad() override;
+
+	protected:
+		// Mesh data parsed from our file that is waiting to be uploaded, see DecodeAsync
+		struct DecodedMesh;
+		std::unique_ptr<DecodedMesh> _decoded;
+
+		void _LoadFromFile();
+		void _Bake(MeshBuilder<VertexPosNormTexColTangents>& mesh);
+		/// <summary>
+		/// Uploads a mesh and it's simplified levels of detail to OpenGL, does not touch the bounds
+		/// </summary>
+		void _Upload(MeshBuilder<VertexPosNormTexColTangents>& mesh, const std::vector<MeshSimplifier::Lod>& lods);
 	};
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <GLFW/glfw3.h>
 #include <locale>
 #include <codecvt>
+#include <unordered_set>
+#include <filesystem>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/GlmBulletConversions.h"
@@ -11,6 +13,7 @@
 #include "Gameplay/Physics/TriggerVolume.h"
 #include "Gameplay/MeshResource.h"
 #include "Gameplay/Material.h"
+#include "Gameplay/SceneStreamer.h"
 
 #include "Graphics/DebugDraw.h"
 #include "Graphics/Textures/TextureCube.h"
@@ -21,6 +24,11 @@ namespace Gameplay {
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_objectsByGuid(),
+		_objectsByName(),
+		_nextSceneOrder(0),
+		_transformOrder(),
+		_isHierarchyDirty(true),
 		Lights(std::vector<Light>()),
 		IsPlaying(false),
 		MainCamera(nullptr),
@@ -51,6 +59,9 @@ namespace Gameplay {
 		_skyboxShader = nullptr;
 		_skyboxMesh = nullptr;
 		_skyboxTexture = nullptr;
+		_objectsByGuid.clear();
+		_objectsByName.clear();
+		_transformOrder.clear();
 		_objects.clear();
 		Lights.clear();
 		_CleanupPhysics();
@@ -111,10 +122,10 @@ namespace Gameplay {
 	GameObject::Sptr Scene::CreateGameObject(const std::string& name)
 	{
 		GameObject::Sptr result(new GameObject());
-		result->Name = name;
+		result->_name = name;
 		result->_scene = this;
 		result->_selfRef = result;
-		_objects.push_back(result);
+		_AddObject(result);
 		return result;
 	}
 
@@ -123,17 +134,13 @@ namespace Gameplay {
 	}
 
 	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->Name == name;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _objectsByName.find(name);
+		return it == _objectsByName.end() || it->second.empty() ? nullptr : it->second.front()->SelfRef();
 	}
 
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->_guid == id;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _objectsByGuid.find(id);
+		return it == _objectsByGuid.end() ? nullptr : it->second->SelfRef();
 	}
 
 	void Scene::SetAmbientLight(const glm::vec3& value) {
@@ -172,10 +179,10 @@ namespace Gameplay {
 	}
 
 	void Scene::DoPhysics(float dt) {
-		_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+		_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 			body->PhysicsPreStep(dt);
 		});
-		_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+		_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 			body->PhysicsPreStep(dt);
 		});
 
@@ -183,10 +190,10 @@ namespace Gameplay {
 
 			_physicsWorld->stepSimulation(dt, 1);
 
-			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
+			_components.Each<Gameplay::Physics::RigidBody>([=](Gameplay::Physics::RigidBody* body) {
 				body->PhysicsPostStep(dt);
 			});
-			_components.Each<Gameplay::Physics::TriggerVolume>([=](const std::shared_ptr<Gameplay::Physics::TriggerVolume>& body) {
+			_components.Each<Gameplay::Physics::TriggerVolume>([=](Gameplay::Physics::TriggerVolume* body) {
 				body->PhysicsPostStep(dt);
 			});
 		}
@@ -207,9 +214,12 @@ namespace Gameplay {
 			}
 		}
 		_FlushDeleteQueue();
+		_UpdateTransforms();
 	}
 
 	void Scene::PreRender() {
+		// Physics may have moved objects since the update
+		_UpdateTransforms();
 		_lightingUbo->Bind(LIGHT_UBO_BINDING);
 	}
 
@@ -264,6 +274,10 @@ namespace Gameplay {
 
 		Scene::Sptr result = std::make_shared<Scene>();
 		result->MainCamera = nullptr;
+		result->_objectsByGuid.clear();
+		result->_objectsByName.clear();
+		result->_transformOrder.clear();
+		result->_isHierarchyDirty = true;
 		result->_objects.clear();
 		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
 
@@ -286,7 +300,7 @@ namespace Gameplay {
 			obj->_scene = result.get();
 			obj->_parent.SceneContext = result.get();
 			obj->_selfRef = obj;
-			result->_objects.push_back(obj);
+			result->_AddObject(obj);
 		}
 
 		// Re-build the parent hierarchy 
@@ -346,6 +360,10 @@ namespace Gameplay {
 
 	void Scene::Save(const std::string& path) {
 		_filePath = path;
+		if (std::filesystem::path(path).extension() == SceneStreamer::FILE_EXTENSION) {
+			SceneStreamer::Save(*this, path);
+			return;
+		}
 		// Save data to file
 		FileHelpers::WriteContentsToFile(path, ToJson().dump(1, '\t'));
 		LOG_INFO("Saved scene to \"{}\"", path);
@@ -354,10 +372,21 @@ namespace Gameplay {
 	Scene::Sptr Scene::Load(const std::string& path)
 	{
 		LOG_INFO("Loading scene from \"{}\"", path);
-		std::string content = FileHelpers::ReadFile(path);
-		nlohmann::json blob = nlohmann::json::parse(content);
-		Scene::Sptr result = FromJson(blob);
-		result->_filePath = path;
+		double startTime = glfwGetTime();
+
+		Scene::Sptr result = nullptr;
+		if (std::filesystem::path(path).extension() == SceneStreamer::FILE_EXTENSION) {
+			result = SceneStreamer::Load(path);
+		} else {
+			std::string content = FileHelpers::ReadFile(path);
+			nlohmann::json blob = nlohmann::json::parse(content);
+			result = FromJson(blob);
+		}
+
+		if (result != nullptr) {
+			result->_filePath = path;
+			LOG_TRACE("Loaded scene \"{}\" in {} seconds ({} objects)", path, glfwGetTime() - startTime, result->NumObjects());
+		}
 		return result;
 	}
 
@@ -400,14 +429,112 @@ namespace Gameplay {
 
 
 	void Scene::_FlushDeleteQueue() {
+		if (_deletionQueue.empty()) {
+			return;
+		}
+
+		// Gather the objects to delete into a set, this also handles objects being queued more than once
+		std::unordered_set<GameObject*> deleted;
+		deleted.reserve(_deletionQueue.size());
 		for (auto& weakPtr : _deletionQueue) {
-			if (weakPtr.expired()) continue;
-			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
-			if (it != _objects.end()) {
-				_objects.erase(it);
+			GameObject::Sptr object = weakPtr.lock();
+			if (object != nullptr && object->_scene == this) {
+				deleted.insert(object.get());
 			}
 		}
 		_deletionQueue.clear();
+		if (deleted.empty()) {
+			return;
+		}
+
+		// Remove the objects from the lookups, compacting each affected name's list once
+		std::unordered_set<std::string> names;
+		for (GameObject* object : deleted) {
+			auto guidIt = _objectsByGuid.find(object->_guid);
+			if (guidIt != _objectsByGuid.end() && guidIt->second == object) {
+				_objectsByGuid.erase(guidIt);
+			}
+			names.insert(object->_name);
+		}
+		for (const std::string& name : names) {
+			auto nameIt = _objectsByName.find(name);
+			if (nameIt != _objectsByName.end()) {
+				std::vector<GameObject*>& named = nameIt->second;
+				named.erase(std::remove_if(named.begin(), named.end(), [&](GameObject* object) {
+					return deleted.count(object) > 0;
+				}), named.end());
+				if (named.empty()) {
+					_objectsByName.erase(nameIt);
+				}
+			}
+		}
+
+		// Compact the object list in a single pass, keeping the remaining objects in order. The
+		// deleted objects (and their components) are destroyed when the tail is erased
+		auto it = std::remove_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& object) {
+			return deleted.count(object.get()) > 0;
+		});
+		_objects.erase(it, _objects.end());
+		_isHierarchyDirty = true;
+	}
+
+	void Scene::_AddObject(const GameObject::Sptr& object) {
+		// New objects always go at the end of the scene, and so at the end of their name's list
+		object->_sceneOrder = _nextSceneOrder++;
+		_objects.push_back(object);
+		_objectsByGuid[object->_guid] = object.get();
+		_objectsByName[object->_name].push_back(object.get());
+		_isHierarchyDirty = true;
+	}
+
+	void Scene::_OnObjectRenamed(GameObject* object, const std::string& oldName) {
+		auto nameIt = _objectsByName.find(oldName);
+		if (nameIt == _objectsByName.end()) {
+			return;
+		}
+		std::vector<GameObject*>& named = nameIt->second;
+		auto it = std::find(named.begin(), named.end(), object);
+		if (it == named.end()) {
+			return;
+		}
+		named.erase(it);
+		if (named.empty()) {
+			_objectsByName.erase(nameIt);
+		}
+
+		// Keep the new name's list in scene order, so FindObjectByName still returns the first match in the scene
+		std::vector<GameObject*>& renamed = _objectsByName[object->_name];
+		renamed.insert(std::upper_bound(renamed.begin(), renamed.end(), object, [](const GameObject* a, const GameObject* b) {
+			return a->_sceneOrder < b->_sceneOrder;
+		}), object);
+	}
+
+	void Scene::_UpdateTransforms() {
+		if (_isHierarchyDirty) {
+			// Walk down from each root object, so that parents are always listed before their children
+			_transformOrder.clear();
+			_transformOrder.reserve(_objects.size());
+			for (const auto& object : _objects) {
+				if (object->GetParent() == nullptr) {
+					_transformOrder.push_back(object.get());
+				}
+			}
+			for (size_t ix = 0; ix < _transformOrder.size(); ix++) {
+				for (const auto& child : _transformOrder[ix]->GetChildren()) {
+					GameObject::Sptr childSptr = child;
+					if (childSptr != nullptr) {
+						_transformOrder.push_back(childSptr.get());
+					}
+				}
+			}
+			_isHierarchyDirty = false;
+		}
+
+		// Since each parent is updated before it's children, recalculating a transform never has to
+		// walk back up the hierarchy, and clean objects are skipped immediately
+		for (GameObject* object : _transformOrder) {
+			object->_RecalcWorldTransform();
+		}
 	}
 
 	void Scene::DrawAllGameObjectGUIs()
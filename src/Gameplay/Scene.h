@@ -91,16 +91,15 @@ namespace Gameplay {
 		void RemoveGameObject(const GameObject::Sptr& object);
 
 		/// <summary>
-		/// Searches all objects in the scene and returns the first
-		/// one who's name matches the one given, or nullptr if no object
-		/// is found
+		/// Returns the first object in the scene who's name matches the one given, 
+		/// or nullptr if no object is found. Objects must be renamed via 
+		/// GameObject::SetName to be found under their new name
 		/// </summary>
 		/// <param name="name">The name of the object to find</param>
 		GameObject::Sptr FindObjectByName(const std::string name) const;
 		/// <summary>
-		/// Searches all render objects in the scene and returns the first
-		/// one who's guid matches the one given, or nullptr if no object
-		/// is found
+		/// Returns the object in the scene who's guid matches the one given, 
+		/// or nullptr if no object is found
 		/// </summary>
 		/// <param name="id">The guid of the object to find</param>
 		GameObject::Sptr FindObjectByGUID(Guid id) const;
@@ -196,12 +195,13 @@ namespace Gameplay {
 		const ComponentManager& Components() const { return _components; }
 
 		/// <summary>
-		/// Saves this scene to an output JSON file
+		/// Saves this scene to an output file, paths ending in .bscene are saved in the binary
+		/// scene format (see SceneStreamer), anything else is saved as JSON
 		/// </summary>
 		/// <param name="path">The path of the file to write to</param>
 		void Save(const std::string& path);
 		/// <summary>
-		/// Loads a scene from an input JSON file
+		/// Loads a scene from an input JSON or binary scene file, based on the file's extension
 		/// </summary>
 		/// <param name="path">The path of the file to read from</param>
 		/// <returns>A new scene loaded from the file</returns>
@@ -214,6 +214,7 @@ namespace Gameplay {
 	protected:
 		friend class HierarchyWindow;
 		friend class GameObject;
+		friend class SceneStreamer;
 
 		// The component manager will store all components for objects in this scene
 		ComponentManager _components;
@@ -243,6 +244,20 @@ namespace Gameplay {
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
 
+		// Lookups for all the objects in _objects, so that finding objects (and resolving references
+		// when loading scenes) doesn't need to scan the whole scene. Names are not unique, so each name
+		// maps to all objects with that name, in the order they were added to the scene
+		std::unordered_map<Guid, GameObject*>                     _objectsByGuid;
+		std::unordered_map<std::string, std::vector<GameObject*>> _objectsByName;
+		// The scene order to give the next object that is added, see GameObject::_sceneOrder
+		uint64_t                                                  _nextSceneOrder;
+
+		// All the objects in the scene, ordered so that parents always come before their children. This
+		// lets us update every transform in one pass without recursing up the hierarchy
+		std::vector<GameObject*> _transformOrder;
+		// True when objects have been added, removed or re-parented since _transformOrder was built
+		bool                     _isHierarchyDirty;
+
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
 		std::shared_ptr<MeshResource> _skyboxMesh;
@@ -296,6 +311,23 @@ namespace Gameplay {
 		/// </summary>
 		void _CleanupPhysics();
 
+		/// <summary>
+		/// Removes all objects in the deletion queue from the scene, in a single pass over the object list
+		/// </summary>
 		void _FlushDeleteQueue();
+
+		/// <summary>
+		/// Adds an object to the end of the scene's object list and the lookups
+		/// </summary>
+		void _AddObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Moves an object to a new name in the name lookup, invoked by GameObject::SetName
+		/// </summary>
+		void _OnObjectRenamed(GameObject* object, const std::string& oldName);
+
+		/// <summary>
+		/// Recalculates the world transforms of all dirty objects in the scene, parents first
+		/// </summary>
+		void _UpdateTransforms();
 	};
 }
\ No newline at end of file
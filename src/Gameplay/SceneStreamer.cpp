@@ -0,0 +1,569 @@
+#include "Gameplay/SceneStreamer.h"
+
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+
+#include <Logging.h>
+
+#include "Utils/FileHelpers.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+#include "Gameplay/MeshResource.h"
+#include "Gameplay/Material.h"
+#include "Graphics/ShaderProgram.h"
+#include "Graphics/Textures/TextureCube.h"
+
+namespace Gameplay {
+	const char* SceneStreamer::FILE_EXTENSION = ".bscene";
+
+	namespace {
+		const char HEADER_BYTES[4] = { 'B', 'S', 'C', 'N' };
+		const uint16_t CURRENT_VERSION = 0x01;
+
+		void WriteGuid(uint8_t* out, const Guid& guid) {
+			memcpy(out, guid.bytes(), 16);
+		}
+
+		Guid ReadGuid(const uint8_t* bytes) {
+			return Guid::FromBytes(const_cast<unsigned char*>(bytes));
+		}
+
+		// Collects the records for a scene file before they're written out
+		struct SceneWriter {
+			SceneStreamer::SceneRecord                  Settings;
+			std::vector<SceneStreamer::StringRecord>    Strings;
+			std::string                                 StringData;
+			std::unordered_map<std::string, uint32_t>   StringLookup;
+			std::vector<SceneStreamer::LightRecord>     Lights;
+			std::vector<SceneStreamer::ObjectRecord>    Objects;
+			std::vector<SceneStreamer::ComponentRecord> Components;
+			std::vector<uint8_t>                        ComponentData;
+
+			// Adds a string to the string table if it's not there already, and returns it's index
+			uint32_t AddString(const std::string& value) {
+				auto it = StringLookup.find(value);
+				if (it != StringLookup.end()) {
+					return it->second;
+				}
+				uint32_t index = static_cast<uint32_t>(Strings.size());
+				Strings.push_back({ static_cast<uint32_t>(StringData.size()), static_cast<uint32_t>(value.size()) });
+				StringData += value;
+				StringLookup[value] = index;
+				return index;
+			}
+
+			// Adds a component to the end of the component table, components must be added right after their object
+			void AddComponent(const std::string& typeName, const nlohmann::json& data) {
+				SceneStreamer::ComponentRecord record;
+				record.TypeName = AddString(typeName);
+				record.DataOffset = static_cast<uint32_t>(ComponentData.size());
+				nlohmann::json::to_cbor(data, ComponentData);
+				record.DataSize = static_cast<uint32_t>(ComponentData.size()) - record.DataOffset;
+				Components.push_back(record);
+				Objects.back().NumComponents++;
+			}
+
+			bool Write(const std::string& path) const {
+				SceneStreamer::BinaryHeader header;
+				header.Version = CURRENT_VERSION;
+				header.NumStrings = static_cast<uint32_t>(Strings.size());
+				header.NumLights = static_cast<uint32_t>(Lights.size());
+				header.NumObjects = static_cast<uint32_t>(Objects.size());
+				header.NumComponents = static_cast<uint32_t>(Components.size());
+				header.StringDataSize = static_cast<uint32_t>(StringData.size());
+				header.ComponentDataSize = static_cast<uint32_t>(ComponentData.size());
+
+				std::ofstream file(path, std::ios::binary);
+				if (!file.is_open()) {
+					LOG_ERROR("Failed to open \"{}\" for writing", path);
+					return false;
+				}
+				file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+				file.write(reinterpret_cast<const char*>(&Settings), sizeof(Settings));
+				file.write(reinterpret_cast<const char*>(Strings.data()), Strings.size() * sizeof(SceneStreamer::StringRecord));
+				file.write(reinterpret_cast<const char*>(Lights.data()), Lights.size() * sizeof(SceneStreamer::LightRecord));
+				file.write(reinterpret_cast<const char*>(Objects.data()), Objects.size() * sizeof(SceneStreamer::ObjectRecord));
+				file.write(reinterpret_cast<const char*>(Components.data()), Components.size() * sizeof(SceneStreamer::ComponentRecord));
+				file.write(StringData.data(), StringData.size());
+				file.write(reinterpret_cast<const char*>(ComponentData.data()), ComponentData.size());
+				return file.good();
+			}
+		};
+
+		// Gets the order to write objects in so that parents always come before their children, given a function
+		// that returns the index of an object's parent (or -1 for none)
+		template <typename ParentFunc>
+		std::vector<size_t> GetParentFirstOrder(size_t count, ParentFunc getParent) {
+			std::vector<size_t> result;
+			result.reserve(count);
+			std::vector<bool> written(count, false);
+			std::vector<size_t> chain;
+			for (size_t ix = 0; ix < count; ix++) {
+				// Walk up until we find an ancestor that's already been written, then write the chain back down
+				chain.clear();
+				for (int64_t seek = ix; seek >= 0 && !written[seek]; seek = getParent(seek)) {
+					written[seek] = true;
+					chain.push_back(seek);
+				}
+				result.insert(result.end(), chain.rbegin(), chain.rend());
+			}
+			return result;
+		}
+
+		std::string ReplaceExtension(const std::string& path, const std::string& extension) {
+			return std::filesystem::path(path).replace_extension(extension).string();
+		}
+	}
+
+	SceneStreamer::SceneStreamer() :
+		_scene(nullptr),
+		_path(""),
+		_file(nullptr),
+		_header(nullptr),
+		_sceneRecord(nullptr),
+		_strings(),
+		_lights(),
+		_objects(),
+		_components(),
+		_stringData(nullptr),
+		_componentData(nullptr),
+		_nextObject(0),
+		_orphans(),
+		_isComplete(false)
+	{ }
+
+	SceneStreamer::~SceneStreamer() = default;
+
+	void SceneStreamer::Save(const Scene& scene, const std::string& path) {
+		SceneWriter writer;
+
+		WriteGuid(writer.Settings.DefaultMaterial, scene.DefaultMaterial ? scene.DefaultMaterial->GetGUID() : Guid());
+		WriteGuid(writer.Settings.SkyboxMesh, scene._skyboxMesh ? scene._skyboxMesh->GetGUID() : Guid());
+		WriteGuid(writer.Settings.SkyboxShader, scene._skyboxShader ? scene._skyboxShader->GetGUID() : Guid());
+		WriteGuid(writer.Settings.SkyboxTexture, scene._skyboxTexture ? scene._skyboxTexture->GetGUID() : Guid());
+		WriteGuid(writer.Settings.MainCamera, scene.MainCamera ? scene.MainCamera->GetGUID() : Guid());
+		writer.Settings.AmbientLight = scene.GetAmbientLight();
+		writer.Settings.SkyboxRotation = glm::quat_cast(scene._skyboxRotation);
+
+		for (const Light& light : scene.Lights) {
+			writer.Lights.push_back({ light.Position, light.Color, light.Range });
+		}
+
+		// Find each object's parent up front, so we only resolve the references once
+		std::unordered_map<const GameObject*, size_t> indices;
+		indices.reserve(scene._objects.size());
+		for (size_t ix = 0; ix < scene._objects.size(); ix++) {
+			indices[scene._objects[ix].get()] = ix;
+		}
+		std::vector<GameObject::Sptr> parents(scene._objects.size());
+		std::vector<int64_t> parentIndices(scene._objects.size(), -1);
+		for (size_t ix = 0; ix < scene._objects.size(); ix++) {
+			parents[ix] = scene._objects[ix]->_parent;
+			auto it = indices.find(parents[ix].get());
+			if (it != indices.end()) {
+				parentIndices[ix] = it->second;
+			}
+		}
+
+		for (size_t ix : GetParentFirstOrder(scene._objects.size(), [&](size_t index) { return parentIndices[index]; })) {
+			const GameObject::Sptr& object = scene._objects[ix];
+
+			ObjectRecord record;
+			WriteGuid(record.Guid, object->_guid);
+			WriteGuid(record.Parent, parents[ix] != nullptr ? parents[ix]->_guid : Guid());
+			record.Position = object->_position;
+			record.Rotation = object->_rotation;
+			record.Scale = object->_scale;
+			record.Name = writer.AddString(object->_name);
+			record.FirstComponent = static_cast<uint32_t>(writer.Components.size());
+			record.Flags = object->HideInHierarchy ? OBJECT_FLAG_HIDE_IN_HIERARCHY : 0;
+			writer.Objects.push_back(record);
+
+			for (const IComponent::Sptr& component : object->_components) {
+				nlohmann::json blob = component->ToJson();
+				IComponent::SaveBaseJson(component, blob);
+				writer.AddComponent(component->ComponentTypeName(), blob);
+			}
+		}
+
+		if (writer.Write(path)) {
+			LOG_INFO("Saved binary scene to \"{}\" ({} objects, {} components)", path, writer.Objects.size(), writer.Components.size());
+		}
+	}
+
+	Scene::Sptr SceneStreamer::Load(const std::string& path) {
+		SceneStreamer::Sptr streamer = Open(path);
+		return streamer != nullptr ? streamer->Finish() : nullptr;
+	}
+
+	SceneStreamer::Sptr SceneStreamer::Open(const std::string& path) {
+		SceneStreamer::Sptr result = std::make_shared<SceneStreamer>();
+		if (!result->_MapFile(path)) {
+			return nullptr;
+		}
+		result->_path = path;
+		result->_LoadSceneRecord();
+		return result;
+	}
+
+	bool SceneStreamer::ConvertToBinary(const std::string& inFile, const std::string& outFile) {
+		if (!std::filesystem::exists(inFile)) {
+			LOG_WARN("Could not find scene file \"{}\"", inFile);
+			return false;
+		}
+		nlohmann::json data = nlohmann::json::parse(FileHelpers::ReadFile(inFile));
+		SceneWriter writer;
+
+		WriteGuid(writer.Settings.DefaultMaterial, Guid(JsonGet<std::string>(data, "default_material", "null")));
+		WriteGuid(writer.Settings.MainCamera, Guid(JsonGet<std::string>(data, "main_camera", "null")));
+		if (data.contains("ambient")) {
+			writer.Settings.AmbientLight = data["ambient"];
+		}
+		if (data.contains("skybox") && data["skybox"].is_object()) {
+			const nlohmann::json& blob = data["skybox"];
+			WriteGuid(writer.Settings.SkyboxMesh, Guid(JsonGet<std::string>(blob, "mesh", "null")));
+			WriteGuid(writer.Settings.SkyboxShader, Guid(JsonGet<std::string>(blob, "shader", "null")));
+			WriteGuid(writer.Settings.SkyboxTexture, Guid(JsonGet<std::string>(blob, "texture", "null")));
+			writer.Settings.SkyboxRotation = blob["orientation"];
+		}
+
+		if (data.contains("lights") && data["lights"].is_array()) {
+			for (const nlohmann::json& blob : data["lights"]) {
+				Light light = Light::FromJson(blob);
+				writer.Lights.push_back({ light.Position, light.Color, light.Range });
+			}
+		}
+
+		if (!data.contains("objects") || !data["objects"].is_array()) {
+			LOG_WARN("Objects not present in scene \"{}\"", inFile);
+			return false;
+		}
+		const nlohmann::json& objects = data["objects"];
+
+		std::unordered_map<std::string, size_t> indices;
+		indices.reserve(objects.size());
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			indices[objects[ix]["guid"].get<std::string>()] = ix;
+		}
+		std::vector<int64_t> parentIndices(objects.size(), -1);
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			auto it = indices.find(JsonGet<std::string>(objects[ix], "parent", "null"));
+			if (it != indices.end()) {
+				parentIndices[ix] = it->second;
+			}
+		}
+
+		for (size_t ix : GetParentFirstOrder(objects.size(), [&](size_t index) { return parentIndices[index]; })) {
+			const nlohmann::json& blob = objects[ix];
+
+			ObjectRecord record;
+			WriteGuid(record.Guid, Guid(blob["guid"].get<std::string>()));
+			WriteGuid(record.Parent, Guid(JsonGet<std::string>(blob, "parent", "null")));
+			record.Position = blob["position"];
+			record.Rotation = blob["rotation"];
+			record.Scale = blob["scale"];
+			record.Name = writer.AddString(blob["name"].get<std::string>());
+			record.FirstComponent = static_cast<uint32_t>(writer.Components.size());
+			record.Flags = JsonGet(blob, "hide_in_inspector", false) ? OBJECT_FLAG_HIDE_IN_HIERARCHY : 0;
+			writer.Objects.push_back(record);
+
+			// The component blobs already include the base component data
+			if (blob.contains("components") && blob["components"].is_object()) {
+				for (auto& [typeName, value] : blob["components"].items()) {
+					writer.AddComponent(typeName, value);
+				}
+			}
+		}
+
+		std::string outFileName = outFile.empty() ? ReplaceExtension(inFile, FILE_EXTENSION) : outFile;
+		if (!writer.Write(outFileName)) {
+			return false;
+		}
+		LOG_INFO("Converted scene \"{}\" to binary \"{}\"", inFile, outFileName);
+		return true;
+	}
+
+	bool SceneStreamer::ConvertToJson(const std::string& inFile, const std::string& outFile) {
+		SceneStreamer streamer;
+		if (!streamer._MapFile(inFile)) {
+			return false;
+		}
+
+		// Mirrors the layout of Scene::ToJson, minus the nested copies of each object's children
+		auto guidToJson = [](const uint8_t* bytes) {
+			Guid guid = ReadGuid(bytes);
+			return guid.isValid() ? guid.str() : "null";
+		};
+
+		nlohmann::json blob;
+		const SceneRecord& scene = *streamer._sceneRecord;
+		blob["default_material"] = guidToJson(scene.DefaultMaterial);
+		blob["ambient"] = scene.AmbientLight;
+		blob["skybox"] = nlohmann::json();
+		blob["skybox"]["mesh"] = guidToJson(scene.SkyboxMesh);
+		blob["skybox"]["shader"] = guidToJson(scene.SkyboxShader);
+		blob["skybox"]["texture"] = guidToJson(scene.SkyboxTexture);
+		blob["skybox"]["orientation"] = scene.SkyboxRotation;
+
+		std::vector<nlohmann::json> objects;
+		objects.reserve(streamer._objects.size());
+		for (const ObjectRecord& record : streamer._objects) {
+			nlohmann::json object = {
+				{ "name", streamer._GetString(record.Name) },
+				{ "guid", guidToJson(record.Guid) },
+				{ "position", record.Position },
+				{ "rotation", record.Rotation },
+				{ "scale",    record.Scale },
+				{ "parent",   guidToJson(record.Parent) },
+				{ "hide_in_inspector", (record.Flags & OBJECT_FLAG_HIDE_IN_HIERARCHY) != 0 }
+			};
+			object["components"] = nlohmann::json::object();
+			for (uint32_t ix = 0; ix < record.NumComponents; ix++) {
+				const ComponentRecord& component = streamer._components[record.FirstComponent + ix];
+				object["components"][streamer._GetString(component.TypeName)] = streamer._GetComponentJson(component);
+			}
+			objects.push_back(std::move(object));
+		}
+		blob["objects"] = objects;
+
+		std::vector<nlohmann::json> lights;
+		lights.reserve(streamer._lights.size());
+		for (const LightRecord& record : streamer._lights) {
+			Light light;
+			light.Position = record.Position;
+			light.Color = record.Color;
+			light.Range = record.Range;
+			lights.push_back(light.ToJson());
+		}
+		blob["lights"] = lights;
+
+		blob["main_camera"] = guidToJson(scene.MainCamera);
+
+		std::string outFileName = outFile.empty() ? ReplaceExtension(inFile, ".json") : outFile;
+		FileHelpers::WriteContentsToFile(outFileName, blob.dump(1, '\t'));
+		LOG_INFO("Converted binary scene \"{}\" to \"{}\"", inFile, outFileName);
+		return true;
+	}
+
+	bool SceneStreamer::Step(double budgetSeconds) {
+		if (_isComplete) {
+			return true;
+		}
+
+		const auto startTime = std::chrono::steady_clock::now();
+		uint32_t count = 0;
+		while (_nextObject < _header->NumObjects) {
+			// Most objects load faster than we can read the clock, so we only check it every few objects
+			if (budgetSeconds >= 0.0 && count > 0 && (count % 16) == 0 &&
+				std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() >= budgetSeconds) {
+				break;
+			}
+			_LoadObject(_nextObject++);
+			count++;
+		}
+
+		if (_nextObject >= _header->NumObjects) {
+			_Complete();
+		}
+		return _isComplete;
+	}
+
+	Scene::Sptr SceneStreamer::Finish() {
+		Step(-1.0);
+		return _scene;
+	}
+
+	float SceneStreamer::GetProgress() const {
+		if (_isComplete || _header == nullptr || _header->NumObjects == 0) {
+			return 1.0f;
+		}
+		return static_cast<float>(_nextObject) / static_cast<float>(_header->NumObjects);
+	}
+
+	bool SceneStreamer::_MapFile(const std::string& path) {
+		MemoryMappedFile::Sptr file = MemoryMappedFile::Open(path);
+		if (file == nullptr) {
+			LOG_WARN("Failed to open binary scene \"{}\"", path);
+			return false;
+		}
+
+		size_t size = file->GetSize();
+		if (size < sizeof(BinaryHeader) + sizeof(SceneRecord)) {
+			LOG_ERROR("Not enough data in the file!");
+			return false;
+		}
+
+		const BinaryHeader* header = reinterpret_cast<const BinaryHeader*>(file->GetData());
+		if (memcmp(header->HeaderBytes, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+			LOG_ERROR("File is not a binary scene file!");
+			return false;
+		}
+		if (header->Version != CURRENT_VERSION || header->Flags != 0) {
+			LOG_ERROR("Unsupported binary scene version {}", header->Version);
+			return false;
+		}
+
+		// Everything is laid out back to back, so we can check the size of the file in one go
+		size_t requiredBytes =
+			sizeof(BinaryHeader) + sizeof(SceneRecord) +
+			header->NumStrings    * sizeof(StringRecord) +
+			header->NumLights     * sizeof(LightRecord) +
+			header->NumObjects    * sizeof(ObjectRecord) +
+			header->NumComponents * sizeof(ComponentRecord) +
+			(size_t)header->StringDataSize + header->ComponentDataSize;
+		if (size < requiredBytes) {
+			LOG_ERROR("Not enough data in the file!");
+			return false;
+		}
+
+		const uint8_t* seek = file->GetData() + sizeof(BinaryHeader);
+		_sceneRecord = reinterpret_cast<const SceneRecord*>(seek);
+		seek += sizeof(SceneRecord);
+		_strings = Span<const StringRecord>(reinterpret_cast<const StringRecord*>(seek), header->NumStrings);
+		seek += header->NumStrings * sizeof(StringRecord);
+		_lights = Span<const LightRecord>(reinterpret_cast<const LightRecord*>(seek), header->NumLights);
+		seek += header->NumLights * sizeof(LightRecord);
+		_objects = Span<const ObjectRecord>(reinterpret_cast<const ObjectRecord*>(seek), header->NumObjects);
+		seek += header->NumObjects * sizeof(ObjectRecord);
+		_components = Span<const ComponentRecord>(reinterpret_cast<const ComponentRecord*>(seek), header->NumComponents);
+		seek += header->NumComponents * sizeof(ComponentRecord);
+		_stringData = reinterpret_cast<const char*>(seek);
+		seek += header->StringDataSize;
+		_componentData = seek;
+
+		// Make sure none of the records will read outside of the file, so loading doesn't need to check
+		for (const StringRecord& record : _strings) {
+			if ((size_t)record.Offset + record.Length > header->StringDataSize) {
+				LOG_ERROR("String table entry is outside the bounds of the string data!");
+				return false;
+			}
+		}
+		for (const ComponentRecord& record : _components) {
+			if (record.TypeName >= header->NumStrings || (size_t)record.DataOffset + record.DataSize > header->ComponentDataSize) {
+				LOG_ERROR("Component record is outside the bounds of the file!");
+				return false;
+			}
+		}
+		for (const ObjectRecord& record : _objects) {
+			if (record.Name >= header->NumStrings || (size_t)record.FirstComponent + record.NumComponents > header->NumComponents) {
+				LOG_ERROR("Object record is outside the bounds of the file!");
+				return false;
+			}
+		}
+
+		_header = header;
+		_file = file;
+		return true;
+	}
+
+	std::string SceneStreamer::_GetString(uint32_t index) const {
+		const StringRecord& record = _strings[index];
+		return std::string(_stringData + record.Offset, record.Length);
+	}
+
+	nlohmann::json SceneStreamer::_GetComponentJson(const ComponentRecord& record) const {
+		if (record.DataSize == 0) {
+			return nlohmann::json::object();
+		}
+		const uint8_t* data = _componentData + record.DataOffset;
+		return nlohmann::json::from_cbor(data, data + record.DataSize);
+	}
+
+	void SceneStreamer::_LoadSceneRecord() {
+		// Same as Scene::FromJson, we don't want the default camera that a new scene creates
+		_scene = std::make_shared<Scene>();
+		_scene->MainCamera = nullptr;
+		_scene->_objectsByGuid.clear();
+		_scene->_objectsByName.clear();
+		_scene->_transformOrder.clear();
+		_scene->_isHierarchyDirty = true;
+		_scene->_objects.clear();
+		_scene->_objects.reserve(_header->NumObjects);
+
+		const SceneRecord& record = *_sceneRecord;
+		_scene->DefaultMaterial = ResourceManager::Get<Material>(ReadGuid(record.DefaultMaterial));
+		_scene->SetAmbientLight(record.AmbientLight);
+		_scene->_skyboxMesh = ResourceManager::Get<MeshResource>(ReadGuid(record.SkyboxMesh));
+		_scene->SetSkyboxShader(ResourceManager::Get<ShaderProgram>(ReadGuid(record.SkyboxShader)));
+		_scene->SetSkyboxTexture(ResourceManager::Get<TextureCube>(ReadGuid(record.SkyboxTexture)));
+		_scene->SetSkyboxRotation(glm::mat3_cast(record.SkyboxRotation));
+
+		_scene->Lights.reserve(_lights.size());
+		for (const LightRecord& light : _lights) {
+			Light result;
+			result.Position = light.Position;
+			result.Color = light.Color;
+			result.Range = light.Range;
+			_scene->Lights.push_back(result);
+		}
+	}
+
+	void SceneStreamer::_LoadObject(uint32_t index) {
+		const ObjectRecord& record = _objects[index];
+		Guid parentGuid = ReadGuid(record.Parent);
+
+		// We need to manually construct since the GameObject constructor is protected
+		GameObject::Sptr result(new GameObject());
+		result->_scene = _scene.get();
+		result->_selfRef = result;
+		result->_name = _GetString(record.Name);
+		result->_guid = ReadGuid(record.Guid);
+		result->_parent = GameObject::WeakRef(parentGuid, _scene.get());
+		result->_position = record.Position;
+		result->_rotation = record.Rotation;
+		result->_scale = record.Scale;
+		result->HideInHierarchy = (record.Flags & OBJECT_FLAG_HIDE_IN_HIERARCHY) != 0;
+		result->_isLocalTransformDirty = true;
+		result->_isWorldTransformDirty = true;
+
+		for (uint32_t ix = 0; ix < record.NumComponents; ix++) {
+			const ComponentRecord& component = _components[record.FirstComponent + ix];
+			result->_AddLoadedComponent(_GetString(component.TypeName), _GetComponentJson(component));
+		}
+
+		_scene->_AddObject(result);
+
+		// Parents are written before their children, so our parent should already be in the scene
+		if (parentGuid.isValid()) {
+			GameObject::Sptr parent = _scene->FindObjectByGUID(parentGuid);
+			if (parent != nullptr) {
+				parent->AddChild(result);
+			} else {
+				_orphans.push_back(index);
+			}
+		}
+	}
+
+	void SceneStreamer::_Complete() {
+		// Objects whose parents came later in the file (or never showed up) get one more chance
+		for (uint32_t index : _orphans) {
+			const ObjectRecord& record = _objects[index];
+			GameObject::Sptr object = _scene->FindObjectByGUID(ReadGuid(record.Guid));
+			GameObject::Sptr parent = _scene->FindObjectByGUID(ReadGuid(record.Parent));
+			if (object != nullptr && parent != nullptr) {
+				parent->AddChild(object);
+			}
+		}
+		_orphans.clear();
+
+		_scene->MainCamera = _scene->_components.GetComponentByGUID<Camera>(ReadGuid(_sceneRecord->MainCamera));
+		_scene->_filePath = _path;
+
+		// We're done with the file, let it go
+		_header = nullptr;
+		_sceneRecord = nullptr;
+		_strings = Span<const StringRecord>();
+		_lights = Span<const LightRecord>();
+		_objects = Span<const ObjectRecord>();
+		_components = Span<const ComponentRecord>();
+		_stringData = nullptr;
+		_componentData = nullptr;
+		_file = nullptr;
+
+		_isComplete = true;
+	}
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "json.hpp"
+#include "Gameplay/Scene.h"
+#include "Utils/MemoryMappedFile.h"
+#include "Utils/Span.h"
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Reads and writes scenes in a compact binary format, as an alternative to the JSON scene files
+	///
+	/// Object and component headers are stored as flat records, with names and component types stored
+	/// once in a shared string table, and GUIDs stored as their raw 16 bytes. Components are still
+	/// serialized through their ToJson and FromJson methods, but their data is stored as CBOR so that
+	/// only the components themselves need to be parsed, instead of the whole file
+	///
+	/// Scenes can be loaded in one go with Load, or streamed in over several frames by calling Step
+	/// on a streamer returned from Open
+	/// </summary>
+	class SceneStreamer {
+	public:
+		DEFINE_RESOURCE(SceneStreamer);
+
+		// The extension we use for binary scene files
+		static const char* FILE_EXTENSION;
+
+		// Will be put at the start of the binary file, contains info about the contents of the file
+		struct BinaryHeader {
+			// A check value so we can ensure that we're loading in the right file type
+			char     HeaderBytes[4] = { 'B', 'S', 'C', 'N' };
+			// The version code, we can use this to create different loaders if our format changes
+			uint16_t Version = 0;
+			// Reserved for flags, must be 0 in version 1 files
+			uint16_t Flags = 0;
+			// The number of entries in the string table
+			uint32_t NumStrings = 0;
+			// The number of lights in the scene
+			uint32_t NumLights = 0;
+			// The number of game objects in the scene
+			uint32_t NumObjects = 0;
+			// The total number of components across all objects
+			uint32_t NumComponents = 0;
+			// The number of bytes of character data backing the string table
+			uint32_t StringDataSize = 0;
+			// The number of bytes of CBOR component data at the end of the file
+			uint32_t ComponentDataSize = 0;
+		};
+
+		// Follows the header, stores the scene-wide settings
+		struct SceneRecord {
+			// The GUIDs of the resources the scene references, all zeros for none
+			uint8_t   DefaultMaterial[16] = { 0 };
+			uint8_t   SkyboxMesh[16]      = { 0 };
+			uint8_t   SkyboxShader[16]    = { 0 };
+			uint8_t   SkyboxTexture[16]   = { 0 };
+			// The GUID of the camera component to use as the main camera
+			uint8_t   MainCamera[16]      = { 0 };
+			glm::vec3 AmbientLight        = glm::vec3(0.0f);
+			glm::quat SkyboxRotation      = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		};
+
+		// An entry in the string table, the characters are not null terminated
+		struct StringRecord {
+			// The offset of the string in the string data
+			uint32_t Offset = 0;
+			// The number of characters in the string
+			uint32_t Length = 0;
+		};
+
+		// Stores a single light
+		struct LightRecord {
+			glm::vec3 Position = glm::vec3(0.0f);
+			glm::vec3 Color    = glm::vec3(1.0f);
+			float     Range    = 4.0f;
+		};
+
+		// Stores a single game object. Objects are always written after their parents
+		struct ObjectRecord {
+			uint8_t   Guid[16]   = { 0 };
+			// The GUID of the parent object, all zeros for objects at the root of the scene
+			uint8_t   Parent[16] = { 0 };
+			glm::vec3 Position   = glm::vec3(0.0f);
+			glm::quat Rotation   = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			glm::vec3 Scale      = glm::vec3(1.0f);
+			// The index of the object's name in the string table
+			uint32_t  Name = 0;
+			// The index of the object's first component in the component table
+			uint32_t  FirstComponent = 0;
+			// The number of components the object has, stored back to back in the component table
+			uint32_t  NumComponents = 0;
+			// See the OBJECT_FLAG constants
+			uint32_t  Flags = 0;
+		};
+
+		// Stores a single component, the data is the component's JSON representation encoded as CBOR
+		struct ComponentRecord {
+			// The index of the component's type name in the string table
+			uint32_t TypeName = 0;
+			// The offset of the component's data in the component data
+			uint32_t DataOffset = 0;
+			// The number of bytes of CBOR data for the component
+			uint32_t DataSize = 0;
+		};
+
+		// Set on objects that should not be shown in the hierarchy
+		static const uint32_t OBJECT_FLAG_HIDE_IN_HIERARCHY = 1 << 0;
+
+		/// <summary>
+		/// Saves a scene to a binary scene file
+		/// </summary>
+		/// <param name="scene">The scene to save</param>
+		/// <param name="path">The path of the file to write to</param>
+		static void Save(const Scene& scene, const std::string& path);
+
+		/// <summary>
+		/// Loads an entire binary scene file at once
+		/// </summary>
+		/// <param name="path">The path of the file to read from</param>
+		/// <returns>The loaded scene, or nullptr if the file could not be loaded</returns>
+		static Scene::Sptr Load(const std::string& path);
+
+		/// <summary>
+		/// Opens a binary scene file for streaming. The scene-wide settings and lights are loaded
+		/// immediately, while the objects are loaded as Step is called
+		/// </summary>
+		/// <param name="path">The path of the file to read from</param>
+		/// <returns>A streamer for the file, or nullptr if the file could not be opened or is invalid</returns>
+		static SceneStreamer::Sptr Open(const std::string& path);
+
+		/// <summary>
+		/// Converts a JSON scene file to a binary scene file. Works directly on the JSON, so none
+		/// of the scene's resources or components need to be loaded
+		/// </summary>
+		/// <param name="inFile">The path to the JSON scene file</param>
+		/// <param name="outFile">The output path, or empty to replace the input's extension with FILE_EXTENSION</param>
+		/// <returns>True if the file was converted</returns>
+		static bool ConvertToBinary(const std::string& inFile, const std::string& outFile = "");
+		/// <summary>
+		/// Converts a binary scene file back to a JSON scene file that Scene::Load can read
+		/// </summary>
+		/// <param name="inFile">The path to the binary scene file</param>
+		/// <param name="outFile">The output path, or empty to replace the input's extension with .json</param>
+		/// <returns>True if the file was converted</returns>
+		static bool ConvertToJson(const std::string& inFile, const std::string& outFile = "");
+
+		SceneStreamer();
+		~SceneStreamer();
+
+		/// <summary>
+		/// Loads objects from the file until the time budget is used up, or until all objects are loaded.
+		/// At least one object is always loaded, so that we make progress even with a tiny budget
+		/// </summary>
+		/// <param name="budgetSeconds">The time to spend loading objects, or a negative value to load everything</param>
+		/// <returns>True if the scene has been fully loaded</returns>
+		bool Step(double budgetSeconds = 0.004);
+		/// <summary>
+		/// Loads all remaining objects and returns the scene
+		/// </summary>
+		Scene::Sptr Finish();
+
+		/// <summary>
+		/// Returns true once all objects have been loaded and the file has been released
+		/// </summary>
+		bool IsComplete() const { return _isComplete; }
+		/// <summary>
+		/// Gets the fraction of objects that have been loaded so far, in the 0-1 range
+		/// </summary>
+		float GetProgress() const;
+		/// <summary>
+		/// Gets the scene that is being loaded. Objects are added to it as they are loaded, the scene
+		/// should not be woken up until IsComplete returns true
+		/// </summary>
+		const Scene::Sptr& GetScene() const { return _scene; }
+
+	protected:
+		Scene::Sptr                   _scene;
+		std::string                   _path;
+		// The mapping that the spans point into, released once we've finished loading
+		MemoryMappedFile::Sptr        _file;
+		const BinaryHeader*           _header;
+		const SceneRecord*            _sceneRecord;
+		Span<const StringRecord>      _strings;
+		Span<const LightRecord>       _lights;
+		Span<const ObjectRecord>      _objects;
+		Span<const ComponentRecord>   _components;
+		const char*                   _stringData;
+		const uint8_t*                _componentData;
+
+		// The index of the next object to load
+		uint32_t                      _nextObject;
+		// The indices of objects whose parents had not been loaded when they were, these are linked up at the end
+		std::vector<uint32_t>         _orphans;
+		bool                          _isComplete;
+
+		/// <summary>
+		/// Maps and validates the file, setting up our spans into it
+		/// </summary>
+		bool _MapFile(const std::string& path);
+		/// <summary>
+		/// Gets a string from the string table
+		/// </summary>
+		std::string _GetString(uint32_t index) const;
+		/// <summary>
+		/// Decodes the JSON representation of a component from the component data
+		/// </summary>
+		nlohmann::json _GetComponentJson(const ComponentRecord& record) const;
+		/// <summary>
+		/// Loads the scene-wide settings and lights into a new scene
+		/// </summary>
+		void _LoadSceneRecord();
+		/// <summary>
+		/// Loads the object at the given index and adds it to the scene
+		/// </summary>
+		void _LoadObject(uint32_t index);
+		/// <summary>
+		/// Links up any remaining parents, resolves the main camera and releases the file
+		/// </summary>
+		void _Complete();
+	};
+}
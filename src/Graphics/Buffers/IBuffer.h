@@ -52,6 +52,16 @@ public:
 	/// <param name="allowResize">True if resizing the buffer is allowed, otherwise an assertion is thrown for oversized writes</param>
 	virtual void UpdateData(const void* data, uint32_t elementSize, uint32_t elementCount, bool allowResize = true);
 
+	/// <summary>
+	/// Allocates immutable storage for this buffer, using glNamedBufferStorage. Unlike LoadData, the buffer
+	/// can never be resized or re-loaded afterwards, but it can stay mapped while the GPU is using it
+	/// </summary>
+	/// <param name="data">The initial data for the buffer, or nullptr to leave it uninitialized</param>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="elementCount">The number of elements to allocate space for</param>
+	/// <param name="flags">The ways the buffer is allowed to be mapped, include Persistent to be able to draw while it's mapped</param>
+	void AllocateStorage(const void* data, uint32_t elementSize, uint32_t elementCount, BufferMapMode flags);
+
 	/// <summary>
 	/// Loads an array of data into this buffer, using the bindless method glNamedBufferData
 	/// </summary>
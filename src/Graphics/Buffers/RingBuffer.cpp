@@ -0,0 +1,70 @@
+#include "RingBuffer.h"
+#include "Logging.h"
+
+RingBuffer::RingBuffer(uint32_t elementSize, uint32_t initialCapacity, uint32_t alignment) :
+	_buffer(nullptr),
+	_data(nullptr),
+	_layout(elementSize, initialCapacity, FRAME_COUNT, alignment),
+	_fences(),
+	_stats()
+{
+	_Allocate();
+}
+
+RingBuffer::~RingBuffer() {
+	_DeleteFences();
+}
+
+void* RingBuffer::BeginFrame(uint32_t elementCount) {
+	if (_layout.Reserve(elementCount)) {
+		_Allocate();
+		_stats.Reallocations++;
+	}
+
+	// Wait until the GPU is done with the last frame that used this region. We poll first, so that
+	// we only count the times that we actually had to block
+	GLsync& fence = _fences[_layout.GetFrame()];
+	if (fence != nullptr) {
+		GLenum waitResult = glClientWaitSync(fence, 0, 0);
+		if (waitResult == GL_TIMEOUT_EXPIRED) {
+			_stats.SyncWaits++;
+			do {
+				waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			} while (waitResult == GL_TIMEOUT_EXPIRED);
+		}
+		if (waitResult == GL_WAIT_FAILED) {
+			LOG_WARN("Failed to wait on ring buffer fence, data may be overwritten while in use");
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	_stats.BytesWritten += (uint64_t)elementCount * _layout.GetElementSize();
+	return _data + _layout.GetFrameByteOffset();
+}
+
+void RingBuffer::EndFrame() {
+	_fences[_layout.GetFrame()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_layout.Advance();
+}
+
+void RingBuffer::_Allocate() {
+	// The old buffer will stick around on the GPU until any frames using it are done, so we can
+	// forget about its fences and start fresh. The layout has already moved back to the first region
+	_DeleteFences();
+
+	// Our buffer stays mapped for its whole lifetime, coherent mapping means we don't need to flush our writes
+	const BufferMapMode mapMode = BufferMapMode::Write | BufferMapMode::Persistent | BufferMapMode::Coherent;
+	_buffer = VertexBuffer::Create(BufferUsage::DynamicDraw);
+	_buffer->AllocateStorage(nullptr, _layout.GetElementSize(), _layout.GetElementCount(), mapMode);
+	_data = reinterpret_cast<uint8_t*>(_buffer->Map(mapMode));
+}
+
+void RingBuffer::_DeleteFences() {
+	for (GLsync& fence : _fences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "VertexBuffer.h"
+#include "RingBufferLayout.h"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A buffer for streaming per-frame data to the GPU. The buffer is allocated with immutable storage
+/// and stays persistently mapped, and is split into a region for each frame that the GPU may still be
+/// drawing. Each region is fenced when the frame ends, so we only ever wait on the GPU if it falls a
+/// full FRAME_COUNT frames behind
+/// </summary>
+class RingBuffer {
+public:
+	DEFINE_RESOURCE(RingBuffer);
+
+	// The number of frames that can be in flight at once
+	static const uint32_t FRAME_COUNT = 3;
+
+	/// <summary>
+	/// Counts the work done by the ring buffer since the last call to ResetStats
+	/// </summary>
+	struct Stats {
+		// The number of bytes that have been handed out for writing
+		uint64_t BytesWritten = 0;
+		// The number of times we had to block because the GPU was still reading a region
+		uint32_t SyncWaits = 0;
+		// The number of times the buffer had to be re-allocated to fit a frame's data
+		uint32_t Reallocations = 0;
+	};
+
+	/// <summary>
+	/// Creates a new ring buffer
+	/// </summary>
+	/// <param name="elementSize">The size of a single element in the buffer, in bytes</param>
+	/// <param name="initialCapacity">The number of elements that each frame's region can store initially</param>
+	/// <param name="alignment">The alignment in bytes of the start of each frame's region, for when regions are bound with glBindBufferRange</param>
+	static inline Sptr Create(uint32_t elementSize, uint32_t initialCapacity = 1024, uint32_t alignment = 1) {
+		return std::make_shared<RingBuffer>(elementSize, initialCapacity, alignment);
+	}
+
+	RingBuffer(uint32_t elementSize, uint32_t initialCapacity = 1024, uint32_t alignment = 1);
+	~RingBuffer();
+
+	/// <summary>
+	/// Starts writing a new frame's data, growing the buffer if needed and waiting for the GPU
+	/// to finish with the region we're about to write over
+	/// </summary>
+	/// <param name="elementCount">The number of elements that will be written this frame</param>
+	/// <returns>A pointer to the start of this frame's region, with room for elementCount elements</returns>
+	void* BeginFrame(uint32_t elementCount);
+	/// <summary>
+	/// Fences off the current frame's region after all draws that use it have been issued, and
+	/// moves on to the next region
+	/// </summary>
+	void EndFrame();
+
+	/// <summary>
+	/// Gets the underlying buffer. Note that this will change if the ring buffer needs to grow
+	/// </summary>
+	const VertexBuffer::Sptr& GetBuffer() const { return _buffer; }
+	/// <summary>
+	/// Gets the index of the first element in the current frame's region
+	/// </summary>
+	uint32_t GetFrameOffset() const { return _layout.GetFrameOffset(); }
+	/// <summary>
+	/// Gets how the buffer is split into regions
+	/// </summary>
+	const RingBufferLayout& GetLayout() const { return _layout; }
+
+	const Stats& GetStats() const { return _stats; }
+	void ResetStats() { _stats = Stats(); }
+
+protected:
+	VertexBuffer::Sptr _buffer;
+	uint8_t*           _data;
+	RingBufferLayout   _layout;
+	GLsync             _fences[FRAME_COUNT];
+	Stats              _stats;
+
+	void _Allocate();
+	void _DeleteFences();
+};
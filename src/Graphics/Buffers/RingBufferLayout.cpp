@@ -0,0 +1,48 @@
+#include "RingBufferLayout.h"
+
+#include <numeric>
+#include <algorithm>
+
+#include "Logging.h"
+
+RingBufferLayout::RingBufferLayout(uint32_t elementSize, uint32_t capacity, uint32_t frameCount, uint32_t alignment) :
+	_elementSize(elementSize),
+	_frameCount(frameCount),
+	_alignmentStep(1),
+	_capacity(0),
+	_frame(0)
+{
+	LOG_ASSERT(elementSize > 0 && frameCount > 0 && alignment > 0, "Ring buffer element size, frame count and alignment must not be 0");
+
+	// A region starts on the alignment when its element count times the element size is a multiple of
+	// the alignment, the smallest count where that happens is the alignment without the factors they share
+	_alignmentStep = alignment / std::gcd(elementSize, alignment);
+	_capacity = _RoundCapacity(std::max(capacity, 1u));
+	LOG_ASSERT(_capacity > 0, "Ring buffer capacity of {} is too large", capacity);
+}
+
+bool RingBufferLayout::Reserve(uint32_t elementCount) {
+	if (elementCount <= _capacity) {
+		return false;
+	}
+
+	// Double the size so that we don't re-allocate every frame while a scene is growing, but settle for
+	// just what was asked for if doubling would overflow the element indices
+	uint32_t capacity = _RoundCapacity(std::max((uint64_t)elementCount, (uint64_t)_capacity * 2));
+	if (capacity == 0) {
+		capacity = _RoundCapacity(elementCount);
+	}
+	LOG_ASSERT(capacity > 0, "Ring buffer capacity of {} is too large", elementCount);
+	_capacity = capacity;
+	_frame = 0;
+	return true;
+}
+
+void RingBufferLayout::Advance() {
+	_frame = (_frame + 1) % _frameCount;
+}
+
+uint32_t RingBufferLayout::_RoundCapacity(uint64_t capacity) const {
+	const uint64_t result = (capacity + _alignmentStep - 1) / _alignmentStep * _alignmentStep;
+	return result * _frameCount > UINT32_MAX ? 0 : static_cast<uint32_t>(result);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// The offset arithmetic behind RingBuffer, kept apart from the GL calls so that it can be tested
+/// without a context. The buffer is split into a region for each frame, each holding the same number
+/// of elements, and the regions are used in turn as frames end
+/// </summary>
+class RingBufferLayout {
+public:
+	/// <summary>
+	/// Creates a new layout, starting on the first region
+	/// </summary>
+	/// <param name="elementSize">The size of a single element, in bytes</param>
+	/// <param name="capacity">The number of elements that each region needs to hold, this is rounded up to keep the regions aligned</param>
+	/// <param name="frameCount">The number of regions in the buffer</param>
+	/// <param name="alignment">The alignment in bytes of the start of each region, such as GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT when regions are bound as ranges</param>
+	RingBufferLayout(uint32_t elementSize, uint32_t capacity, uint32_t frameCount, uint32_t alignment = 1);
+
+	/// <summary>
+	/// Makes sure that each region can hold the given number of elements. Growing at least doubles the
+	/// capacity, and starts over on the first region since the buffer must be re-allocated
+	/// </summary>
+	/// <param name="elementCount">The number of elements that will be written to the current region</param>
+	/// <returns>True if the layout grew and the buffer needs to be re-allocated</returns>
+	bool Reserve(uint32_t elementCount);
+	/// <summary>
+	/// Moves on to the next region, wrapping back to the first after the last
+	/// </summary>
+	void Advance();
+
+	uint32_t GetElementSize() const { return _elementSize; }
+	uint32_t GetFrameCount() const { return _frameCount; }
+	/// <summary>
+	/// Gets the number of elements in each region
+	/// </summary>
+	uint32_t GetCapacity() const { return _capacity; }
+	/// <summary>
+	/// Gets the index of the region that is currently being written
+	/// </summary>
+	uint32_t GetFrame() const { return _frame; }
+	/// <summary>
+	/// Gets the index of the first element in the current region, for use as a base instance
+	/// </summary>
+	uint32_t GetFrameOffset() const { return _frame * _capacity; }
+	/// <summary>
+	/// Gets the offset in bytes of the current region from the start of the buffer
+	/// </summary>
+	uint64_t GetFrameByteOffset() const { return (uint64_t)GetFrameOffset() * _elementSize; }
+	/// <summary>
+	/// Gets the number of elements across all of the regions, which is what the buffer needs to be allocated with
+	/// </summary>
+	uint32_t GetElementCount() const { return _capacity * _frameCount; }
+
+protected:
+	uint32_t _elementSize;
+	uint32_t _frameCount;
+	uint32_t _alignmentStep;
+	uint32_t _capacity;
+	uint32_t _frame;
+
+	// Rounds a capacity up so that regions start on the alignment, returns 0 if the buffer would be too big to index
+	uint32_t _RoundCapacity(uint64_t capacity) const;
+};
@@ -160,8 +160,9 @@ void Framebuffer::_AddAttachment(RenderTargetAttachment attachment, const Render
 		descriptor.HorizontalWrap     = WrapMode::ClampToEdge;
 		descriptor.VerticalWrap       = WrapMode::ClampToEdge;
 
-		// Create image and store in the buffer
+		// Create image and store in the buffer, it will be drawn to so it's pixels need reading back when saved
 		Texture2D::Sptr image = std::make_shared<Texture2D>(descriptor);
+		image->MarkAsRenderTarget();
 		buffer.Resource = image;
 
 		// Attach texture to the framebuffer
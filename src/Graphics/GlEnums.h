@@ -45,11 +45,21 @@ ENUM(InternalFormat, GLint,
 	SRGB         = GL_SRGB8,
 	RGB10        = GL_RGB10,
 	RGB16        = GL_RGB16,
+	RGB16F       = GL_RGB16F,
 	RGB32F       = GL_RGB32F,
 	RGBA8        = GL_RGBA8,
 	SRGBA        = GL_SRGB8_ALPHA8,
 	RGBA16       = GL_RGBA16,
-	RGB32AF      = GL_RGBA32F
+	RGB32AF      = GL_RGBA32F,
+	// Block compressed formats, see TextureCompressor. S3TC is an extension, so we use it's values directly
+	BC1          = 0x83F0, // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	BC1_SRGB     = 0x8C4C, // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+	BC3          = 0x83F3, // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+	BC3_SRGB     = 0x8C4F, // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+	BC4          = GL_COMPRESSED_RED_RGTC1,
+	BC5          = GL_COMPRESSED_RG_RGTC2,
+	BC7          = GL_COMPRESSED_RGBA_BPTC_UNORM,
+	BC7_SRGB     = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
 	// Note: There are sized internal formats but there is a LOT of them
 )
 
@@ -803,17 +813,54 @@ ENUM(AttribUsage, uint8_t,
 /// </summary>
 /// <see>https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glVertexAttribPointer.xhtml</see>
 ENUM(AttributeType, GLenum,
-	 Byte    = GL_BYTE,
-	 UByte   = GL_UNSIGNED_BYTE,
-	 Short   = GL_SHORT,
-	 UShort  = GL_UNSIGNED_SHORT,
-	 Int     = GL_INT,
-	 UInt    = GL_UNSIGNED_INT,
-	 Float   = GL_FLOAT,
-	 Double  = GL_DOUBLE,
-	 Unknown = GL_NONE
+	 Byte               = GL_BYTE,
+	 UByte              = GL_UNSIGNED_BYTE,
+	 Short              = GL_SHORT,
+	 UShort             = GL_UNSIGNED_SHORT,
+	 Int                = GL_INT,
+	 UInt               = GL_UNSIGNED_INT,
+	 Float              = GL_FLOAT,
+	 Double             = GL_DOUBLE,
+	 HalfFloat          = GL_HALF_FLOAT,
+	 // 3 signed normalized 10 bit components and a 2 bit w component, packed into 4 bytes
+	 Int_2_10_10_10_Rev = GL_INT_2_10_10_10_REV,
+	 Unknown            = GL_NONE
 )
 
+/// <summary>
+/// Gets the number of bytes a single component of the given attribute type takes up, or 0 for
+/// packed types that store all of their components together
+/// </summary>
+inline size_t GetAttributeTypeSize(AttributeType type) {
+	switch (type) {
+		case AttributeType::Byte:      return sizeof(int8_t);
+		case AttributeType::UByte:     return sizeof(uint8_t);
+		case AttributeType::Short:     return sizeof(int16_t);
+		case AttributeType::UShort:    return sizeof(uint16_t);
+		case AttributeType::Int:       return sizeof(int32_t);
+		case AttributeType::UInt:      return sizeof(uint32_t);
+		case AttributeType::Float:     return sizeof(float);
+		case AttributeType::Double:    return sizeof(double);
+		case AttributeType::HalfFloat: return sizeof(uint16_t);
+		// Packed types have no per component size, see GetAttributeByteSize
+		case AttributeType::Int_2_10_10_10_Rev:
+		case AttributeType::Unknown:
+		default:
+			return 0;
+	}
+}
+
+/// <summary>
+/// Gets the number of bytes an attribute with the given type and component count takes up in a vertex
+/// </summary>
+inline size_t GetAttributeByteSize(AttributeType type, int components) {
+	switch (type) {
+		case AttributeType::Int_2_10_10_10_Rev: return sizeof(uint32_t);
+		default:
+			return components * GetAttributeTypeSize(type);
+	}
+}
+
 /// <summary>
 /// Represents the mode in which a VAO will be drawn
 /// </summary>
@@ -828,6 +875,15 @@ ENUM(DrawMode, GLenum,
 	 TriangleList  = GL_TRIANGLES
 )
 
+/**
+ * Enumerates the ways a shader may access a texture that is bound as an image with glBindImageTexture
+ */
+ENUM(ImageAccess, GLenum,
+	ReadOnly  = GL_READ_ONLY,
+	WriteOnly = GL_WRITE_ONLY,
+	ReadWrite = GL_READ_WRITE
+)
+
 /**
  * Enumerates all possible attachment options of the glFramebufferTexture and  glFramebufferRenderbuffer commands
  */
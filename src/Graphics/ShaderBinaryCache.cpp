@@ -0,0 +1,200 @@
+#include "Graphics/ShaderBinaryCache.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <algorithm>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "Logging.h"
+
+namespace {
+	const char     HEADER_BYTES[4] = { 'S', 'B', 'I', 'N' };
+	// Bump this whenever the key or file layout changes, so old entries are ignored
+	const uint32_t CACHE_VERSION   = 1;
+
+	struct CacheHeader {
+		char     Magic[4];
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t Format;
+		uint32_t Length;
+		// How long the program took to compile from source, so we know what a hit saves us
+		double   CompileTime;
+	};
+
+	bool        IsCacheEnabled  = true;
+	// -1 until we've asked the driver if it supports any binary formats
+	int         DriverSupport   = -1;
+	std::string CacheDirectory  = "shader_cache";
+	ShaderBinaryCache::Stats CacheStats;
+
+	// 64 bit FNV-1a, stable across runs and platforms unlike std::hash
+	const uint64_t FNV_OFFSET = 14695981039346656037ull;
+	const uint64_t FNV_PRIME  = 1099511628211ull;
+
+	void HashBytes(uint64_t& hash, const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t ix = 0; ix < size; ix++) {
+			hash = (hash ^ bytes[ix]) * FNV_PRIME;
+		}
+	}
+
+	void HashString(uint64_t& hash, const std::string& value) {
+		// Hash the length as well, so that ("ab", "c") and ("a", "bc") differ
+		const uint64_t length = value.size();
+		HashBytes(hash, &length, sizeof(uint64_t));
+		HashBytes(hash, value.data(), value.size());
+	}
+
+	std::string GetGlString(GLenum name) {
+		const GLubyte* value = glGetString(name);
+		return value != nullptr ? reinterpret_cast<const char*>(value) : "";
+	}
+
+	std::filesystem::path GetEntryPath(uint64_t key) {
+		char fileName[32];
+		snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(key));
+		return std::filesystem::path(CacheDirectory) / fileName;
+	}
+}
+
+void ShaderBinaryCache::SetEnabled(bool enabled) {
+	IsCacheEnabled = enabled;
+}
+
+bool ShaderBinaryCache::IsEnabled() {
+	if (DriverSupport == -1) {
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		DriverSupport = numFormats > 0 ? 1 : 0;
+		if (!DriverSupport) {
+			LOG_WARN("Driver does not support any program binary formats, shader cache is disabled");
+		}
+	}
+	return IsCacheEnabled && DriverSupport == 1;
+}
+
+void ShaderBinaryCache::SetDirectory(const std::string& directory) {
+	CacheDirectory = directory;
+}
+
+uint64_t ShaderBinaryCache::ComputeKey(const std::map<ShaderPartType, std::string>& sources, const std::vector<std::string>& varyings, bool interleaved) {
+	// Binaries are only valid for the exact driver that produced them
+	static const std::string driver = GetGlString(GL_VENDOR) + "|" + GetGlString(GL_RENDERER) + "|" + GetGlString(GL_VERSION);
+
+	uint64_t hash = FNV_OFFSET;
+	HashBytes(hash, &CACHE_VERSION, sizeof(uint32_t));
+	HashString(hash, driver);
+	// std::map keeps the stages in a stable order
+	for (const auto& [type, source] : sources) {
+		const GLint stage = static_cast<GLint>(type);
+		HashBytes(hash, &stage, sizeof(GLint));
+		HashString(hash, source);
+	}
+	for (const std::string& varying : varyings) {
+		HashString(hash, varying);
+	}
+	HashBytes(hash, &interleaved, sizeof(bool));
+	return hash;
+}
+
+bool ShaderBinaryCache::TryLoad(uint32_t program, uint64_t key, const std::string& debugName) {
+	if (!IsEnabled()) {
+		return false;
+	}
+
+	double startTime = glfwGetTime();
+
+	std::filesystem::path path = GetEntryPath(key);
+	std::ifstream file(path, std::ios::in | std::ios::binary);
+	if (!file) {
+		CacheStats.Misses++;
+		LOG_INFO("Shader cache miss for \"{}\" ({} hits, {} misses)", debugName, CacheStats.Hits, CacheStats.Misses);
+		return false;
+	}
+
+	CacheHeader header;
+	std::vector<char> binary;
+	bool valid = file.read(reinterpret_cast<char*>(&header), sizeof(CacheHeader)) &&
+		memcmp(header.Magic, HEADER_BYTES, 4) == 0 && header.Version == CACHE_VERSION && header.Key == key;
+	if (valid) {
+		binary.resize(header.Length);
+		valid = header.Length > 0 && file.read(binary.data(), header.Length);
+	}
+	file.close();
+
+	// The driver may refuse binaries even if it produced them (ex: after an update that kept the version string)
+	GLint status = GL_FALSE;
+	if (valid) {
+		glProgramBinary(program, header.Format, binary.data(), header.Length);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+	}
+
+	if (status == GL_FALSE) {
+		LOG_WARN("Discarding rejected shader cache entry for \"{}\" ({})", debugName, path.string());
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		CacheStats.Rejected++;
+		CacheStats.Misses++;
+		return false;
+	}
+
+	double loadTime = glfwGetTime() - startTime;
+	CacheStats.Hits++;
+	CacheStats.TimeSaved += std::max(header.CompileTime - loadTime, 0.0);
+	LOG_INFO("Shader cache hit for \"{}\", loaded in {:.2f}ms instead of {:.2f}ms ({} hits, {} misses, {:.2f}ms saved total)", debugName,
+		loadTime * 1000.0, header.CompileTime * 1000.0, CacheStats.Hits, CacheStats.Misses, CacheStats.TimeSaved * 1000.0);
+	return true;
+}
+
+void ShaderBinaryCache::Store(uint32_t program, uint64_t key, double compileTime) {
+	if (!IsEnabled()) {
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	CacheHeader header;
+	memcpy(header.Magic, HEADER_BYTES, 4);
+	header.Version     = CACHE_VERSION;
+	header.Key         = key;
+	header.CompileTime = compileTime;
+
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+	header.Format = format;
+	header.Length = static_cast<uint32_t>(length);
+
+	std::error_code error;
+	std::filesystem::create_directories(CacheDirectory, error);
+
+	// Write to a temporary file and swap it in, so a crash mid-write can't leave a truncated entry behind
+	std::filesystem::path path = GetEntryPath(key);
+	std::filesystem::path tempPath = path;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file) {
+			LOG_WARN("Could not write shader cache entry \"{}\"", tempPath.string());
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+		file.write(binary.data(), header.Length);
+	}
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		LOG_WARN("Could not write shader cache entry \"{}\": {}", path.string(), error.message());
+		std::filesystem::remove(tempPath, error);
+	}
+}
+
+const ShaderBinaryCache::Stats& ShaderBinaryCache::GetStats() {
+	return CacheStats;
+}
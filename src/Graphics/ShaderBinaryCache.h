@@ -0,0 +1,76 @@
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "Graphics/GlEnums.h"
+
+/// <summary>
+/// An on-disk cache of linked shader program binaries (glGetProgramBinary / glProgramBinary)
+///
+/// Entries are keyed by a hash of the fully include-resolved shader sources, any transform feedback
+/// varyings, and the driver's vendor, renderer and version strings, so a driver update or a change
+/// to any included file will simply miss the cache. The driver is also free to reject a binary at load
+/// time, in which case the entry is deleted and the program is compiled from source as usual
+/// </summary>
+class ShaderBinaryCache {
+public:
+	/// <summary>
+	/// Running totals for how effective the cache has been this session
+	/// </summary>
+	struct Stats {
+		// The number of programs loaded from a cached binary
+		uint32_t Hits = 0;
+		// The number of programs that had no cached binary and were compiled from source
+		uint32_t Misses = 0;
+		// The number of cached binaries the driver refused to load, these also count as misses
+		uint32_t Rejected = 0;
+		// The total compile and link time avoided by cache hits, in seconds
+		double   TimeSaved = 0.0;
+	};
+
+	ShaderBinaryCache() = delete;
+
+	/// <summary>
+	/// Enables or disables the cache, when disabled every program is compiled from source
+	/// </summary>
+	static void SetEnabled(bool enabled);
+	/// <summary>
+	/// Returns true if the cache is enabled and the driver supports at least one program binary format
+	/// </summary>
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Sets the folder that cached binaries are stored in, defaults to "shader_cache"
+	/// </summary>
+	static void SetDirectory(const std::string& directory);
+
+	/// <summary>
+	/// Calculates the cache key for a program
+	/// </summary>
+	/// <param name="sources">The include-resolved source for each stage of the program</param>
+	/// <param name="varyings">The transform feedback varyings that will be captured, if any</param>
+	/// <param name="interleaved">True if the varyings are captured into a single interleaved buffer</param>
+	static uint64_t ComputeKey(const std::map<ShaderPartType, std::string>& sources, const std::vector<std::string>& varyings, bool interleaved);
+
+	/// <summary>
+	/// Attempts to load a program from the cache, returns true if the program is now linked
+	/// </summary>
+	/// <param name="program">The OpenGL handle of the program to load the binary into</param>
+	/// <param name="key">The key generated by ComputeKey</param>
+	/// <param name="debugName">The name of the program, used for logging</param>
+	static bool TryLoad(uint32_t program, uint64_t key, const std::string& debugName);
+	/// <summary>
+	/// Stores the binary for a program that was just linked from source
+	/// </summary>
+	/// <param name="program">The OpenGL handle of the linked program</param>
+	/// <param name="key">The key generated by ComputeKey</param>
+	/// <param name="compileTime">How long it took to compile and link the program, in seconds</param>
+	static void Store(uint32_t program, uint64_t key, double compileTime);
+
+	/// <summary>
+	/// Gets the running totals for the cache
+	/// </summary>
+	static const Stats& GetStats();
+};
@@ -3,20 +3,30 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
 
 #include "Utils/FileHelpers.h"
 #include "Utils/JsonGlmHelpers.h"
+#include "Graphics/ShaderBinaryCache.h"
+#include "Graphics/ShaderReloader.h"
+#include <GLFW/glfw3.h>
 
 ShaderProgram::ShaderProgram() : 
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_varyingsInterleaved(true),
+	_materialStateKey(0),
+	_linkGeneration(0)
 {
 	_rendererId = glCreateProgram();
 }
 
 ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::string>& filePaths) :
 	IGraphicsResource(),
-	IResource()
+	IResource(),
+	_varyingsInterleaved(true),
+	_materialStateKey(0),
+	_linkGeneration(0)
 {
 	_rendererId = glCreateProgram();
 	for (auto& [type, path] : filePaths) {
@@ -26,6 +36,7 @@ ShaderProgram::ShaderProgram(const std::unordered_map<ShaderPartType, std::strin
 }
 
 ShaderProgram::~ShaderProgram() {
+	ShaderReloader::Unwatch(this);
 	if (_rendererId != 0) {
 		glDeleteProgram(_rendererId);
 		_rendererId = 0;
@@ -33,68 +44,33 @@ ShaderProgram::~ShaderProgram() {
 }
 
 bool ShaderProgram::LoadShaderPart(const char* source, ShaderPartType type) {
-	// Creates a new shader part (VS, FS, GS, etc...)
-	GLuint handle = glCreateShader((GLenum)type);
-
-	// Load the GLSL source and compile it
-	glShaderSource(handle, 1, &source, nullptr);
-	glCompileShader(handle);
-
-	// Get the compilation status for the shader part
-	GLint status = 0;
-	glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
-
-	if (status == GL_FALSE) {
-		// Get the size of the error log
-		GLint logSize = 0;
-		glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &logSize);
-
-		// Create a new character buffer for the log
-		char* log = new char[logSize];
-
-		// Get the log
-		glGetShaderInfoLog(handle, logSize, &logSize, log);
-
-		// Dump error log
-		LOG_ERROR("Failed to compile shader part:\n{}", log);
-
-		// Clean up our log memory
-		delete[] log;
-
-		// Delete the broken shader result
-		glDeleteShader(handle);
-		handle = 0;
-
-		return false;
-	}
-
-	// If we're overwriting, warn and clean up the old program before we store
-	if (_handles[type] != 0) {
+	// We hold onto the source until Link, since we may not need to compile it at all if the
+	// linked program is in the binary cache
+	if (_pendingSources.count(type) != 0) {
 		LOG_WARN("Another shader has been attached to this slot, overwriting");
-		glDeleteShader(_handles[type]);
 	}
-	_handles[type] = handle;
+	_pendingSources[type] = source;
 
 	// Store info about where we got this data from
 	_fileSourceMap[type].IsFilePath = false;
 	_fileSourceMap[type].Source = source;
+	_fileSourceMap[type].Dependencies.clear();
 
-	return status != GL_FALSE;
+	return true;
 }
 
 bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type) {
 	// Make sure that the file exists before we try reading
 	if (std::filesystem::exists(path)) {
 		// Load the source from the file, using our helper that will
-		// resolve #include directives
-		std::string source = FileHelpers::ReadResolveIncludes(path);
+		// resolve #include directives, and remember which files it read
+		std::vector<std::string> dependencies;
+		std::string source = FileHelpers::ReadResolveIncludes(path, &dependencies);
 		// Pass off to LoadShaderPart
 		bool result =  LoadShaderPart(source.c_str(), type);
 		_fileSourceMap[type].IsFilePath = true;
 		_fileSourceMap[type].Source = path;
-		if (result == false) {
-			LOG_ERROR("Source File: {}", path);
-		}
+		_fileSourceMap[type].Dependencies = std::move(dependencies);
 		return result; 
 	} else {
 		LOG_WARN("Could not open file at \"{}\"", path);
@@ -103,44 +79,162 @@ bool ShaderProgram::LoadShaderPartFromFile(const char* path, ShaderPartType type
 }
 
 bool ShaderProgram::Link() {
+	bool linked = _BuildProgram(_rendererId);
+
+	// Remove the sources so we don't accidentally compile them again
+	_pendingSources.clear();
+
+	// Perform our uniform introspection to see what uniforms are in the shader
+	_Introspect();
+
+	// Linking resets all uniforms to their defaults, so whatever material was applied is gone
+	_materialStateKey = 0;
+
+	if (linked) {
+		_linkGeneration++;
+	}
+
+	// Start watching our source files so we can be rebuilt when they change
+	ShaderReloader::Watch(this);
+
+	return linked;
+}
+
+bool ShaderProgram::_BuildProgram(GLuint program) {
+	// The key covers the fully resolved sources, so any change to an included file is a miss
+	const uint64_t cacheKey = ShaderBinaryCache::ComputeKey(_pendingSources, _varyings, _varyingsInterleaved);
+
+	// Programs created from a list of files are linked before they get a name, so fall back to a file path
+	std::string logName = _debugName;
+	if (logName.empty() && !_pendingSources.empty()) {
+		logName = _fileSourceMap[_pendingSources.begin()->first].IsFilePath ? _fileSourceMap[_pendingSources.begin()->first].Source : "<from source>";
+	}
+
+	if (!_pendingSources.empty() && ShaderBinaryCache::TryLoad(program, cacheKey, logName)) {
+		return true;
+	}
+
+	double startTime = glfwGetTime();
+	bool linked = _CompileAndLink(program);
+	if (linked && !_pendingSources.empty()) {
+		ShaderBinaryCache::Store(program, cacheKey, glfwGetTime() - startTime);
+	}
+	return linked;
+}
+
+bool ShaderProgram::_Reload(std::map<ShaderPartType, std::string>&& sources, std::unordered_map<ShaderPartType, std::vector<std::string>>&& dependencies) {
+	// Keep track of the new include graph even if the build fails, so that fixing an
+	// error in a newly included file will trigger another reload
+	for (auto& [type, files] : dependencies) {
+		_fileSourceMap[type].Dependencies = std::move(files);
+	}
+	ShaderReloader::Watch(this);
+
+	// Build into a fresh program, so the current one stays usable if something is broken
+	GLuint program = glCreateProgram();
+	if (!_varyings.empty()) {
+		std::vector<const char*> names;
+		names.reserve(_varyings.size());
+		for (const std::string& name : _varyings) {
+			names.push_back(name.c_str());
+		}
+		glTransformFeedbackVaryings(program, (GLsizei)names.size(), names.data(), _varyingsInterleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
+	}
+
+	_pendingSources = std::move(sources);
+	bool linked = _BuildProgram(program);
+	_pendingSources.clear();
+
+	if (!linked) {
+		LOG_WARN("Failed to reload shader \"{}\", keeping the previous program", _debugName);
+		glDeleteProgram(program);
+		return false;
+	}
+
+	// Uniform block bindings are program state, so we need to carry any custom ones over
+	std::unordered_map<std::string, int> blockBindings;
+	for (auto& [name, block] : _uniformBlocks) {
+		if (block.CurrentBinding != block.DefaultBinding) {
+			blockBindings[name] = block.CurrentBinding;
+		}
+	}
+
+	// Swap the new program in, this also moves our debug name over to it
+	glDeleteProgram(_rendererId);
+	_SetRenderId(program);
+
+	// Locations may have moved around, so we start our introspection from scratch
+	_uniforms.clear();
+	_uniformBlocks.clear();
+	_Introspect();
+	for (auto& [name, slot] : blockBindings) {
+		BindUniformBlockToSlot(name, slot);
+	}
+
+	_materialStateKey = 0;
+	_linkGeneration++;
+
+	return true;
+}
+
+std::vector<std::string> ShaderProgram::GetDependencies() const {
+	std::vector<std::string> result;
+	for (auto& [type, source] : _fileSourceMap) {
+		for (const std::string& file : source.Dependencies) {
+			if (std::find(result.begin(), result.end(), file) == result.end()) {
+				result.push_back(file);
+			}
+		}
+	}
+	return result;
+}
 
+bool ShaderProgram::_CompileAndLink(GLuint program) {
 	LOG_TRACE("Starting shader link:");
-	
-	// Attach all our shaders
-	for (auto& [type, id] : _handles) {
-		if (id != 0) {
-			glAttachShader(_rendererId, id);
-			LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
+
+	// Compile all our shaders
+	std::vector<GLuint> handles;
+	bool compiled = true;
+	for (auto& [type, source] : _pendingSources) {
+		GLuint handle = _CompileShaderPart(type, source);
+		if (handle == 0) {
+			compiled = false;
+			continue;
 		}
+		handles.push_back(handle);
+	}
+
+	// Attach all our shaders
+	for (GLuint handle : handles) {
+		glAttachShader(program, handle);
 	}
 
+	// Let the driver know that we'll be asking for the binary, so it can keep it around
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	// Perform linking
-	glLinkProgram(_rendererId);
+	glLinkProgram(program);
 
 	// Remove shader parts to save space (we can do this since we only needed the shader parts to compile an actual shader program)
-	for (auto& [type, id] : _handles) { 
-		if (id != 0) {
-			glDetachShader(_rendererId, id);
-			glDeleteShader(id);
-		}
+	for (GLuint handle : handles) { 
+		glDetachShader(program, handle);
+		glDeleteShader(handle);
 	}
-	// Remove all the handles so we don't accidentally use them
-	_handles.clear();
 
 	GLint status = 0;
-	glGetProgramiv(_rendererId, GL_LINK_STATUS, &status);
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
 
 	// If linking failed, figure out why
 	if (status == GL_FALSE)
 	{
 		// Get the length of the log
 		GLint length = 0;
-		glGetProgramiv(_rendererId, GL_INFO_LOG_LENGTH, &length);
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
 
 		if (length > 0) {
 			// Read the log from openGL
 			char* log = new char[length];
-			glGetProgramInfoLog(_rendererId, length, &length, log);
+			glGetProgramInfoLog(program, length, &length, log);
 			LOG_ERROR("Shader failed to link:\n{}", log);
 			delete[] log;
 		} else {
@@ -150,10 +244,50 @@ bool ShaderProgram::Link() {
 		LOG_TRACE("Linking complete, starting introspection");
 	}
 
-	// Perform our uniform introspection to see what uniforms are in the shader
-	_Introspect();
+	return compiled && status != GL_FALSE;
+}
+
+GLuint ShaderProgram::_CompileShaderPart(ShaderPartType type, const std::string& source) {
+	LOG_TRACE("\t{} - {}", ~type, _fileSourceMap[type].IsFilePath ? _fileSourceMap[type].Source : "<from source>");
+
+	// Creates a new shader part (VS, FS, GS, etc...)
+	GLuint handle = glCreateShader((GLenum)type);
 
-	return status != GL_FALSE;
+	// Load the GLSL source and compile it
+	const char* sourcePtr = source.c_str();
+	glShaderSource(handle, 1, &sourcePtr, nullptr);
+	glCompileShader(handle);
+
+	// Get the compilation status for the shader part
+	GLint status = 0;
+	glGetShaderiv(handle, GL_COMPILE_STATUS, &status);
+
+	if (status == GL_FALSE) {
+		// Get the size of the error log
+		GLint logSize = 0;
+		glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &logSize);
+
+		// Create a new character buffer for the log
+		char* log = new char[logSize];
+
+		// Get the log
+		glGetShaderInfoLog(handle, logSize, &logSize, log);
+
+		// Dump error log
+		LOG_ERROR("Failed to compile shader part:\n{}", log);
+		if (_fileSourceMap[type].IsFilePath) {
+			LOG_ERROR("Source File: {}", _fileSourceMap[type].Source);
+		}
+
+		// Clean up our log memory
+		delete[] log;
+
+		// Delete the broken shader result
+		glDeleteShader(handle);
+		handle = 0;
+	}
+
+	return handle;
 }
 
 void ShaderProgram::Bind() {
@@ -520,4 +654,8 @@ GlResourceType ShaderProgram::GetResourceClass() const {
 void ShaderProgram::RegisterVaryings(const char* const* names, int numVaryings, bool interleaved /*= true*/)
 {
 	glTransformFeedbackVaryings(_rendererId, numVaryings, names, interleaved ? GL_INTERLEAVED_ATTRIBS : GL_SEPARATE_ATTRIBS);
+
+	// Capture layouts are baked into the program binary, so they need to be part of the cache key
+	_varyings.assign(names, names + numVaryings);
+	_varyingsInterleaved = interleaved;
 }
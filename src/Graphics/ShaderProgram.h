@@ -3,6 +3,8 @@
 #include <memory>
 #include <string>               // for std::string
 #include <unordered_map>        // for std::unordered_map
+#include <map>                  // for std::map
+#include <vector>               // for std::vector
 #include <GLM/glm.hpp>          // for our GLM types
 #include <GLM/gtc/type_ptr.hpp> // for glm::value_ptr
 #include <Logging.h>            // for the logging functions
@@ -71,6 +73,7 @@ public:
 
 	/// <summary>
 	/// Loads a single shader stage into this shader object (ex: Vertex Shader or Fragment Shader)
+	/// The stage is compiled when Link is called, unless the linked program is found in the ShaderBinaryCache
 	/// </summary>
 	/// <param name="source">The source code of the shader to load</param>
 	/// <param name="type">The stage to load (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER)</param>
@@ -94,6 +97,8 @@ public:
 
 	/// <summary>
 	/// Links the vertex and fragment shader, and allows this shader program to be used
+	/// Will load the program from the ShaderBinaryCache if possible, otherwise compiles the
+	/// loaded stages from source and stores the result in the cache
 	/// </summary>
 	/// <returns>True if the linking was successful, false if otherwise</returns>
 	bool Link();
@@ -109,6 +114,30 @@ public:
 
 	const std::unordered_map<std::string, UniformInfo>& GetUniforms() const { return _uniforms; }
 
+	/// <summary>
+	/// Gets every file that this program was built from, including all files pulled in by #include
+	/// These are the files that the ShaderReloader watches for changes
+	/// </summary>
+	std::vector<std::string> GetDependencies() const;
+
+	/// <summary>
+	/// Gets a counter that is incremented every time a new program is successfully linked, either by
+	/// Link or by a hot reload. When this changes, uniform locations and types may have changed too
+	/// </summary>
+	uint32_t GetLinkGeneration() const { return _linkGeneration; }
+
+	/// <summary>
+	/// Gets the key of the material state that was last uploaded to this program's uniforms, or 0 if
+	/// no material has been applied since the program was linked. Materials use this to skip re-sending
+	/// uniforms that the program already holds
+	/// </summary>
+	uint64_t GetMaterialStateKey() const { return _materialStateKey; }
+	/// <summary>
+	/// Records the key of the material state that was just uploaded to this program's uniforms
+	/// </summary>
+	/// <param name="key">The key of the material state, see Material::Apply</param>
+	void SetMaterialStateKey(uint64_t key) { _materialStateKey = key; }
+
 	// Inherited from IGraphicsResource
 
 	virtual GlResourceType GetResourceClass() const override;
@@ -177,23 +206,62 @@ public:
 	void BindUniformBlockToSlot(const std::string& name, int uboSlot);
 
 protected:
-	// Stores all the handles to our shaders until we
+	// The reloader swaps new programs in for us when our source files change
+	friend class ShaderReloader;
+
+	// Stores the include-resolved source of our shaders until we
 	// are ready to compile them into a program
-	std::unordered_map<ShaderPartType, int> _handles;
+	std::map<ShaderPartType, std::string> _pendingSources;
+	// The transform feedback varyings registered for capture, these are part of the binary cache key
+	std::vector<std::string> _varyings;
+	bool _varyingsInterleaved;
 	
 	// Map access to look up uniform locations and blocks
 	std::unordered_map<std::string, UniformInfo> _uniforms;
 	std::unordered_map<std::string, UniformBlockInfo> _uniformBlocks;
 
+	// The key of the material state last uploaded to our uniforms
+	uint64_t _materialStateKey;
+	// Incremented whenever a new program is successfully linked
+	uint32_t _linkGeneration;
+
 	// Stores information about the source of our shader parts
 	// EX: if a VS shader is loaded from a file, will contain
 	// the file path, and IsFilePath=true
 	struct ShaderSource {
 		std::string Source;
 		bool        IsFilePath;
+		// The lexically normal path of the file and every file it included, empty if not from a file
+		std::vector<std::string> Dependencies;
 	};
 	std::unordered_map<ShaderPartType, ShaderSource> _fileSourceMap;
 
+	/// <summary>
+	/// Builds the pending shader stages into the given program, either from the ShaderBinaryCache or
+	/// by compiling and linking them, storing the result in the cache
+	/// </summary>
+	/// <param name="program">The OpenGL handle of the program to build into</param>
+	/// <returns>True if the program is linked</returns>
+	bool _BuildProgram(GLuint program);
+	/// <summary>
+	/// Compiles all of the pending shader stages and links them into the program
+	/// </summary>
+	/// <param name="program">The OpenGL handle of the program to link</param>
+	/// <returns>True if the program compiled and linked successfully</returns>
+	bool _CompileAndLink(GLuint program);
+	/// <summary>
+	/// Builds a new program from re-read sources, and replaces our current program with it if it links
+	/// If the new program fails to build, the current program is left untouched
+	/// </summary>
+	/// <param name="sources">The include-resolved source for each stage</param>
+	/// <param name="dependencies">The files each stage was read from, see ShaderSource::Dependencies</param>
+	/// <returns>True if the new program was swapped in</returns>
+	bool _Reload(std::map<ShaderPartType, std::string>&& sources, std::unordered_map<ShaderPartType, std::vector<std::string>>&& dependencies);
+	/// <summary>
+	/// Compiles a single shader stage, returning it's handle or 0 if compilation failed
+	/// </summary>
+	GLuint _CompileShaderPart(ShaderPartType type, const std::string& source);
+
 	/// <summary>
 	/// Performs program introspection, where we examine the uniforms that
 	/// the program contains
@@ -0,0 +1,355 @@
+#include "Graphics/ShaderReloader.h"
+
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <chrono>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include "Graphics/ShaderProgram.h"
+#include "Utils/FileHelpers.h"
+#include "Logging.h"
+
+namespace {
+	// Where a single stage of a program came from, copied out of the program so workers never touch it
+	struct StageSource {
+		std::string Source;
+		bool        IsFilePath;
+	};
+
+	// The re-read sources of a program, produced on a worker thread
+	struct ReloadResult {
+		bool Success = false;
+		std::map<ShaderPartType, std::string> Sources;
+		std::unordered_map<ShaderPartType, std::vector<std::string>> Dependencies;
+	};
+
+	struct ReloadJob {
+		std::future<ReloadResult> Result;
+		// Set if one of the program's files changed again while we were reading, so we need to go again
+		bool Stale = false;
+	};
+
+	bool IsReloadEnabled = true;
+	// Set by Shutdown, programs destroyed after this (ex: during static destruction) must not touch our state
+	bool IsShutdown = false;
+	ShaderReloader::Stats ReloadStats;
+
+	// The dependency graph, in both directions. These are only touched from the main thread
+	std::unordered_map<std::string, std::unordered_set<ShaderProgram*>> Dependents;
+	std::unordered_map<ShaderProgram*, std::vector<std::string>> ProgramFiles;
+	std::unordered_map<ShaderProgram*, ReloadJob> Jobs;
+
+	// Shared between the main thread and the watcher thread
+	std::mutex WatchMutex;
+	std::unordered_set<std::string> WatchedFiles;
+	std::unordered_set<std::string> ChangedFiles;
+	std::thread       WatcherThread;
+	std::atomic<bool> IsWatcherRunning(false);
+
+	#ifdef __linux__
+	int InotifyHandle = -1;
+	// Maps inotify watch descriptors to the directory they are watching
+	std::unordered_map<int, std::string> WatchedDirectories;
+
+	// We watch directories instead of files, since a lot of editors save by writing a temporary
+	// file and renaming it over the original, which would silently drop a watch on the file itself
+	void AddPlatformWatch(const std::string& file) {
+		std::string directory = std::filesystem::path(file).parent_path().string();
+		if (directory.empty()) {
+			directory = ".";
+		}
+		// inotify hands back the same descriptor if the directory is already watched
+		int descriptor = inotify_add_watch(InotifyHandle, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (descriptor < 0) {
+			LOG_WARN("Failed to watch shader directory \"{}\"", directory);
+			return;
+		}
+		WatchedDirectories[descriptor] = directory;
+	}
+
+	void WatcherLoop() {
+		alignas(inotify_event) char buffer[4096];
+		while (IsWatcherRunning) {
+			// Wake up every so often so that we notice when we've been asked to stop
+			pollfd request = { InotifyHandle, POLLIN, 0 };
+			if (poll(&request, 1, 100) <= 0) {
+				continue;
+			}
+			ssize_t length = read(InotifyHandle, buffer, sizeof(buffer));
+			if (length <= 0) {
+				continue;
+			}
+
+			std::lock_guard<std::mutex> lock(WatchMutex);
+			for (char* seek = buffer; seek < buffer + length; ) {
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(seek);
+				seek += sizeof(inotify_event) + event->len;
+
+				auto it = WatchedDirectories.find(event->wd);
+				if (event->len == 0 || it == WatchedDirectories.end()) {
+					continue;
+				}
+				// Other files in the directory will show up too, we only care about the ones we depend on
+				std::string file = (std::filesystem::path(it->second) / event->name).lexically_normal().string();
+				if (WatchedFiles.count(file) != 0) {
+					ChangedFiles.insert(file);
+				}
+			}
+		}
+	}
+
+	bool StartPlatformWatcher() {
+		InotifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (InotifyHandle < 0) {
+			LOG_WARN("Failed to initialize inotify, shader hot reloading is disabled");
+			return false;
+		}
+		return true;
+	}
+
+	void StopPlatformWatcher() {
+		if (InotifyHandle >= 0) {
+			close(InotifyHandle);
+			InotifyHandle = -1;
+		}
+		WatchedDirectories.clear();
+	}
+	#else
+	// Without inotify we fall back to polling the write times of every watched file
+	void AddPlatformWatch(const std::string& file) { }
+
+	void WatcherLoop() {
+		std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+		std::vector<std::string> files;
+		std::vector<std::string> changed;
+		while (IsWatcherRunning) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+			{
+				std::lock_guard<std::mutex> lock(WatchMutex);
+				files.assign(WatchedFiles.begin(), WatchedFiles.end());
+			}
+
+			changed.clear();
+			for (const std::string& file : files) {
+				std::error_code error;
+				std::filesystem::file_time_type time = std::filesystem::last_write_time(file, error);
+				if (error) {
+					continue;
+				}
+				// The first time we see a file we only record the time
+				auto it = writeTimes.find(file);
+				if (it == writeTimes.end()) {
+					writeTimes[file] = time;
+				} else if (it->second != time) {
+					it->second = time;
+					changed.push_back(file);
+				}
+			}
+
+			if (!changed.empty()) {
+				std::lock_guard<std::mutex> lock(WatchMutex);
+				ChangedFiles.insert(changed.begin(), changed.end());
+			}
+		}
+	}
+
+	bool StartPlatformWatcher() { return true; }
+	void StopPlatformWatcher() { }
+	#endif
+
+	void AddFileWatch(const std::string& file) {
+		// The watcher thread is only started once there's something to watch
+		if (!IsWatcherRunning) {
+			if (!StartPlatformWatcher()) {
+				IsReloadEnabled = false;
+				return;
+			}
+			IsWatcherRunning = true;
+			WatcherThread = std::thread(WatcherLoop);
+		}
+
+		std::lock_guard<std::mutex> lock(WatchMutex);
+		if (WatchedFiles.insert(file).second) {
+			AddPlatformWatch(file);
+		}
+	}
+
+	void RemoveEdges(ShaderProgram* program) {
+		auto it = ProgramFiles.find(program);
+		if (it == ProgramFiles.end()) {
+			return;
+		}
+		for (const std::string& file : it->second) {
+			auto dependents = Dependents.find(file);
+			if (dependents != Dependents.end()) {
+				dependents->second.erase(program);
+				if (dependents->second.empty()) {
+					Dependents.erase(dependents);
+				}
+			}
+		}
+		ProgramFiles.erase(it);
+	}
+
+	// Runs on a worker thread, does all of the file IO for a reload
+	ReloadResult ResolveSources(const std::unordered_map<ShaderPartType, StageSource>& stages) {
+		ReloadResult result;
+		for (auto& [type, stage] : stages) {
+			if (stage.IsFilePath) {
+				// The file may be mid-save, in which case we'll get another change event shortly
+				if (!std::filesystem::exists(stage.Source)) {
+					LOG_WARN("Could not open file at \"{}\", skipping shader reload", stage.Source);
+					return result;
+				}
+				result.Sources[type] = FileHelpers::ReadResolveIncludes(stage.Source, &result.Dependencies[type]);
+			} else {
+				result.Sources[type] = stage.Source;
+			}
+		}
+		result.Success = true;
+		return result;
+	}
+}
+
+void ShaderReloader::SetEnabled(bool enabled) {
+	IsReloadEnabled = enabled;
+}
+
+bool ShaderReloader::IsEnabled() {
+	return IsReloadEnabled;
+}
+
+void ShaderReloader::Watch(ShaderProgram* program) {
+	if (IsShutdown) {
+		return;
+	}
+
+	// Our includes may have changed since last time, so we rebuild this program's edges from scratch
+	RemoveEdges(program);
+	std::vector<std::string> files = program->GetDependencies();
+	if (files.empty()) {
+		return;
+	}
+	for (const std::string& file : files) {
+		Dependents[file].insert(program);
+		AddFileWatch(file);
+	}
+	ProgramFiles[program] = std::move(files);
+}
+
+void ShaderReloader::Unwatch(ShaderProgram* program) {
+	if (IsShutdown) {
+		return;
+	}
+	RemoveEdges(program);
+	// Note that this waits for the worker if it's still reading
+	Jobs.erase(program);
+}
+
+void ShaderReloader::Poll() {
+	if (IsShutdown) {
+		return;
+	}
+
+	// Grab everything the watcher has seen since last frame
+	std::unordered_set<std::string> changed;
+	{
+		std::lock_guard<std::mutex> lock(WatchMutex);
+		changed.swap(ChangedFiles);
+	}
+
+	// Start reloading every program that depends on a changed file, each program is only reloaded once
+	// no matter how many of its files changed
+	if (IsReloadEnabled) {
+		for (const std::string& file : changed) {
+			auto it = Dependents.find(file);
+			if (it == Dependents.end()) {
+				continue;
+			}
+			LOG_INFO("Shader source \"{}\" changed, reloading {} program(s)", file, it->second.size());
+			for (ShaderProgram* program : it->second) {
+				auto job = Jobs.find(program);
+				if (job != Jobs.end()) {
+					job->second.Stale = true;
+				} else {
+					_StartReload(program);
+				}
+			}
+		}
+	}
+
+	// Swap in any programs whose sources are ready
+	std::vector<ShaderProgram*> restart;
+	for (auto it = Jobs.begin(); it != Jobs.end(); ) {
+		if (it->second.Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+
+		ShaderProgram* program = it->first;
+		ReloadResult result = it->second.Result.get();
+		bool stale = it->second.Stale;
+		it = Jobs.erase(it);
+
+		// No point building something we know is out of date
+		if (stale) {
+			restart.push_back(program);
+			continue;
+		}
+
+		if (result.Success && program->_Reload(std::move(result.Sources), std::move(result.Dependencies))) {
+			ReloadStats.Reloaded++;
+			LOG_INFO("Reloaded shader \"{}\" ({} reloaded, {} failed this session)", program->GetDebugName(), ReloadStats.Reloaded, ReloadStats.Failed);
+		} else {
+			ReloadStats.Failed++;
+		}
+	}
+	for (ShaderProgram* program : restart) {
+		_StartReload(program);
+	}
+}
+
+void ShaderReloader::Shutdown() {
+	if (IsShutdown) {
+		return;
+	}
+
+	if (IsWatcherRunning) {
+		IsWatcherRunning = false;
+		WatcherThread.join();
+	}
+	StopPlatformWatcher();
+
+	// Clearing the jobs waits on any workers that are still going
+	Jobs.clear();
+	Dependents.clear();
+	ProgramFiles.clear();
+	WatchedFiles.clear();
+	ChangedFiles.clear();
+
+	IsShutdown = true;
+}
+
+const ShaderReloader::Stats& ShaderReloader::GetStats() {
+	return ReloadStats;
+}
+
+void ShaderReloader::_StartReload(ShaderProgram* program) {
+	std::unordered_map<ShaderPartType, StageSource> stages;
+	for (auto& [type, source] : program->_fileSourceMap) {
+		stages[type] = { source.Source, source.IsFilePath };
+	}
+	Jobs[program].Result = std::async(std::launch::async, ResolveSources, std::move(stages));
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class ShaderProgram;
+
+/// <summary>
+/// Watches the source files of our shader programs, and rebuilds programs when any file they were built
+/// from (including files pulled in by #include) changes on disk
+///
+/// On Linux files are watched with inotify, on other platforms their write times are polled. Changed files
+/// are re-read and have their includes resolved on worker threads, then the new program is compiled and
+/// linked on the main thread in Poll. A program keeps using its previous binary until the new one links,
+/// so a typo in a shader will only log an error instead of breaking rendering
+/// </summary>
+class ShaderReloader {
+public:
+	/// <summary>
+	/// Running totals for the reloader this session
+	/// </summary>
+	struct Stats {
+		// The number of programs that were rebuilt and swapped in
+		uint32_t Reloaded = 0;
+		// The number of rebuilds that failed, leaving the previous program in place
+		uint32_t Failed = 0;
+	};
+
+	ShaderReloader() = delete;
+
+	/// <summary>
+	/// Enables or disables hot reloading, programs are still tracked while disabled but will not be rebuilt
+	/// </summary>
+	static void SetEnabled(bool enabled);
+	static bool IsEnabled();
+
+	/// <summary>
+	/// Starts watching all of a program's dependencies, or updates them if the program is already watched
+	/// Called by the program whenever it is linked or reloaded
+	/// </summary>
+	/// <param name="program">The program to watch, must call Unwatch before it is destroyed</param>
+	static void Watch(ShaderProgram* program);
+	/// <summary>
+	/// Stops watching a program, any reload that is in flight for it will be discarded
+	/// </summary>
+	/// <param name="program">The program to stop watching</param>
+	static void Unwatch(ShaderProgram* program);
+
+	/// <summary>
+	/// Should be called once per frame on the thread that owns the OpenGL context. Starts reloads for
+	/// programs that depend on changed files, and swaps in any programs that have finished reloading
+	/// </summary>
+	static void Poll();
+
+	/// <summary>
+	/// Stops the file watcher and waits for any in flight reloads, should be called before exit
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Gets the running totals for the reloader
+	/// </summary>
+	static const Stats& GetStats();
+
+private:
+	/// <summary>
+	/// Takes a copy of where each of a program's stages came from, and starts re-reading them on a worker thread
+	/// </summary>
+	static void _StartReload(ShaderProgram* program);
+};
\ No newline at end of file
@@ -40,6 +40,7 @@ void ITexture::Unbind(int slot) {
 void ITexture::Clear(const glm::vec4& color) {
 	if (_rendererId != 0) {
 		glClearTexImage(_rendererId, 0, GL_RGBA, GL_FLOAT, &color.x);
+		_OnContentsChanged();
 	}
 }
 
@@ -62,6 +62,11 @@ protected:
 
 	TextureType _type; // The type for this texture, mainly used for debugging
 
+	/// <summary>
+	/// Called after our contents have been changed on the GPU, ex: by Clear
+	/// </summary>
+	virtual void _OnContentsChanged() {}
+
 // STATIC SECTION
 private:
 	static Limits __limits;
@@ -128,8 +128,8 @@ void Texture1D::_LoadDataFromFile()
 		int width, height, numChannels;
 		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
 
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
+		// Use STBI to load the image, only setting the flip flag for this thread since other threads may be decoding too
+		stbi_set_flip_vertically_on_load_thread(true);
 		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
 
 		// If we could not load any data, warn and return null
@@ -1,9 +1,11 @@
 #include "Texture2D.h"
+#include <filesystem>
 #include <stb_image.h>
 #include <Logging.h>
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Utils/BlobStore.h"
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -15,6 +17,70 @@ inline int CalcRequiredMipLevels(int width, int height) {
 	return (1 + floor(log2(glm::max(width, height))));
 }
 
+/// <summary>
+/// The pixels of an image that was decoded by STBI, along with any mip levels we generated for it
+/// </summary>
+struct Texture2D::DecodedImage {
+	int      Width       = 0;
+	int      Height      = 0;
+	int      NumChannels = 0;
+	uint8_t* Data        = nullptr;
+	// Levels 1 and up, empty if the driver is generating our mip maps
+	std::vector<MipGenerator::Level> Mips;
+	// The block compressed image and mip chain, if this is set Data and Mips are not used
+	TextureCompressor::CompressedImage Compressed;
+	// A copy of the texture's description from when the load was queued, so the worker never reads
+	// the texture's own description while the main thread may be changing it
+	Texture2DDescription Description;
+
+	~DecodedImage() {
+		if (Data != nullptr) {
+			stbi_image_free(Data);
+		}
+	}
+};
+
+// Bump this whenever the encoders or the layout of the compressed cache change, so that old caches get rebuilt
+static const uint32_t COMPRESSED_CACHE_VERSION = 1;
+
+/// <summary>
+/// Returns true if the wrap mode repeats the texture, so that filters should wrap around the edges
+/// </summary>
+static bool IsRepeating(WrapMode mode) {
+	return mode == WrapMode::Repeat || mode == WrapMode::MirroredRepeat;
+}
+
+/// <summary>
+/// Packs every setting that affects the contents of a texture's compressed cache into a single value,
+/// if any of these change the cache needs to be rebuilt
+/// </summary>
+static uint32_t GetCompressedCacheKey(const Texture2DDescription& descr, MipFilter mipFilter, int targetChannels) {
+	uint32_t result = COMPRESSED_CACHE_VERSION << 24;
+	result |= static_cast<uint32_t>(*descr.Compression) & 0xF;
+	result |= (descr.GenerateMipMaps ? static_cast<uint32_t>(*mipFilter) + 1 : 0) << 4;
+	result |= static_cast<uint32_t>(targetChannels) << 8;
+	result |= (descr.IsSrgb ? 1 : 0) << 12;
+	result |= (IsRepeating(descr.HorizontalWrap) ? 1 : 0) << 13;
+	result |= (IsRepeating(descr.VerticalWrap) ? 1 : 0) << 14;
+	return result;
+}
+
+/// <summary>
+/// Gets the OpenGL format for a block compressed format
+/// </summary>
+static InternalFormat GetInternalFormatForCompression(TextureCompression format, bool isSrgb) {
+	switch (format) {
+		case TextureCompression::BC1: return isSrgb ? InternalFormat::BC1_SRGB : InternalFormat::BC1;
+		case TextureCompression::BC3: return isSrgb ? InternalFormat::BC3_SRGB : InternalFormat::BC3;
+		case TextureCompression::BC4: return InternalFormat::BC4;
+		case TextureCompression::BC5: return InternalFormat::BC5;
+		case TextureCompression::BC7: return isSrgb ? InternalFormat::BC7_SRGB : InternalFormat::BC7;
+		default:
+			LOG_WARN("No internal format for compression {}", ~format);
+			return InternalFormat::Unknown;
+	}
+}
+
 nlohmann::json Texture2D::ToJson() const {
 	nlohmann::json result = {
 		{ "wrap_s",  ~_description.HorizontalWrap },
@@ -23,6 +89,9 @@ nlohmann::json Texture2D::ToJson() const {
 		{ "filter_mag",       ~_description.MagnificationFilter },
 		{ "anisotropic",       _description.MaxAnisotropic },
 		{ "generate_mipmaps",  _description.GenerateMipMaps },
+		{ "mip_filter",       ~_description.MipMapFilter },
+		{ "srgb",              _description.IsSrgb },
+		{ "compression",      ~_description.Compression },
 	};
 
 	if (!_description.Filename.empty()) {
@@ -30,42 +99,85 @@ nlohmann::json Texture2D::ToJson() const {
 	}
 	else if (_pixelType != PixelType::Unknown) {
 		result["size_x"] = _description.Width;
-		result["size_y"] = _description.Width;
+		result["size_y"] = _description.Height;
 
+		result["internal_format"] = ~_description.Format;
 		result["format"] = ~_description.FormatHint;
 		result["pixel_type"] = ~_pixelType;
+
+		// Pixels are stored in a sidecar blob, and we only read them back from the GPU if they've changed since the last save.
+		// Render targets could have been drawn to since then, so they are always read back
 		if (_description.Width * _description.Height > 0 && _description.FormatHint != PixelFormat::Unknown) {
-			size_t dataSize = GetTexelSize(_description.FormatHint, _pixelType) * _description.Width * _description.Height;
-			uint8_t* dataStore = new uint8_t[dataSize];
-			glGetTextureImage(_rendererId, 0, *_description.Format, *_pixelType, dataSize, dataStore);
-			result["data"] = Base64::Encode(dataStore, dataSize);
+			if (_isRenderTarget || !BlobStore::Contains(_blobReference)) {
+				size_t dataSize = GetTexelSize(_description.FormatHint, _pixelType) * _description.Width * _description.Height;
+				std::vector<uint8_t> dataStore(dataSize);
+				glPixelStorei(GL_PACK_ALIGNMENT, 1);
+				glGetTextureImage(_rendererId, 0, *_description.FormatHint, *_pixelType, (GLsizei)dataSize, dataStore.data());
+				_blobReference = BlobStore::Write(dataStore.data(), dataSize);
+			}
+			result["blob"] = _blobReference;
 		}
 	}
 
 	return result;
 }
 
-Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
-{
+/// <summary>
+/// Reads the sampling parameters and filename of a texture from it's JSON representation
+/// </summary>
+static Texture2DDescription ParseDescription(const nlohmann::json& data) {
 	Texture2DDescription descr = Texture2DDescription();
-	descr.Filename = data["filename"];
+	descr.Filename = JsonGet<std::string>(data, "filename", "");
+	// Generated textures store their size and format instead of a filename
+	descr.Width      = JsonGet(data, "size_x", 0u);
+	descr.Height     = JsonGet(data, "size_y", 0u);
+	descr.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::RGBA);
+	descr.Format     = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::Unknown);
+	if (descr.Format == InternalFormat::Unknown && descr.Width * descr.Height > 0) {
+		descr.Format = GetInternalFormatForChannels8(GetTexelComponentCount(descr.FormatHint));
+	}
 	descr.HorizontalWrap = JsonParseEnum(WrapMode, data, "wrap_s", WrapMode::ClampToEdge);
 	descr.VerticalWrap   = JsonParseEnum(WrapMode, data, "wrap_t", WrapMode::ClampToEdge);
 	descr.MinificationFilter  = JsonParseEnum(MinFilter, data, "filter_min", MinFilter::NearestMipNearest);
 	descr.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	descr.MaxAnisotropic      = JsonGet(data, "anisotropic", 0.0f);
 	descr.GenerateMipMaps     = JsonGet(data, "generate_mipmaps", false);
+	descr.MipMapFilter        = JsonParseEnum(MipFilter, data, "mip_filter", MipFilter::Box);
+	descr.IsSrgb              = JsonGet(data, "srgb", false);
+	descr.Compression         = JsonParseEnum(TextureCompression, data, "compression", TextureCompression::None);
+	return descr;
+}
+
+Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
+{
+	Texture2DDescription descr = ParseDescription(data);
 
 	Texture2D::Sptr result = std::make_shared<Texture2D>(descr);
 
-	// If we embedded data into the JSON, load it now
-	if (descr.Filename.empty() && data.contains("data") && data["data"].is_string()) {
-		PixelType type = JsonParseEnum(PixelType, data, "pixel_type", PixelType::Unknown);
+	if (!descr.Filename.empty() || descr.Width * descr.Height == 0) {
+		return result;
+	}
+
+	// Generated textures keep their pixels in a sidecar blob, which we can map and hand straight to OpenGL
+	PixelType type = JsonParseEnum(PixelType, data, "pixel_type", PixelType::Unknown);
+	if (data.contains("blob")) {
+		MemoryMappedFile::Sptr blob = BlobStore::Open(data["blob"]);
+		const size_t expectedSize = GetTexelSize(descr.FormatHint, type) * descr.Width * descr.Height;
+		if (blob != nullptr && blob->GetSize() == expectedSize) {
+			result->LoadData(descr.Width, descr.Height, descr.FormatHint, type, const_cast<uint8_t*>(blob->GetData()));
+			// Our contents match the blob, so saving again won't need to read them back
+			result->_blobReference = data["blob"];
+		} else {
+			LOG_WARN("Texture blob is missing or the wrong size, expected {} bytes", expectedSize);
+		}
+	}
+	// Older manifests embedded the pixels as Base64
+	else if (data.contains("data") && data["data"].is_string()) {
 		try {
-			std::string rawData = Base64::Decode(data['data'].get<std::string>());
+			std::string rawData = Base64::Decode(data["data"].get<std::string>());
 			result->LoadData(descr.Width, descr.Height, descr.FormatHint, type, rawData.data());
 		}
-		catch (std::runtime_error()) {
+		catch (const std::runtime_error&) {
 			LOG_WARN("JSON blob had data, but failed to load to texture");
 		}
 	}
@@ -73,10 +185,61 @@ Texture2D::Sptr Texture2D::FromJson(const nlohmann::json& data)
 	return result;
 }
 
+Texture2D::Sptr Texture2D::FromJsonAsync(const nlohmann::json& data) {
+	Texture2DDescription descr = ParseDescription(data);
+
+	// Generated textures have nothing to decode
+	if (descr.Filename.empty()) {
+		return FromJson(data);
+	}
+
+	// Create the texture without a filename so it doesn't load right away
+	std::string filename = descr.Filename;
+	descr.Filename = "";
+	Texture2D::Sptr result = std::make_shared<Texture2D>(descr);
+	result->_description.Filename = filename;
+
+	// The worker decodes from a snapshot of our description, taken here on the main thread
+	result->_decoded = std::make_unique<DecodedImage>();
+	result->_decoded->Description = result->_description;
+
+	// Give the placeholder a single white texel, our description stays empty until the real image arrives
+	const uint8_t white[4] = { 255, 255, 255, 255 };
+	glTextureStorage2D(result->_rendererId, 1, GL_RGBA8, 1, 1);
+	glTextureSubImage2D(result->_rendererId, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, white);
+
+	return result;
+}
+
+bool Texture2D::DecodeAsync() {
+	if (_decoded == nullptr) {
+		return false;
+	}
+	return _DecodeFile(_decoded->Description, *_decoded);
+}
+
+void Texture2D::FinishAsyncLoad() {
+	if (_decoded == nullptr) {
+		return;
+	}
+
+	// Texture storage can't be resized, so we need a fresh texture object to replace the placeholder
+	glDeleteTextures(1, &_rendererId);
+	_rendererId = 0;
+	_Recreate();
+
+	_UploadImage(*_decoded);
+	_decoded = nullptr;
+
+	SetDebugName(_description.Filename);
+}
+
 Texture2D::Texture2D(const Texture2DDescription& description) : 
 	ITexture(TextureType::_2D),
 	_description(description),
-	_pixelType(PixelType::Unknown)
+	_pixelType(PixelType::Unknown),
+	_blobReference(nullptr),
+	_isRenderTarget(false)
 {
 	_SetTextureParams();
 	if (!description.Filename.empty()) {
@@ -87,13 +250,17 @@ Texture2D::Texture2D(const Texture2DDescription& description) :
 Texture2D::Texture2D(const std::string& filePath) : 
 	ITexture(TextureType::_2D),
 	_description(Texture2DDescription()),
-	_pixelType(PixelType::Unknown)
+	_pixelType(PixelType::Unknown),
+	_blobReference(nullptr),
+	_isRenderTarget(false)
 {
 	_description.Filename = filePath;
 	_SetTextureParams();
 	_LoadDataFromFile();
 }
 
+Texture2D::~Texture2D() = default;
+
 void Texture2D::SetMinFilter(MinFilter value) {
 	if (_description.MultisampleCount == 1) {
 		_description.MinificationFilter = value;
@@ -118,7 +285,8 @@ void Texture2D::SetAnisoLevel(float value) {
 		_description.MaxAnisotropic = glm::clamp(value, 1.0f, ITexture::GetLimits().MAX_ANISOTROPY);
 		glTextureParameterf(_rendererId, GL_TEXTURE_MAX_ANISOTROPY, _description.MaxAnisotropic);
 
-		if (_description.GenerateMipMaps) {
+		// Mip chains we built on the CPU are already filtered, regenerating them would throw them away
+		if (_description.GenerateMipMaps && _description.MipMapFilter == MipFilter::Driver && _description.Compression == TextureCompression::None) {
 			glGenerateTextureMipmap(_rendererId);
 		}
 	}
@@ -131,6 +299,7 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 
 	_description.FormatHint = format;
 	_pixelType = type;
+	_blobReference = nullptr;
 
 	// Align the data store to the size of a single component to ensure we don't get weirdness with images that aren't RGBA
 	// See https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glPixelStore.xhtml
@@ -146,57 +315,170 @@ void Texture2D::LoadData(uint32_t width, uint32_t height, PixelFormat format, Pi
 	}
 }
 
+void Texture2D::BindImage(int unit, ImageAccess access, int level) {
+	if (access != ImageAccess::ReadOnly) {
+		MarkAsRenderTarget();
+	}
+	glBindImageTexture(unit, _rendererId, level, GL_FALSE, 0, *access, *_description.Format);
+}
+
+void Texture2D::MarkAsRenderTarget() {
+	_isRenderTarget = true;
+	_blobReference = nullptr;
+}
+
+void Texture2D::_OnContentsChanged() {
+	_blobReference = nullptr;
+}
+
 void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
 	if (!_description.Filename.empty()) {
-		// Variables that will store properties about our image
-		int width, height, numChannels;
-		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
-
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
-
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			LOG_WARN("STBI Failed to load image from \"{}\"", _description.Filename);
-			return ;
+		DecodedImage image;
+		if (!_DecodeFile(_description, image)) {
+			return;
 		}
+		_UploadImage(image);
+	}
+	
+	SetDebugName(_description.Filename);
+}
 
-		// We should estimate a good format for our data
+bool Texture2D::_DecodeFile(const Texture2DDescription& description, DecodedImage& image) {
+	const int targetChannels = GetTexelComponentCount(description.FormatHint);
+
+	// The driver can't generate mips for compressed textures, so those always build their chain here
+	const bool compress = description.Compression != TextureCompression::None && description.MultisampleCount == 1;
+	const MipFilter mipFilter = compress && description.MipMapFilter == MipFilter::Driver ? MipFilter::Box : description.MipMapFilter;
+	const uint32_t cacheKey = GetCompressedCacheKey(description, mipFilter, targetChannels);
+	const std::string cachePath = description.Filename + ".dds";
+
+	// Use the compressed cache if it was built with the same settings and is newer than the source file. We
+	// also accept the cache if the source file is missing, so that only the caches need to be shipped
+	if (compress) {
+		std::error_code sourceError, cacheError;
+		auto sourceTime = std::filesystem::last_write_time(description.Filename, sourceError);
+		auto cacheTime  = std::filesystem::last_write_time(cachePath, cacheError);
+		if (!cacheError && (sourceError || cacheTime >= sourceTime) &&
+			TextureCompressor::LoadCachedDds(cachePath, cacheKey, image.Compressed)) {
+			image.Width  = image.Compressed.Levels[0].Width;
+			image.Height = image.Compressed.Levels[0].Height;
+			return true;
+		}
+		image.Compressed = TextureCompressor::CompressedImage();
+	}
 
-		// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
-		if (targetChannels != 0)
-			numChannels = targetChannels;
+	// Use STBI to load the image. Async loads decode on pool workers, so we set the flip flag for this
+	// thread only instead of touching the process wide one
+	stbi_set_flip_vertically_on_load_thread(true);
+	image.Data = stbi_load(description.Filename.c_str(), &image.Width, &image.Height, &image.NumChannels, targetChannels);
 
-		// We'll determine a recommended format for the image based on number of channels
-		// We hinted that we wanted a certain number of channels, but we're not guaranteed
-		// that all those channels exist (ex: loading an RGB image but requesting RGBA)
-		InternalFormat internal_format = GetInternalFormatForChannels8(numChannels);
-		PixelFormat    image_format = GetPixelFormatForChannels(numChannels);
+	// If we could not load any data, warn and return null
+	if (image.Data == nullptr) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", description.Filename);
+		return false;
+	}
+
+	// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
+	if (targetChannels != 0)
+		image.NumChannels = targetChannels;
+
+	// Build the mip chain here instead of on the GPU, so that async loads do the work on a worker thread
+	// There are no 1 or 2 channel sRGB formats, so those are always stored (and filtered) as linear
+	const bool isSrgb = description.IsSrgb && image.NumChannels >= 3;
+	if (description.GenerateMipMaps && description.MultisampleCount == 1 && mipFilter != MipFilter::Driver) {
+		MipGenerator::Options options;
+		options.Filter = mipFilter;
+		options.IsSrgb = isSrgb;
+		options.WrapX  = IsRepeating(description.HorizontalWrap);
+		options.WrapY  = IsRepeating(description.VerticalWrap);
+		image.Mips = MipGenerator::Generate(image.Data, image.Width, image.Height, image.NumChannels, options);
+	}
 
-		// This is one of those poorly documented things in OpenGL
-		if ((numChannels * width) % 4 != 0) {
-			LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
+	if (compress) {
+		TextureCompressor::CompressedImage& compressed = image.Compressed;
+		compressed.Format = TextureCompressor::ResolveFormat(description.Compression, image.NumChannels);
+		compressed.IsSrgb = isSrgb && compressed.Format != TextureCompression::BC4 && compressed.Format != TextureCompression::BC5;
+		compressed.SettingsKey = cacheKey;
+		compressed.Levels.push_back({ (uint32_t)image.Width, (uint32_t)image.Height, TextureCompressor::Compress(compressed.Format, image.Data, image.Width, image.Height, image.NumChannels) });
+		for (const MipGenerator::Level& level : image.Mips) {
+			compressed.Levels.push_back({ level.Width, level.Height, TextureCompressor::Compress(compressed.Format, level.Data.data(), level.Width, level.Height, image.NumChannels) });
 		}
 
-		// Update our description to match what we loaded
-		_description.Format = internal_format;
-		_description.Width = width;
-		_description.Height = height;
+		// If this fails we'll just encode the image again next time
+		if (TextureCompressor::SaveDds(cachePath, compressed)) {
+			LOG_INFO("Wrote compressed texture cache \"{}\"", cachePath);
+		}
+
+		// We don't need the uncompressed pixels anymore
+		stbi_image_free(image.Data);
+		image.Data = nullptr;
+		image.Mips.clear();
+	}
 
-		// Allocates our memory
+	return true;
+}
+
+void Texture2D::_UploadImage(const DecodedImage& image) {
+	// Block compressed images already have their whole mip chain, so we can upload them as-is
+	if (!image.Compressed.Levels.empty()) {
+		_description.Format = GetInternalFormatForCompression(image.Compressed.Format, image.Compressed.IsSrgb);
+		_description.Width  = image.Width;
+		_description.Height = image.Height;
 		_SetTextureParams();
 
-		// Upload data to our texture
-		LoadData(width, height, image_format, PixelType::UByte, data);
+		const size_t numLevels = _description.GenerateMipMaps ? image.Compressed.Levels.size() : 1;
+		for (size_t ix = 0; ix < numLevels; ix++) {
+			const MipGenerator::Level& level = image.Compressed.Levels[ix];
+			glCompressedTextureSubImage2D(_rendererId, (GLint)ix, 0, 0, level.Width, level.Height, *_description.Format, (GLsizei)level.Data.size(), level.Data.data());
+		}
+		return;
+	}
 
-		// We now have data in the image, we can clear the STBI data
-		stbi_image_free(data);
+	// We'll determine a recommended format for the image based on number of channels
+	// We hinted that we wanted a certain number of channels, but we're not guaranteed
+	// that all those channels exist (ex: loading an RGB image but requesting RGBA)
+	InternalFormat internal_format = GetInternalFormatForChannels8(image.NumChannels);
+	PixelFormat    image_format = GetPixelFormatForChannels(image.NumChannels);
+
+	// sRGB formats let the hardware convert back to linear when sampling
+	if (_description.IsSrgb && image.NumChannels == 3) {
+		internal_format = InternalFormat::SRGB;
+	} else if (_description.IsSrgb && image.NumChannels == 4) {
+		internal_format = InternalFormat::SRGBA;
 	}
-	
-	SetDebugName(_description.Filename);
+
+	// This is one of those poorly documented things in OpenGL
+	if ((image.NumChannels * image.Width) % 4 != 0) {
+		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
+	}
+
+	// Update our description to match what we loaded
+	_description.Format = internal_format;
+	_description.Width = image.Width;
+	_description.Height = image.Height;
+
+	// Allocates our memory
+	_SetTextureParams();
+
+	// Without CPU mips we can just let LoadData upload and have the driver build the chain
+	if (image.Mips.empty()) {
+		LoadData(image.Width, image.Height, image_format, PixelType::UByte, image.Data);
+		return;
+	}
+
+	_description.FormatHint = image_format;
+	_pixelType = PixelType::UByte;
+
+	// Smaller mip levels will rarely have rows that are a multiple of 4 bytes, so we upload everything tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTextureSubImage2D(_rendererId, 0, 0, 0, image.Width, image.Height, *image_format, *PixelType::UByte, image.Data);
+	for (size_t ix = 0; ix < image.Mips.size(); ix++) {
+		const MipGenerator::Level& level = image.Mips[ix];
+		glTextureSubImage2D(_rendererId, (GLint)ix + 1, 0, 0, level.Width, level.Height, *image_format, *PixelType::UByte, level.Data.data());
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 }
 
 void Texture2D::_SetTextureParams() {
@@ -1,5 +1,7 @@
 #pragma once
 #include "ITexture.h"
+#include "Utils/MipGenerator.h"
+#include "Utils/TextureCompressor.h"
 
 /// <summary>
 /// Describes all parameters we can manipulate with our 2D Textures
@@ -43,6 +45,22 @@ struct Texture2DDescription {
 	/// </summary>
 	bool           GenerateMipMaps;
 	/// <summary>
+	/// The filter to use when generating mip maps for images loaded from files. Anything other than
+	/// Driver builds the mip chain on the CPU while the image is decoded, default Box
+	/// </summary>
+	MipFilter      MipMapFilter;
+	/// <summary>
+	/// True if the color channels of the image file are sRGB encoded. 3 and 4 channel images will
+	/// be stored in an sRGB format, and mip maps will be filtered in linear space, default false
+	/// </summary>
+	bool           IsSrgb;
+	/// <summary>
+	/// The block compressed format to store images loaded from files in, default None. Compressed
+	/// images are cached with their mip chain in a DDS file next to the source file, and are only
+	/// re-encoded when the source file is newer or the settings change
+	/// </summary>
+	TextureCompression Compression;
+	/// <summary>
 	/// Returns the number of samples if the texture is multisampled, default 1
 	/// </summary>
 	uint8_t        MultisampleCount;
@@ -69,6 +87,9 @@ struct Texture2DDescription {
 		MagnificationFilter(MagFilter::Linear),
 		MaxAnisotropic(-1.0f), // max aniso by default
 		GenerateMipMaps(true),
+		MipMapFilter(MipFilter::Box),
+		IsSrgb(false),
+		Compression(TextureCompression::None),
 		MultisampleCount(1),
 		Filename(""),
 		FormatHint(PixelFormat::RGBA)
@@ -80,7 +101,7 @@ public:
 	DEFINE_RESOURCE(Texture2D)
 
 	// Make sure we mark our destructor as virtual so base class is called
-	virtual ~Texture2D() = default;
+	virtual ~Texture2D();
 
 public:
 	Texture2D(const std::string& filePath);
@@ -124,6 +145,8 @@ public:
 	/// <summary>
 	/// Loads a region of data into this texture
 	/// Bounds must be contained by the bounds of the texture
+	/// If the texture generates mip maps they are rebuilt by the driver, regardless of MipMapFilter
+	/// Cannot be used with block compressed textures
 	/// format and type must be convertible to the texture's internal format
 	/// </summary>
 	/// <param name="width">The width of the data frame, in pixels</param>
@@ -135,6 +158,25 @@ public:
 	/// <param name="offsetY">The y edge of the destination rectangle in the texture, bottom->top</param>
 	void LoadData(uint32_t width, uint32_t height, PixelFormat format, PixelType type, void* data, uint32_t offsetX = 0, uint32_t offsetY = 0);
 
+	/// <summary>
+	/// Binds a level of this texture to an image unit, so that shaders can load from and store to it.
+	/// Binding for writing marks this texture as a render target
+	/// </summary>
+	/// <param name="unit">The image unit to bind to</param>
+	/// <param name="access">How the shader will access the image</param>
+	/// <param name="level">The mip level to bind</param>
+	void BindImage(int unit, ImageAccess access, int level = 0);
+
+	/// <summary>
+	/// Marks this texture as being written to by the GPU, ex: when it is attached to a framebuffer.
+	/// Our pixels can then change without us knowing, so saving always reads them back
+	/// </summary>
+	void MarkAsRenderTarget();
+	/// <summary>
+	/// Gets whether this texture can be written to by the GPU, see MarkAsRenderTarget
+	/// </summary>
+	bool IsRenderTarget() const { return _isRenderTarget; }
+
 	/// <summary>
 	/// Gets this texture's description, which contains basic information about the
 	/// texture's dimensions and creation parameters
@@ -143,21 +185,52 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture2D::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Creates a 1x1 white placeholder texture for ResourceManager::LoadAsync, the image file is
+	/// decoded in DecodeAsync and replaces the placeholder in FinishAsyncLoad
+	/// </summary>
+	static Texture2D::Sptr FromJsonAsync(const nlohmann::json& data);
+
+	virtual bool DecodeAsync() override;
+	virtual void FinishAsyncLoad() override;
 
 protected:
 	Texture2DDescription _description;
 	PixelType _pixelType;
 
+	// The blob that our pixels were last saved to or loaded from, cleared whenever LoadData or Clear change
+	// our contents. Lets ToJson skip reading the texture back from the GPU if nothing has changed. Not used
+	// for render targets, since we can't see when the GPU writes to them
+	mutable nlohmann::json _blobReference;
+	bool _isRenderTarget;
+
+	// Pixels decoded from our file that are waiting to be uploaded, see DecodeAsync. Created by FromJsonAsync
+	// along with a snapshot of our description for the worker to decode with
+	struct DecodedImage;
+	std::unique_ptr<DecodedImage> _decoded;
+
 	/// <summary>
 	/// Loads this texture from the file specified in the description
 	/// Will overwrite description size
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
+	/// Decodes the file specified in a description into memory, does not touch OpenGL or the texture
+	/// Also generates the mip chain if we're not leaving that to the driver, and block
+	/// compresses the image (or loads it from the compressed cache) if requested
+	/// </summary>
+	static bool _DecodeFile(const Texture2DDescription& description, DecodedImage& image);
+	/// <summary>
+	/// Allocates our storage to match a decoded image and uploads it's pixels and mip levels
+	/// </summary>
+	void _UploadImage(const DecodedImage& image);
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
 
+	virtual void _OnContentsChanged() override;
+
 public:
 	static Texture2D::Sptr LoadFromFile(const std::string& path, const Texture2DDescription& description = Texture2DDescription(), bool forceRgba = true);
 };
@@ -32,6 +32,8 @@ Texture3D::Texture3D(const Texture3DDescription& description) :
 	}
 }
 
+Texture3D::~Texture3D() = default;
+
 void Texture3D::SetMinFilter(MinFilter value)
 {
 	_description.MinificationFilter = value;
@@ -74,6 +76,7 @@ nlohmann::json Texture3D::ToJson() const
 		{ "filter_min",       ~_description.MinificationFilter },
 		{ "filter_mag",       ~_description.MagnificationFilter },
 		{ "generate_mipmaps",  _description.GenerateMipMaps },
+		{ "internal_format",  ~_description.Format },
 	};
 
 	if (!_description.Filename.empty()) {
@@ -97,8 +100,10 @@ nlohmann::json Texture3D::ToJson() const
 	return result;
 }
 
-Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
-{
+/// <summary>
+/// Reads the size, sampling parameters and filename of a texture from it's JSON representation
+/// </summary>
+static Texture3DDescription ParseDescription(const nlohmann::json& data) {
 	Texture3DDescription description = Texture3DDescription();
 	description.Filename = JsonGet<std::string>(data, "filename", "");
 
@@ -114,6 +119,13 @@ Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
 	description.MagnificationFilter = JsonParseEnum(MagFilter, data, "filter_mag", MagFilter::Linear);
 	description.GenerateMipMaps = JsonGet(data, "generate_mipmaps", false);
 	description.FormatHint = JsonParseEnum(PixelFormat, data, "format", PixelFormat::Unknown);
+	description.Format = JsonParseEnum(InternalFormat, data, "internal_format", InternalFormat::Unknown);
+	return description;
+}
+
+Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
+{
+	Texture3DDescription description = ParseDescription(data);
 
 	Texture3D::Sptr result = std::make_shared<Texture3D>(description);
 
@@ -132,6 +144,66 @@ Texture3D::Sptr Texture3D::FromJson(const nlohmann::json& data)
 	return result;
 }
 
+Texture3D::Sptr Texture3D::FromJsonAsync(const nlohmann::json& data)
+{
+	Texture3DDescription description = ParseDescription(data);
+
+	// Generated textures have nothing to decode
+	if (description.Filename.empty()) {
+		return FromJson(data);
+	}
+
+	// The placeholder is a 2x2x2 identity LUT, so anything graded with it looks ungraded instead of broken
+	Texture3DDescription placeholder = description;
+	placeholder.Filename = "";
+	placeholder.Width = placeholder.Height = placeholder.Depth = 2;
+	placeholder.Format = InternalFormat::RGB8;
+	placeholder.WrapS = placeholder.WrapT = placeholder.WrapR = WrapMode::ClampToEdge;
+	placeholder.GenerateMipMaps = false;
+	Texture3D::Sptr result = std::make_shared<Texture3D>(placeholder);
+
+	glm::u8vec3 identity[8];
+	for (int ix = 0; ix < 8; ix++) {
+		// Red changes fastest, then green, then blue
+		identity[ix] = glm::u8vec3((ix & 1) * 255, ((ix >> 1) & 1) * 255, ((ix >> 2) & 1) * 255);
+	}
+	result->LoadData(2, 2, 2, PixelFormat::RGB, PixelType::UByte, identity);
+
+	// Our description stays empty until the real LUT arrives
+	result->_description = description;
+	result->_pixelType = PixelType::Unknown;
+	return result;
+}
+
+bool Texture3D::DecodeAsync()
+{
+	std::string extension = std::filesystem::path(_description.Filename).extension().string();
+	StringTools::ToLower(extension);
+	if (extension.compare(".cube") != 0) {
+		LOG_WARN("Cannot load 3D texture from \"{}\"", _description.Filename);
+		return false;
+	}
+
+	// We're already on a worker, so the parse stays on this thread
+	_decoded = std::make_unique<CubeLutParser::Lut>();
+	return _ParseCubeFile(*_decoded, 1);
+}
+
+void Texture3D::FinishAsyncLoad()
+{
+	if (_decoded == nullptr) {
+		return;
+	}
+
+	// Texture storage can't be resized, so we need a fresh texture object to replace the placeholder
+	glDeleteTextures(1, &_rendererId);
+	_rendererId = 0;
+	_Recreate();
+
+	_UploadCubeLut(*_decoded);
+	_decoded = nullptr;
+}
+
 void Texture3D::_LoadDataFromFile()
 {
 	LOG_ASSERT(_description.Width + _description.Height + _description.Depth == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
@@ -149,121 +221,58 @@ void Texture3D::_LoadDataFromFile()
 
 void Texture3D::_LoadCubeFile()
 {
-	std::ifstream inFile(_description.Filename);
-
-	if (!inFile.is_open()) {
-		LOG_WARN("Failed to open file .cube file: {}", _description.Filename);
-		return;
+	CubeLutParser::Lut lut;
+	if (_ParseCubeFile(lut, 0)) {
+		_UploadCubeLut(lut);
 	}
+}
 
-	glm::u8vec3* textureData = nullptr;
-	uint32_t lutSize{ 0 };
-	uint32_t ix{ 0 };
-	glm::vec3 rgb { 0, 0, 0 };
-
-	std::string line;
-	// Iterate as long as we have lines from the file
-	while (std::getline(inFile, line)) {
-
-		// Trim whitespace from start and end of the line
-		StringTools::Trim(line);
-
-		// Skip empty lines
-		if (line.empty()) {
-			continue;
-		}
-
-		// Skip comments
-		else if (line[0] == '#') {
-			continue;
-		}
-
-		// Handle sizing the LUT
-		else if (line.find("LUT_3D_SIZE") != std::string::npos) {
-
-			// Skip over the LUT_3D_SIZE text and read in the value
-			std::stringstream lReader(line.substr(12));
-			lReader >> lutSize;
-
-			// Update the description's size
-			_description.Width = _description.Height = _description.Depth = lutSize;
-
-			// If the size we read is non-zero, allocate our data!
-			if (lutSize > 0) {
-				// If we had data already, delete it
-				if (textureData != nullptr) {
-					delete[] textureData;
-				} 
-
-				// Allocate data to store texels in
-				textureData = new glm::u8vec3[(size_t)lutSize * lutSize * lutSize];
-				ix = 0;
-			}
-		}
-
-		// We'll grab the title for our debug name, nice lil use of it
-		else if (line.find("TITLE") != std::string::npos) {
-
-			// Skip over the TITLE token and the space after it
-			std::string name = line.substr(6);
-
-			// Trim any excess whitespace
-			StringTools::Trim(name);
-
-			// We'll store this in the debug name
-			SetDebugName(name);
-		}
-
-		else if (line.find("DOMAIN_MIN") != std::string::npos)
-		{ /* ignore for now */ }
-
-		else if (line.find("DOMAIN_MAX") != std::string::npos)
-		{ /* ignore for now */ }
-
-		else if (line.find("LUT_1D_SIZE") != std::string::npos)
-		{ /* ignore for now */ }
-
-		// Reading data lines
-		else if (!line.empty() && textureData != nullptr) {
-
-			// Make sure we don't case a write access violation
-			if (ix >= (lutSize * lutSize * lutSize) && lutSize > 0) {
-				LOG_ASSERT(false, "Attempting to write outside the bounds of the LUT");
-			}
-
-			// Read RGB from the line
-			std::stringstream lReader(line);
-			lReader >> rgb.r >> rgb.g >> rgb.b;
+bool Texture3D::_ParseCubeFile(CubeLutParser::Lut& lut, uint32_t threadCount) const
+{
+	const std::string cachePath = _description.Filename + CubeLutParser::CACHE_EXTENSION;
+
+	// Use the cache if it's newer than the source file. We also accept the cache if the source file is
+	// missing, so that only the caches need to be shipped
+	std::error_code sourceError, cacheError;
+	auto sourceTime = std::filesystem::last_write_time(_description.Filename, sourceError);
+	auto cacheTime  = std::filesystem::last_write_time(cachePath, cacheError);
+	if (!cacheError && (sourceError || cacheTime >= sourceTime) && CubeLutParser::LoadCache(cachePath, lut)) {
+		CubeLutParser::RemapToUnitDomain(lut);
+		return true;
+	}
 
-			rgb = glm::clamp(rgb, glm::vec3(0), glm::vec3(1));
+	if (!CubeLutParser::ParseFile(_description.Filename, lut, threadCount)) {
+		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
+		return false;
+	}
+	if (CubeLutParser::SaveCache(cachePath, lut)) {
+		LOG_INFO("Wrote LUT cache \"{}\"", cachePath);
+	}
 
-			// Store in the array, converting to the correct scale for bytes
-			textureData[ix].r = static_cast<uint8_t>(rgb.r * 255);
-			textureData[ix].g = static_cast<uint8_t>(rgb.g * 255);
-			textureData[ix].b = static_cast<uint8_t>(rgb.b * 255);
+	// Our shaders sample the LUT with colors directly, so it needs to cover the 0-1 range
+	CubeLutParser::RemapToUnitDomain(lut);
+	return true;
+}
 
-			// Move to the next texel
-			ix++;
-		}
-	} 
+void Texture3D::_UploadCubeLut(const CubeLutParser::Lut& lut)
+{
+	if (!lut.Title.empty()) {
+		SetDebugName(lut.Title);
+	}
 
-	if (textureData != nullptr) {
-		// Set the pixel format
+	// Update the description's size
+	_description.Width = _description.Height = _description.Depth = lut.Size;
+	// Keep the precision of the LUT if a float format was requested, otherwise OpenGL quantizes it to bytes for us
+	if (_description.Format != InternalFormat::RGB16F && _description.Format != InternalFormat::RGB32F) {
 		_description.Format = InternalFormat::RGB8;
-		// We need to clamp to edge for LUTS
-		_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
-
-		// Allocate data and configure params
-		_SetTextureParams();
-		// Load data
-		LoadData(lutSize, lutSize, lutSize, PixelFormat::RGB, PixelType::UByte, textureData);
-
-		// Clean up after ourselves
-		delete[] textureData;
-	}
-	else {
-		LOG_WARN("Failed to load cube file: \"{}\"", _description.Filename);
 	}
+	// We need to clamp to edge for LUTS
+	_description.WrapS = _description.WrapT = _description.WrapR = WrapMode::ClampToEdge;
+
+	// Allocate data and configure params
+	_SetTextureParams();
+	// Load data
+	LoadData(lut.Size, lut.Size, lut.Size, PixelFormat::RGB, PixelType::Float, const_cast<glm::vec3*>(lut.Data.data()));
 }
 
 void Texture3D::_SetTextureParams()
@@ -1,5 +1,6 @@
 #pragma once
 #include "ITexture.h"
+#include "Utils/CubeLutParser.h"
 
 /// <summary>
 /// Describes all parameters we can manipulate with our 2D Textures
@@ -18,7 +19,9 @@ struct Texture3DDescription {
 	/// </summary>
 	uint32_t       Depth;
 	/// <summary>
-	/// The internal format that OpenGL should use when storing this texture
+	/// The internal format that OpenGL should use when storing this texture. LUTs loaded from
+	/// .cube files are stored as RGB8 unless this is RGB16F or RGB32F, which avoid the banding
+	/// that 8 bits can cause in smooth gradients
 	/// </summary>
 	InternalFormat Format;
 	/// <summary>
@@ -78,7 +81,7 @@ public:
 	DEFINE_RESOURCE(Texture3D)
 
 		// Make sure we mark our destructor as virtual so base class is called
-		virtual ~Texture3D() = default;
+		virtual ~Texture3D();
 
 public:
 	Texture3D(const std::string& filePath);
@@ -145,11 +148,22 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static Texture3D::Sptr FromJson(const nlohmann::json& data);
+	/// <summary>
+	/// Creates an identity LUT placeholder for ResourceManager::LoadAsync, the file is parsed in
+	/// DecodeAsync and replaces the placeholder in FinishAsyncLoad
+	/// </summary>
+	static Texture3D::Sptr FromJsonAsync(const nlohmann::json& data);
+
+	virtual bool DecodeAsync() override;
+	virtual void FinishAsyncLoad() override;
 
 protected:
 	Texture3DDescription _description;
 	PixelType _pixelType;
 
+	// A LUT parsed from our file that is waiting to be uploaded, see DecodeAsync
+	std::unique_ptr<CubeLutParser::Lut> _decoded;
+
 	/// <summary>
 	/// Loads this texture from the file specified in the description
 	/// Will overwrite description size
@@ -160,6 +174,17 @@ protected:
 	/// </summary>
 	void _LoadCubeFile();
 	/// <summary>
+	/// Parses the .cube file specified in the description into memory, does not touch OpenGL. Parsed
+	/// LUTs are cached in a binary file next to the source file, which is used until the source changes
+	/// </summary>
+	/// <param name="lut">The LUT to store the parsed data into, remapped to a 0-1 domain</param>
+	/// <param name="threadCount">The maximum number of threads to parse with, or 0 to use all hardware threads</param>
+	bool _ParseCubeFile(CubeLutParser::Lut& lut, uint32_t threadCount) const;
+	/// <summary>
+	/// Allocates our storage to match a parsed LUT and uploads it's texels
+	/// </summary>
+	void _UploadCubeLut(const CubeLutParser::Lut& lut);
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
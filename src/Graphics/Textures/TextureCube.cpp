@@ -115,8 +115,8 @@ void TextureCube::_LoadImages(const std::unordered_map<CubeMapFace, std::string>
 		const std::string& filename = _description.FaceFileNames[face];
 		int fileWidth, fileHeight, fileNumChannels;
 
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
+		// Use STBI to load the image, only setting the flip flag for this thread since other threads may be decoding too
+		stbi_set_flip_vertically_on_load_thread(true);
 		uint8_t* data = stbi_load(filename.c_str(), &fileWidth, &fileHeight, &fileNumChannels, 0);
 
 		// If we could not load any data, warn and return null
@@ -43,7 +43,8 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const
 			_elementCount = _vertexCount;
 		}
 	} 
-	else if (buffer->GetElementCount() != _vertexCount) {
+	// Instanced buffers are indexed by instance rather than by vertex, so their size doesn't need to match
+	else if (!instanced && buffer->GetElementCount() != _vertexCount) {
 		LOG_WARN("Buffer element count does not match vertex count of this VAO!!!");
 	}
 
@@ -77,7 +78,7 @@ void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const
 	});
 
 	if (it != _vertexBuffers.end()) {
-		if (buffer->GetElementCount() != _vertexCount) {
+		if (!binding->Instanced && buffer->GetElementCount() != _vertexCount) {
 			LOG_WARN("Buffer element count does not match vertex count of this VAO!!!");
 		}
 
@@ -103,6 +104,11 @@ void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const
 
 void VertexArrayObject::Draw(DrawMode mode) {
 	Bind();
+	DrawBound(mode);
+	Unbind();
+}
+
+void VertexArrayObject::DrawBound(DrawMode mode) {
 	if (_indexBuffer == nullptr) {
 		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
 		glDrawArrays((GLenum)mode, 0, elements);
@@ -110,7 +116,6 @@ void VertexArrayObject::Draw(DrawMode mode) {
 		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
 		glDrawElements((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr);
 	}
-	Unbind();
 }
 
 void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*= DrawMode::TriangleList*/)
@@ -128,8 +133,34 @@ void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*=
 	
 }
 
+void VertexArrayObject::DrawInstancedBound(uint32_t instanceCount, uint32_t baseInstance, DrawMode mode)
+{
+	if (_indexBuffer == nullptr) {
+		uint32_t elements = _elementCount == 0 ? _vertexBuffers[0]->Buffer->GetElementCount() : _elementCount;
+		glDrawArraysInstancedBaseInstance((GLenum)mode, 0, elements, instanceCount, baseInstance);
+	}
+	else {
+		uint32_t elements = _elementCount == 0 ? _indexBuffer->GetElementCount() : _elementCount;
+		glDrawElementsInstancedBaseInstance((GLenum)mode, elements, (GLenum)_indexBuffer->GetElementType(), nullptr, instanceCount, baseInstance);
+	}
+}
+
+void VertexArrayObject::SetConstantAttribute(GLuint slot, const glm::vec4& value) {
+	auto it = std::find_if(_constantAttributes.begin(), _constantAttributes.end(), [&](const auto& constant) {
+		return constant.first == slot;
+	});
+	if (it != _constantAttributes.end()) {
+		it->second = value;
+	} else {
+		_constantAttributes.push_back(std::make_pair(slot, value));
+	}
+}
+
 void VertexArrayObject::Bind() {
 	glBindVertexArray(_handle);
+	for (const auto& [slot, value] : _constantAttributes) {
+		glVertexAttrib4fv(slot, &value.x);
+	}
 }
 
 void VertexArrayObject::Unbind() {
@@ -177,6 +208,7 @@ VertexArrayObject::Sptr VertexArrayObject::Clone() const
 	}
 
 	result->SetVDecl(_vDecl);
+	result->_constantAttributes = _constantAttributes;
 
 	return result;
 }
@@ -4,6 +4,7 @@
 #include <vector>
 #include <memory>
 #include <EnumToString.h>
+#include <GLM/glm.hpp>
 
 #include "Graphics/Buffers/VertexBuffer.h"
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -112,6 +113,15 @@ public:
 
 	void ReplaceVertexBuffer(VertexBufferBinding* binding, const VertexBuffer::Sptr& buffer);
 
+	/// <summary>
+	/// Sets a constant value for a vertex attribute that is not fed by any of this VAO's buffers
+	/// (for instance a color that is the same for every vertex). Since constant attribute values are
+	/// context state rather than VAO state, they are re-applied every time this VAO is bound
+	/// </summary>
+	/// <param name="slot">The attribute slot to set the value for</param>
+	/// <param name="value">The value that the vertex shader will receive for every vertex</param>
+	void SetConstantAttribute(GLuint slot, const glm::vec4& value);
+
 	/// <summary>
 	/// Gets the buffer binding that has an attribute with the given usage
 	/// We can use this for extracting info from a VBO at a later time
@@ -119,12 +129,22 @@ public:
 	/// <param name="usage">The attribute usage hint to search for</param>
 	/// <returns>A const pointer to the binding, or nullptr if none is found</returns>
 	VertexBufferBinding* GetBufferBinding(AttribUsage usage);
+	/// <summary>
+	/// Gets all the vertex buffers that are bound to this VAO
+	/// </summary>
+	const std::vector<VertexBufferBinding*>& GetVertexBuffers() const { return _vertexBuffers; }
 
 	/// <summary>
 	/// Renders this VAO, using the specified draw mode
 	/// </summary>
 	/// <param name="mode">The draw mode for primitives in this VAO</param>
 	void Draw(DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Renders this VAO without binding or unbinding it, the VAO must already be bound. Use this
+	/// to avoid redundant binds when drawing the same VAO several times in a row
+	/// </summary>
+	/// <param name="mode">The draw mode for primitives in this VAO</param>
+	void DrawBound(DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Renders this VAO with the given instance count, using the specified draw mode. 
@@ -133,6 +153,14 @@ public:
 	/// <param name="instanceCount">The number of instances to render</param>
 	/// <param name="mode">The primitive mode for rendering the mesh</param>
 	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
+	/// <summary>
+	/// Renders this VAO with the given instance count without binding or unbinding it, the VAO must already
+	/// be bound. Instanced attributes will start reading from the given base instance
+	/// </summary>
+	/// <param name="instanceCount">The number of instances to render</param>
+	/// <param name="baseInstance">The index of the first element to read from instanced vertex buffers</param>
+	/// <param name="mode">The primitive mode for rendering the mesh</param>
+	void DrawInstancedBound(uint32_t instanceCount, uint32_t baseInstance = 0, DrawMode mode = DrawMode::TriangleList);
 
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
@@ -157,6 +185,8 @@ protected:
 	IndexBuffer::Sptr _indexBuffer;
 	// The vertex buffers bound to this VAO
 	std::vector<VertexBufferBinding*> _vertexBuffers;
+	// Attribute values that are the same for every vertex, applied when we bind
+	std::vector<std::pair<GLuint, glm::vec4>> _constantAttributes;
 
 	// Stores a copy of one of the vertex declarations
 	// defined in VertexTypes.cpp
@@ -0,0 +1,177 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+
+#include "Utils/Base64.h"
+
+namespace {
+	/// <summary>
+	/// Limits Base64 to an instruction set for the lifetime of the object, and restores the level it was
+	/// using afterwards even if a check fails
+	/// </summary>
+	class ScopedSimdLevel {
+	public:
+		ScopedSimdLevel(Base64Simd level) : _previous(Base64::GetSimdLevel()) {
+			Base64::SetSimdLevel(level);
+		}
+		~ScopedSimdLevel() {
+			Base64::SetSimdLevel(_previous);
+		}
+
+	private:
+		Base64Simd _previous;
+	};
+
+	// The levels that this CPU can run, SetSimdLevel ignores the ones it can't
+	std::vector<Base64Simd> GetSupportedLevels() {
+		std::vector<Base64Simd> result;
+		for (Base64Simd level : { Base64Simd::Scalar, Base64Simd::SSSE3, Base64Simd::AVX2 }) {
+			ScopedSimdLevel scope(level);
+			if (Base64::GetSimdLevel() == level) {
+				result.push_back(level);
+			}
+		}
+		return result;
+	}
+
+	std::string MakeRandomBytes(std::mt19937& random, size_t size) {
+		std::string result(size, '\0');
+		for (char& c : result) {
+			c = static_cast<char>(random() & 0xFF);
+		}
+		return result;
+	}
+
+	// Returns true if decoding the input throws
+	bool DecodeThrows(const std::string& input) {
+		try {
+			Base64::Decode(input);
+		}
+		catch (const std::runtime_error&) {
+			return true;
+		}
+		return false;
+	}
+}
+
+TEST_CASE(Base64, Rfc4648Vectors) {
+	// The test vectors from section 10 of RFC 4648
+	const std::pair<std::string, std::string> vectors[] = {
+		{ "",       ""         },
+		{ "f",      "Zg=="     },
+		{ "fo",     "Zm8="     },
+		{ "foo",    "Zm9v"     },
+		{ "foob",   "Zm9vYg==" },
+		{ "fooba",  "Zm9vYmE=" },
+		{ "foobar", "Zm9vYmFy" },
+	};
+
+	for (Base64Simd level : GetSupportedLevels()) {
+		ScopedSimdLevel scope(level);
+		LOG_INFO("  {}", ~level);
+
+		for (const auto& [decoded, encoded] : vectors) {
+			CHECK(Base64::Encode(decoded.data(), decoded.size(), false, true) == encoded);
+			CHECK(Base64::Decode(encoded) == decoded);
+
+			// Without padding, which we also accept when decoding
+			std::string unpadded = encoded.substr(0, encoded.find('='));
+			CHECK(Base64::Encode(decoded.data(), decoded.size(), false, false) == unpadded);
+			CHECK(Base64::Decode(unpadded) == decoded);
+		}
+
+		// The two alphabets only differ in the last two characters and the padding
+		const std::string highBits = "\xFB\xFF\xBF\xFB";
+		CHECK(Base64::Encode(highBits.data(), highBits.size(), false, true) == "+/+/+w==");
+		CHECK(Base64::Encode(highBits.data(), highBits.size(), true, true) == "-_-_-w..");
+		CHECK(Base64::Decode("+/+/+w==") == highBits);
+		CHECK(Base64::Decode("-_-_-w..") == highBits);
+
+		// Invalid characters, a lone trailing character and padding on a string that isn't a multiple of 4
+		CHECK(DecodeThrows("Zm9v!mFy"));
+		CHECK(DecodeThrows("Zm9vY"));
+		CHECK(DecodeThrows("Zm9=="));
+		CHECK(Base64::IsBase64("Zm9v-_+/=."));
+		CHECK(!Base64::IsBase64("Zm9v YmFy"));
+	}
+}
+
+TEST_CASE(Base64, RoundTripFuzz) {
+	std::vector<Base64Simd> levels = GetSupportedLevels();
+	LOG_INFO("  Supported: {} levels, up to {}", levels.size(), ~levels.back());
+
+	// Every size up to a few SIMD blocks to cover all the tails, then some larger random sizes
+	std::mt19937 random(1234);
+	std::vector<size_t> sizes;
+	for (size_t size = 0; size <= 200; size++) {
+		sizes.push_back(size);
+	}
+	for (int ix = 0; ix < 200; ix++) {
+		sizes.push_back(random() % 20000);
+	}
+
+	for (size_t size : sizes) {
+		const std::string data = MakeRandomBytes(random, size);
+		for (bool urlEncode : { false, true }) {
+			for (bool includeTrailing : { false, true }) {
+				// Scalar is the reference that the SIMD paths must match exactly
+				std::string expected;
+				{
+					ScopedSimdLevel scope(Base64Simd::Scalar);
+					expected = Base64::Encode(data.data(), data.size(), urlEncode, includeTrailing);
+				}
+
+				for (Base64Simd level : levels) {
+					ScopedSimdLevel scope(level);
+					std::string encoded = Base64::Encode(data.data(), data.size(), urlEncode, includeTrailing);
+					CHECK(encoded == expected);
+					CHECK(Base64::IsBase64(encoded));
+					CHECK(Base64::Decode(encoded) == data);
+				}
+			}
+		}
+
+		// A single bad character anywhere must be caught, whichever path it lands in
+		if (size > 0) {
+			std::string corrupt = Base64::Encode(data.data(), data.size());
+			corrupt[random() % corrupt.size()] = "!*@ \n"[random() % 5];
+			for (Base64Simd level : levels) {
+				ScopedSimdLevel scope(level);
+				CHECK(DecodeThrows(corrupt));
+			}
+		}
+	}
+}
+
+BENCHMARK_CASE(Base64, EncodeDecode) {
+	// About the size of a 1024x1024 RGBA texture
+	const size_t size = 4 * 1024 * 1024;
+	std::mt19937 random(1234);
+	const std::string data = MakeRandomBytes(random, size);
+	const std::string encoded = Base64::Encode(data.data(), data.size());
+	const double megabytes = size / (1024.0 * 1024.0);
+
+	LOG_INFO("  {:.0f} MB", megabytes);
+	double scalarEncode = 0.0;
+	double scalarDecode = 0.0;
+	for (Base64Simd level : GetSupportedLevels()) {
+		ScopedSimdLevel scope(level);
+
+		std::string result;
+		double encodeTime = TestRegistry::Measure(~level + " encode", 10, [&]() {
+			result = Base64::Encode(data.data(), data.size());
+		});
+		CHECK(result == encoded);
+		double decodeTime = TestRegistry::Measure(~level + " decode", 10, [&]() {
+			result = Base64::Decode(encoded);
+		});
+		CHECK(result == data);
+
+		if (level == Base64Simd::Scalar) {
+			scalarEncode = encodeTime;
+			scalarDecode = decodeTime;
+		}
+		LOG_INFO("    encode {:.0f} MB/s, decode {:.0f} MB/s, speedup {:.1f}x / {:.1f}x over scalar",
+			megabytes * 1000.0 / encodeTime, megabytes * 1000.0 / decodeTime, scalarEncode / encodeTime, scalarDecode / decodeTime);
+	}
+}
@@ -0,0 +1,210 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+#include <filesystem>
+
+#include "Utils/Base64.h"
+#include "Utils/BlobStore.h"
+#include "Utils/FileHelpers.h"
+#include "Graphics/Textures/Texture2D.h"
+
+namespace {
+	/// <summary>
+	/// Points the BlobStore at an empty temporary folder for the lifetime of the object, then deletes
+	/// the folder and restores the previous directory, even if a check fails
+	/// </summary>
+	class ScopedBlobDirectory {
+	public:
+		ScopedBlobDirectory(const std::string& name) :
+			_previous(BlobStore::GetDirectory()),
+			_path((std::filesystem::temp_directory_path() / name).generic_string())
+		{
+			std::filesystem::remove_all(_path);
+			BlobStore::SetDirectory(_path);
+		}
+		~ScopedBlobDirectory() {
+			std::error_code error;
+			std::filesystem::remove_all(_path, error);
+			BlobStore::SetDirectory(_previous);
+		}
+
+		const std::string& GetPath() const { return _path; }
+
+		// Counts the files in the folder, including any temporary files that were left behind
+		size_t CountFiles() const {
+			size_t result = 0;
+			std::error_code error;
+			for (const auto& entry : std::filesystem::directory_iterator(_path, error)) {
+				result += entry.is_regular_file() ? 1 : 0;
+			}
+			return result;
+		}
+
+	private:
+		std::string _previous;
+		std::string _path;
+	};
+
+	// Makes an RGBA8 texture without mips, filled with random pixels
+	Texture2D::Sptr MakeTexture(uint32_t size, std::mt19937& random) {
+		Texture2DDescription description;
+		description.Width = size;
+		description.Height = size;
+		description.Format = InternalFormat::RGBA8;
+		description.GenerateMipMaps = false;
+		description.MinificationFilter = MinFilter::Linear;
+		Texture2D::Sptr result = std::make_shared<Texture2D>(description);
+
+		std::vector<uint8_t> pixels((size_t)size * size * 4);
+		for (uint8_t& value : pixels) {
+			value = static_cast<uint8_t>(random() & 0xFF);
+		}
+		result->LoadData(size, size, PixelFormat::RGBA, PixelType::UByte, pixels.data());
+		return result;
+	}
+
+	// Reads the pixels of an RGBA8 texture back from the GPU
+	std::vector<uint8_t> ReadPixels(const Texture2D::Sptr& texture) {
+		std::vector<uint8_t> result((size_t)texture->GetWidth() * texture->GetHeight() * 4);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTextureImage(texture->GetHandle(), 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)result.size(), result.data());
+		return result;
+	}
+
+	// Draws over a texture without going through LoadData, the way a render target's contents change on the GPU
+	void DrawOver(const Texture2D::Sptr& texture, uint8_t value) {
+		const uint8_t color[4] = { value, value, value, 255 };
+		glClearTexImage(texture->GetHandle(), 0, GL_RGBA, GL_UNSIGNED_BYTE, color);
+	}
+}
+
+TEST_CASE(BlobStore, WriteAndOpen) {
+	ScopedBlobDirectory directory("blobstore-test");
+
+	const std::string data = "Some data that we'd rather not put in a manifest";
+	nlohmann::json reference = BlobStore::Write(data.data(), data.size());
+	CHECK(reference.is_object());
+	CHECK(reference["hash"] == BlobStore::Hash(data.data(), data.size()));
+	CHECK(reference["size"] == data.size());
+	CHECK(BlobStore::Contains(reference));
+
+	// The blob went straight to it's final name, without leaving a temporary file behind
+	CHECK(directory.CountFiles() == 1);
+	MemoryMappedFile::Sptr blob = BlobStore::Open(reference);
+	CHECK(blob != nullptr);
+	CHECK(std::string(reinterpret_cast<const char*>(blob->GetData()), blob->GetSize()) == data);
+	blob = nullptr;
+
+	// Identical data shares the blob
+	CHECK(BlobStore::Write(data.data(), data.size()) == reference);
+	CHECK(directory.CountFiles() == 1);
+
+	// A reference with the wrong size is rejected rather than read past the end
+	nlohmann::json wrongSize = reference;
+	wrongSize["size"] = data.size() + 1;
+	CHECK(!BlobStore::Contains(wrongSize));
+	CHECK(BlobStore::Open(wrongSize) == nullptr);
+
+	// Blobs that weren't written or checked since the directory was set are cleaned up
+	const std::string other = "Stale data";
+	nlohmann::json otherReference = BlobStore::Write(other.data(), other.size());
+	BlobStore::SetDirectory(directory.GetPath());
+	CHECK(BlobStore::Contains(reference));
+	BlobStore::RemoveUnused();
+	CHECK(BlobStore::Open(reference) != nullptr);
+	CHECK(!std::filesystem::exists(otherReference["path"].get<std::string>()));
+}
+
+TEST_CASE(BlobStore, Texture2DRoundTrip) {
+	ScopedBlobDirectory directory("blobstore-texture-test");
+	std::mt19937 random(1234);
+
+	Texture2D::Sptr texture = MakeTexture(64, random);
+	const std::vector<uint8_t> pixels = ReadPixels(texture);
+
+	// The pixels go in a blob, not in the JSON
+	nlohmann::json data = texture->ToJson();
+	CHECK(data.contains("blob"));
+	CHECK(!data.contains("data"));
+	CHECK(data["blob"]["size"] == pixels.size());
+	CHECK(data.dump().size() < 1024);
+
+	Texture2D::Sptr loaded = Texture2D::FromJson(data);
+	CHECK(loaded->GetWidth() == texture->GetWidth());
+	CHECK(loaded->GetHeight() == texture->GetHeight());
+	CHECK(loaded->GetFormat() == texture->GetFormat());
+	CHECK(ReadPixels(loaded) == pixels);
+
+	// Saving again without any changes reuses the blob
+	CHECK(loaded->ToJson()["blob"] == data["blob"]);
+	CHECK(directory.CountFiles() == 1);
+
+	// Render targets are always read back, since they can be drawn to without us knowing
+	loaded->MarkAsRenderTarget();
+	DrawOver(loaded, 128);
+	nlohmann::json drawn = loaded->ToJson();
+	CHECK(drawn["blob"]["hash"] != data["blob"]["hash"]);
+	CHECK(ReadPixels(Texture2D::FromJson(drawn)) == ReadPixels(loaded));
+
+	// Manifests from before blobs embedded the pixels as Base64, which we still load
+	nlohmann::json legacy = data;
+	legacy.erase("blob");
+	legacy["data"] = Base64::Encode(pixels.data(), pixels.size());
+	CHECK(ReadPixels(Texture2D::FromJson(legacy)) == pixels);
+}
+
+BENCHMARK_CASE(BlobStore, RenderTargetManifest) {
+	ScopedBlobDirectory directory("blobstore-bench");
+	const std::string manifestPath = (std::filesystem::temp_directory_path() / "blobstore-bench-manifest.json").string();
+
+	// 200 render targets, each drawn to between saves so that every save has to read them back
+	const int count = 200;
+	const uint32_t size = 256;
+	std::mt19937 random(1234);
+	std::vector<Texture2D::Sptr> textures;
+	for (int ix = 0; ix < count; ix++) {
+		textures.push_back(MakeTexture(size, random));
+		textures.back()->MarkAsRenderTarget();
+	}
+	LOG_INFO("  {} render targets, {}x{} RGBA8 ({:.1f} MB of pixels)", count, size, size, count * size * size * 4 / (1024.0 * 1024.0));
+
+	// How ToJson saved textures before blobs, reading back and Base64 encoding into the manifest itself. The
+	// settings are the same for every texture, so we only need to get them once
+	nlohmann::json settings = textures[0]->ToJson();
+	settings.erase("blob");
+	size_t embeddedSize = 0;
+	double embeddedTime = TestRegistry::Measure("Base64 in the manifest", 3, [&]() {
+		nlohmann::json manifest;
+		for (int ix = 0; ix < count; ix++) {
+			DrawOver(textures[ix], static_cast<uint8_t>(ix));
+			nlohmann::json blob = settings;
+			std::vector<uint8_t> pixels = ReadPixels(textures[ix]);
+			blob["data"] = Base64::Encode(pixels.data(), pixels.size());
+			manifest[std::to_string(ix)] = blob;
+		}
+		std::string contents = manifest.dump(1, '\t');
+		embeddedSize = contents.size();
+		FileHelpers::WriteContentsToFile(manifestPath, contents);
+	});
+
+	size_t blobSize = 0;
+	int frame = 0;
+	double blobTime = TestRegistry::Measure("sidecar blobs", 3, [&]() {
+		// Draw something new each time, so that the blobs really are written again
+		frame++;
+		nlohmann::json manifest;
+		for (int ix = 0; ix < count; ix++) {
+			DrawOver(textures[ix], static_cast<uint8_t>(ix + frame * count));
+			manifest[std::to_string(ix)] = textures[ix]->ToJson();
+		}
+		std::string contents = manifest.dump(1, '\t');
+		blobSize = contents.size();
+		FileHelpers::WriteContentsToFile(manifestPath, contents);
+	});
+	std::filesystem::remove(manifestPath);
+
+	LOG_INFO("    manifest {:.1f} MB with Base64, {:.1f} KB with blobs ({:.0f}x smaller), save {:.1f}x faster",
+		embeddedSize / (1024.0 * 1024.0), blobSize / 1024.0, (double)embeddedSize / blobSize, embeddedTime / blobTime);
+	CHECK(blobSize * 100 < embeddedSize);
+	CHECK(directory.CountFiles() >= (size_t)count);
+}
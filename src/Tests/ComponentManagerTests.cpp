@@ -0,0 +1,110 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+#include <functional>
+#include <unordered_map>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/GameObject.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+
+namespace {
+	/// <summary>
+	/// Creates a scene with the given number of objects that each have a RotatingBehaviour, with
+	/// the rotation speed's X component set to the object's index
+	/// </summary>
+	Gameplay::Scene::Sptr MakeRotatorScene(int count, std::vector<std::weak_ptr<Gameplay::GameObject>>* objects = nullptr) {
+		Gameplay::Scene::Sptr scene = std::make_shared<Gameplay::Scene>();
+		for (int ix = 0; ix < count; ix++) {
+			Gameplay::GameObject::Sptr object = scene->CreateGameObject("Rotator " + std::to_string(ix));
+			RotatingBehaviour::Sptr rotator = object->Add<RotatingBehaviour>();
+			rotator->RotationSpeed = glm::vec3((float)ix, 0.0f, 0.0f);
+			if (objects != nullptr) {
+				objects->push_back(object);
+			}
+		}
+		return scene;
+	}
+}
+
+TEST_CASE(ComponentManager, DestroyDuringEach) {
+	using namespace Gameplay;
+
+	const int count = 1000;
+	std::vector<std::weak_ptr<GameObject>> objects;
+	Scene::Sptr scene = MakeRotatorScene(count, &objects);
+
+	// Every third component destroys itself and another random object, which may or may not have been
+	// visited yet. Flushing the scene's delete queue destroys the components in the middle of the walk
+	std::mt19937 random(1234);
+	std::unordered_map<Guid, int> visits;
+	int calls = 0;
+	scene->Components().Each<RotatingBehaviour>([&](RotatingBehaviour* rotator) {
+		visits[rotator->GetGUID()]++;
+		if (calls++ % 3 == 0) {
+			scene->RemoveGameObject(rotator->GetGameObject()->SelfRef());
+			GameObject::Sptr other = objects[random() % objects.size()].lock();
+			if (other != nullptr) {
+				scene->RemoveGameObject(other);
+			}
+			scene->Update(0.0f);
+		}
+	});
+
+	// No component may be visited twice, and every component that survived must have been visited
+	for (const auto& [guid, visitCount] : visits) {
+		CHECK(visitCount == 1);
+	}
+	std::vector<Guid> remaining;
+	scene->Components().Each<RotatingBehaviour>([&](RotatingBehaviour* rotator) {
+		remaining.push_back(rotator->GetGUID());
+	}, true);
+	for (const Guid& guid : remaining) {
+		CHECK(visits.count(guid) == 1);
+	}
+	CHECK(remaining.size() == scene->Components().Count<RotatingBehaviour>());
+	CHECK(remaining.size() < (size_t)count);
+}
+
+BENCHMARK_CASE(ComponentManager, EachHundredThousand) {
+	using namespace Gameplay;
+
+	const int count = 100000;
+	Scene::Sptr scene = MakeRotatorScene(count);
+
+	// The store and iteration that Each used before the dense pools, a weak_ptr per component that
+	// is locked, cast and passed through a std::function
+	std::vector<std::weak_ptr<IComponent>> weakStore;
+	weakStore.reserve(count);
+	scene->Components().Each<RotatingBehaviour>([&](RotatingBehaviour* rotator) {
+		weakStore.push_back(rotator->SelfRef());
+	});
+
+	double oldSum = 0.0;
+	std::function<void(const std::shared_ptr<RotatingBehaviour>&)> oldCallback = [&](const std::shared_ptr<RotatingBehaviour>& rotator) {
+		oldSum += rotator->RotationSpeed.x;
+	};
+	double newSum = 0.0;
+
+	LOG_INFO("  {} components", count);
+	double oldTime = TestRegistry::Measure("weak_ptr, dynamic_pointer_cast, std::function", 50, [&]() {
+		oldSum = 0.0;
+		for (auto& wptr : weakStore) {
+			std::shared_ptr<IComponent> sptr = wptr.lock();
+			if (sptr && sptr->IsEnabled) {
+				oldCallback(std::dynamic_pointer_cast<RotatingBehaviour>(sptr));
+			}
+		}
+	});
+	double newTime = TestRegistry::Measure("dense pool", 50, [&]() {
+		newSum = 0.0;
+		scene->Components().Each<RotatingBehaviour>([&](RotatingBehaviour* rotator) {
+			newSum += rotator->RotationSpeed.x;
+		});
+	});
+	LOG_INFO("    speedup {:.1f}x", oldTime / newTime);
+
+	// The speeds are whole numbers, so the sums are exact whatever order they are added in
+	CHECK(oldSum == newSum);
+	CHECK(newSum == (double)count * (count - 1) / 2.0);
+}
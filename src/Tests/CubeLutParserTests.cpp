@@ -0,0 +1,186 @@
+#include "Tests/TestRegistry.h"
+
+#include <string>
+#include <cctype>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+
+#include "Utils/CubeLutParser.h"
+#include "Utils/StringUtils.h"
+
+namespace {
+	/// <summary>
+	/// The getline and stringstream parsing that Texture3D used before CubeLutParser, extended to keep
+	/// the title and domain and to keep the values as floats so that it's output can be compared
+	/// </summary>
+	bool ParseWithStreams(const std::string& filename, CubeLutParser::Lut& result) {
+		std::ifstream file(filename, std::ios::binary);
+		if (!file) {
+			return false;
+		}
+
+		result = CubeLutParser::Lut();
+		std::string line;
+		while (std::getline(file, line)) {
+			StringTools::Trim(line);
+			if (line.empty() || line[0] == '#') {
+				continue;
+			}
+
+			std::stringstream reader(line);
+			std::string keyword;
+			if (line.rfind("TITLE", 0) == 0) {
+				std::string title = line.substr(5);
+				StringTools::Trim(title);
+				if (title.size() >= 2 && title.front() == '"' && title.back() == '"') {
+					title = title.substr(1, title.size() - 2);
+				}
+				result.Title = title;
+			}
+			else if (line.rfind("LUT_3D_SIZE", 0) == 0) {
+				reader >> keyword >> result.Size;
+				result.Data.reserve((size_t)result.Size * result.Size * result.Size);
+			}
+			else if (line.rfind("DOMAIN_MIN", 0) == 0) {
+				reader >> keyword >> result.DomainMin.r >> result.DomainMin.g >> result.DomainMin.b;
+			}
+			else if (line.rfind("DOMAIN_MAX", 0) == 0) {
+				reader >> keyword >> result.DomainMax.r >> result.DomainMax.g >> result.DomainMax.b;
+			}
+			else if (std::isdigit(static_cast<unsigned char>(line[0])) || line[0] == '-' || line[0] == '.') {
+				glm::vec3 rgb;
+				reader >> rgb.r >> rgb.g >> rgb.b;
+				if (!reader) {
+					return false;
+				}
+				result.Data.push_back(rgb);
+			}
+		}
+		return result.Size > 0 && result.Data.size() == (size_t)result.Size * result.Size * result.Size;
+	}
+
+	// Finds all the .cube files in the luts folder, the extension isn't always lower case
+	std::vector<std::string> FindLutFiles() {
+		std::vector<std::string> result;
+		for (const auto& entry : std::filesystem::directory_iterator("luts")) {
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+			if (entry.is_regular_file() && extension == ".cube") {
+				result.push_back(entry.path().generic_string());
+			}
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	// Checks that two LUTs hold the same table, values are compared to within float rounding of the text
+	void CheckSameLut(const CubeLutParser::Lut& a, const CubeLutParser::Lut& b) {
+		CHECK(a.Size == b.Size);
+		CHECK(a.Title == b.Title);
+		CHECK(a.DomainMin == b.DomainMin);
+		CHECK(a.DomainMax == b.DomainMax);
+		CHECK(a.Data.size() == b.Data.size());
+		float largest = 0.0f;
+		for (size_t ix = 0; ix < a.Data.size(); ix++) {
+			const glm::vec3 difference = glm::abs(a.Data[ix] - b.Data[ix]);
+			largest = std::max({ largest, difference.r, difference.g, difference.b });
+		}
+		CHECK(largest <= 1e-6f);
+	}
+}
+
+TEST_CASE(CubeLutParser, MatchesReference) {
+	std::vector<std::string> files = FindLutFiles();
+	CHECK(!files.empty());
+
+	for (const std::string& filename : files) {
+		CubeLutParser::Lut reference;
+		CHECK(ParseWithStreams(filename, reference));
+
+		CubeLutParser::Lut single;
+		CHECK(CubeLutParser::ParseFile(filename, single, 1));
+		LOG_INFO("  {}: {}^3 entries, \"{}\"", filename, single.Size, single.Title);
+		CheckSameLut(single, reference);
+
+		// The larger files are split into several chunks, which must stitch back together in order
+		CubeLutParser::Lut chunked;
+		CHECK(CubeLutParser::ParseFile(filename, chunked, 4));
+		CheckSameLut(chunked, reference);
+	}
+}
+
+TEST_CASE(CubeLutParser, Formatting) {
+	// Line endings, a byte order mark, comments, blank lines and signs must not change the result
+	const std::string plain = "TITLE \"Test\"\nLUT_3D_SIZE 2\nDOMAIN_MIN 0 0 0\nDOMAIN_MAX 1 1 1\n"
+		"0 0 0\n1 0 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n";
+	const std::string messy = "\xEF\xBB\xBF# A comment\r\nTITLE   \"Test\"  \r\n\r\nLUT_3D_SIZE\t2\r\n"
+		"DOMAIN_MIN 0.0 0.0 0.0\r\nDOMAIN_MAX +1.0 1.0 1.0\r\n"
+		"0 0 0\r\n1.0 0 0 # trailing comment\r\n# Between rows\r\n0 1 0\r\n+1 1 0\r\n0 0 1\r\n1 0 1\r\n0 1 1\r\n  1 1 1";
+
+	CubeLutParser::Lut expected;
+	CubeLutParser::Lut result;
+	CHECK(CubeLutParser::Parse(plain.data(), plain.data() + plain.size(), expected));
+	CHECK(CubeLutParser::Parse(messy.data(), messy.data() + messy.size(), result));
+	CheckSameLut(result, expected);
+	CHECK(result.Data[7] == glm::vec3(1.0f));
+
+	// Resolve's older input range keyword sets the domain on every channel
+	const std::string inputRange = "LUT_3D_SIZE 2\nLUT_3D_INPUT_RANGE -0.5 2\n0 0 0\n1 0 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n";
+	CHECK(CubeLutParser::Parse(inputRange.data(), inputRange.data() + inputRange.size(), result));
+	CHECK(result.DomainMin == glm::vec3(-0.5f));
+	CHECK(result.DomainMax == glm::vec3(2.0f));
+
+	// Missing rows, bad rows and 1D LUTs are all rejected
+	for (const std::string& invalid : {
+		std::string("LUT_3D_SIZE 2\n0 0 0\n1 0 0\n"),
+		std::string("LUT_3D_SIZE 2\n0 0 0\n1 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n"),
+		std::string("LUT_1D_SIZE 2\n0 0 0\n1 1 1\n"),
+		std::string("LUT_3D_SIZE 2\nDOMAIN_MIN 1 1 1\nDOMAIN_MAX 0 0 0\n0 0 0\n1 0 0\n0 1 0\n1 1 0\n0 0 1\n1 0 1\n0 1 1\n1 1 1\n") }) {
+		CHECK(!CubeLutParser::Parse(invalid.data(), invalid.data() + invalid.size(), result));
+	}
+}
+
+TEST_CASE(CubeLutParser, CacheRoundTrip) {
+	std::vector<std::string> files = FindLutFiles();
+	CHECK(!files.empty());
+
+	CubeLutParser::Lut parsed;
+	CHECK(CubeLutParser::ParseFile(files[0], parsed));
+
+	const std::string path = (std::filesystem::temp_directory_path() / (std::string("cubelutparser-test") + CubeLutParser::CACHE_EXTENSION)).string();
+	CubeLutParser::Lut cached;
+	const bool saved = CubeLutParser::SaveCache(path, parsed);
+	const bool loaded = CubeLutParser::LoadCache(path, cached);
+	std::filesystem::remove(path);
+
+	CHECK(saved);
+	CHECK(loaded);
+	CheckSameLut(cached, parsed);
+}
+
+BENCHMARK_CASE(CubeLutParser, SampleLuts) {
+	const std::string cachePath = (std::filesystem::temp_directory_path() / (std::string("cubelutparser-bench") + CubeLutParser::CACHE_EXTENSION)).string();
+
+	for (const std::string& filename : FindLutFiles()) {
+		CubeLutParser::Lut streams;
+		CubeLutParser::Lut single;
+		CubeLutParser::Lut threaded;
+		CubeLutParser::Lut cached;
+
+		LOG_INFO("  {} ({:.1f} MB)", filename, std::filesystem::file_size(filename) / (1024.0 * 1024.0));
+		double oldTime = TestRegistry::Measure("iostream", 10, [&]() { ParseWithStreams(filename, streams); });
+		double newTime = TestRegistry::Measure("CubeLutParser, 1 thread", 10, [&]() { CubeLutParser::ParseFile(filename, single, 1); });
+		double threadedTime = TestRegistry::Measure("CubeLutParser, all threads", 10, [&]() { CubeLutParser::ParseFile(filename, threaded, 0); });
+
+		CubeLutParser::SaveCache(cachePath, single);
+		double cacheTime = TestRegistry::Measure("LoadCache", 10, [&]() { CubeLutParser::LoadCache(cachePath, cached); });
+		std::filesystem::remove(cachePath);
+
+		LOG_INFO("    speedup {:.1f}x on 1 thread, {:.1f}x on all threads, {:.1f}x from the cache", oldTime / newTime, oldTime / threadedTime, oldTime / cacheTime);
+
+		CheckSameLut(single, streams);
+		CheckSameLut(threaded, single);
+		CheckSameLut(cached, single);
+	}
+}
@@ -0,0 +1,115 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+
+#include <GLM/gtc/matrix_transform.hpp>
+
+#include "Utils/Frustum.h"
+
+namespace {
+	/// <summary>
+	/// Switches the frustum between the SSE and scalar plane tests for the lifetime of the object, and
+	/// restores the previous setting afterwards even if a check fails
+	/// </summary>
+	class ScopedSse {
+	public:
+		ScopedSse(bool enabled) : _previous(Frustum::IsSseEnabled()) {
+			Frustum::SetSseEnabled(enabled);
+		}
+		~ScopedSse() {
+			Frustum::SetSseEnabled(_previous);
+		}
+
+	private:
+		bool _previous;
+	};
+
+	// The plane tests that this build can run, SSE is only there if the build targets it
+	std::vector<bool> GetSupportedModes() {
+		std::vector<bool> result = { false };
+		ScopedSse scope(true);
+		if (Frustum::IsSseEnabled()) {
+			result.push_back(true);
+		}
+		return result;
+	}
+
+	// Makes a box around a point
+	bool IntersectsCube(const Frustum& frustum, const glm::vec3& center, float halfSize) {
+		return frustum.IntersectsBox(center - glm::vec3(halfSize), center + glm::vec3(halfSize));
+	}
+}
+
+TEST_CASE(Frustum, IntersectsBox) {
+	// An orthographic camera at the origin looking down -Z, so the frustum is just the box between these corners
+	const glm::vec3 lower(-10.0f, -5.0f, -100.0f);
+	const glm::vec3 upper(10.0f, 5.0f, -1.0f);
+	const Frustum frustum(glm::ortho(-10.0f, 10.0f, -5.0f, 5.0f, 1.0f, 100.0f));
+	const glm::vec3 middle = (lower + upper) * 0.5f;
+
+	// A perspective camera looking at the origin with Z up, like the ones in our scenes
+	const glm::vec3 eye(5.0f, 5.0f, 5.0f);
+	const Frustum perspective(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f) * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+
+	const std::vector<bool> modes = GetSupportedModes();
+	for (bool sse : modes) {
+		ScopedSse scope(sse);
+		LOG_INFO("  {}", sse ? "SSE" : "Scalar");
+
+		CHECK(Frustum().IntersectsBox(glm::vec3(-1e6f), glm::vec3(1e6f)));
+		CHECK(frustum.IntersectsBox(lower - glm::vec3(1.0f), upper + glm::vec3(1.0f)));
+		CHECK(IntersectsCube(frustum, middle, 1.0f));
+
+		// Inside, straddling and outside of each plane in turn, keeping the box well inside the other 5
+		for (int axis = 0; axis < 3; axis++) {
+			for (float side : { -1.0f, 1.0f }) {
+				const float plane = side < 0.0f ? lower[axis] : upper[axis];
+				glm::vec3 center = middle;
+
+				center[axis] = plane - side * 0.6f;
+				CHECK(IntersectsCube(frustum, center, 0.5f));
+				center[axis] = plane;
+				CHECK(IntersectsCube(frustum, center, 0.5f));
+				center[axis] = plane + side * 0.4f;
+				CHECK(IntersectsCube(frustum, center, 0.5f));
+				center[axis] = plane + side * 0.6f;
+				CHECK(!IntersectsCube(frustum, center, 0.5f));
+				center[axis] = plane + side * 50.0f;
+				CHECK(!IntersectsCube(frustum, center, 0.5f));
+			}
+		}
+
+		// Past all 3 planes at a corner
+		CHECK(!IntersectsCube(frustum, upper + glm::vec3(1.0f), 0.5f));
+
+		CHECK(IntersectsCube(perspective, glm::vec3(0.0f), 1.0f));
+		CHECK(IntersectsCube(perspective, eye, 0.5f));
+		CHECK(!IntersectsCube(perspective, eye * 2.0f, 1.0f));
+		CHECK(!IntersectsCube(perspective, eye * -20.0f, 1.0f));
+		CHECK(!IntersectsCube(perspective, glm::vec3(20.0f, -20.0f, 0.0f), 1.0f));
+	}
+
+	// Both paths must agree exactly on random boxes, including the ones right on the edge of the frustum
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> size(0.0f, 10.0f);
+	size_t visible = 0;
+	const size_t count = 10000;
+	for (size_t ix = 0; ix < count; ix++) {
+		const glm::vec3 min(position(random), position(random), position(random));
+		const glm::vec3 max = min + glm::vec3(size(random), size(random), size(random));
+
+		bool expected = false;
+		{
+			ScopedSse scope(false);
+			expected = perspective.IntersectsBox(min, max);
+		}
+		for (bool sse : modes) {
+			ScopedSse scope(sse);
+			CHECK(perspective.IntersectsBox(min, max) == expected);
+		}
+		visible += expected ? 1 : 0;
+	}
+	LOG_INFO("  {} of {} random boxes visible", visible, count);
+	CHECK(visible > 0 && visible < count);
+}
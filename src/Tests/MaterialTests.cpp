@@ -0,0 +1,112 @@
+#include "Tests/TestRegistry.h"
+
+#include "Gameplay/Material.h"
+#include "Graphics/Textures/Texture2D.h"
+
+namespace {
+	/// <summary>
+	/// Gives us access to the way materials were applied before they kept location sorted apply lists,
+	/// walking the uniform map and sending every uniform on every call
+	/// </summary>
+	class LegacyMaterial : public Gameplay::Material {
+	public:
+		typedef std::shared_ptr<LegacyMaterial> Sptr;
+
+		LegacyMaterial(const ShaderProgram::Sptr& shader) : Material(shader) {}
+
+		/// <summary>
+		/// Gets the number of textures in the apply list, valid after the material has been applied
+		/// </summary>
+		size_t GetTextureCount() const { return _textureUniforms.size(); }
+
+		/// <summary>
+		/// Applies the material the old way, returning the number of GL calls that were issued
+		/// </summary>
+		uint32_t ApplyLegacy() {
+			uint32_t calls = 0;
+			int textureSlot = 0;
+			for (auto& [name, data] : _uniforms) {
+				if (GetShaderDataTypeCode(data.Type) == ShaderDataTypecode::Texture) {
+					if (textureSlot < MAX_TEXTURE_SLOTS) {
+						if (data.TextureAsset != nullptr) {
+							data.TextureAsset->Bind(textureSlot);
+						} else {
+							ITexture::Unbind(textureSlot);
+						}
+						_shader->SetUniform(data.Location, data.Type, &textureSlot);
+						textureSlot++;
+						calls += 2;
+					}
+				} else {
+					_shader->SetUniform(data.Location, data.Type, data.ArraySize > 1 ? data.ArrayBlock : data.Value, (int)data.ArraySize);
+					calls++;
+				}
+			}
+			return calls;
+		}
+	};
+}
+
+BENCHMARK_CASE(Material, ApplyThousandMaterials) {
+	using namespace Gameplay;
+
+	ShaderProgram::Sptr shader = std::make_shared<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/basic.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/frag_blinn_phong_textured.glsl" }
+	});
+	Texture2D::Sptr textures[] = {
+		std::make_shared<Texture2D>("textures/box-diffuse.png"),
+		std::make_shared<Texture2D>("textures/monkey-uvMap.png")
+	};
+
+	// The same materials are set up for both paths, with a different texture and shininess for each
+	const int count = 1000;
+	std::vector<LegacyMaterial::Sptr> materials;
+	for (int ix = 0; ix < count; ix++) {
+		LegacyMaterial::Sptr material = std::make_shared<LegacyMaterial>(shader);
+		material->Name = "Material " + std::to_string(ix);
+		material->Set("u_Material.Diffuse", textures[ix % 2]);
+		material->Set("u_Material.Shininess", ix / (float)count);
+		materials.push_back(material);
+	}
+	shader->Bind();
+
+	// Draws are sorted by material, so each material is applied for several draws in a row
+	const int drawsPerMaterial = 10;
+	uint64_t legacyCalls = 0;
+	uint64_t calls = 0;
+	uint64_t repeatCalls = 0;
+	uint64_t repeatTextureBinds = 0;
+
+	LOG_INFO("  {} materials, {} draws each", count, drawsPerMaterial);
+	double legacyTime = TestRegistry::Measure("uniform map, every uniform every call", 20, [&]() {
+		legacyCalls = 0;
+		for (const LegacyMaterial::Sptr& material : materials) {
+			for (int draw = 0; draw < drawsPerMaterial; draw++) {
+				legacyCalls += material->ApplyLegacy();
+			}
+		}
+	});
+	double newTime = TestRegistry::Measure("apply lists, unchanged uniforms skipped", 20, [&]() {
+		calls = 0;
+		repeatCalls = 0;
+		repeatTextureBinds = 0;
+		for (const LegacyMaterial::Sptr& material : materials) {
+			for (int draw = 0; draw < drawsPerMaterial; draw++) {
+				material->Apply();
+				calls += material->GetLastApplyCallCount();
+				if (draw > 0) {
+					repeatCalls += material->GetLastApplyCallCount();
+					repeatTextureBinds += material->GetTextureCount();
+				}
+			}
+		}
+	});
+
+	const uint64_t applies = (uint64_t)count * drawsPerMaterial;
+	LOG_INFO("    GL calls per apply: {:.2f} -> {:.2f}, speedup {:.1f}x", legacyCalls / (double)applies, calls / (double)applies, legacyTime / newTime);
+
+	// Applying a material again only re-binds it's textures
+	CHECK(repeatCalls == repeatTextureBinds);
+	CHECK(calls < legacyCalls);
+}
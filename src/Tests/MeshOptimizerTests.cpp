@@ -0,0 +1,122 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+#include <array>
+
+#include "Utils/MeshOptimizer.h"
+#include "Utils/ObjParser.h"
+
+namespace {
+	// Builds a triangle list for a size x size grid of quads, with the triangles in a random order
+	std::vector<uint32_t> MakeShuffledGrid(uint32_t size, uint32_t& vertexCount) {
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (uint32_t y = 0; y < size; y++) {
+			for (uint32_t x = 0; x < size; x++) {
+				uint32_t a = y * (size + 1) + x;
+				uint32_t b = a + 1;
+				uint32_t c = a + size + 1;
+				uint32_t d = c + 1;
+				triangles.push_back({ a, b, d });
+				triangles.push_back({ a, d, c });
+			}
+		}
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+
+		std::vector<uint32_t> result;
+		for (const auto& triangle : triangles) {
+			result.insert(result.end(), triangle.begin(), triangle.end());
+		}
+		vertexCount = (size + 1) * (size + 1);
+		return result;
+	}
+
+	// Rotates each triangle so that it starts with it's smallest index, then sorts the triangles, so
+	// that two lists containing the same triangles with the same winding compare equal
+	std::vector<std::array<uint32_t, 3>> CanonicalTriangles(const std::vector<uint32_t>& indices) {
+		std::vector<std::array<uint32_t, 3>> result;
+		for (size_t ix = 0; ix + 2 < indices.size(); ix += 3) {
+			std::array<uint32_t, 3> triangle = { indices[ix], indices[ix + 1], indices[ix + 2] };
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			result.push_back(triangle);
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	// Runs both optimizations on a triangle list, and checks that the mesh still has the same triangles afterwards
+	MeshOptimizer::Report OptimizeAndCheck(std::vector<uint32_t>& indices, size_t vertexCount) {
+		const std::vector<uint32_t> original = indices;
+
+		MeshOptimizer::Report report;
+		report.Before = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+		MeshOptimizer::OptimizeVertexCache(indices.data(), indices.size(), vertexCount);
+		std::vector<uint32_t> order = MeshOptimizer::OptimizeVertexFetch(indices.data(), indices.size(), vertexCount);
+		report.After = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+		// The fetch order must be a permutation of the original vertices
+		CHECK(order.size() == vertexCount);
+		std::vector<uint32_t> sortedOrder = order;
+		std::sort(sortedOrder.begin(), sortedOrder.end());
+		for (uint32_t ix = 0; ix < vertexCount; ix++) {
+			CHECK(sortedOrder[ix] == ix);
+		}
+
+		// Vertices are laid out in the order they are first used
+		uint32_t nextNew = 0;
+		for (uint32_t index : indices) {
+			CHECK(index <= nextNew);
+			if (index == nextNew) {
+				nextNew++;
+			}
+		}
+
+		// Mapping back to the old vertices gives us the same triangles, with the same winding
+		std::vector<uint32_t> remapped(indices.size());
+		for (size_t ix = 0; ix < indices.size(); ix++) {
+			remapped[ix] = order[indices[ix]];
+		}
+		CHECK(CanonicalTriangles(remapped) == CanonicalTriangles(original));
+
+		return report;
+	}
+}
+
+TEST_CASE(MeshOptimizer, CacheStatistics) {
+	// A strip of 4 triangles through 6 vertices, every vertex only needs to be transformed once
+	const uint32_t strip[] = { 0, 1, 2,  2, 1, 3,  2, 3, 4,  4, 3, 5 };
+	MeshOptimizer::CacheStatistics stats = MeshOptimizer::AnalyzeVertexCache(strip, 12, 6);
+	CHECK(stats.VerticesTransformed == 6);
+	CHECK_NEAR(stats.ACMR, 6.0f / 4.0f, 1e-6f);
+	CHECK_NEAR(stats.ATVR, 1.0f, 1e-6f);
+
+	// With a single entry cache, only the repeated vertex between consecutive triangles can hit
+	stats = MeshOptimizer::AnalyzeVertexCache(strip, 12, 6, 1);
+	CHECK(stats.ATVR > 1.0f);
+}
+
+TEST_CASE(MeshOptimizer, ShuffledGrid) {
+	uint32_t vertexCount = 0;
+	std::vector<uint32_t> indices = MakeShuffledGrid(64, vertexCount);
+	MeshOptimizer::Report report = OptimizeAndCheck(indices, vertexCount);
+
+	LOG_INFO("  64x64 grid: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR);
+
+	// Shuffled triangles miss almost every time, an optimized grid should get close to the 0.5 best case
+	CHECK(report.Before.ACMR > 2.0f);
+	CHECK(report.After.ACMR < 0.8f);
+	CHECK(report.After.ATVR < 1.6f);
+}
+
+TEST_CASE(MeshOptimizer, SampleMeshes) {
+	for (const char* filename : { "monkey.obj", "test.obj" }) {
+		ObjParser::Result obj;
+		CHECK(ObjParser::ParseFile(filename, obj));
+		MeshOptimizer::Report report = OptimizeAndCheck(obj.Indices, obj.Vertices.size());
+
+		LOG_INFO("  {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", filename, report.Before.ACMR, report.After.ACMR, report.Before.ATVR, report.After.ATVR);
+
+		// Optimizing should never make a mesh worse
+		CHECK(report.After.ACMR <= report.Before.ACMR);
+		CHECK(report.After.ATVR <= report.Before.ATVR);
+	}
+}
@@ -0,0 +1,281 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+#include <cmath>
+
+#include "Utils/MipGenerator.h"
+
+namespace {
+	// A level of the reference mip chain, in linear double precision
+	struct ReferenceLevel {
+		uint32_t            Width  = 0;
+		uint32_t            Height = 0;
+		std::vector<double> Data;
+	};
+
+	bool IsSrgbChannel(uint32_t channel, uint32_t numChannels, const MipGenerator::Options& options) {
+		const bool hasAlpha = numChannels == 2 || numChannels == 4;
+		return options.IsSrgb && !(hasAlpha && channel == numChannels - 1);
+	}
+
+	double Kaiser(double x) {
+		const double halfWidth = 3.0;
+		const double alpha = 4.0;
+		if (std::abs(x) >= halfWidth) {
+			return 0.0;
+		}
+		const double pi = 3.14159265358979323846;
+		double sinc = std::abs(x) < 1e-9 ? 1.0 : std::sin(pi * x) / (pi * x);
+		double ratio = x / halfWidth;
+		return sinc * std::cyl_bessel_i(0.0, alpha * std::sqrt(1.0 - ratio * ratio)) / std::cyl_bessel_i(0.0, alpha);
+	}
+
+	// The unnormalized weights of the source texels along one axis for a destination texel, with texels
+	// past the edge folded back in by wrapping or clamping. Texels with no weight are left out
+	std::vector<std::pair<uint32_t, double>> AxisWeights(uint32_t dest, uint32_t sourceSize, uint32_t destSize, MipFilter filter, bool wrap) {
+		std::vector<double> result(sourceSize, 0.0);
+		const double scale = sourceSize / (double)destSize;
+		auto resolve = [&](int64_t index) {
+			if (wrap) {
+				return (size_t)(((index % sourceSize) + sourceSize) % sourceSize);
+			}
+			return (size_t)std::clamp<int64_t>(index, 0, sourceSize - 1);
+		};
+
+		if (filter == MipFilter::Kaiser && scale > 1.0) {
+			const double center = (dest + 0.5) * scale;
+			for (int64_t ix = (int64_t)std::floor(center - 3.0 * scale) - 1; ix <= (int64_t)std::ceil(center + 3.0 * scale) + 1; ix++) {
+				result[resolve(ix)] += Kaiser((ix + 0.5 - center) / scale);
+			}
+		} else {
+			const double start = dest * scale;
+			const double end = start + scale;
+			for (int64_t ix = 0; ix < sourceSize; ix++) {
+				result[ix] = std::max(0.0, std::min(end, ix + 1.0) - std::max(start, (double)ix));
+			}
+		}
+
+		std::vector<std::pair<uint32_t, double>> weights;
+		for (uint32_t ix = 0; ix < sourceSize; ix++) {
+			if (result[ix] != 0.0) {
+				weights.emplace_back(ix, result[ix]);
+			}
+		}
+		return weights;
+	}
+
+	// Halves a reference level with a direct 2D weighted sum, nothing is shared with MipGenerator's separable filters
+	ReferenceLevel ReferenceDownsample(const ReferenceLevel& source, uint32_t numChannels, const MipGenerator::Options& options) {
+		ReferenceLevel result;
+		result.Width  = std::max(source.Width / 2, 1u);
+		result.Height = std::max(source.Height / 2, 1u);
+		result.Data.resize((size_t)result.Width * result.Height * numChannels);
+
+		for (uint32_t y = 0; y < result.Height; y++) {
+			std::vector<std::pair<uint32_t, double>> weightsY = AxisWeights(y, source.Height, result.Height, options.Filter, options.WrapY);
+			for (uint32_t x = 0; x < result.Width; x++) {
+				std::vector<std::pair<uint32_t, double>> weightsX = AxisWeights(x, source.Width, result.Width, options.Filter, options.WrapX);
+				double total = 0.0;
+				double sum[4] = { 0.0, 0.0, 0.0, 0.0 };
+				for (const auto& [sy, weightY] : weightsY) {
+					for (const auto& [sx, weightX] : weightsX) {
+						double weight = weightX * weightY;
+						total += weight;
+						for (uint32_t channel = 0; channel < numChannels; channel++) {
+							sum[channel] += source.Data[((size_t)sy * source.Width + sx) * numChannels + channel] * weight;
+						}
+					}
+				}
+				for (uint32_t channel = 0; channel < numChannels; channel++) {
+					result.Data[((size_t)y * result.Width + x) * numChannels + channel] = std::clamp(sum[channel] / total, 0.0, 1.0);
+				}
+			}
+		}
+		return result;
+	}
+
+	// Converts a reference level to 8 bits, with the exact sRGB curve
+	std::vector<uint8_t> ReferenceEncode(const ReferenceLevel& level, uint32_t numChannels, const MipGenerator::Options& options) {
+		std::vector<uint8_t> result(level.Data.size());
+		for (size_t ix = 0; ix < level.Data.size(); ix++) {
+			double value = level.Data[ix];
+			if (IsSrgbChannel(ix % numChannels, numChannels, options)) {
+				value = value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+			}
+			result[ix] = (uint8_t)std::lround(value * 255.0);
+		}
+		return result;
+	}
+
+	// Builds the whole reference mip chain, each level is filtered from the double precision level above it
+	std::vector<std::vector<uint8_t>> ReferenceChain(const std::vector<uint8_t>& image, uint32_t width, uint32_t height, uint32_t numChannels, const MipGenerator::Options& options) {
+		ReferenceLevel level;
+		level.Width  = width;
+		level.Height = height;
+		level.Data.resize(image.size());
+		for (size_t ix = 0; ix < image.size(); ix++) {
+			double value = image[ix] / 255.0;
+			if (IsSrgbChannel(ix % numChannels, numChannels, options)) {
+				value = value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4);
+			}
+			level.Data[ix] = value;
+		}
+
+		std::vector<std::vector<uint8_t>> result;
+		while (level.Width > 1 || level.Height > 1) {
+			level = ReferenceDownsample(level, numChannels, options);
+			result.push_back(ReferenceEncode(level, numChannels, options));
+		}
+		return result;
+	}
+
+	std::vector<uint8_t> MakeNoise(uint32_t width, uint32_t height, uint32_t numChannels) {
+		std::mt19937 random(1234);
+		std::vector<uint8_t> result((size_t)width * height * numChannels);
+		for (uint8_t& value : result) {
+			value = (uint8_t)(random() & 0xFF);
+		}
+		return result;
+	}
+
+	// The largest difference between two levels, in 8 bit steps
+	int MaxDifference(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+		int result = 0;
+		for (size_t ix = 0; ix < a.size(); ix++) {
+			result = std::max(result, std::abs((int)a[ix] - (int)b[ix]));
+		}
+		return result;
+	}
+
+	// The number of values in a level that differ from the reference
+	size_t CountDifferent(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+		size_t result = 0;
+		for (size_t ix = 0; ix < a.size(); ix++) {
+			result += a[ix] != b[ix];
+		}
+		return result;
+	}
+
+	// Generates a mip chain and checks every level against the reference, returning the largest difference
+	int CheckAgainstReference(const char* label, const std::vector<uint8_t>& image, uint32_t width, uint32_t height, uint32_t numChannels, const MipGenerator::Options& options) {
+		std::vector<MipGenerator::Level> levels = MipGenerator::Generate(image.data(), width, height, numChannels, options);
+		std::vector<std::vector<uint8_t>> reference = ReferenceChain(image, width, height, numChannels, options);
+
+		CHECK(levels.size() == MipGenerator::CalcLevelCount(width, height) - 1);
+		CHECK(levels.size() == reference.size());
+		int result = 0;
+		uint32_t expectedWidth = width;
+		uint32_t expectedHeight = height;
+		for (size_t ix = 0; ix < levels.size(); ix++) {
+			expectedWidth  = std::max(expectedWidth / 2, 1u);
+			expectedHeight = std::max(expectedHeight / 2, 1u);
+			CHECK(levels[ix].Width == expectedWidth);
+			CHECK(levels[ix].Height == expectedHeight);
+			CHECK(levels[ix].Data.size() == reference[ix].size());
+			result = std::max(result, MaxDifference(levels[ix].Data, reference[ix]));
+		}
+		LOG_INFO("  {}: {} levels, largest difference from the reference {}", label, levels.size(), result);
+		return result;
+	}
+}
+
+TEST_CASE(MipGenerator, BoxMatchesReference) {
+	MipGenerator::Options options;
+	options.Filter = MipFilter::Box;
+
+	// Even RGBA sizes take the SSE2 path, the rest go through the separable filters
+	std::vector<uint8_t> image = MakeNoise(64, 32, 4);
+	CHECK(CheckAgainstReference("64x32 RGBA", image, 64, 32, 4, options) <= 1);
+
+	image = MakeNoise(37, 23, 3);
+	CHECK(CheckAgainstReference("37x23 RGB", image, 37, 23, 3, options) <= 1);
+
+	image = MakeNoise(16, 1, 1);
+	CHECK(CheckAgainstReference("16x1 R", image, 16, 1, 1, options) <= 1);
+
+	// sRGB color is averaged in linear space, the alpha channel is not. The table used to encode sRGB is
+	// slightly coarser than the exact curve near black, so we allow an extra step
+	options.IsSrgb = true;
+	image = MakeNoise(64, 64, 4);
+	CHECK(CheckAgainstReference("64x64 sRGB RGBA", image, 64, 64, 4, options) <= 2);
+
+	image = MakeNoise(19, 40, 2);
+	CHECK(CheckAgainstReference("19x40 sRGB RG", image, 19, 40, 2, options) <= 2);
+}
+
+TEST_CASE(MipGenerator, KaiserMatchesReference) {
+	MipGenerator::Options options;
+	options.Filter = MipFilter::Kaiser;
+
+	std::vector<uint8_t> image = MakeNoise(32, 32, 4);
+	CHECK(CheckAgainstReference("32x32 RGBA, clamped", image, 32, 32, 4, options) <= 1);
+
+	// Wrapping pulls the taps past each edge from the opposite side of the image
+	options.WrapX = true;
+	options.WrapY = true;
+	CHECK(CheckAgainstReference("32x32 RGBA, wrapped", image, 32, 32, 4, options) <= 1);
+
+	options.WrapY = false;
+	options.IsSrgb = true;
+	image = MakeNoise(45, 17, 3);
+	CHECK(CheckAgainstReference("45x17 sRGB RGB, wrapped along x", image, 45, 17, 3, options) <= 2);
+}
+
+TEST_CASE(MipGenerator, FlatStaysFlat) {
+	// Normalized weights must keep a flat image flat on every level, even with the Kaiser filter's negative lobes
+	for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser }) {
+		for (bool isSrgb : { false, true }) {
+			MipGenerator::Options options;
+			options.Filter = filter;
+			options.IsSrgb = isSrgb;
+
+			const uint8_t texel[4] = { 10, 128, 200, 255 };
+			std::vector<uint8_t> image;
+			for (int ix = 0; ix < 33 * 20; ix++) {
+				image.insert(image.end(), texel, texel + 4);
+			}
+			for (const MipGenerator::Level& level : MipGenerator::Generate(image.data(), 33, 20, 4, options)) {
+				for (size_t ix = 0; ix < level.Data.size(); ix++) {
+					CHECK(level.Data[ix] == texel[ix % 4]);
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE(MipGenerator, ChainDoesNotDrift) {
+	MipGenerator::Options options;
+	options.Filter = MipFilter::Kaiser;
+	options.IsSrgb = true;
+
+	// Filtering each level from the rounded level above it lets the rounding build up down the chain, the
+	// float chain must stay closer to the reference than that does
+	const uint32_t size = 256;
+	std::vector<uint8_t> image = MakeNoise(size, size, 4);
+	std::vector<std::vector<uint8_t>> reference = ReferenceChain(image, size, size, 4, options);
+	std::vector<MipGenerator::Level> levels = MipGenerator::Generate(image.data(), size, size, 4, options);
+	CHECK(levels.size() == reference.size());
+
+	std::vector<uint8_t> level = image;
+	uint32_t width = size;
+	uint32_t height = size;
+	size_t total = 0;
+	size_t generated = 0;
+	size_t chained = 0;
+	int largest = 0;
+	for (size_t ix = 0; ix < reference.size(); ix++) {
+		MipGenerator::Level next = MipGenerator::Downsample(level.data(), width, height, 4, options);
+		total += reference[ix].size();
+		generated += CountDifferent(levels[ix].Data, reference[ix]);
+		chained += CountDifferent(next.Data, reference[ix]);
+		largest = std::max(largest, MaxDifference(levels[ix].Data, reference[ix]));
+		level = next.Data;
+		width = next.Width;
+		height = next.Height;
+	}
+	LOG_INFO("  {}x{} sRGB RGBA, values that differ from the reference: {} of {} from the float chain, {} when every level is rounded to 8 bits",
+		size, size, generated, total, chained);
+
+	CHECK(largest <= 2);
+	CHECK(generated < chained);
+}
@@ -0,0 +1,265 @@
+#include "Tests/TestRegistry.h"
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <unordered_map>
+
+#include "Utils/ObjParser.h"
+#include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+
+namespace {
+	/// <summary>
+	/// The iostream based parsing that ObjLoader and OptimizedObjLoader used before ObjParser, kept
+	/// here so that we have something to time against. Note that it does not handle the v//n face form,
+	/// so it's output is only comparable for files with UVs. It also packs each index into 21 bits when
+	/// de-duplicating, so files with more than 2^21 of any attribute alias vertices together
+	/// </summary>
+	void ParseWithStreams(const std::string& filename, ObjParser::Result& result) {
+		std::ifstream file;
+		file.open(filename, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("Failed to open file");
+		}
+
+		result.Clear();
+		std::unordered_map<uint64_t, uint32_t> vertexMap;
+
+		std::string line;
+		glm::vec3 vecData;
+		glm::ivec3 vertexIndices;
+
+		while (file.peek() != EOF) {
+			std::string command;
+			file >> command;
+
+			if (command == "#") {
+				std::getline(file, line);
+			}
+			else if (command == "v") {
+				file >> vecData.x >> vecData.y >> vecData.z;
+				result.Positions.push_back(vecData);
+			}
+			else if (command == "vn") {
+				file >> vecData.x >> vecData.y >> vecData.z;
+				result.Normals.push_back(vecData);
+			}
+			else if (command == "vt") {
+				file >> vecData.x >> vecData.y;
+				result.UVs.push_back(glm::vec2(vecData));
+			}
+			else if (command == "f") {
+				std::getline(file, line);
+				StringTools::Trim(line);
+				std::stringstream stream = std::stringstream(line);
+
+				uint32_t edges[4];
+				int ix = 0;
+				for (; ix < 4; ix++) {
+					if (stream.peek() == EOF) {
+						break;
+					}
+					char tempChar;
+					vertexIndices = glm::ivec3(0);
+					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
+
+					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
+					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
+
+					auto it = vertexMap.find(key);
+					if (it != vertexMap.end()) {
+						edges[ix] = it->second;
+					} else {
+						result.Vertices.push_back(vertexIndices - glm::ivec3(1));
+						edges[ix] = static_cast<uint32_t>(result.Vertices.size()) - 1;
+						vertexMap[key] = edges[ix];
+					}
+				}
+
+				if (ix >= 3) {
+					result.Indices.push_back(edges[0]);
+					result.Indices.push_back(edges[1]);
+					result.Indices.push_back(edges[2]);
+				}
+				if (ix == 4) {
+					result.Indices.push_back(edges[0]);
+					result.Indices.push_back(edges[2]);
+					result.Indices.push_back(edges[3]);
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Writes a grid of quads, split into triangles, with the given number of faces to an OBJ file
+	/// </summary>
+	void WriteSyntheticObj(const std::string& filename, uint32_t faceCount) {
+		const uint32_t quadsPerRow = 1000;
+		const uint32_t rows = (faceCount / 2 + quadsPerRow - 1) / quadsPerRow;
+		const uint32_t columns = quadsPerRow + 1;
+
+		std::ofstream file(filename, std::ios::binary);
+		file << "# Synthetic " << faceCount << " face grid for the ObjParser benchmarks\n";
+		for (uint32_t y = 0; y <= rows; y++) {
+			for (uint32_t x = 0; x < columns; x++) {
+				file << "v " << x * 0.01f << " 0.0 " << y * 0.01f << "\n";
+				file << "vt " << x / (float)quadsPerRow << " " << y / (float)rows << "\n";
+			}
+		}
+		file << "vn 0.0 1.0 0.0\n";
+
+		uint32_t written = 0;
+		for (uint32_t y = 0; y < rows && written < faceCount; y++) {
+			for (uint32_t x = 0; x < quadsPerRow && written < faceCount; x++) {
+				uint32_t a = y * columns + x + 1;
+				uint32_t b = a + 1;
+				uint32_t c = a + columns;
+				uint32_t d = c + 1;
+				file << "f " << a << "/" << a << "/1 " << b << "/" << b << "/1 " << d << "/" << d << "/1\n";
+				file << "f " << a << "/" << a << "/1 " << d << "/" << d << "/1 " << c << "/" << c << "/1\n";
+				written += 2;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Times the old iostream parsing against ObjParser on one and all threads for a file
+	/// </summary>
+	void CompareParsers(const std::string& filename, int iterations) {
+		ObjParser::Result streams;
+		ObjParser::Result single;
+		ObjParser::Result threaded;
+
+		LOG_INFO("  {} ({:.1f} MB)", filename, std::filesystem::file_size(filename) / (1024.0 * 1024.0));
+		double oldTime = TestRegistry::Measure("iostream", iterations, [&]() { ParseWithStreams(filename, streams); });
+		double newTime = TestRegistry::Measure("ObjParser, 1 thread", iterations, [&]() { ObjParser::ParseFile(filename, single, 1); });
+		double threadedTime = TestRegistry::Measure("ObjParser, all threads", iterations, [&]() { ObjParser::ParseFile(filename, threaded, 0); });
+		LOG_INFO("    speedup {:.1f}x on 1 thread, {:.1f}x on all threads", oldTime / newTime, oldTime / threadedTime);
+
+		CHECK(threaded.Indices == single.Indices);
+		CHECK(threaded.Vertices == single.Vertices);
+	}
+}
+
+TEST_CASE(ObjParser, ChunkedMatchesSingleThread) {
+	ObjParser::Result single;
+	ObjParser::Result chunked;
+	CHECK(ObjParser::ParseFile("test.obj", single, 1));
+	CHECK(ObjParser::ParseFile("test.obj", chunked, 4));
+
+	CHECK(single.Indices.size() == 34701 * 3);
+	CHECK(chunked.Positions == single.Positions);
+	CHECK(chunked.Normals == single.Normals);
+	CHECK(chunked.Vertices == single.Vertices);
+	CHECK(chunked.Indices == single.Indices);
+}
+
+TEST_CASE(ObjParser, PoolWorkersParseInline) {
+	ObjParser::Result single;
+	CHECK(ObjParser::ParseFile("test.obj", single, 1));
+
+	// Asking for every hardware thread from a pool job falls back to parsing on the worker
+	ThreadPool pool(1);
+	ObjParser::Result pooled;
+	bool onWorker = pool.Submit([&]() {
+		ObjParser::ParseFile("test.obj", pooled, 0);
+		return ThreadPool::IsWorkerThread();
+	}).get();
+
+	CHECK(onWorker);
+	CHECK(!ThreadPool::IsWorkerThread());
+	CHECK(pooled.Vertices == single.Vertices);
+	CHECK(pooled.Indices == single.Indices);
+}
+
+TEST_CASE(ObjParser, RejectsMissingAttributes) {
+	const std::string header = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\n";
+	ObjParser::Result result;
+
+	// Omitted UVs and normals, and relative indices that land inside the file are fine
+	const std::string valid = header + "f 1/1/1 2/1/1 3/1/1\nf -3//1 -2//1 -1//1\nf 1 2 3\n";
+	CHECK(ObjParser::Parse(valid.data(), valid.data() + valid.size(), result));
+	CHECK(result.Indices.size() == 9);
+
+	for (const std::string& invalid : {
+		header + "f /1/1 2/1/1 3/1/1\n",  // Missing position
+		header + "f 0 1 2\n",             // Indices start at 1
+		header + "f 1 2 4\n",             // Position past the end
+		header + "f 1/2 2/1 3/1\n",       // UV past the end
+		header + "f 1//1 2//1 3//2\n",    // Normal past the end
+		header + "f -4 -2 -1\n",          // Relative index before the start
+		"f -1 -2 -3\n" + header }) {     // Relative indices are resolved against the attributes before the face
+		result.Positions.push_back(glm::vec3(0.0f));
+		CHECK(!ObjParser::Parse(invalid.data(), invalid.data() + invalid.size(), result));
+		CHECK(result.Positions.empty());
+		CHECK(result.Vertices.empty());
+		CHECK(result.Indices.empty());
+	}
+
+	// A bad face in a later chunk of a large file still rejects the whole file
+	std::ifstream file("test.obj", std::ios::binary);
+	std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	CHECK(!data.empty());
+	data += "\nf 1 2 999999999\n";
+	CHECK(!ObjParser::Parse(data.data(), data.data() + data.size(), result, 4));
+	CHECK(result.Vertices.empty());
+}
+
+TEST_CASE(ObjParser, IndicesAbove21Bits) {
+	// Enough positions and normals that some indices need more than 21 bits, the old parser packed
+	// each index into 21 bits of a 64 bit key and would merge 1 with 2^21 + 1
+	const size_t count = (1 << 21) + 2;
+	std::string data;
+	data.reserve(count * 20);
+	for (size_t ix = 0; ix < count; ix++) {
+		data += "v " + std::to_string(ix) + " 0 0\n";
+	}
+	for (size_t ix = 0; ix < count; ix++) {
+		data += "vn 0 0 1\n";
+	}
+
+	// Every corner of the second face aliases a corner of the first under a 21 bit mask
+	const int high = (1 << 21) + 1;
+	const std::string a = std::to_string(high);
+	const std::string b = std::to_string(high + 1);
+	data += "f 1//1 2//2 3//3\n";
+	data += "f " + a + "//" + a + " " + b + "//" + b + " 1//" + a + "\n";
+	// The same corners again, which must be merged with the first two faces
+	data += "f 3//3 " + b + "//" + b + " 1//" + a + "\n";
+
+	for (uint32_t threadCount : { 1u, 4u }) {
+		ObjParser::Result result;
+		CHECK(ObjParser::Parse(data.data(), data.data() + data.size(), result, threadCount));
+		CHECK(result.Positions.size() == count);
+		CHECK(result.Normals.size() == count);
+
+		CHECK(result.Vertices.size() == 6);
+		CHECK(result.Vertices[0] == glm::ivec3(0, -1, 0));
+		CHECK(result.Vertices[3] == glm::ivec3(high - 1, -1, high - 1));
+		CHECK(result.Vertices[4] == glm::ivec3(high, -1, high));
+		CHECK(result.Vertices[5] == glm::ivec3(0, -1, high - 1));
+		CHECK(result.Positions[result.Vertices[4].x].x == static_cast<float>(high));
+		CHECK(result.Indices == std::vector<uint32_t>({ 0, 1, 2, 3, 4, 5, 2, 4, 5 }));
+	}
+}
+
+BENCHMARK_CASE(ObjParser, SampleMeshes) {
+	CompareParsers("monkey.obj", 20);
+	CompareParsers("test.obj", 20);
+}
+
+BENCHMARK_CASE(ObjParser, TenMillionFaces) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "objparser-bench-10m.obj";
+	WriteSyntheticObj(path.string(), 10'000'000);
+	try {
+		CompareParsers(path.string(), 1);
+	}
+	catch (...) {
+		std::filesystem::remove(path);
+		throw;
+	}
+	std::filesystem::remove(path);
+}
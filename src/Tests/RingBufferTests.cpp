@@ -0,0 +1,119 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+
+#include "Graphics/Buffers/RingBufferLayout.h"
+
+namespace {
+	// Checks that every region starts on the alignment, and that the regions fit in the buffer without overlapping
+	void CheckRegions(RingBufferLayout layout, uint32_t alignment) {
+		while (layout.GetFrame() != 0) {
+			layout.Advance();
+		}
+		for (uint32_t frame = 0; frame < layout.GetFrameCount(); frame++) {
+			CHECK(layout.GetFrame() == frame);
+			CHECK(layout.GetFrameOffset() == frame * layout.GetCapacity());
+			CHECK(layout.GetFrameByteOffset() == (uint64_t)layout.GetFrameOffset() * layout.GetElementSize());
+			CHECK(layout.GetFrameByteOffset() % alignment == 0);
+			CHECK((uint64_t)layout.GetFrameOffset() + layout.GetCapacity() <= layout.GetElementCount());
+			layout.Advance();
+		}
+		CHECK(layout.GetFrame() == 0);
+	}
+}
+
+TEST_CASE(RingBuffer, OffsetsAndWrap) {
+	// The same layout as the render layer's instance buffer, 112 bytes of instance data per draw
+	RingBufferLayout layout(112, 1024, 3);
+	CHECK(layout.GetCapacity() == 1024);
+	CHECK(layout.GetElementCount() == 3 * 1024);
+	CheckRegions(layout, 1);
+
+	// Each frame moves on to the next region, and wraps around to the first after the last
+	const uint32_t expected[] = { 0, 1024, 2048, 0, 1024, 2048, 0 };
+	for (uint32_t offset : expected) {
+		CHECK(!layout.Reserve(1000));
+		CHECK(layout.GetFrameOffset() == offset);
+		CHECK(layout.GetFrameByteOffset() == offset * 112ull);
+		layout.Advance();
+	}
+
+	// A frame that fits doesn't change anything, even if it fills the region exactly
+	CHECK(layout.GetFrame() == 1);
+	CHECK(!layout.Reserve(1024));
+	CHECK(!layout.Reserve(0));
+	CHECK(layout.GetFrame() == 1);
+	CHECK(layout.GetCapacity() == 1024);
+
+	// Growing at least doubles the capacity, and starts over on the first region of the new buffer
+	CHECK(layout.Reserve(1025));
+	CHECK(layout.GetCapacity() == 2048);
+	CHECK(layout.GetFrame() == 0);
+	CHECK(layout.GetFrameOffset() == 0);
+	CheckRegions(layout, 1);
+
+	// Unless the frame needs even more than that
+	CHECK(layout.Reserve(10000));
+	CHECK(layout.GetCapacity() == 10000);
+	CHECK(layout.GetElementCount() == 30000);
+	CheckRegions(layout, 1);
+
+	// A capacity of 0 would put every region at the same offset
+	CHECK(RingBufferLayout(16, 0, 3).GetCapacity() == 1);
+}
+
+TEST_CASE(RingBuffer, Alignment) {
+	// 112 and 256 share a factor of 16, so regions must hold a multiple of 256 / 16 = 16 elements
+	RingBufferLayout layout(112, 10, 3, 256);
+	CHECK(layout.GetCapacity() == 16);
+	CHECK(layout.GetElementCount() == 48);
+	CheckRegions(layout, 256);
+
+	// Growing keeps the regions aligned
+	CHECK(layout.Reserve(17));
+	CHECK(layout.GetCapacity() == 32);
+	CheckRegions(layout, 256);
+	CHECK(layout.Reserve(100));
+	CHECK(layout.GetCapacity() == 112);
+	CheckRegions(layout, 256);
+
+	// Elements that are already a multiple of the alignment don't need any rounding
+	CHECK(RingBufferLayout(64, 10, 3, 16).GetCapacity() == 10);
+	// And elements with no factors in common with the alignment need a full alignment's worth
+	CHECK(RingBufferLayout(3, 10, 3, 64).GetCapacity() == 64);
+
+	// Every combination rounds up to the smallest aligned capacity
+	std::mt19937 random(1234);
+	for (uint32_t alignment : { 1u, 2u, 4u, 16u, 48u, 64u, 256u }) {
+		for (uint32_t elementSize = 1; elementSize <= 160; elementSize++) {
+			const uint32_t capacity = 1 + random() % 2000;
+			RingBufferLayout aligned(elementSize, capacity, 3, alignment);
+			CHECK(aligned.GetCapacity() >= capacity);
+			CHECK(aligned.GetCapacity() - capacity < alignment);
+			CheckRegions(aligned, alignment);
+			for (uint32_t smaller = capacity; smaller < aligned.GetCapacity(); smaller++) {
+				CHECK((uint64_t)smaller * elementSize % alignment != 0);
+			}
+
+			const uint32_t grown = aligned.GetCapacity() + 1 + random() % 5000;
+			CHECK(aligned.Reserve(grown));
+			CHECK(aligned.GetCapacity() >= grown);
+			CheckRegions(aligned, alignment);
+		}
+	}
+}
+
+TEST_CASE(RingBuffer, LargeCapacity) {
+	// 3 regions of 2^30 elements just fit in 32 bit element indices, but doubling them would not
+	RingBufferLayout layout(4, 1u << 30, 3);
+	CHECK(layout.GetElementCount() == 3u << 30);
+	CHECK(layout.Reserve((1u << 30) + 1));
+	CHECK(layout.GetCapacity() == (1u << 30) + 1);
+	CHECK(layout.GetElementCount() == 3 * ((1u << 30) + 1));
+
+	layout.Advance();
+	layout.Advance();
+	CHECK(layout.GetFrameOffset() == 2 * ((1u << 30) + 1));
+	CHECK(layout.GetFrameByteOffset() == 8ull * ((1u << 30) + 1));
+	CheckRegions(layout, 1);
+}
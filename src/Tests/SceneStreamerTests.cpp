@@ -0,0 +1,281 @@
+#include "Tests/TestRegistry.h"
+
+#include <filesystem>
+#include <functional>
+
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/SceneStreamer.h"
+#include "Gameplay/GameObject.h"
+#include "Gameplay/Components/Camera.h"
+#include "Gameplay/Components/JumpBehaviour.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+#include "Utils/FileHelpers.h"
+
+#ifdef WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <fstream>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
+namespace {
+	/// <summary>
+	/// The memory used by the process, in bytes
+	/// </summary>
+	struct MemoryUsage {
+		size_t Current = 0;
+		// The most the process has used since it started
+		size_t Peak    = 0;
+	};
+
+	/// <summary>
+	/// Gets the current and peak working set of the process, or zeros if they can't be read
+	/// </summary>
+	MemoryUsage GetMemoryUsage() {
+		MemoryUsage result;
+		#ifdef WINDOWS
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			result.Current = counters.WorkingSetSize;
+			result.Peak    = counters.PeakWorkingSetSize;
+		}
+		#else
+		size_t pages = 0;
+		std::ifstream statm("/proc/self/statm");
+		if (statm >> pages >> pages) {
+			result.Current = pages * (size_t)sysconf(_SC_PAGESIZE);
+		}
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0) {
+			result.Peak = (size_t)usage.ru_maxrss * 1024;
+		}
+		#endif
+		return result;
+	}
+
+	double ToMegabytes(size_t bytes) {
+		return bytes / (1024.0 * 1024.0);
+	}
+
+	/// <summary>
+	/// Loads a scene once while watching the process's memory, and logs how far the peak rose above
+	/// the memory in use before the load. The peak can't be reset, so if an earlier test already went
+	/// higher we can only log an upper bound
+	/// </summary>
+	Gameplay::Scene::Sptr LoadAndMeasureMemory(const std::string& label, const std::function<Gameplay::Scene::Sptr()>& load) {
+		MemoryUsage before = GetMemoryUsage();
+		Gameplay::Scene::Sptr scene = load();
+		MemoryUsage after = GetMemoryUsage();
+
+		if (after.Peak > before.Peak) {
+			LOG_INFO("    {:<48} peak {:>8.1f} MB above the starting working set, {:.1f} MB retained", label,
+				ToMegabytes(after.Peak - before.Current), ToMegabytes(after.Current - std::min(after.Current, before.Current)));
+		} else {
+			LOG_INFO("    {:<48} peak at most {:>5.1f} MB above the starting working set, {:.1f} MB retained", label,
+				ToMegabytes(before.Peak - before.Current), ToMegabytes(after.Current - std::min(after.Current, before.Current)));
+		}
+		return scene;
+	}
+}
+
+TEST_CASE(SceneStreamer, ConvertedJsonMatchesFromJson) {
+	using namespace Gameplay;
+
+	const std::filesystem::path tempDir = std::filesystem::temp_directory_path();
+	const std::string jsonPath   = (tempDir / "scenestreamer-test.json").string();
+	const std::string binaryPath = (tempDir / (std::string("scenestreamer-test") + SceneStreamer::FILE_EXTENSION)).string();
+	{
+		Scene::Sptr scene = std::make_shared<Scene>();
+		scene->SetAmbientLight(glm::vec3(0.1f, 0.2f, 0.3f));
+		scene->SetSkyboxRotation(glm::mat3_cast(glm::angleAxis(glm::radians(30.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+		for (int ix = 0; ix < 3; ix++) {
+			Light light;
+			light.Position = glm::vec3(ix, ix * 2.0f, -ix);
+			light.Color = glm::vec3(1.0f, 0.5f, ix * 0.25f);
+			light.Range = 10.0f + ix;
+			scene->Lights.push_back(light);
+		}
+
+		GameObject::Sptr camera = scene->CreateGameObject("Main Camera");
+		camera->SetPostion(glm::vec3(0.0f, 5.0f, 10.0f));
+		scene->MainCamera = camera->Add<Camera>();
+
+		// Chains of objects with a mix of components, some sharing names and some hidden
+		GameObject::Sptr parent = nullptr;
+		for (int ix = 0; ix < 40; ix++) {
+			GameObject::Sptr object = scene->CreateGameObject("Object " + std::to_string(ix / 2));
+			object->SetPostion(glm::vec3(ix, 0.0f, 0.0f));
+			object->SetScale(glm::vec3(1.0f + ix * 0.1f));
+			object->HideInHierarchy = ix % 7 == 0;
+			if (ix % 2 == 0) {
+				object->Add<RotatingBehaviour>()->RotationSpeed = glm::vec3(0.0f, 0.0f, ix * 10.0f);
+			}
+			if (ix % 3 == 0) {
+				object->Add<JumpBehaviour>();
+			}
+			if (ix % 5 != 0) {
+				parent->AddChild(object);
+			}
+			parent = object;
+		}
+
+		// A child that comes before it's parent in the file, so the parent must be linked up later
+		GameObject::Sptr child = scene->CreateGameObject("Early Child");
+		GameObject::Sptr lateParent = scene->CreateGameObject("Late Parent");
+		lateParent->AddChild(child);
+		scene->Save(jsonPath);
+	}
+
+	Scene::Sptr expected;
+	Scene::Sptr streamed;
+	bool converted = false;
+	try {
+		expected = Scene::FromJson(nlohmann::json::parse(FileHelpers::ReadFile(jsonPath)));
+		converted = SceneStreamer::ConvertToBinary(jsonPath, binaryPath);
+		SceneStreamer::Sptr streamer = converted ? SceneStreamer::Open(binaryPath) : nullptr;
+		if (streamer != nullptr) {
+			// A tiny budget, so that the objects are spread over many steps
+			while (!streamer->Step(0.0)) { }
+			streamed = streamer->Finish();
+		}
+	}
+	catch (...) {
+		std::filesystem::remove(jsonPath);
+		std::filesystem::remove(binaryPath);
+		throw;
+	}
+	std::filesystem::remove(jsonPath);
+	std::filesystem::remove(binaryPath);
+
+	CHECK(converted);
+	CHECK(streamed != nullptr);
+	CHECK(expected->NumObjects() == 43);
+	CHECK(streamed->NumObjects() == expected->NumObjects());
+
+	// Objects may be reordered so that parents come first, so match them up by GUID
+	for (int ix = 0; ix < expected->NumObjects(); ix++) {
+		GameObject::Sptr object = expected->GetObjectByIndex(ix);
+		GameObject::Sptr loaded = streamed->FindObjectByGUID(object->GetGUID());
+		CHECK(loaded != nullptr);
+
+		const nlohmann::json objectJson = object->ToJson();
+		const nlohmann::json loadedJson = loaded->ToJson();
+		CHECK(loaded->GetName() == object->GetName());
+		CHECK(loaded->HideInHierarchy == object->HideInHierarchy);
+		CHECK((loaded->GetParent() == nullptr) == (object->GetParent() == nullptr));
+		CHECK(loaded->GetParent() == nullptr || loaded->GetParent()->GetGUID() == object->GetParent()->GetGUID());
+		CHECK(loaded->GetChildren().size() == object->GetChildren().size());
+		CHECK(loaded->GetPosition() == object->GetPosition());
+		CHECK(loaded->GetRotation() == object->GetRotation());
+		CHECK(loaded->GetScale() == object->GetScale());
+		CHECK(loadedJson["components"].size() == objectJson["components"].size());
+		CHECK(loadedJson["components"] == objectJson["components"]);
+	}
+	CHECK(streamed->FindObjectByName("Early Child")->GetParent() == streamed->FindObjectByName("Late Parent"));
+
+	CHECK(streamed->MainCamera != nullptr);
+	CHECK(streamed->MainCamera->GetGUID() == expected->MainCamera->GetGUID());
+
+	CHECK(streamed->Lights.size() == expected->Lights.size());
+	for (size_t ix = 0; ix < expected->Lights.size(); ix++) {
+		CHECK(streamed->Lights[ix].Position == expected->Lights[ix].Position);
+		CHECK(streamed->Lights[ix].Color == expected->Lights[ix].Color);
+		CHECK(streamed->Lights[ix].Range == expected->Lights[ix].Range);
+	}
+
+	CHECK(streamed->GetAmbientLight() == expected->GetAmbientLight());
+	CHECK(streamed->GetSkyboxRotation() == expected->GetSkyboxRotation());
+	CHECK(streamed->GetSkyboxShader() == expected->GetSkyboxShader());
+	CHECK(streamed->GetSkyboxTexture() == expected->GetSkyboxTexture());
+	CHECK(streamed->ToJson()["skybox"] == expected->ToJson()["skybox"]);
+}
+
+BENCHMARK_CASE(SceneStreamer, BinaryVsJson) {
+	using namespace Gameplay;
+
+	// A 50k object scene, in chains of 20 so that both formats need to resolve parents
+	const int count = 50000;
+	const std::filesystem::path tempDir = std::filesystem::temp_directory_path();
+	const std::string jsonPath   = (tempDir / "scenestreamer-bench.json").string();
+	const std::string binaryPath = (tempDir / (std::string("scenestreamer-bench") + SceneStreamer::FILE_EXTENSION)).string();
+	{
+		Scene::Sptr scene = std::make_shared<Scene>();
+		GameObject::Sptr parent = nullptr;
+		for (int ix = 0; ix < count; ix++) {
+			GameObject::Sptr object = scene->CreateGameObject("Object " + std::to_string(ix));
+			object->Add<RotatingBehaviour>();
+			if (ix % 20 != 0) {
+				parent->AddChild(object);
+			}
+			parent = object;
+		}
+		scene->Save(jsonPath);
+		scene->Save(binaryPath);
+	}
+	LOG_INFO("  {} objects, JSON {:.1f} MB, binary {:.1f} MB", count, ToMegabytes(std::filesystem::file_size(jsonPath)), ToMegabytes(std::filesystem::file_size(binaryPath)));
+
+	try {
+		// The smaller loads go first, so that the JSON load's peak isn't hidden behind theirs
+		auto stream = [&]() {
+			SceneStreamer::Sptr streamer = SceneStreamer::Open(binaryPath);
+			CHECK(streamer != nullptr);
+			while (!streamer->Step()) { }
+			return streamer->Finish();
+		};
+		Scene::Sptr binary   = LoadAndMeasureMemory("binary, Scene::Load", [&]() { return Scene::Load(binaryPath); });
+		binary = nullptr;
+		Scene::Sptr streamed = LoadAndMeasureMemory("binary, streamed", stream);
+		streamed = nullptr;
+		Scene::Sptr json     = LoadAndMeasureMemory("JSON, Scene::Load", [&]() { return Scene::Load(jsonPath); });
+		json = nullptr;
+
+		// Keep the loaded scenes alive until we're done timing, so that their destruction isn't timed
+		std::vector<Scene::Sptr> loaded;
+		double jsonTime = TestRegistry::Measure("JSON, Scene::Load", 3, [&]() { loaded.push_back(Scene::Load(jsonPath)); });
+		const int jsonObjects = loaded.back()->NumObjects();
+		loaded.clear();
+		double binaryTime = TestRegistry::Measure("binary, Scene::Load", 3, [&]() { loaded.push_back(Scene::Load(binaryPath)); });
+		const int binaryObjects = loaded.back()->NumObjects();
+		loaded.clear();
+
+		// Streaming spreads the load over frames, the longest step is what a frame would see
+		int frames = 0;
+		double longestStep = 0.0;
+		double streamTime = TestRegistry::Measure("binary, streamed with a 4 ms budget", 3, [&]() {
+			SceneStreamer::Sptr streamer = SceneStreamer::Open(binaryPath);
+			CHECK(streamer != nullptr);
+			frames = 0;
+			longestStep = 0.0;
+			bool complete = false;
+			while (!complete) {
+				auto start = std::chrono::high_resolution_clock::now();
+				complete = streamer->Step(0.004);
+				longestStep = std::max(longestStep, std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+				frames++;
+			}
+			loaded.push_back(streamer->Finish());
+		});
+		const int streamedObjects = loaded.back()->NumObjects();
+		loaded.clear();
+
+		LOG_INFO("    binary is {:.1f}x faster than JSON, streaming took {} frames ({:.1f}x slower in total) with a longest step of {:.1f} ms",
+			jsonTime / binaryTime, frames, streamTime / binaryTime, longestStep);
+
+		CHECK(jsonObjects == count + 1);
+		CHECK(binaryObjects == jsonObjects);
+		CHECK(streamedObjects == jsonObjects);
+	}
+	catch (...) {
+		std::filesystem::remove(jsonPath);
+		std::filesystem::remove(binaryPath);
+		throw;
+	}
+	std::filesystem::remove(jsonPath);
+	std::filesystem::remove(binaryPath);
+}
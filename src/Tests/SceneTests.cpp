@@ -0,0 +1,329 @@
+#include "Tests/TestRegistry.h"
+
+#include <random>
+#include <chrono>
+#include <unordered_set>
+#include <unordered_map>
+
+#include <GLM/gtc/matrix_transform.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Gameplay/Scene.h"
+#include "Gameplay/GameObject.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+
+namespace {
+	/// <summary>
+	/// Creates a scene with the given number of uniquely named objects, each with a RotatingBehaviour.
+	/// The objects are arranged in chains of the given depth, so that loading has parent references
+	/// to resolve
+	/// </summary>
+	Gameplay::Scene::Sptr MakeLargeScene(int count, int depth) {
+		Gameplay::Scene::Sptr scene = std::make_shared<Gameplay::Scene>();
+		Gameplay::GameObject::Sptr parent = nullptr;
+		for (int ix = 0; ix < count; ix++) {
+			Gameplay::GameObject::Sptr object = scene->CreateGameObject("Object " + std::to_string(ix));
+			object->Add<RotatingBehaviour>();
+			if (ix % depth != 0) {
+				parent->AddChild(object);
+			}
+			parent = object;
+		}
+		return scene;
+	}
+
+	/// <summary>
+	/// Checks that two matrices are equal to within a tolerance
+	/// </summary>
+	template <typename Matrix>
+	bool MatricesNear(const Matrix& a, const Matrix& b, float epsilon) {
+		for (int col = 0; col < Matrix::length(); col++) {
+			for (int row = 0; row < Matrix::col_type::length(); row++) {
+				if (std::abs(a[col][row] - b[col][row]) > epsilon) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+TEST_CASE(Scene, DestroyHalf) {
+	using namespace Gameplay;
+	using Clock = std::chrono::high_resolution_clock;
+
+	// Objects share their names in pairs, so that every name keeps one of it's objects
+	const int count = 100000;
+	Scene::Sptr scene = std::make_shared<Scene>();
+	std::vector<GameObject::Sptr> kept;
+	std::vector<GameObject::Sptr> removed;
+	for (int ix = 0; ix < count; ix++) {
+		GameObject::Sptr object = scene->CreateGameObject("Object " + std::to_string(ix / 2));
+		object->Add<RotatingBehaviour>();
+		(ix % 2 == 0 ? kept : removed).push_back(object);
+	}
+	const int objectsBefore = scene->NumObjects();
+
+	// Queue every other object for deletion, and drop our references so that the flush destroys them
+	std::vector<std::weak_ptr<GameObject>> removedRefs;
+	std::vector<Guid> removedGuids;
+	std::vector<Guid> removedComponentGuids;
+	for (const GameObject::Sptr& object : removed) {
+		removedRefs.push_back(object);
+		removedGuids.push_back(object->GetGUID());
+		removedComponentGuids.push_back(object->Get<RotatingBehaviour>()->GetGUID());
+		scene->RemoveGameObject(object);
+	}
+	removed.clear();
+
+	Clock::time_point start = Clock::now();
+	scene->Update(0.0f);
+	double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	LOG_INFO("  Destroyed {} of {} objects in {:.1f} ms", removedGuids.size(), count, elapsed);
+
+	// Removing one object at a time shifted the rest of the list for each one, which took many seconds
+	// at this size. A single compacting pass has a lot of headroom under this, even in debug builds
+	CHECK(elapsed < 2000.0);
+
+	// The deleted objects and their components are gone, and nothing can find them anymore
+	CHECK(scene->NumObjects() == objectsBefore - (int)removedGuids.size());
+	for (size_t ix = 0; ix < removedGuids.size(); ix++) {
+		CHECK(removedRefs[ix].expired());
+		CHECK(scene->FindObjectByGUID(removedGuids[ix]) == nullptr);
+		CHECK(scene->Components().GetComponentByGUID<RotatingBehaviour>(removedComponentGuids[ix]) == nullptr);
+	}
+
+	// The remaining objects are still indexed, and are still in their original order
+	std::unordered_set<Guid> keptComponentGuids;
+	for (size_t ix = 0; ix < kept.size(); ix++) {
+		const GameObject::Sptr& object = kept[ix];
+		RotatingBehaviour::Sptr rotator = object->Get<RotatingBehaviour>();
+		keptComponentGuids.insert(rotator->GetGUID());
+
+		CHECK(scene->GetObjectByIndex(scene->NumObjects() - (int)kept.size() + (int)ix) == object);
+		CHECK(scene->FindObjectByGUID(object->GetGUID()) == object);
+		CHECK(scene->FindObjectByName(object->GetName()) == object);
+		CHECK(scene->Components().GetComponentByGUID<RotatingBehaviour>(rotator->GetGUID()) == rotator);
+	}
+
+	// The component pool only holds the surviving components
+	CHECK(scene->Components().Count<RotatingBehaviour>() == kept.size());
+	std::vector<Guid> pooled;
+	scene->Components().Each<RotatingBehaviour>([&](RotatingBehaviour* rotator) {
+		pooled.push_back(rotator->GetGUID());
+	}, true);
+	CHECK(pooled.size() == kept.size());
+	for (const Guid& guid : pooled) {
+		CHECK(keptComponentGuids.count(guid) == 1);
+	}
+}
+
+TEST_CASE(Scene, RenameKeepsSceneOrder) {
+	using namespace Gameplay;
+
+	Scene::Sptr scene = std::make_shared<Scene>();
+	GameObject::Sptr first  = scene->CreateGameObject("First");
+	GameObject::Sptr second = scene->CreateGameObject("Target");
+	GameObject::Sptr third  = scene->CreateGameObject("Third");
+	GameObject::Sptr fourth = scene->CreateGameObject("Fourth");
+	CHECK(scene->FindObjectByName("Target") == second);
+
+	// Objects renamed to a name that's already in use are found in scene order, not in the order they were renamed
+	fourth->SetName("Target");
+	first->SetName("Target");
+	CHECK(first->GetName() == "Target");
+	CHECK(scene->FindObjectByName("Target") == first);
+	CHECK(scene->FindObjectByName("First") == nullptr);
+
+	first->SetName("First");
+	CHECK(scene->FindObjectByName("Target") == second);
+	CHECK(scene->FindObjectByName("First") == first);
+
+	// Removing an object keeps the rest of the name's objects in order
+	scene->RemoveGameObject(second);
+	scene->Update(0.0f);
+	CHECK(scene->FindObjectByName("Target") == fourth);
+	third->SetName("Target");
+	CHECK(scene->FindObjectByName("Target") == third);
+	CHECK(scene->FindObjectByName("Third") == nullptr);
+}
+
+BENCHMARK_CASE(Scene, FindObjects) {
+	using namespace Gameplay;
+
+	const int count = 50000;
+	Scene::Sptr scene = MakeLargeScene(count, 20);
+
+	// Look the objects up in a random order, so we aren't just walking the object list
+	std::vector<GameObject::Sptr> objects;
+	for (int ix = 0; ix < scene->NumObjects(); ix++) {
+		objects.push_back(scene->GetObjectByIndex(ix));
+	}
+	std::shuffle(objects.begin(), objects.end(), std::mt19937(1234));
+
+	// The linear scans that the lookups used before the scene kept indices, only timed on a slice
+	// of the objects since a full pass is quadratic
+	const size_t scanCount = 500;
+	size_t found = 0;
+	LOG_INFO("  {} objects", scene->NumObjects());
+	double scanTime = TestRegistry::Measure("GUID, linear scan (500 lookups)", 5, [&]() {
+		found = 0;
+		for (size_t ix = 0; ix < scanCount; ix++) {
+			for (int jx = 0; jx < scene->NumObjects(); jx++) {
+				if (scene->GetObjectByIndex(jx)->GetGUID() == objects[ix]->GetGUID()) {
+					found++;
+					break;
+				}
+			}
+		}
+	});
+	CHECK(found == scanCount);
+
+	size_t matched = 0;
+	double guidTime = TestRegistry::Measure("FindObjectByGUID", 20, [&]() {
+		matched = 0;
+		for (const GameObject::Sptr& object : objects) {
+			matched += scene->FindObjectByGUID(object->GetGUID()) == object;
+		}
+	});
+	CHECK(matched == objects.size());
+
+	double nameTime = TestRegistry::Measure("FindObjectByName", 20, [&]() {
+		matched = 0;
+		for (const GameObject::Sptr& object : objects) {
+			matched += scene->FindObjectByName(object->GetName()) == object;
+		}
+	});
+	CHECK(matched == objects.size());
+
+	std::vector<RotatingBehaviour::Sptr> rotators;
+	for (const GameObject::Sptr& object : objects) {
+		RotatingBehaviour::Sptr rotator = object->Get<RotatingBehaviour>();
+		if (rotator != nullptr) {
+			rotators.push_back(rotator);
+		}
+	}
+	double componentTime = TestRegistry::Measure("GetComponentByGUID", 20, [&]() {
+		matched = 0;
+		for (const RotatingBehaviour::Sptr& rotator : rotators) {
+			matched += scene->Components().GetComponentByGUID<RotatingBehaviour>(rotator->GetGUID()) == rotator;
+		}
+	});
+	CHECK(matched == rotators.size());
+
+	const double toMicroseconds = 1000.0;
+	LOG_INFO("    per lookup: scan {:.3f} us, GUID {:.3f} us, name {:.3f} us, component {:.3f} us",
+		scanTime * toMicroseconds / scanCount,
+		guidTime * toMicroseconds / objects.size(),
+		nameTime * toMicroseconds / objects.size(),
+		componentTime * toMicroseconds / rotators.size());
+}
+
+BENCHMARK_CASE(Scene, DeepHierarchyTransforms) {
+	using namespace Gameplay;
+
+	const int count = 10000;
+	const int depth = 20;
+	Scene::Sptr scene = MakeLargeScene(count, depth);
+
+	// Give every object a small random offset and rotation, so errors would build up down the chains
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> angle(-30.0f, 30.0f);
+	std::vector<GameObject::Sptr> objects;
+	std::unordered_map<GameObject*, int> indices;
+	for (int ix = 0; ix < scene->NumObjects(); ix++) {
+		GameObject::Sptr object = scene->GetObjectByIndex(ix);
+		object->SetPostion(glm::vec3(offset(random), offset(random), offset(random)));
+		object->SetRotation(glm::vec3(angle(random), angle(random), angle(random)));
+		indices[object.get()] = (int)objects.size();
+		objects.push_back(object);
+	}
+
+	// The scene lists parents before their children, which lets the reference below work in one pass
+	std::vector<int> parents(objects.size(), -1);
+	for (size_t ix = 0; ix < objects.size(); ix++) {
+		GameObject::Sptr parent = objects[ix]->GetParent();
+		if (parent != nullptr) {
+			parents[ix] = indices[parent.get()];
+			CHECK(parents[ix] < (int)ix);
+		}
+	}
+
+	// Moves 5% of the objects each frame, dirtying them and everything below them
+	const size_t movedPerFrame = objects.size() / 20;
+	auto moveRandomObjects = [&]() {
+		for (size_t ix = 0; ix < movedPerFrame; ix++) {
+			objects[random() % objects.size()]->SetPostion(glm::vec3(offset(random), offset(random), offset(random)));
+		}
+	};
+
+	// What the transforms cost before the flattened pass, composing TRS and using general inverses
+	// for the inverse and normal matrices on every object
+	std::vector<glm::mat4> world(objects.size());
+	std::vector<glm::mat4> inverse(objects.size());
+	std::vector<glm::mat3> normal(objects.size());
+	auto updateReference = [&]() {
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			const GameObject::Sptr& object = objects[ix];
+			glm::mat4 local = glm::translate(glm::mat4(1.0f), object->GetPosition()) * glm::mat4_cast(object->GetRotation()) * glm::scale(glm::mat4(1.0f), object->GetScale());
+			world[ix] = parents[ix] < 0 ? local : world[parents[ix]] * local;
+			inverse[ix] = glm::inverse(world[ix]);
+			normal[ix] = glm::transpose(glm::inverse(glm::mat3(world[ix])));
+		}
+	};
+
+	LOG_INFO("  {} objects at depth {}, {} moved per frame", objects.size(), depth, movedPerFrame);
+	double oldTime = TestRegistry::Measure("TRS and glm::inverse, every object", 50, [&]() {
+		moveRandomObjects();
+		updateReference();
+	});
+	double newTime = TestRegistry::Measure("Scene::Update, dirty objects only", 50, [&]() {
+		moveRandomObjects();
+		scene->Update(0.0f);
+	});
+	double fullTime = TestRegistry::Measure("Scene::Update, every root moved", 50, [&]() {
+		for (size_t ix = 0; ix < objects.size(); ix++) {
+			if (parents[ix] < 0) {
+				objects[ix]->SetPostion(objects[ix]->GetPosition());
+			}
+		}
+		scene->Update(0.0f);
+	});
+	LOG_INFO("    speedup {:.1f}x with random dirtying, {:.1f}x with everything dirty", oldTime / newTime, oldTime / fullTime);
+
+	// The analytic inverses must match the general ones, even at the bottom of the chains
+	updateReference();
+	for (size_t ix = 0; ix < objects.size(); ix++) {
+		CHECK(MatricesNear(objects[ix]->GetTransform(), world[ix], 1e-3f));
+		CHECK(MatricesNear(objects[ix]->GetInverseTransform(), inverse[ix], 1e-3f));
+		CHECK(MatricesNear(objects[ix]->GetNormalMatrix(), normal[ix], 1e-3f));
+	}
+}
+
+BENCHMARK_CASE(Scene, FromJson) {
+	using namespace Gameplay;
+
+	// Time a few sizes, with the lookups the time per object should stay roughly flat
+	for (int count : { 12500, 25000, 50000 }) {
+		nlohmann::json blob = MakeLargeScene(count, 20)->ToJson();
+
+		// Keep the loaded scenes alive until we're done timing, so that their destruction isn't timed
+		std::vector<Scene::Sptr> loaded;
+		LOG_INFO("  {} objects", count);
+		double time = TestRegistry::Measure("Scene::FromJson", 3, [&]() {
+			loaded.push_back(Scene::FromJson(blob));
+		});
+		LOG_INFO("    {:.3f} us per object", time * 1000.0 / count);
+
+		// Every parent reference must have been resolved
+		Scene::Sptr scene = loaded.back();
+		CHECK(scene->NumObjects() == (int)blob["objects"].size());
+		CHECK(scene->MainCamera != nullptr);
+		int children = 0;
+		for (int ix = 0; ix < scene->NumObjects(); ix++) {
+			children += scene->GetObjectByIndex(ix)->GetParent() != nullptr;
+		}
+		CHECK(children == count - count / 20);
+	}
+}
@@ -0,0 +1,49 @@
+#include "Tests/TestRegistry.h"
+
+#include <chrono>
+
+bool TestRegistry::Register(const std::string& name, TestKind kind, void(*function)()) {
+	_GetCases().push_back({ name, kind, function });
+	return true;
+}
+
+int TestRegistry::Run(TestKind kind, const std::string& filter) {
+	using Clock = std::chrono::high_resolution_clock;
+
+	int run = 0;
+	int failed = 0;
+	for (const Case& testCase : _GetCases()) {
+		if (testCase.Kind != kind || testCase.Name.find(filter) == std::string::npos) {
+			continue;
+		}
+		run++;
+
+		LOG_INFO("[ RUN  ] {}", testCase.Name);
+		Clock::time_point start = Clock::now();
+		try {
+			testCase.Function();
+			double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+			LOG_INFO("[  OK  ] {} ({:.1f} ms)", testCase.Name, elapsed);
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR("[ FAIL ] {}: {}", testCase.Name, e.what());
+			failed++;
+		}
+	}
+
+	if (failed > 0) {
+		LOG_ERROR("{} of {} {} cases failed", failed, run, ~kind);
+	} else {
+		LOG_INFO("All {} {} cases passed", run, ~kind);
+	}
+	return failed;
+}
+
+void TestRegistry::Fail(const char* file, int line, const std::string& message) {
+	throw Failure(std::string(file) + "(" + std::to_string(line) + "): " + message);
+}
+
+std::vector<TestRegistry::Case>& TestRegistry::_GetCases() {
+	static std::vector<Case> cases;
+	return cases;
+}
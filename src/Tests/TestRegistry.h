@@ -0,0 +1,131 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include <EnumToString.h>
+
+#include "Logging.h"
+
+/// <summary>
+/// The kinds of cases that can be registered with the TestRegistry
+/// </summary>
+ENUM(TestKind, uint8_t,
+	Test      = 0,
+	Benchmark = 1
+);
+
+/// <summary>
+/// A small, self registering test and benchmark runner. Cases are declared in the src/Tests folder
+/// with the TEST_CASE and BENCHMARK_CASE macros, and are run when the application is started with
+/// --test or --bench (optionally followed by a filter) instead of opening the editor. Cases run on
+/// the main thread after the GL context has been created and all our types have been registered,
+/// so they are free to create resources and scenes
+///
+/// Results are written to the log, and the application's exit code is the number of failed cases
+/// </summary>
+class TestRegistry {
+public:
+	/// <summary>
+	/// Thrown by the CHECK macros when a condition does not hold, fails the current case
+	/// </summary>
+	class Failure : public std::runtime_error {
+	public:
+		Failure(const std::string& message) : std::runtime_error(message) {}
+	};
+
+	/// <summary>
+	/// A test or benchmark that has been registered with the runner
+	/// </summary>
+	struct Case {
+		// The name of the case, formatted as Group.Name
+		std::string Name;
+		TestKind    Kind;
+		void      (*Function)();
+	};
+
+	TestRegistry() = delete;
+
+	/// <summary>
+	/// Registers a new case with the runner, used by the TEST_CASE and BENCHMARK_CASE macros
+	/// </summary>
+	/// <returns>Always true, so that the result can initialize a static variable</returns>
+	static bool Register(const std::string& name, TestKind kind, void(*function)());
+
+	/// <summary>
+	/// Runs all the cases of the given kind whose name contains filter, in the order they were registered
+	/// </summary>
+	/// <param name="kind">The kind of cases to run</param>
+	/// <param name="filter">Only cases containing this string are run, or empty to run all cases</param>
+	/// <returns>The number of cases that failed</returns>
+	static int Run(TestKind kind, const std::string& filter = "");
+
+	/// <summary>
+	/// Fails the current case, used by the CHECK macros
+	/// </summary>
+	[[noreturn]] static void Fail(const char* file, int line, const std::string& message);
+
+	/// <summary>
+	/// Times a function over a number of runs, after running it once to warm up any caches,
+	/// and logs the fastest and average times
+	/// </summary>
+	/// <param name="label">The label to log the timings under</param>
+	/// <param name="iterations">The number of timed runs</param>
+	/// <param name="func">The function to time</param>
+	/// <returns>The fastest run, in milliseconds</returns>
+	template <typename Func>
+	static double Measure(const std::string& label, int iterations, Func&& func);
+
+protected:
+	// Function local so that cases can register themselves during static initialization in any order
+	static std::vector<Case>& _GetCases();
+};
+
+template <typename Func>
+double TestRegistry::Measure(const std::string& label, int iterations, Func&& func) {
+	using Clock = std::chrono::high_resolution_clock;
+
+	func();
+
+	double fastest = std::numeric_limits<double>::max();
+	double total = 0.0;
+	for (int ix = 0; ix < iterations; ix++) {
+		Clock::time_point start = Clock::now();
+		func();
+		double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		fastest = std::min(fastest, elapsed);
+		total += elapsed;
+	}
+
+	LOG_INFO("    {:<48} min {:>10.3f} ms    mean {:>10.3f} ms    ({} runs)", label, fastest, total / std::max(iterations, 1), iterations);
+	return fastest;
+}
+
+// Declares a test case, the body follows the macro like a function body
+#define TEST_CASE(Group, Name) \
+	static void Group##_##Name(); \
+	static const bool Group##_##Name##_Registered = TestRegistry::Register(#Group "." #Name, TestKind::Test, &Group##_##Name); \
+	static void Group##_##Name()
+
+// Declares a benchmark case, the body follows the macro like a function body
+#define BENCHMARK_CASE(Group, Name) \
+	static void Group##_##Name(); \
+	static const bool Group##_##Name##_Registered = TestRegistry::Register(#Group "." #Name, TestKind::Benchmark, &Group##_##Name); \
+	static void Group##_##Name()
+
+// Fails the current case if the condition is false
+#define CHECK(condition) \
+	do { if (!(condition)) { TestRegistry::Fail(__FILE__, __LINE__, #condition); } } while (false)
+
+// Fails the current case if the two floating point values are further than epsilon apart
+#define CHECK_NEAR(a, b, epsilon) \
+	do { \
+		const double _a = (a), _b = (b); \
+		if (!(std::abs(_a - _b) <= (epsilon))) { \
+			TestRegistry::Fail(__FILE__, __LINE__, #a " ~= " #b " (" + std::to_string(_a) + " vs " + std::to_string(_b) + ")"); \
+		} \
+	} while (false)
@@ -0,0 +1,280 @@
+#include "Tests/TestRegistry.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
+#include "Utils/TextureCompressor.h"
+
+namespace {
+	/// <summary>
+	/// Decoders for the blocks we encode, written from the format specifications rather than from the
+	/// encoder so that they can act as a reference. Every block decodes to 16 RGBA texels
+	/// </summary>
+	void DecodeBc1Block(const uint8_t* block, uint8_t out[16][4]) {
+		const uint16_t c0 = block[0] | (block[1] << 8);
+		const uint16_t c1 = block[2] | (block[3] << 8);
+
+		int palette[4][4];
+		for (int ix = 0; ix < 2; ix++) {
+			const uint16_t value = ix == 0 ? c0 : c1;
+			const int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+			palette[ix][0] = (r << 3) | (r >> 2);
+			palette[ix][1] = (g << 2) | (g >> 4);
+			palette[ix][2] = (b << 3) | (b >> 2);
+			palette[ix][3] = 255;
+		}
+		for (int channel = 0; channel < 4; channel++) {
+			// 4 color mode when the first endpoint is larger, otherwise 3 colors and transparent black
+			if (c0 > c1) {
+				palette[2][channel] = (2 * palette[0][channel] + palette[1][channel] + 1) / 3;
+				palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel] + 1) / 3;
+			}
+			else {
+				palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+				palette[3][channel] = 0;
+			}
+		}
+
+		const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+		for (int ix = 0; ix < 16; ix++) {
+			const int index = (indices >> (ix * 2)) & 3;
+			for (int channel = 0; channel < 4; channel++) {
+				out[ix][channel] = static_cast<uint8_t>(palette[index][channel]);
+			}
+		}
+	}
+
+	// Decodes a BC4 block into one channel of the texels
+	void DecodeBc4Block(const uint8_t* block, uint8_t out[16][4], int channel) {
+		const int e0 = block[0], e1 = block[1];
+		int palette[8] = { e0, e1 };
+		// 8 value mode when the first endpoint is larger, otherwise 6 values plus 0 and 255
+		if (e0 > e1) {
+			for (int ix = 2; ix < 8; ix++) {
+				palette[ix] = ((8 - ix) * e0 + (ix - 1) * e1 + 3) / 7;
+			}
+		}
+		else {
+			for (int ix = 2; ix < 6; ix++) {
+				palette[ix] = ((6 - ix) * e0 + (ix - 1) * e1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t indices = 0;
+		for (int ix = 0; ix < 6; ix++) {
+			indices |= (uint64_t)block[2 + ix] << (ix * 8);
+		}
+		for (int ix = 0; ix < 16; ix++) {
+			out[ix][channel] = static_cast<uint8_t>(palette[(indices >> (ix * 3)) & 7]);
+		}
+	}
+
+	// Decodes a BC7 block, we only ever write mode 6 so that's the only mode this needs to understand
+	void DecodeBc7Block(const uint8_t* block, uint8_t out[16][4]) {
+		uint32_t position = 0;
+		auto read = [&](uint32_t numBits) {
+			uint32_t value = 0;
+			for (uint32_t bit = 0; bit < numBits; bit++, position++) {
+				value |= ((block[position >> 3] >> (position & 7)) & 1) << bit;
+			}
+			return value;
+		};
+
+		CHECK(read(7) == 1 << 6);
+		int endpoints[2][4];
+		for (int channel = 0; channel < 4; channel++) {
+			endpoints[0][channel] = read(7) << 1;
+			endpoints[1][channel] = read(7) << 1;
+		}
+		const uint32_t pBits[2] = { read(1), read(1) };
+		for (int channel = 0; channel < 4; channel++) {
+			endpoints[0][channel] |= pBits[0];
+			endpoints[1][channel] |= pBits[1];
+		}
+
+		const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+		for (int ix = 0; ix < 16; ix++) {
+			// The first index has an implied top bit of 0
+			const int weight = weights[read(ix == 0 ? 3 : 4)];
+			for (int channel = 0; channel < 4; channel++) {
+				out[ix][channel] = static_cast<uint8_t>(((64 - weight) * endpoints[0][channel] + weight * endpoints[1][channel] + 32) >> 6);
+			}
+		}
+	}
+
+	// Decodes a whole image to RGBA, missing channels are filled in the same way OpenGL would when sampling
+	std::vector<uint8_t> Decompress(TextureCompression format, const std::vector<uint8_t>& blocks, uint32_t width, uint32_t height) {
+		const uint32_t blocksX = (width + 3) / 4;
+		const uint32_t blockSize = TextureCompressor::GetBlockSize(format);
+		CHECK(blocks.size() == TextureCompressor::CalcLevelSize(format, width, height));
+
+		std::vector<uint8_t> result((size_t)width * height * 4);
+		for (size_t blockIx = 0; blockIx < blocks.size() / blockSize; blockIx++) {
+			const uint8_t* block = blocks.data() + blockIx * blockSize;
+			uint8_t texels[16][4];
+			for (auto& texel : texels) {
+				texel[0] = 0; texel[1] = 0; texel[2] = 0; texel[3] = 255;
+			}
+			switch (format) {
+				case TextureCompression::BC1: DecodeBc1Block(block, texels); break;
+				case TextureCompression::BC4: DecodeBc4Block(block, texels, 0); break;
+				case TextureCompression::BC5: DecodeBc4Block(block, texels, 0); DecodeBc4Block(block + 8, texels, 1); break;
+				case TextureCompression::BC7: DecodeBc7Block(block, texels); break;
+				default: CHECK(false);
+			}
+
+			// Partial blocks past the edges of the image are dropped
+			const uint32_t blockX = static_cast<uint32_t>(blockIx % blocksX);
+			const uint32_t blockY = static_cast<uint32_t>(blockIx / blocksX);
+			for (uint32_t ix = 0; ix < 16; ix++) {
+				const uint32_t x = blockX * 4 + ix % 4;
+				const uint32_t y = blockY * 4 + ix / 4;
+				if (x < width && y < height) {
+					std::copy(texels[ix], texels[ix] + 4, result.data() + ((size_t)y * width + x) * 4);
+				}
+			}
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Makes a test image that looks a bit like a photo, smooth gradients with some fine noise and a few
+	/// hard edges. The size is deliberately not a multiple of the block size
+	/// </summary>
+	std::vector<uint8_t> MakeTestImage(uint32_t width, uint32_t height, uint32_t numChannels) {
+		std::mt19937 random(1234);
+		std::uniform_int_distribution<int> noise(-4, 4);
+		std::vector<uint8_t> result((size_t)width * height * numChannels);
+		for (uint32_t y = 0; y < height; y++) {
+			for (uint32_t x = 0; x < width; x++) {
+				for (uint32_t channel = 0; channel < numChannels; channel++) {
+					float value = 128.0f + 100.0f * std::sin(x * 0.11f + channel) * std::cos(y * 0.07f - channel * 0.5f);
+					if ((x / 16 + y / 16) % 5 == 0) {
+						value = 255.0f - value;
+					}
+					result[((size_t)y * width + x) * numChannels + channel] = static_cast<uint8_t>(std::clamp(static_cast<int>(value) + noise(random), 0, 255));
+				}
+			}
+		}
+		return result;
+	}
+
+	// Gets the peak signal to noise ratio of the decoded RGBA image against the source, over the source's channels
+	double CalcPsnr(const std::vector<uint8_t>& source, uint32_t numChannels, const std::vector<uint8_t>& decoded) {
+		const size_t numTexels = source.size() / numChannels;
+		double errorSq = 0.0;
+		for (size_t ix = 0; ix < numTexels; ix++) {
+			for (uint32_t channel = 0; channel < numChannels; channel++) {
+				const double difference = (double)source[ix * numChannels + channel] - decoded[ix * 4 + channel];
+				errorSq += difference * difference;
+			}
+		}
+		const double mse = errorSq / (numTexels * numChannels);
+		return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+	}
+}
+
+TEST_CASE(TextureCompressor, EncodeDecodePsnr) {
+	const uint32_t width = 67;
+	const uint32_t height = 45;
+
+	// The lowest quality we accept for each format, a little under what the encoder currently manages
+	const struct { TextureCompression Format; uint32_t NumChannels; double MinPsnr; } cases[] = {
+		{ TextureCompression::BC1, 3, 32.0 },
+		{ TextureCompression::BC4, 1, 45.0 },
+		{ TextureCompression::BC5, 2, 45.0 },
+		{ TextureCompression::BC7, 4, 33.0 },
+	};
+
+	for (const auto& testCase : cases) {
+		const std::vector<uint8_t> source = MakeTestImage(width, height, testCase.NumChannels);
+		const std::vector<uint8_t> blocks = TextureCompressor::Compress(testCase.Format, source.data(), width, height, testCase.NumChannels);
+		const std::vector<uint8_t> decoded = Decompress(testCase.Format, blocks, width, height);
+
+		const double psnr = CalcPsnr(source, testCase.NumChannels, decoded);
+		LOG_INFO("  {}: {:.1f} dB", ~testCase.Format, psnr);
+		CHECK(psnr >= testCase.MinPsnr);
+		CHECK(TextureCompressor::ResolveFormat(TextureCompression::Auto, testCase.NumChannels) == testCase.Format);
+	}
+
+	// BC7 has twice the bits of BC1, so it should do better on the same opaque image
+	const std::vector<uint8_t> rgb = MakeTestImage(width, height, 3);
+	const double bc1Psnr = CalcPsnr(rgb, 3, Decompress(TextureCompression::BC1, TextureCompressor::Compress(TextureCompression::BC1, rgb.data(), width, height, 3), width, height));
+	const double bc7Psnr = CalcPsnr(rgb, 3, Decompress(TextureCompression::BC7, TextureCompressor::Compress(TextureCompression::BC7, rgb.data(), width, height, 3), width, height));
+	LOG_INFO("  RGB: {:.1f} dB as BC1, {:.1f} dB as BC7", bc1Psnr, bc7Psnr);
+	CHECK(bc7Psnr > bc1Psnr);
+
+	// Flat blocks should come back exactly, as long as the color fits in the endpoint precision
+	const uint8_t flat[4] = { 10, 200, 64, 128 };
+	std::vector<uint8_t> flatImage;
+	for (int ix = 0; ix < 16; ix++) {
+		flatImage.insert(flatImage.end(), flat, flat + 4);
+	}
+	for (const auto& [format, numChannels] : { std::make_pair(TextureCompression::BC4, 1), std::make_pair(TextureCompression::BC5, 2), std::make_pair(TextureCompression::BC7, 4) }) {
+		const std::vector<uint8_t> decoded = Decompress(format, TextureCompressor::Compress(format, flatImage.data(), 4, 4, 4), 4, 4);
+		for (int ix = 0; ix < 16; ix++) {
+			CHECK(std::equal(flat, flat + numChannels, decoded.data() + ix * 4));
+		}
+	}
+}
+
+TEST_CASE(TextureCompressor, DdsRoundTrip) {
+	// A BC7 image with a partial mip chain, including levels smaller than a block
+	TextureCompressor::CompressedImage image;
+	image.Format = TextureCompression::BC7;
+	image.IsSrgb = true;
+	image.SettingsKey = 0x12345678;
+	for (uint32_t width = 67, height = 45; width > 1 || height > 1; width = std::max(width / 2, 1u), height = std::max(height / 2, 1u)) {
+		const std::vector<uint8_t> source = MakeTestImage(width, height, 4);
+		image.Levels.push_back({ width, height, TextureCompressor::Compress(image.Format, source.data(), width, height, 4) });
+	}
+
+	const std::string path = (std::filesystem::temp_directory_path() / "texturecompressor-test.dds").string();
+	TextureCompressor::CompressedImage loaded;
+	TextureCompressor::CompressedImage cached;
+	TextureCompressor::CompressedImage mismatched;
+	const bool saved = TextureCompressor::SaveDds(path, image);
+	const bool wasLoaded = TextureCompressor::LoadDds(path, loaded);
+	const bool wasCached = TextureCompressor::LoadCachedDds(path, image.SettingsKey, cached);
+	const bool wasMismatched = TextureCompressor::LoadCachedDds(path, image.SettingsKey + 1, mismatched);
+
+	// A file that was cut short must not be read past it's end
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+	TextureCompressor::CompressedImage truncated;
+	const bool wasTruncated = TextureCompressor::LoadDds(path, truncated);
+	std::filesystem::remove(path);
+
+	CHECK(saved);
+	CHECK(wasLoaded);
+	CHECK(loaded.Format == image.Format);
+	CHECK(loaded.IsSrgb == image.IsSrgb);
+	CHECK(loaded.SettingsKey == image.SettingsKey);
+	CHECK(loaded.Levels.size() == image.Levels.size());
+	for (size_t ix = 0; ix < image.Levels.size(); ix++) {
+		CHECK(loaded.Levels[ix].Width == image.Levels[ix].Width);
+		CHECK(loaded.Levels[ix].Height == image.Levels[ix].Height);
+		CHECK(loaded.Levels[ix].Data == image.Levels[ix].Data);
+	}
+
+	// The cache is only used if it was written with the same settings
+	CHECK(wasCached);
+	CHECK(cached.Levels.size() == image.Levels.size());
+	CHECK(!wasMismatched);
+	CHECK(mismatched.Levels.empty());
+
+	CHECK(!wasTruncated);
+	CHECK(truncated.Levels.empty());
+	CHECK(!TextureCompressor::LoadDds(path, truncated));
+
+	// Images without a block format can't be saved
+	TextureCompressor::CompressedImage uncompressed = image;
+	uncompressed.Format = TextureCompression::None;
+	CHECK(!TextureCompressor::SaveDds(path, uncompressed));
+	CHECK(!std::filesystem::exists(path));
+}
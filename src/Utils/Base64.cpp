@@ -1,6 +1,21 @@
 #include "Base64.h"
+#include <atomic>
+#include <algorithm>
 #include <stdexcept>
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BASE64_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+// MSVC lets us use any intrinsic without changing the compiler flags
+#define BASE64_TARGET(isa)
+#else
+// GCC and Clang need each function that uses SSSE3 or AVX2 to be marked, so the rest of the file still runs anywhere
+#define BASE64_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
 const char* Base64::LookupTables[2] = {
 	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 	"abcdefghijklmnopqrstuvwxyz"
@@ -11,109 +26,346 @@ const char* Base64::LookupTables[2] = {
 	"0123456789-_."
 };
 
-uint32_t CharPos(const char input) {
-	if (input >= 'A' && input <= 'Z') return input - 'A';
-	else if (input >= 'a' && input <= 'z') return input - 'Z';
-	else if (input == '+' || input == '-') return 62;
-	else if (input == '/' || input == '_') return 63;
-	else if (input == '=' || input == '.') return 64;
-	else
-		throw std::runtime_error("Not a valid Base64 character");
-}
+namespace {
+	// Entries in the decode table for characters that aren't 6 bit values, both have the top bits set
+	// so that a whole group can be checked at once
+	const uint8_t INVALID = 0xFF;
+	const uint8_t PADDING = 0xFE;
 
-std::string Base64::Encode(void* data, size_t sizeBytes, bool urlEncode, bool includeTrailing)
-{
-	// Determine the size of the output
-	size_t encodedLength = ((sizeBytes + 2) / 3) * 4;
+	// Maps characters to their 6 bit values, accepting characters from both alphabets
+	struct DecodeTable {
+		uint8_t Values[256];
 
-	// Allocate space for output
-	std::string result;
-	result.reserve(encodedLength);
+		DecodeTable() {
+			std::fill(Values, Values + 256, INVALID);
+			for (uint8_t ix = 0; ix < 64; ix++) {
+				Values[static_cast<uint8_t>(Base64::LookupTables[0][ix])] = ix;
+				Values[static_cast<uint8_t>(Base64::LookupTables[1][ix])] = ix;
+			}
+			Values[static_cast<uint8_t>('=')] = PADDING;
+			Values[static_cast<uint8_t>('.')] = PADDING;
+		}
+	};
 
-	// Grab shorthands to various things we'll need
-	uint8_t* dataPtr = reinterpret_cast<uint8_t*>(data);
-	const char* lut = LookupTables[urlEncode ? 1 : 0];
-	char paddingChar = lut[64];
-
-	// Iterate over all bytes in the data
-	for (size_t pos = 0; pos < sizeBytes; pos++) {
-		result.push_back(lut[(dataPtr[pos] & 0xfc) >> 2]); // 0b11111100 >> 2
-
-		if (pos + 1 < sizeBytes) {
-			// 0b00000011 << 4 + 0b11110000 >> 4
-			result.push_back(lut[((dataPtr[pos] & 0x03) << 4) + ((dataPtr[pos + 1] & 0xf0) >> 4)]);
-			
-			if (pos + 2 < sizeBytes) {
-				// 0b00001111 << 2 + 0b11000000 >> 6
-				result.push_back(lut[((dataPtr[pos + 1] & 0x0f) << 2) + ((dataPtr[pos + 2] & 0xc0) >> 6)]);
-				result.push_back(lut[dataPtr[pos + 2] & 0x3f]); // 0b00111111
+	const uint8_t* GetDecodeTable() {
+		static DecodeTable table;
+		return table.Values;
+	}
+
+	// Encodes whole 3 byte groups, returns the number of bytes that were consumed
+	size_t EncodeScalar(const uint8_t* in, size_t size, char* out, const char* lut) {
+		size_t pos = 0;
+		for (; pos + 3 <= size; pos += 3, out += 4) {
+			const uint32_t group = (in[pos] << 16) | (in[pos + 1] << 8) | in[pos + 2];
+			out[0] = lut[group >> 18];
+			out[1] = lut[(group >> 12) & 0x3F];
+			out[2] = lut[(group >> 6) & 0x3F];
+			out[3] = lut[group & 0x3F];
+		}
+		return pos;
+	}
+
+	// Decodes whole 4 character groups, throws if any of the characters are invalid
+	size_t DecodeScalar(const char* in, size_t numChars, uint8_t* out, const uint8_t* table) {
+		size_t pos = 0;
+		for (; pos + 4 <= numChars; pos += 4, out += 3) {
+			const uint32_t a = table[static_cast<uint8_t>(in[pos])];
+			const uint32_t b = table[static_cast<uint8_t>(in[pos + 1])];
+			const uint32_t c = table[static_cast<uint8_t>(in[pos + 2])];
+			const uint32_t d = table[static_cast<uint8_t>(in[pos + 3])];
+			if ((a | b | c | d) & 0xC0) {
+				throw std::runtime_error("Not a valid Base64 character");
 			}
-			else {
-				result.push_back(lut[(dataPtr[pos + 1] & 0x0f) << 2]); // 0b00001111 << 2
-				if (includeTrailing) {
-					result.push_back(paddingChar);
-				}
+			const uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+			out[0] = static_cast<uint8_t>(group >> 16);
+			out[1] = static_cast<uint8_t>(group >> 8);
+			out[2] = static_cast<uint8_t>(group);
+		}
+		return pos;
+	}
+
+	#ifdef BASE64_X86
+	// The SIMD paths work on 6 bit indices instead of characters, following Wojciech Muła's approach
+	// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+
+	// Added to each index based on which range it's in, see EncodeSsse3 for how ranges are numbered
+	#define BASE64_SHIFT_LUT(urlEncode) \
+		71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, (urlEncode) ? -17 : -19, (urlEncode) ? 32 : -16, 65, 0, 0
+
+	BASE64_TARGET("ssse3")
+	size_t EncodeSsse3(const uint8_t* in, size_t size, char* out, bool urlEncode) {
+		// Spreads each 3 byte group across 4 bytes, so each 6 bit index can be shifted into place
+		const __m128i shuffle  = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m128i shiftLut = _mm_setr_epi8(BASE64_SHIFT_LUT(urlEncode));
+
+		size_t pos = 0;
+		// We load 16 bytes but only use 12, so stop while there's still a full load left
+		for (; pos + 16 <= size; pos += 12, out += 16) {
+			__m128i input = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos)), shuffle);
+			__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+			__m128i t1 = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+			__m128i indices = _mm_or_si128(t0, t1);
+
+			// Ranges are 13 for A-Z, 0 for a-z, 1-10 for 0-9, then 11 and 12 for the last two characters
+			__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			__m128i isUpper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+			range = _mm_or_si128(range, _mm_and_si128(isUpper, _mm_set1_epi8(13)));
+
+			__m128i chars = _mm_add_epi8(indices, _mm_shuffle_epi8(shiftLut, range));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), chars);
+		}
+		return pos;
+	}
+
+	BASE64_TARGET("avx2")
+	size_t EncodeAvx2(const uint8_t* in, size_t size, char* out, bool urlEncode) {
+		const __m256i shuffle  = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+												  1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+		const __m256i shiftLut = _mm256_setr_epi8(BASE64_SHIFT_LUT(urlEncode), BASE64_SHIFT_LUT(urlEncode));
+
+		size_t pos = 0;
+		// Each lane gets 12 bytes, the second load reads 4 bytes past the 24 we use
+		for (; pos + 28 <= size; pos += 24, out += 32) {
+			__m256i input = _mm256_inserti128_si256(
+				_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos))),
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos + 12)), 1);
+			input = _mm256_shuffle_epi8(input, shuffle);
+			__m256i t0 = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+			__m256i t1 = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+			__m256i indices = _mm256_or_si256(t0, t1);
+
+			__m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			__m256i isUpper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+			range = _mm256_or_si256(range, _mm256_and_si256(isUpper, _mm256_set1_epi8(13)));
+
+			__m256i chars = _mm256_add_epi8(indices, _mm256_shuffle_epi8(shiftLut, range));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), chars);
+		}
+		return pos;
+	}
+
+	#undef BASE64_SHIFT_LUT
+
+	// Decoding accepts both alphabets at once, so instead of a lookup we check each character range. Any
+	// chunk with a character outside of the ranges (including padding) is left for the scalar path, which
+	// will throw if the character is actually invalid. Each chunk writes 4 bytes past the 12 it decodes
+
+	BASE64_TARGET("ssse3")
+	size_t DecodeSsse3(const char* in, size_t numChars, uint8_t* out) {
+		size_t pos = 0;
+		for (; pos + 16 <= numChars; pos += 16, out += 12) {
+			__m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + pos));
+			__m128i upper = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), chars));
+			__m128i lower = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), chars));
+			__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), chars));
+			__m128i plus  = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('+')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('-')));
+			__m128i slash = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8('/')), _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+
+			__m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(plus, slash)));
+			if (_mm_movemask_epi8(valid) != 0xFFFF) {
+				break;
 			}
+
+			__m128i shift = _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')),
+							_mm_or_si128(_mm_and_si128(lower, _mm_set1_epi8(26 - 'a')), _mm_and_si128(digit, _mm_set1_epi8(52 - '0'))));
+			__m128i values = _mm_andnot_si128(_mm_or_si128(plus, slash), _mm_add_epi8(chars, shift));
+			values = _mm_or_si128(values, _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(62)), _mm_and_si128(slash, _mm_set1_epi8(63))));
+
+			// Merge pairs of 6 bit values into 12 bits, then pairs of those into 24 bits, and pack the 3 byte groups together
+			__m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+			__m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+			packed = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), packed);
 		}
-		else {
-			result.push_back(lut[(dataPtr[pos] & 0x03) << 4]); // 0b00000011 << 4
-			if (includeTrailing) {
-				result.push_back(paddingChar);
-				result.push_back(paddingChar);
+		return pos;
+	}
+
+	BASE64_TARGET("avx2")
+	size_t DecodeAvx2(const char* in, size_t numChars, uint8_t* out) {
+		size_t pos = 0;
+		for (; pos + 32 <= numChars; pos += 32, out += 24) {
+			__m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + pos));
+			__m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), chars));
+			__m256i lower = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), chars));
+			__m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chars));
+			__m256i plus  = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('+')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('-')));
+			__m256i slash = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8('/')), _mm256_cmpeq_epi8(chars, _mm256_set1_epi8('_')));
+
+			__m256i valid = _mm256_or_si256(_mm256_or_si256(upper, lower), _mm256_or_si256(digit, _mm256_or_si256(plus, slash)));
+			if (static_cast<uint32_t>(_mm256_movemask_epi8(valid)) != 0xFFFFFFFFu) {
+				break;
 			}
+
+			__m256i shift = _mm256_or_si256(_mm256_and_si256(upper, _mm256_set1_epi8(-'A')),
+							_mm256_or_si256(_mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')), _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0'))));
+			__m256i values = _mm256_andnot_si256(_mm256_or_si256(plus, slash), _mm256_add_epi8(chars, shift));
+			values = _mm256_or_si256(values, _mm256_or_si256(_mm256_and_si256(plus, _mm256_set1_epi8(62)), _mm256_and_si256(slash, _mm256_set1_epi8(63))));
+
+			__m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+			__m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+			packed = _mm256_shuffle_epi8(packed, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+																  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			// Each lane holds 12 bytes, the second store overwrites the junk at the end of the first
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(packed));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm256_extracti128_si256(packed, 1));
 		}
+		return pos;
 	}
+	#endif
 
-	return result;
+	Base64Simd DetectSimdLevel() {
+		#ifdef BASE64_X86
+		#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		__cpuid(info, 1);
+		const bool ssse3 = (info[2] & (1 << 9)) != 0;
+		// AVX2 also needs the OS to save the upper halves of the registers (OSXSAVE + AVX, then XCR0)
+		bool avx2 = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+		if (avx2 && maxLeaf >= 7) {
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		} else {
+			avx2 = false;
+		}
+		#else
+		__builtin_cpu_init();
+		const bool ssse3 = __builtin_cpu_supports("ssse3");
+		const bool avx2  = __builtin_cpu_supports("avx2");
+		#endif
+		return avx2 ? Base64Simd::AVX2 : ssse3 ? Base64Simd::SSSE3 : Base64Simd::Scalar;
+		#else
+		return Base64Simd::Scalar;
+		#endif
+	}
+
+	const Base64Simd& GetSupportedLevel() {
+		static const Base64Simd level = DetectSimdLevel();
+		return level;
+	}
+
+	std::atomic<uint8_t>& GetCurrentLevel() {
+		static std::atomic<uint8_t> level(static_cast<uint8_t>(GetSupportedLevel()));
+		return level;
+	}
 }
 
-std::string Base64::Decode(const std::string& input)
+Base64Simd Base64::GetSimdLevel() {
+	return static_cast<Base64Simd>(GetCurrentLevel().load(std::memory_order_relaxed));
+}
+
+void Base64::SetSimdLevel(Base64Simd level) {
+	GetCurrentLevel().store(static_cast<uint8_t>(std::min(level, GetSupportedLevel())), std::memory_order_relaxed);
+}
+
+std::string Base64::Encode(const void* data, size_t sizeBytes, bool urlEncode, bool includeTrailing)
 {
-	if (input.empty()) return std::string();
+	const uint8_t* in = static_cast<const uint8_t*>(data);
+	const char* lut = LookupTables[urlEncode ? 1 : 0];
 
-	if (!IsBase64(input)) {
-		throw std::runtime_error("Input is not a base 64 string!");
+	// Determine the size of the output, a trailing partial group takes up 1 more character than it has bytes
+	const size_t remainder = sizeBytes % 3;
+	const size_t encodedLength = (sizeBytes / 3) * 4 + (remainder == 0 ? 0 : includeTrailing ? 4 : remainder + 1);
+	std::string result(encodedLength, '\0');
+	char* out = result.data();
+
+	// Let the widest path we can use take as much as it can, then finish up with narrower ones
+	size_t pos = 0;
+	#ifdef BASE64_X86
+	const Base64Simd level = GetSimdLevel();
+	if (level >= Base64Simd::AVX2) {
+		pos += EncodeAvx2(in, sizeBytes, out, urlEncode);
 	}
+	if (level >= Base64Simd::SSSE3) {
+		pos += EncodeSsse3(in + pos, sizeBytes - pos, out + pos / 3 * 4, urlEncode);
+	}
+	#endif
+	pos += EncodeScalar(in + pos, sizeBytes - pos, out + pos / 3 * 4, lut);
+	out += pos / 3 * 4;
 
-	size_t inLength = input.length();
-	size_t approxOutLength = (inLength / 4) * 3;
+	if (remainder == 1) {
+		const uint32_t group = in[pos] << 16;
+		out[0] = lut[group >> 18];
+		out[1] = lut[(group >> 12) & 0x3F];
+		if (includeTrailing) {
+			out[2] = lut[64];
+			out[3] = lut[64];
+		}
+	}
+	else if (remainder == 2) {
+		const uint32_t group = (in[pos] << 16) | (in[pos + 1] << 8);
+		out[0] = lut[group >> 18];
+		out[1] = lut[(group >> 12) & 0x3F];
+		out[2] = lut[(group >> 6) & 0x3F];
+		if (includeTrailing) {
+			out[3] = lut[64];
+		}
+	}
 
-	std::string result;
-	result.reserve(approxOutLength);
+	return result;
+}
 
-	for (size_t pos = 0; pos < inLength; pos += 4) {
-		size_t charPos1 = CharPos(input[pos + 1]);
+std::string Base64::Decode(const std::string& input)
+{
+	const uint8_t* table = GetDecodeTable();
 
-		result.push_back(static_cast<std::string::value_type>( ( CharPos(input[pos]) << 2 ) + ( (charPos1 & 0x30) >> 4) ) );
+	// Strip off any padding, if there is some then the input must have been padded to a multiple of 4
+	size_t length = input.length();
+	size_t padding = 0;
+	while (length > 0 && padding < 2 && table[static_cast<uint8_t>(input[length - 1])] == PADDING) {
+		length--;
+		padding++;
+	}
+	if (length % 4 == 1 || (padding > 0 && input.length() % 4 != 0)) {
+		throw std::runtime_error("Input is not a base 64 string!");
+	}
+
+	// The SIMD paths write a few bytes past the end of what they decode, so we leave some space
+	const size_t decodedLength = (length / 4) * 3 + (length % 4 == 0 ? 0 : length % 4 - 1);
+	std::string result(decodedLength + 16, '\0');
+	uint8_t* out = reinterpret_cast<uint8_t*>(result.data());
+	const char* in = input.data();
 
-		if (
-			(pos + 2 < inLength) &&
-			input[pos + 2] != '=' &&
-			input[pos + 2] != '.'
-		) {
-			size_t charPos2 = CharPos(input[pos + 2]);
-			result.push_back(static_cast<std::string::value_type>(((charPos1 & 0x0f) << 4) + ( (charPos2 & 0x3c) >> 2)));
+	size_t pos = 0;
+	#ifdef BASE64_X86
+	const Base64Simd level = GetSimdLevel();
+	if (level >= Base64Simd::AVX2) {
+		pos += DecodeAvx2(in, length, out);
+	}
+	if (level >= Base64Simd::SSSE3) {
+		pos += DecodeSsse3(in + pos, length - pos, out + pos / 4 * 3);
+	}
+	#endif
+	pos += DecodeScalar(in + pos, length - pos, out + pos / 4 * 3, table);
+	out += pos / 4 * 3;
 
-			if (
-				(pos + 3 < inLength) &&
-				input[pos + 3] != '=' &&
-				input[pos + 3] != '.'
-			) {
-				size_t charPos3 = CharPos(input[pos + 3]);
-				result.push_back(static_cast<std::string::value_type>(((charPos2 & 0x03) << 6) + charPos3));
+	// Handle the last 2 or 3 characters
+	if (pos < length) {
+		uint32_t group = 0;
+		for (size_t ix = pos; ix < length; ix++) {
+			const uint32_t value = table[static_cast<uint8_t>(in[ix])];
+			if (value & 0xC0) {
+				throw std::runtime_error("Not a valid Base64 character");
 			}
+			group |= value << (18 - 6 * (ix - pos));
+		}
+		out[0] = static_cast<uint8_t>(group >> 16);
+		if (length - pos == 3) {
+			out[1] = static_cast<uint8_t>(group >> 8);
 		}
 	}
 
+	result.resize(decodedLength);
 	return result;
 }
 
 bool Base64::IsBase64(const std::string& input)
 {
+	const uint8_t* table = GetDecodeTable();
 	for (const char c : input) {
-		if (!(isalnum(c) || (c == '-') || (c == '_') || (c == '=') || (c == '.')))
+		if (table[static_cast<uint8_t>(c)] == INVALID)
 			return false;
 	}
 	return true;
 }
-
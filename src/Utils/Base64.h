@@ -1,12 +1,54 @@
 #pragma once
 
-#include <string>;
+#include <string>
+#include <cstdint>
 
+#include <EnumToString.h>
+
+/// <summary>
+/// The instruction sets that Base64 can use, each level includes the ones before it
+/// </summary>
+ENUM(Base64Simd, uint8_t,
+	Scalar = 0,
+	SSSE3  = 1,
+	AVX2   = 2
+);
+
+/// <summary>
+/// Encodes and decodes Base64 (RFC 4648), with either the standard or URL safe alphabet
+///
+/// Decoding accepts both alphabets, and padding is optional. Large inputs are processed 12 or 24
+/// bytes at a time with SSSE3 or AVX2 when the CPU supports it, the instruction set is picked the
+/// first time it's needed
+/// </summary>
 class Base64 {
 public:
-	static std::string Encode(void* data, size_t sizeBytes, bool urlEncode = true, bool includeTrailing = false);
+	/// <summary>
+	/// Encodes binary data as Base64
+	/// </summary>
+	/// <param name="data">The data to encode</param>
+	/// <param name="sizeBytes">The number of bytes to encode</param>
+	/// <param name="urlEncode">True to use the URL safe alphabet (- and _ instead of + and /, with . for padding)</param>
+	/// <param name="includeTrailing">True to pad the output to a multiple of 4 characters</param>
+	static std::string Encode(const void* data, size_t sizeBytes, bool urlEncode = true, bool includeTrailing = false);
+	/// <summary>
+	/// Decodes a Base64 string, throws a std::runtime_error if the input is not valid Base64
+	/// </summary>
 	static std::string Decode(const std::string& input);
+	/// <summary>
+	/// Returns true if the input only contains characters from either Base64 alphabet
+	/// </summary>
 	static bool IsBase64(const std::string& input);
 
+	/// <summary>
+	/// Gets the instruction set that encoding and decoding will use
+	/// </summary>
+	static Base64Simd GetSimdLevel();
+	/// <summary>
+	/// Limits the instruction set that encoding and decoding will use, mostly useful for testing and
+	/// benchmarking. Levels the CPU doesn't support are ignored
+	/// </summary>
+	static void SetSimdLevel(Base64Simd level);
+
 	static const char* LookupTables[2];
-};
\ No newline at end of file
+};
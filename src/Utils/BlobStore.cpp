@@ -0,0 +1,158 @@
+#include "Utils/BlobStore.h"
+
+#include <thread>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+
+#include <Logging.h>
+#include "Utils/JsonGlmHelpers.h"
+
+namespace fs = std::filesystem;
+
+const char* BlobStore::FILE_EXTENSION = ".blob";
+
+std::string           BlobStore::_directory = "blobs";
+std::set<std::string> BlobStore::_usedBlobs;
+
+void BlobStore::SetDirectory(const std::string& directory) {
+	_directory = directory;
+	_usedBlobs.clear();
+}
+
+std::string BlobStore::Hash(const void* data, size_t size) {
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t ix = 0; ix < size; ix++) {
+		hash ^= bytes[ix];
+		hash *= 0x100000001b3ull;
+	}
+
+	static const char* digits = "0123456789abcdef";
+	std::string result(16, '0');
+	for (int ix = 15; ix >= 0; ix--) {
+		result[ix] = digits[hash & 0xF];
+		hash >>= 4;
+	}
+	return result;
+}
+
+nlohmann::json BlobStore::Write(const void* data, size_t size) {
+	const std::string hash = Hash(data, size);
+	const std::string path = _GetPath(hash);
+
+	nlohmann::json result = {
+		{ "path", path },
+		{ "hash", hash },
+		{ "size", size }
+	};
+
+	// The name comes from the contents, so if the file is already there we're done
+	std::error_code error;
+	if (fs::exists(path, error) && fs::file_size(path, error) == size) {
+		_usedBlobs.insert(fs::path(path).filename().string());
+		return result;
+	}
+
+	// Write to a temporary file first, so a save that fails part way (or another thread writing the same
+	// blob) never leaves a truncated blob behind under the final name
+	fs::create_directories(_directory, error);
+	const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary);
+		if (!file.is_open()) {
+			LOG_WARN("Failed to open blob \"{}\" for writing", tempPath);
+			return nlohmann::json();
+		}
+		file.write(static_cast<const char*>(data), size);
+		if (!file.good()) {
+			LOG_WARN("Failed to write blob \"{}\"", tempPath);
+			file.close();
+			fs::remove(tempPath, error);
+			return nlohmann::json();
+		}
+	}
+
+	fs::rename(tempPath, path, error);
+	if (error) {
+		LOG_WARN("Failed to move \"{}\" to \"{}\": {}", tempPath, path, error.message());
+		fs::remove(tempPath, error);
+		return nlohmann::json();
+	}
+
+	_usedBlobs.insert(fs::path(path).filename().string());
+	return result;
+}
+
+bool BlobStore::Contains(const nlohmann::json& reference) {
+	if (!reference.is_object() || !reference.contains("hash")) {
+		return false;
+	}
+
+	// References from another directory (ex: a manifest that was saved somewhere else) need to be written again
+	const std::string path = _GetPath(JsonGet<std::string>(reference, "hash"));
+	if (JsonGet<std::string>(reference, "path") != path) {
+		return false;
+	}
+
+	std::error_code error;
+	if (!fs::exists(path, error) || fs::file_size(path, error) != JsonGet<size_t>(reference, "size", 0)) {
+		return false;
+	}
+
+	_usedBlobs.insert(fs::path(path).filename().string());
+	return true;
+}
+
+nlohmann::json BlobStore::Keep(const nlohmann::json& reference) {
+	if (Contains(reference)) {
+		return reference;
+	}
+
+	MemoryMappedFile::Sptr blob = Open(reference);
+	if (blob == nullptr) {
+		return reference;
+	}
+	nlohmann::json result = Write(blob->GetData(), blob->GetSize());
+	return result.is_null() ? reference : result;
+}
+
+MemoryMappedFile::Sptr BlobStore::Open(const nlohmann::json& reference) {
+	if (!reference.is_object() || !reference.contains("path")) {
+		LOG_WARN("Blob reference is missing it's path");
+		return nullptr;
+	}
+
+	const std::string path = JsonGet<std::string>(reference, "path");
+	MemoryMappedFile::Sptr result = MemoryMappedFile::Open(path);
+	if (result == nullptr) {
+		LOG_WARN("Failed to open blob \"{}\"", path);
+		return nullptr;
+	}
+
+	const size_t expectedSize = JsonGet<size_t>(reference, "size", 0);
+	if (result->GetSize() != expectedSize) {
+		LOG_WARN("Blob \"{}\" is {} bytes, expected {}", path, result->GetSize(), expectedSize);
+		return nullptr;
+	}
+
+	return result;
+}
+
+void BlobStore::RemoveUnused() {
+	std::error_code error;
+	if (!fs::is_directory(_directory, error)) {
+		return;
+	}
+
+	for (const fs::directory_entry& entry : fs::directory_iterator(_directory, error)) {
+		if (entry.path().extension() == FILE_EXTENSION && _usedBlobs.count(entry.path().filename().string()) == 0) {
+			LOG_INFO("Removing unused blob \"{}\"", entry.path().string());
+			fs::remove(entry.path(), error);
+		}
+	}
+}
+
+std::string BlobStore::_GetPath(const std::string& hash) {
+	return (fs::path(_directory) / (hash + FILE_EXTENSION)).generic_string();
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <set>
+#include <string>
+#include <cstdint>
+
+#include "json.hpp"
+#include "Utils/MemoryMappedFile.h"
+
+/// <summary>
+/// Stores binary data (ex: the pixels of generated textures) in sidecar files instead of embedding
+/// it in JSON manifests. Blobs are named after a hash of their contents, so data that hasn't changed
+/// between saves is only written once, and identical data is shared
+///
+/// Resources store the JSON reference returned by Write, which holds the path, hash and size of the
+/// blob. Blobs are loaded back by memory mapping them, so they can be handed straight to OpenGL.
+/// References should be stored under a "blob" key, so that ResourceManager can find the blobs of
+/// resources that were never loaded when it saves a manifest
+/// </summary>
+class BlobStore {
+public:
+	// The extension we use for blob files
+	static const char* FILE_EXTENSION;
+
+	BlobStore() = delete;
+
+	/// <summary>
+	/// Sets the folder that blobs are written to, and starts tracking which blobs are in use so that
+	/// RemoveUnused can clean up after a save. The folder is created when the first blob is written
+	/// </summary>
+	static void SetDirectory(const std::string& directory);
+	/// <summary>
+	/// Gets the folder that blobs are written to
+	/// </summary>
+	static const std::string& GetDirectory() { return _directory; }
+
+	/// <summary>
+	/// Hashes a block of data with 64 bit FNV-1a
+	/// </summary>
+	/// <returns>The hash as 16 hex digits</returns>
+	static std::string Hash(const void* data, size_t size);
+
+	/// <summary>
+	/// Writes a blob to the current directory, the write is skipped if a blob with the same contents already exists
+	/// </summary>
+	/// <param name="data">The data to store</param>
+	/// <param name="size">The number of bytes to store</param>
+	/// <returns>A JSON reference to the blob, or null if it could not be written</returns>
+	static nlohmann::json Write(const void* data, size_t size);
+	/// <summary>
+	/// Checks if a reference returned by Write points to a blob that exists in the current directory, and
+	/// marks the blob as in use if it does. Lets resources skip reading back data that hasn't changed
+	/// </summary>
+	static bool Contains(const nlohmann::json& reference);
+	/// <summary>
+	/// Makes sure that the blob a reference points to is in the current directory, copying it over if it's
+	/// somewhere else, and marks it as in use
+	/// </summary>
+	/// <returns>The reference to use from now on, the input is returned as-is if the blob could not be found</returns>
+	static nlohmann::json Keep(const nlohmann::json& reference);
+	/// <summary>
+	/// Memory maps the blob that a reference points to
+	/// </summary>
+	/// <param name="reference">A reference returned by Write</param>
+	/// <returns>The mapped blob, or nullptr if the blob is missing or is not the expected size</returns>
+	static MemoryMappedFile::Sptr Open(const nlohmann::json& reference);
+
+	/// <summary>
+	/// Deletes any blobs in the current directory that have not been written or checked with Contains
+	/// since SetDirectory was called
+	/// </summary>
+	static void RemoveUnused();
+
+protected:
+	static std::string           _directory;
+	// The filenames of the blobs that have been written or referenced since SetDirectory
+	static std::set<std::string> _usedBlobs;
+
+	static std::string _GetPath(const std::string& hash);
+};
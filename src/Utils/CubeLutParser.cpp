@@ -0,0 +1,423 @@
+#include "Utils/CubeLutParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <Logging.h>
+#include "Utils/MemoryMappedFile.h"
+
+namespace fs = std::filesystem;
+
+const char* CubeLutParser::CACHE_EXTENSION = ".lutcache";
+
+namespace {
+	// Data is only split between threads if every thread gets at least this many bytes to parse
+	constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+	// The largest LUT_3D_SIZE the format allows
+	constexpr uint32_t MAX_LUT_SIZE = 256;
+
+	// Bump this whenever the layout of the cache changes, so that old caches get rebuilt
+	constexpr uint32_t CACHE_VERSION = 1;
+	// "CLUT" as a little endian integer
+	constexpr uint32_t CACHE_MAGIC = 0x54554C43;
+
+	/// <summary>
+	/// The header at the start of a LUT cache, followed by the title and then the data
+	/// </summary>
+	struct CacheHeader {
+		uint32_t Magic       = CACHE_MAGIC;
+		uint32_t Version     = CACHE_VERSION;
+		uint32_t Size        = 0;
+		uint32_t TitleLength = 0;
+		float    DomainMin[3] = { 0.0f, 0.0f, 0.0f };
+		float    DomainMax[3] = { 1.0f, 1.0f, 1.0f };
+	};
+
+	// Returns true for characters that separate tokens within a line
+	inline bool IsBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// Advances past any blank characters, stopping at the end of the line
+	inline const char* SkipBlanks(const char* seek, const char* end) {
+		while (seek < end && IsBlank(*seek)) { seek++; }
+		return seek;
+	}
+
+	// Finds the newline at the end of the current line, or the end of the data if this is the last line
+	inline const char* FindLineEnd(const char* seek, const char* end) {
+		const char* eol = reinterpret_cast<const char*>(memchr(seek, '\n', end - seek));
+		return eol != nullptr ? eol : end;
+	}
+
+	// Advances past the rest of the current line, including the newline character
+	inline const char* SkipLine(const char* seek, const char* end) {
+		const char* eol = FindLineEnd(seek, end);
+		return eol < end ? eol + 1 : end;
+	}
+
+	// Returns true if the character can start a number, which is how we tell data rows apart from keywords
+	inline bool IsNumberStart(char c) {
+		return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.';
+	}
+
+	// Parses a float from the stream, returning nullptr if the token is not a number
+	inline const char* ParseFloat(const char* seek, const char* end, float& out) {
+		seek = SkipBlanks(seek, end);
+		// from_chars does not accept a leading plus sign
+		if (seek < end && *seek == '+') { seek++; }
+		auto [ptr, error] = std::from_chars(seek, end, out);
+		return error == std::errc() ? ptr : nullptr;
+	}
+
+	// Parses an unsigned integer from the stream, returning nullptr if the token is not a number
+	inline const char* ParseUInt(const char* seek, const char* end, uint32_t& out) {
+		seek = SkipBlanks(seek, end);
+		auto [ptr, error] = std::from_chars(seek, end, out);
+		return error == std::errc() ? ptr : nullptr;
+	}
+
+	// Returns true if the line starts with the given keyword, followed by a blank or the end of the line
+	inline bool IsKeyword(const char* line, const char* eol, const char* keyword) {
+		const size_t length = strlen(keyword);
+		return static_cast<size_t>(eol - line) >= length && memcmp(line, keyword, length) == 0 &&
+			(line + length == eol || IsBlank(line[length]));
+	}
+
+	// Returns the 1 based line number that a character is on, only used for error messages
+	size_t GetLineNumber(const char* begin, const char* seek) {
+		return std::count(begin, seek, '\n') + 1;
+	}
+
+	/// <summary>
+	/// A line aligned section of the data rows, parsed on it's own thread
+	/// </summary>
+	struct LutChunk {
+		const char*            Begin = nullptr;
+		const char*            End   = nullptr;
+		std::vector<glm::vec3> Rows;
+		// The line that failed to parse, or nullptr if the whole chunk was valid
+		const char*            Error = nullptr;
+	};
+
+	// Parses the rows of a chunk, stopping at the first line that is not 3 numbers
+	void ParseChunk(LutChunk& chunk) {
+		const char* end = chunk.End;
+		const char* seek = chunk.Begin;
+
+		// Most lines are close to 20 characters, so this avoids most re-allocation
+		chunk.Rows.reserve((end - seek) / 20 + 1);
+
+		while (seek < end) {
+			const char* line = SkipBlanks(seek, end);
+			if (line >= end) {
+				break;
+			}
+			if (*line == '\n') {
+				seek = line + 1;
+				continue;
+			}
+			if (*line == '#') {
+				seek = SkipLine(line, end);
+				continue;
+			}
+
+			glm::vec3 row;
+			const char* ptr = ParseFloat(line, end, row.r);
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, end, row.g); }
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, end, row.b); }
+			if (ptr != nullptr) { ptr = SkipBlanks(ptr, end); }
+			// Allow trailing comments, but anything else means the row is malformed
+			if (ptr == nullptr || (ptr < end && *ptr != '\n' && *ptr != '#')) {
+				chunk.Error = line;
+				return;
+			}
+
+			chunk.Rows.push_back(row);
+			seek = SkipLine(ptr, end);
+		}
+	}
+}
+
+bool CubeLutParser::ParseFile(const std::string& filename, Lut& result, uint32_t threadCount) {
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(filename);
+	if (file == nullptr) {
+		LOG_WARN("Failed to open .cube file: \"{}\"", filename);
+		return false;
+	}
+
+	const char* data = reinterpret_cast<const char*>(file->GetData());
+	if (!Parse(data, data + file->GetSize(), result, threadCount)) {
+		LOG_WARN("Failed to parse .cube file: \"{}\"", filename);
+		return false;
+	}
+	return true;
+}
+
+bool CubeLutParser::Parse(const char* begin, const char* end, Lut& result, uint32_t threadCount) {
+	result = Lut();
+	uint32_t size1D = 0;
+
+	// Skip the UTF-8 byte order mark some editors add
+	const char* seek = begin;
+	if (end - seek >= 3 && memcmp(seek, "\xEF\xBB\xBF", 3) == 0) {
+		seek += 3;
+	}
+
+	// Keywords all come before the data, so we read lines one at a time until we reach the first row
+	while (seek < end) {
+		const char* line = SkipBlanks(seek, end);
+		if (line >= end || IsNumberStart(*line)) {
+			seek = line;
+			break;
+		}
+		const char* eol = FindLineEnd(line, end);
+		seek = eol < end ? eol + 1 : end;
+
+		// Skip empty lines and comments
+		if (line == eol || *line == '#') {
+			continue;
+		}
+
+		const char* ptr = line;
+		if (IsKeyword(line, eol, "TITLE")) {
+			// The title is quoted, but we'll accept it without quotes as well
+			const char* titleBegin = SkipBlanks(line + 5, eol);
+			const char* titleEnd = eol;
+			while (titleEnd > titleBegin && IsBlank(titleEnd[-1])) { titleEnd--; }
+			if (titleEnd - titleBegin >= 2 && *titleBegin == '"' && titleEnd[-1] == '"') {
+				titleBegin++;
+				titleEnd--;
+			}
+			result.Title.assign(titleBegin, titleEnd);
+		}
+		else if (IsKeyword(line, eol, "LUT_3D_SIZE")) {
+			ptr = ParseUInt(line + 11, eol, result.Size);
+		}
+		else if (IsKeyword(line, eol, "LUT_1D_SIZE")) {
+			ptr = ParseUInt(line + 11, eol, size1D);
+		}
+		else if (IsKeyword(line, eol, "DOMAIN_MIN")) {
+			ptr = ParseFloat(line + 10, eol, result.DomainMin.r);
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, eol, result.DomainMin.g); }
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, eol, result.DomainMin.b); }
+		}
+		else if (IsKeyword(line, eol, "DOMAIN_MAX")) {
+			ptr = ParseFloat(line + 10, eol, result.DomainMax.r);
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, eol, result.DomainMax.g); }
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, eol, result.DomainMax.b); }
+		}
+		else if (IsKeyword(line, eol, "LUT_3D_INPUT_RANGE")) {
+			// Resolve's older version of DOMAIN_MIN and DOMAIN_MAX, with the same range on every channel
+			float min = 0.0f, max = 1.0f;
+			ptr = ParseFloat(line + 18, eol, min);
+			if (ptr != nullptr) { ptr = ParseFloat(ptr, eol, max); }
+			result.DomainMin = glm::vec3(min);
+			result.DomainMax = glm::vec3(max);
+		}
+		// Any other keywords (ex: LUT_1D_INPUT_RANGE, or ones added by other tools) don't affect 3D LUTs
+
+		if (ptr == nullptr) {
+			LOG_WARN("Malformed .cube keyword on line {}", GetLineNumber(begin, line));
+			return false;
+		}
+	}
+
+	if (result.Size == 0) {
+		if (size1D > 0) {
+			LOG_WARN("1D .cube LUTs are not supported");
+		} else {
+			LOG_WARN("The .cube data is missing LUT_3D_SIZE");
+		}
+		return false;
+	}
+	if (result.Size < 2 || result.Size > MAX_LUT_SIZE) {
+		LOG_WARN("LUT_3D_SIZE of {} is outside of the 2-{} range", result.Size, MAX_LUT_SIZE);
+		return false;
+	}
+	if (glm::any(glm::lessThanEqual(result.DomainMax, result.DomainMin))) {
+		LOG_WARN("The .cube DOMAIN_MAX must be larger than DOMAIN_MIN on every channel");
+		return false;
+	}
+
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// Split the rows into line aligned chunks, small LUTs will end up with a single chunk
+	const size_t size = end - seek;
+	const size_t numChunks = std::max<size_t>(1, std::min<size_t>(threadCount, size / MIN_CHUNK_SIZE));
+	std::vector<LutChunk> chunks(numChunks);
+	const char* chunkStart = seek;
+	for (size_t ix = 0; ix < numChunks; ix++) {
+		chunks[ix].Begin = chunkStart;
+		chunkStart = ix + 1 < numChunks ? SkipLine(std::max(chunkStart, seek + (size / numChunks) * (ix + 1)), end) : end;
+		chunks[ix].End = chunkStart;
+	}
+
+	// The first chunk is parsed on this thread, while the others run alongside it
+	std::vector<std::thread> workers;
+	workers.reserve(numChunks - 1);
+	for (size_t ix = 1; ix < numChunks; ix++) {
+		workers.emplace_back(ParseChunk, std::ref(chunks[ix]));
+	}
+	ParseChunk(chunks[0]);
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	// Check that the chunks add up to a full LUT, then stitch them together in order
+	const size_t expectedRows = static_cast<size_t>(result.Size) * result.Size * result.Size;
+	size_t numRows = 0;
+	for (const LutChunk& chunk : chunks) {
+		if (chunk.Error != nullptr) {
+			LOG_WARN("Expected 3 numbers for a .cube data row on line {}", GetLineNumber(begin, chunk.Error));
+			return false;
+		}
+		numRows += chunk.Rows.size();
+	}
+	if (numRows != expectedRows) {
+		LOG_WARN("A LUT_3D_SIZE of {} needs {} data rows, but there were {}", result.Size, expectedRows, numRows);
+		return false;
+	}
+
+	result.Data.reserve(expectedRows);
+	for (const LutChunk& chunk : chunks) {
+		result.Data.insert(result.Data.end(), chunk.Rows.begin(), chunk.Rows.end());
+	}
+	return true;
+}
+
+void CubeLutParser::RemapToUnitDomain(Lut& lut) {
+	if (lut.Size < 2 || (lut.DomainMin == glm::vec3(0.0f) && lut.DomainMax == glm::vec3(1.0f))) {
+		return;
+	}
+
+	// Work out where each entry of the new LUT lands in the old one along each axis, as the index of
+	// the entry before it and how far it is towards the next one
+	const uint32_t size = lut.Size;
+	const float maxIndex = static_cast<float>(size - 1);
+	std::vector<uint32_t> indices[3];
+	std::vector<float>    weights[3];
+	for (int axis = 0; axis < 3; axis++) {
+		indices[axis].resize(size);
+		weights[axis].resize(size);
+		for (uint32_t ix = 0; ix < size; ix++) {
+			const float input = ix / maxIndex;
+			const float position = glm::clamp((input - lut.DomainMin[axis]) / (lut.DomainMax[axis] - lut.DomainMin[axis]), 0.0f, 1.0f) * maxIndex;
+			indices[axis][ix] = std::min(static_cast<uint32_t>(position), size - 2);
+			weights[axis][ix] = position - indices[axis][ix];
+		}
+	}
+
+	auto at = [&](uint32_t r, uint32_t g, uint32_t b) -> const glm::vec3& {
+		return lut.Data[(static_cast<size_t>(b) * size + g) * size + r];
+	};
+
+	// Trilinear filter the old LUT at each of those positions
+	std::vector<glm::vec3> remapped(lut.Data.size());
+	glm::vec3* out = remapped.data();
+	for (uint32_t b = 0; b < size; b++) {
+		const uint32_t b0 = indices[2][b];
+		const float    wb = weights[2][b];
+		for (uint32_t g = 0; g < size; g++) {
+			const uint32_t g0 = indices[1][g];
+			const float    wg = weights[1][g];
+			for (uint32_t r = 0; r < size; r++, out++) {
+				const uint32_t r0 = indices[0][r];
+				const float    wr = weights[0][r];
+				const glm::vec3 c00 = glm::mix(at(r0, g0,     b0),     at(r0 + 1, g0,     b0),     wr);
+				const glm::vec3 c10 = glm::mix(at(r0, g0 + 1, b0),     at(r0 + 1, g0 + 1, b0),     wr);
+				const glm::vec3 c01 = glm::mix(at(r0, g0,     b0 + 1), at(r0 + 1, g0,     b0 + 1), wr);
+				const glm::vec3 c11 = glm::mix(at(r0, g0 + 1, b0 + 1), at(r0 + 1, g0 + 1, b0 + 1), wr);
+				*out = glm::mix(glm::mix(c00, c10, wg), glm::mix(c01, c11, wg), wb);
+			}
+		}
+	}
+
+	lut.Data = std::move(remapped);
+	lut.DomainMin = glm::vec3(0.0f);
+	lut.DomainMax = glm::vec3(1.0f);
+}
+
+bool CubeLutParser::SaveCache(const std::string& path, const Lut& lut) {
+	if (lut.Size == 0 || lut.Data.size() != static_cast<size_t>(lut.Size) * lut.Size * lut.Size) {
+		LOG_WARN("Cannot save \"{}\", the LUT is empty or incomplete", path);
+		return false;
+	}
+
+	CacheHeader header;
+	header.Size = lut.Size;
+	header.TitleLength = static_cast<uint32_t>(lut.Title.size());
+	for (int ix = 0; ix < 3; ix++) {
+		header.DomainMin[ix] = lut.DomainMin[ix];
+		header.DomainMax[ix] = lut.DomainMax[ix];
+	}
+
+	// Several workers could be writing the same file, so each one gets it's own temporary file
+	const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary);
+		if (!file.is_open()) {
+			LOG_WARN("Failed to open \"{}\" for writing", tempPath);
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+		file.write(lut.Title.data(), lut.Title.size());
+		file.write(reinterpret_cast<const char*>(lut.Data.data()), lut.Data.size() * sizeof(glm::vec3));
+		if (!file.good()) {
+			LOG_WARN("Failed to write \"{}\"", tempPath);
+			file.close();
+			fs::remove(tempPath);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	fs::rename(tempPath, path, error);
+	if (error) {
+		LOG_WARN("Failed to move \"{}\" to \"{}\": {}", tempPath, path, error.message());
+		fs::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool CubeLutParser::LoadCache(const std::string& path, Lut& result) {
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(path);
+	if (file == nullptr) {
+		return false;
+	}
+
+	const uint8_t* data = file->GetData();
+	const size_t size = file->GetSize();
+	CacheHeader header;
+	if (size < sizeof(CacheHeader)) {
+		LOG_WARN("\"{}\" is too small to be a LUT cache", path);
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(CacheHeader));
+
+	if (header.Magic != CACHE_MAGIC || header.Version != CACHE_VERSION) {
+		LOG_WARN("\"{}\" is not a LUT cache, or is from an older version", path);
+		return false;
+	}
+	const size_t numEntries = static_cast<size_t>(header.Size) * header.Size * header.Size;
+	if (header.Size < 2 || header.Size > MAX_LUT_SIZE || size != sizeof(CacheHeader) + header.TitleLength + numEntries * sizeof(glm::vec3)) {
+		LOG_WARN("\"{}\" is truncated or corrupt", path);
+		return false;
+	}
+
+	result = Lut();
+	result.Size = header.Size;
+	result.DomainMin = glm::vec3(header.DomainMin[0], header.DomainMin[1], header.DomainMin[2]);
+	result.DomainMax = glm::vec3(header.DomainMax[0], header.DomainMax[1], header.DomainMax[2]);
+	result.Title.assign(reinterpret_cast<const char*>(data) + sizeof(CacheHeader), header.TitleLength);
+	result.Data.resize(numEntries);
+	std::memcpy(result.Data.data(), data + sizeof(CacheHeader) + header.TitleLength, numEntries * sizeof(glm::vec3));
+	return true;
+}
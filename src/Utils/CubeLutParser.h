@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// Parses 3D color lookup tables from Adobe/Resolve .cube files, and reads and writes them in a
+/// binary cache format so that later loads are a single read. Does not touch OpenGL, so LUTs can be
+/// parsed on worker threads, and can be checked without a GPU
+///
+/// Like ObjParser, the parser walks a memory mapped view of the file and parses numbers with
+/// std::from_chars. The data rows of large files can be split into line aligned chunks that are
+/// parsed on separate threads
+/// </summary>
+class CubeLutParser {
+public:
+	// The extension that is added to a .cube file's path to get the path of it's cache
+	static const char* CACHE_EXTENSION;
+
+	/// <summary>
+	/// A 3D LUT parsed from a .cube file
+	/// </summary>
+	struct Lut {
+		// The number of entries along each axis
+		uint32_t               Size = 0;
+		// The range of input colors that the LUT covers, from DOMAIN_MIN and DOMAIN_MAX
+		glm::vec3              DomainMin = glm::vec3(0.0f);
+		glm::vec3              DomainMax = glm::vec3(1.0f);
+		// The TITLE from the file without it's quotes, if it had one
+		std::string            Title;
+		// The output colors, red changes fastest, then green, then blue
+		std::vector<glm::vec3> Data;
+	};
+
+	CubeLutParser() = delete;
+
+	/// <summary>
+	/// Parses a .cube file from disk
+	/// </summary>
+	/// <param name="filename">The path to the .cube file to parse</param>
+	/// <param name="result">The LUT to store the parsed data into</param>
+	/// <param name="threadCount">The maximum number of threads to parse with, or 0 to use all hardware threads</param>
+	/// <returns>True if the file was a valid 3D LUT</returns>
+	static bool ParseFile(const std::string& filename, Lut& result, uint32_t threadCount = 1);
+	/// <summary>
+	/// Parses .cube data from a block of memory
+	/// </summary>
+	/// <param name="begin">A pointer to the first character to parse</param>
+	/// <param name="end">A pointer to one past the last character to parse</param>
+	/// <param name="result">The LUT to store the parsed data into</param>
+	/// <param name="threadCount">The maximum number of threads to parse with, or 0 to use all hardware threads</param>
+	/// <returns>True if the data was a valid 3D LUT</returns>
+	static bool Parse(const char* begin, const char* end, Lut& result, uint32_t threadCount = 1);
+
+	/// <summary>
+	/// Resamples a LUT so that it covers inputs from 0 to 1, so that it can be sampled with colors
+	/// directly. Inputs outside of the original domain are clamped to it's edges. LUTs that already
+	/// have a 0-1 domain are left as-is
+	/// </summary>
+	static void RemapToUnitDomain(Lut& lut);
+
+	/// <summary>
+	/// Writes a LUT to a binary cache file
+	/// </summary>
+	/// <returns>True if the file was written</returns>
+	static bool SaveCache(const std::string& path, const Lut& lut);
+	/// <summary>
+	/// Loads a LUT from a cache file written by SaveCache
+	/// </summary>
+	/// <returns>True if the file was a valid cache from this version of the parser</returns>
+	static bool LoadCache(const std::string& path, Lut& result);
+};
@@ -31,7 +31,18 @@ std::string FileHelpers::ReadFile(const std::string& filename) {
 	return result;
 }
 
-std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::vector<std::string> resolvedPaths) {
+std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::vector<std::string>* dependencies) {
+	// The set of included files is shared by the whole include tree, so that files included by
+	// siblings (or by themselves) are only pulled in once
+	const std::string root = std::filesystem::path(filename).lexically_normal().string();
+	std::unordered_set<std::string> resolvedPaths = { root };
+	if (dependencies != nullptr) {
+		dependencies->push_back(root);
+	}
+	return _ReadResolveIncludes(filename, resolvedPaths, dependencies);
+}
+
+std::string FileHelpers::_ReadResolveIncludes(const std::string& filename, std::unordered_set<std::string>& resolvedPaths, std::vector<std::string>* dependencies) {
 	// Read the entire file contents for processing
 	std::string result = ReadFile(filename);
 	// Determine where the file we just read resides on the filesystem
@@ -72,24 +83,26 @@ std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::v
 		// Get a lexically normal path (ie with the ../ parts resolved)
 		target = target.lexically_normal();
 
-		// If we haven't included the file yet, include it now
-		if (std::find(resolvedPaths.begin(), resolvedPaths.end(), target.string()) == resolvedPaths.end()) {
+		// If we haven't included the file yet, include it now. We mark it before recursing so
+		// that circular includes terminate
+		if (resolvedPaths.insert(target.string()).second) {
+			if (dependencies != nullptr) {
+				dependencies->push_back(target.string());
+			}
 
 			// Make sure file exists, then load and resolve it's includes
 			LOG_ASSERT(std::filesystem::exists(target), "File does not exist");
-			std::string replacement = FileHelpers::ReadResolveIncludes(target.string(), resolvedPaths);
+			std::string replacement = _ReadResolveIncludes(target.string(), resolvedPaths, dependencies);
 
 			// Inject result into our string
 			result.replace(seek, eol - seek, replacement);
 			// Look for more includes!
 			seek = result.find(includeToken, seek + replacement.length());
-
-			resolvedPaths.push_back(target.string());
 		}
-		// File already included, remove the line and continue seeking
+		// File already included, remove the line and continue seeking from where it was
 		else {
 			result.replace(seek, eol - seek, "");
-			seek = result.find(includeToken, eol);
+			seek = result.find(includeToken, seek);
 		}
 	}
 
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <unordered_set>
 
 class FileHelpers {
 public:
@@ -16,11 +17,12 @@ public:
 	/// <summary>
 	/// Reads the entire contents of a file, and will also recursively include
 	/// any other files needed as indicated by a #include fileName on a line
+	/// Each file is only included once, no matter how many files include it
 	/// </summary>
 	/// <param name="filename">The path of the file to load</param>
-	/// <param name="resolvedPaths">The list of paths that have already been included</param>
+	/// <param name="dependencies">If not null, receives the lexically normal path of the file and every file it included, in the order they were read</param>
 	/// <returns>The entire contents of the file, with includes resolved, stored in a string</returns>
-	static std::string ReadResolveIncludes(const std::string& filename, std::vector<std::string> resolvedPaths = std::vector<std::string>());
+	static std::string ReadResolveIncludes(const std::string& filename, std::vector<std::string>* dependencies = nullptr);
 
 	/// <summary>
 	/// Helper for writing the contents of a string into a file
@@ -29,4 +31,7 @@ public:
 	/// <param name="contents">The contents of the file to write</param>
 	/// <param name="append">True if contents should be appended to end of existing files</param>
 	static void WriteContentsToFile(const std::string& filename, const std::string& contents, bool append = false);
+
+private:
+	static std::string _ReadResolveIncludes(const std::string& filename, std::unordered_set<std::string>& resolvedPaths, std::vector<std::string>* dependencies);
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "Utils/Frustum.h"
+
+#include <cmath>
+#include <atomic>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace {
+	std::atomic<bool>& GetSseEnabled() {
+		#ifdef FRUSTUM_USE_SSE
+		static std::atomic<bool> enabled(true);
+		#else
+		static std::atomic<bool> enabled(false);
+		#endif
+		return enabled;
+	}
+}
+
+Frustum::Frustum() {
+	// A plane of (0, 0, 0, 1) is in front of every point
+	for (int ix = 0; ix < 8; ix++) {
+		_planeX[ix] = 0.0f;
+		_planeY[ix] = 0.0f;
+		_planeZ[ix] = 0.0f;
+		_planeW[ix] = 1.0f;
+	}
+}
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+	// GLM matrices are column major, we want the rows
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++) {
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	// Left, right, bottom, top, near, far. Since we only ever compare against 0, the planes don't need to be normalized
+	const glm::vec4 planes[6] = {
+		rows[3] + rows[0],
+		rows[3] - rows[0],
+		rows[3] + rows[1],
+		rows[3] - rows[1],
+		rows[3] + rows[2],
+		rows[3] - rows[2]
+	};
+	for (int ix = 0; ix < 8; ix++) {
+		const glm::vec4& plane = planes[ix % 6];
+		_planeX[ix] = plane.x;
+		_planeY[ix] = plane.y;
+		_planeZ[ix] = plane.z;
+		_planeW[ix] = plane.w;
+	}
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+	const glm::vec3 center  = (min + max) * 0.5f;
+	const glm::vec3 extents = (max - min) * 0.5f;
+
+	// The box is outside if its center is further behind a plane than the box's projected radius onto the plane's normal
+	#ifdef FRUSTUM_USE_SSE
+	if (GetSseEnabled().load(std::memory_order_relaxed)) {
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+		const __m128 ex = _mm_set1_ps(extents.x), ey = _mm_set1_ps(extents.y), ez = _mm_set1_ps(extents.z);
+		for (int group = 0; group < 8; group += 4) {
+			const __m128 px = _mm_load_ps(_planeX + group);
+			const __m128 py = _mm_load_ps(_planeY + group);
+			const __m128 pz = _mm_load_ps(_planeZ + group);
+			const __m128 pw = _mm_load_ps(_planeW + group);
+
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)), _mm_add_ps(_mm_mul_ps(pz, cz), pw));
+			__m128 radius = _mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_andnot_ps(signMask, px), ex),
+				_mm_mul_ps(_mm_andnot_ps(signMask, py), ey)),
+				_mm_mul_ps(_mm_andnot_ps(signMask, pz), ez));
+
+			if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+	#endif
+
+	// Same sums in the same order as the SSE path, so that both give exactly the same answer
+	for (int ix = 0; ix < 6; ix++) {
+		float distance = (_planeX[ix] * center.x + _planeY[ix] * center.y) + (_planeZ[ix] * center.z + _planeW[ix]);
+		float radius = (std::fabs(_planeX[ix]) * extents.x + std::fabs(_planeY[ix]) * extents.y) + std::fabs(_planeZ[ix]) * extents.z;
+		if (distance + radius < 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Frustum::IsSseEnabled() {
+	return GetSseEnabled().load(std::memory_order_relaxed);
+}
+
+void Frustum::SetSseEnabled(bool enabled) {
+	#ifdef FRUSTUM_USE_SSE
+	GetSseEnabled().store(enabled, std::memory_order_relaxed);
+	#else
+	(void)enabled;
+	#endif
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A view frustum, stored as the 6 planes bounding the camera's view volume. The planes are
+/// laid out so that we can test a bounding box against 4 of them at once with SSE
+/// </summary>
+class Frustum {
+public:
+	/// <summary>
+	/// Creates a frustum that contains everything
+	/// </summary>
+	Frustum();
+	/// <summary>
+	/// Extracts the frustum planes from a view projection matrix (Gribb and Hartmann's method)
+	/// </summary>
+	/// <param name="viewProjection">The view projection matrix of the camera</param>
+	explicit Frustum(const glm::mat4& viewProjection);
+
+	/// <summary>
+	/// Tests whether an axis aligned bounding box is at least partially inside the frustum. This is
+	/// conservative, some boxes just outside the corners of the frustum will also pass
+	/// </summary>
+	/// <param name="min">The minimum corner of the box</param>
+	/// <param name="max">The maximum corner of the box</param>
+	/// <returns>True if the box may be visible, false if it is definitely outside of the frustum</returns>
+	bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+	/// <summary>
+	/// Gets whether IntersectsBox will test the planes with SSE, this is always false when the build
+	/// doesn't target SSE
+	/// </summary>
+	static bool IsSseEnabled();
+	/// <summary>
+	/// Switches between the SSE and scalar plane tests, mostly useful for testing and benchmarking.
+	/// Enabling SSE is ignored when the build doesn't target it
+	/// </summary>
+	static void SetSseEnabled(bool enabled);
+
+protected:
+	// The planes are stored as (x, y, z, w) with the normals pointing into the frustum. The last
+	// 2 slots repeat the first 2 planes so that we have 2 full groups of 4
+	alignas(16) float _planeX[8];
+	alignas(16) float _planeY[8];
+	alignas(16) float _planeZ[8];
+	alignas(16) float _planeW[8];
+};
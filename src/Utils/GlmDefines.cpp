@@ -1,5 +1,10 @@
 #include "Utils/GlmDefines.h"
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GLM_DEFINES_USE_SSE
+#include <xmmintrin.h>
+#endif
+
 glm::mat4 MAT4_IDENTITY = glm::mat4(1.0f);
 glm::mat3 MAT3_IDENTITY = glm::mat3(1.0f);
 glm::vec4 UNIT_X = glm::vec4(1.0f, 0.0f, 0.0f, 0.0f);
@@ -35,3 +40,41 @@ glm::mat4 NormalizeScale(const glm::mat4& transform) {
 	NormalizeScaleRef(result);
 	return result;
 }
+
+void MultiplyMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& result) {
+	#ifdef GLM_DEFINES_USE_SSE
+	// Each column of the result is a linear combination of the columns of a, weighted by a column of b
+	const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+	const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+	const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+	const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+	for (int col = 0; col < 4; col++) {
+		const __m128 column = _mm_loadu_ps(&b[col][0]);
+		__m128 sum = _mm_mul_ps(a0, _mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0)));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1))));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2))));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3))));
+		_mm_storeu_ps(&result[col][0], sum);
+	}
+	#else
+	result = a * b;
+	#endif
+}
+
+void ComposeTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& transform, glm::mat4& inverse) {
+	const glm::mat3 rot = glm::mat3_cast(rotation);
+
+	// T * R * S is just the rotation's columns scaled, with the translation in the last column
+	transform[0] = glm::vec4(rot[0] * scale.x, 0.0f);
+	transform[1] = glm::vec4(rot[1] * scale.y, 0.0f);
+	transform[2] = glm::vec4(rot[2] * scale.z, 0.0f);
+	transform[3] = glm::vec4(position, 1.0f);
+
+	// The inverse is S^-1 * R^T * T^-1, so the rows of the 3x3 part are the rotation's columns
+	// divided by the scale
+	const glm::vec3 invScale = 1.0f / scale;
+	for (int col = 0; col < 3; col++) {
+		inverse[col] = glm::vec4(rot[0][col] * invScale.x, rot[1][col] * invScale.y, rot[2][col] * invScale.z, 0.0f);
+	}
+	inverse[3] = glm::vec4(-(glm::mat3(inverse) * position), 1.0f);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "GLM/glm.hpp"
+#include "GLM/gtc/quaternion.hpp"
 
 extern glm::mat4 MAT4_IDENTITY;
 extern glm::mat3 MAT3_IDENTITY;
@@ -32,6 +33,26 @@ void NormalizeScaleRef(glm::mat4& transform);
 /// <returns>A copy of transform with scaling normalized</returns>
 glm::mat4 NormalizeScale(const glm::mat4& transform);
 
+/// <summary>
+/// Multiplies two 4x4 matrices (a * b) using SSE where it is available. The result may
+/// alias either of the inputs
+/// </summary>
+/// <param name="a">The left hand matrix</param>
+/// <param name="b">The right hand matrix</param>
+/// <param name="result">The matrix to store the product in</param>
+void MultiplyMat4(const glm::mat4& a, const glm::mat4& b, glm::mat4& result);
+
+/// <summary>
+/// Builds a translation * rotation * scale transform and it's inverse directly from the components,
+/// which is much cheaper (and more precise) than calling glm::inverse on the transform
+/// </summary>
+/// <param name="position">The translation of the transform</param>
+/// <param name="rotation">The rotation of the transform, should be normalized</param>
+/// <param name="scale">The scale of the transform, should not have any zero components</param>
+/// <param name="transform">The matrix to store the transform in</param>
+/// <param name="inverse">The matrix to store the inverse of the transform in</param>
+void ComposeTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& transform, glm::mat4& inverse);
+
 template <typename T, typename V>
 T Wrap(const T& x, const V& min, const V& max) {
 	return glm::mod((glm::mod((x - min), (max - min)) + (max - min)), (max - min)) + min;
@@ -0,0 +1,117 @@
+#include "Utils/MemoryMappedFile.h"
+#include <Logging.h>
+
+#ifdef WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MemoryMappedFile::MemoryMappedFile() :
+	_data(nullptr),
+	_size(0),
+	_isOpen(false),
+	#ifdef WINDOWS
+	_fileHandle(INVALID_HANDLE_VALUE),
+	_mappingHandle(nullptr)
+	#else
+	_fileDescriptor(-1)
+	#endif
+{ }
+
+MemoryMappedFile::~MemoryMappedFile() {
+	Close();
+}
+
+MemoryMappedFile::Sptr MemoryMappedFile::Open(const std::string& filename) {
+	MemoryMappedFile::Sptr result = std::make_shared<MemoryMappedFile>();
+
+	#ifdef WINDOWS
+	result->_fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (result->_fileHandle == INVALID_HANDLE_VALUE) {
+		LOG_ERROR("Could not open file '{}'", filename);
+		return nullptr;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(result->_fileHandle, &size)) {
+		LOG_ERROR("Could not determine size of file '{}'", filename);
+		return nullptr;
+	}
+	result->_size = static_cast<size_t>(size.QuadPart);
+
+	// Mapping a zero byte file is an error, but it's still a valid (empty) file
+	if (result->_size > 0) {
+		result->_mappingHandle = CreateFileMappingA(result->_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (result->_mappingHandle == nullptr) {
+			LOG_ERROR("Could not create file mapping for '{}'", filename);
+			return nullptr;
+		}
+		result->_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(result->_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	}
+	#else
+	result->_fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (result->_fileDescriptor < 0) {
+		LOG_ERROR("Could not open file '{}'", filename);
+		return nullptr;
+	}
+
+	struct stat info;
+	if (fstat(result->_fileDescriptor, &info) != 0) {
+		LOG_ERROR("Could not determine size of file '{}'", filename);
+		return nullptr;
+	}
+	result->_size = static_cast<size_t>(info.st_size);
+
+	// Mapping a zero byte file is an error, but it's still a valid (empty) file
+	if (result->_size > 0) {
+		void* mapping = mmap(nullptr, result->_size, PROT_READ, MAP_PRIVATE, result->_fileDescriptor, 0);
+		result->_data = mapping != MAP_FAILED ? reinterpret_cast<const uint8_t*>(mapping) : nullptr;
+		// We're going to walk the file front to back, let the kernel know so it can read ahead
+		if (result->_data != nullptr) {
+			madvise(mapping, result->_size, MADV_SEQUENTIAL);
+		}
+	}
+	#endif
+
+	if (result->_size > 0 && result->_data == nullptr) {
+		LOG_ERROR("Could not map file '{}' into memory", filename);
+		return nullptr;
+	}
+
+	result->_isOpen = true;
+	return result;
+}
+
+void MemoryMappedFile::Close() {
+	#ifdef WINDOWS
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mappingHandle != nullptr) {
+		CloseHandle(_mappingHandle);
+		_mappingHandle = nullptr;
+	}
+	if (_fileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(_fileHandle);
+		_fileHandle = INVALID_HANDLE_VALUE;
+	}
+	#else
+	if (_data != nullptr) {
+		munmap(const_cast<uint8_t*>(_data), _size);
+	}
+	if (_fileDescriptor >= 0) {
+		close(_fileDescriptor);
+		_fileDescriptor = -1;
+	}
+	#endif
+
+	_data = nullptr;
+	_size = 0;
+	_isOpen = false;
+}
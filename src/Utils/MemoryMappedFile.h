@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Wraps around a read-only memory mapping of a file on disk (mmap on Linux,
+/// MapViewOfFile on Windows). The OS will page the file in on demand, so data
+/// can be handed directly to consumers without making a copy in our own memory
+/// </summary>
+class MemoryMappedFile {
+public:
+	DEFINE_RESOURCE(MemoryMappedFile);
+
+	/// <summary>
+	/// Maps the given file into memory for reading
+	/// </summary>
+	/// <param name="filename">The path to the file to map</param>
+	/// <returns>The mapped file, or nullptr if the file could not be opened or mapped</returns>
+	static Sptr Open(const std::string& filename);
+
+	MemoryMappedFile();
+	~MemoryMappedFile();
+
+	/// <summary>
+	/// Returns a pointer to the start of the mapped file, valid for the lifetime of this object
+	/// </summary>
+	const uint8_t* GetData() const { return _data; }
+	/// <summary>
+	/// Returns the size of the mapped file, in bytes
+	/// </summary>
+	size_t GetSize() const { return _size; }
+	/// <summary>
+	/// Returns true if this file is currently mapped
+	/// </summary>
+	bool IsOpen() const { return _isOpen; }
+
+	/// <summary>
+	/// Unmaps the file, invalidating any pointers returned by GetData
+	/// </summary>
+	void Close();
+
+protected:
+	const uint8_t* _data;
+	size_t         _size;
+	bool           _isOpen;
+
+	#ifdef WINDOWS
+	void*          _fileHandle;
+	void*          _mappingHandle;
+	#else
+	int            _fileDescriptor;
+	#endif
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include "Graphics/VertexArrayObject.h"
+#include "Utils/MeshOptimizer.h"
+#include "Utils/MeshSimplifier.h"
 
 /// <summary>
 /// A utility class that lets us add vertices and indices, then bake it into a final mesh, using interleaved
@@ -116,6 +118,74 @@ public:
 	/// </summary>
 	size_t GetTriangleCount() const { return _indices.size() > 0 ? _indices.size() / 3 : _vertices.size() / 3; }
 
+	/// <summary>
+	/// Reorders the triangles in this mesh to make better use of the GPU's post-transform vertex cache,
+	/// then lays out the vertices in the order they are first used so that vertex fetches are more
+	/// coherent. This should be done before calling Bake or saving the mesh to a file, and does
+	/// nothing for meshes without indices
+	/// </summary>
+	/// <returns>The vertex cache statistics for the mesh before and after optimizing</returns>
+	MeshOptimizer::Report Optimize() {
+		MeshOptimizer::Report result = MeshOptimizer::Report();
+		if (_indices.size() < 3) {
+			return result;
+		}
+
+		result.Before = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+
+		MeshOptimizer::OptimizeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		std::vector<uint32_t> order = MeshOptimizer::OptimizeVertexFetch(_indices.data(), _indices.size(), _vertices.size());
+
+		// Shuffle our vertices into their new order
+		std::vector<VertType> vertices;
+		vertices.reserve(_vertices.size());
+		for (uint32_t oldIndex : order) {
+			vertices.push_back(_vertices[oldIndex]);
+		}
+		_vertices.swap(vertices);
+
+		result.After = MeshOptimizer::AnalyzeVertexCache(_indices.data(), _indices.size(), _vertices.size());
+		return result;
+	}
+
+	/// <summary>
+	/// Generates a chain of simplified index lists for this mesh, each with roughly half the triangles of
+	/// the level before it. The levels reference this mesh's vertices, so they can share its vertex buffer.
+	/// This should be done after Optimize, since the vertex order must not change afterwards
+	/// </summary>
+	/// <param name="maxLevels">The maximum number of levels to generate, not including the mesh itself</param>
+	/// <param name="minTriangles">The smallest number of triangles to simplify a level down to</param>
+	/// <returns>The simplified levels, from most to least detailed</returns>
+	std::vector<MeshSimplifier::Lod> GenerateLods(uint32_t maxLevels = 4, size_t minTriangles = 64) const {
+		std::vector<MeshSimplifier::Lod> result;
+		if (_indices.size() < 3) {
+			return result;
+		}
+
+		const float* positions = reinterpret_cast<const float*>(&_vertices[0].Position);
+		size_t targetTriangles = _indices.size() / 3;
+		for (uint32_t level = 0; level < maxLevels; level++) {
+			targetTriangles /= 2;
+			if (targetTriangles < minTriangles) {
+				break;
+			}
+
+			MeshSimplifier::Lod lod;
+			lod.Indices = MeshSimplifier::Simplify(_indices.data(), _indices.size(), positions, _vertices.size(), sizeof(VertType), targetTriangles * 3, &lod.Error);
+
+			// If we couldn't remove at least a quarter of the previous level, the rest of the mesh is
+			// locked to seams or borders and further levels won't save anything
+			size_t previousCount = result.empty() ? _indices.size() : result.back().Indices.size();
+			if (lod.Indices.size() * 4 > previousCount * 3) {
+				break;
+			}
+
+			MeshOptimizer::OptimizeVertexCache(lod.Indices.data(), lod.Indices.size(), _vertices.size());
+			result.push_back(std::move(lod));
+		}
+		return result;
+	}
+
 	/// <summary>
 	/// Creates and returns a VertexArraybject from the current data
 	/// </summary>
@@ -0,0 +1,221 @@
+#include "Utils/MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	// Tuning values from Tom Forsyth's reference implementation
+	// https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+	const int   CACHE_SIZE          = 32;
+	const float CACHE_DECAY_POWER   = 1.5f;
+	const float LAST_TRI_SCORE      = 0.75f;
+	const float VALENCE_BOOST_SCALE = 2.0f;
+	const float VALENCE_BOOST_POWER = 0.5f;
+	// Valences above this all get the same boost, the boost is tiny by then anyways
+	const int   MAX_VALENCE         = 32;
+
+	// Pre-computed vertex scores, indexed by cache position and by remaining valence
+	struct ScoreTables {
+		float CachePosition[CACHE_SIZE];
+		float Valence[MAX_VALENCE + 1];
+
+		ScoreTables() {
+			for (int ix = 0; ix < CACHE_SIZE; ix++) {
+				// The 3 most recent vertices were used by the last triangle, we don't want to favour them too
+				// much since we'd just end up making strips
+				if (ix < 3) {
+					CachePosition[ix] = LAST_TRI_SCORE;
+				} else {
+					const float scaler = 1.0f / (CACHE_SIZE - 3);
+					CachePosition[ix] = std::pow(1.0f - (ix - 3) * scaler, CACHE_DECAY_POWER);
+				}
+			}
+			Valence[0] = 0.0f;
+			for (int ix = 1; ix <= MAX_VALENCE; ix++) {
+				// Bonus points for having few triangles left, so we get rid of lone vertices quickly
+				Valence[ix] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(ix), -VALENCE_BOOST_POWER);
+			}
+		}
+	};
+
+	inline float ScoreVertex(const ScoreTables& tables, int cachePosition, uint32_t remainingValence) {
+		// Vertices with no triangles left to draw don't matter any more
+		if (remainingValence == 0) {
+			return -1.0f;
+		}
+		float score = cachePosition >= 0 ? tables.CachePosition[cachePosition] : 0.0f;
+		return score + tables.Valence[std::min<uint32_t>(remainingValence, MAX_VALENCE)];
+	}
+}
+
+MeshOptimizer::CacheStatistics MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	CacheStatistics result = CacheStatistics();
+	if (indexCount == 0 || vertexCount == 0 || cacheSize == 0) {
+		return result;
+	}
+
+	// A FIFO cache stores the time each vertex was added, it's a hit if it was added less than cacheSize misses ago
+	std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t index = indices[ix];
+		if (time - cacheTimestamps[index] > cacheSize) {
+			cacheTimestamps[index] = time++;
+			result.VerticesTransformed++;
+		}
+	}
+
+	// We only count vertices that are actually referenced, since unused ones never get transformed
+	size_t usedVertices = 0;
+	for (uint32_t timestamp : cacheTimestamps) {
+		usedVertices += timestamp != 0;
+	}
+
+	result.ACMR = result.VerticesTransformed / static_cast<float>(indexCount / 3);
+	result.ATVR = result.VerticesTransformed / static_cast<float>(usedVertices);
+	return result;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	static const ScoreTables tables;
+
+	const size_t triCount = indexCount / 3;
+	if (triCount == 0 || vertexCount == 0) {
+		return;
+	}
+
+	// Build a list of the triangles that use each vertex, packed into a single array
+	std::vector<uint32_t> valence(vertexCount, 0);
+	for (size_t ix = 0; ix < triCount * 3; ix++) {
+		valence[indices[ix]]++;
+	}
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		adjacencyOffsets[ix + 1] = adjacencyOffsets[ix] + valence[ix];
+	}
+	std::vector<uint32_t> adjacency(triCount * 3);
+	{
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t ix = 0; ix < triCount * 3; ix++) {
+			adjacency[fill[indices[ix]]++] = static_cast<uint32_t>(ix / 3);
+		}
+	}
+
+	// valence now tracks the number of triangles left to draw for each vertex, the first valence[vertex]
+	// entries of a vertex's adjacency list are the triangles that haven't been drawn yet
+	std::vector<int>   cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		vertexScores[ix] = ScoreVertex(tables, -1, valence[ix]);
+	}
+
+	std::vector<bool> triAdded(triCount, false);
+
+	// We write the new order to a copy, since we still need to look up the original triangles
+	std::vector<uint32_t> output;
+	output.reserve(triCount * 3);
+
+	// The LRU cache, with room for the 3 vertices that a new triangle will push in
+	uint32_t cache[CACHE_SIZE + 3];
+	int cacheCount = 0;
+
+	// Where to resume searching when no triangle in the cache is a good candidate
+	size_t searchCursor = 0;
+	int64_t bestTri = -1;
+
+	for (size_t drawn = 0; drawn < triCount; drawn++) {
+		// If nothing in the cache scored, fall back to the next undrawn triangle in the original order. This
+		// keeps the algorithm linear, and the original order tends to be spatially coherent anyways
+		if (bestTri < 0) {
+			while (triAdded[searchCursor]) { searchCursor++; }
+			bestTri = static_cast<int64_t>(searchCursor);
+		}
+
+		const uint32_t* tri = indices + bestTri * 3;
+		output.insert(output.end(), tri, tri + 3);
+		triAdded[bestTri] = true;
+
+		// Remove the triangle from its vertices' lists of undrawn triangles
+		for (int corner = 0; corner < 3; corner++) {
+			uint32_t vertex = tri[corner];
+			uint32_t* begin = adjacency.data() + adjacencyOffsets[vertex];
+			uint32_t* end = begin + valence[vertex];
+			uint32_t* it = std::find(begin, end, static_cast<uint32_t>(bestTri));
+			if (it != end) {
+				std::swap(*it, *(end - 1));
+				valence[vertex]--;
+			}
+		}
+
+		// Move the triangle's vertices to the front of the cache, in order, shifting everything else back
+		uint32_t newCache[CACHE_SIZE + 3];
+		int newCount = 0;
+		for (int corner = 0; corner < 3; corner++) {
+			// Degenerate triangles can use a vertex more than once, it only needs one slot
+			if (std::find(newCache, newCache + newCount, tri[corner]) == newCache + newCount) {
+				newCache[newCount++] = tri[corner];
+			}
+		}
+		for (int ix = 0; ix < cacheCount; ix++) {
+			uint32_t vertex = cache[ix];
+			if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2]) {
+				newCache[newCount++] = vertex;
+			}
+		}
+
+		// Update the scores for everything that was in the cache, including anything that just fell out of it
+		for (int ix = 0; ix < newCount; ix++) {
+			uint32_t vertex = newCache[ix];
+			cachePositions[vertex] = ix < CACHE_SIZE ? ix : -1;
+			vertexScores[vertex] = ScoreVertex(tables, cachePositions[vertex], valence[vertex]);
+		}
+
+		// Score the undrawn triangles touching the cache, and pick the best one for our next iteration
+		float bestScore = -1.0f;
+		bestTri = -1;
+		for (int ix = 0; ix < newCount; ix++) {
+			uint32_t vertex = newCache[ix];
+			const uint32_t* adjacent = adjacency.data() + adjacencyOffsets[vertex];
+			for (uint32_t adjIx = 0; adjIx < valence[vertex]; adjIx++) {
+				uint32_t triIx = adjacent[adjIx];
+				const uint32_t* other = indices + triIx * 3;
+				float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if (score > bestScore) {
+					bestScore = score;
+					bestTri = triIx;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, CACHE_SIZE);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+std::vector<uint32_t> MeshOptimizer::OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	const uint32_t UNUSED = ~0u;
+
+	// Give every vertex a new index the first time we see it
+	std::vector<uint32_t> remap(vertexCount, UNUSED);
+	std::vector<uint32_t> order;
+	order.reserve(vertexCount);
+	for (size_t ix = 0; ix < indexCount; ix++) {
+		uint32_t& newIndex = remap[indices[ix]];
+		if (newIndex == UNUSED) {
+			newIndex = static_cast<uint32_t>(order.size());
+			order.push_back(indices[ix]);
+		}
+		indices[ix] = newIndex;
+	}
+
+	// Keep any vertices that the indices never touch, so the vertex count doesn't change
+	for (size_t ix = 0; ix < vertexCount; ix++) {
+		if (remap[ix] == UNUSED) {
+			order.push_back(static_cast<uint32_t>(ix));
+		}
+	}
+
+	return order;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Index buffer optimizations that make meshes friendlier to the GPU. These only ever look at the
+/// indices, see MeshBuilder::Optimize for applying them to a mesh along with its vertex data
+/// </summary>
+class MeshOptimizer {
+public:
+	/// <summary>
+	/// Describes how well an index buffer uses the GPU's post-transform vertex cache
+	/// </summary>
+	struct CacheStatistics {
+		// The number of times a vertex needed to be run through the vertex shader
+		uint32_t VerticesTransformed = 0;
+		// Average cache miss ratio, the number of vertices transformed per triangle. 0.5 is the best
+		// case for a large regular grid, 3 is the worst case (every vertex is a miss)
+		float    ACMR = 0.0f;
+		// Average transform to vertex ratio, the number of times each vertex is transformed. 1 is optimal
+		float    ATVR = 0.0f;
+	};
+
+	/// <summary>
+	/// The cache statistics of a mesh before and after it was optimized
+	/// </summary>
+	struct Report {
+		CacheStatistics Before;
+		CacheStatistics After;
+	};
+
+	// The cache size we simulate when measuring, most desktop GPUs behave like a FIFO of about this size
+	static const uint32_t DEFAULT_CACHE_SIZE = 16;
+
+	MeshOptimizer() = delete;
+
+	/// <summary>
+	/// Measures the vertex cache efficiency of an index buffer by simulating a FIFO cache
+	/// </summary>
+	/// <param name="indices">The triangle list to measure</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="cacheSize">The number of entries in the simulated cache</param>
+	static CacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+	/// <summary>
+	/// Reorders the triangles in a triangle list to improve post-transform vertex cache hits, using
+	/// Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" algorithm. Triangle winding is preserved
+	/// </summary>
+	/// <param name="indices">The triangle list to reorder in place</param>
+	/// <param name="indexCount">The number of indices in the list, must be a multiple of 3</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	static void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/// <summary>
+	/// Works out a new vertex order where vertices are laid out in the order they are first used by
+	/// the index buffer, improving pre-transform (vertex fetch) locality. The indices are rewritten to
+	/// use the new order, unused vertices are moved to the end
+	/// </summary>
+	/// <param name="indices">The triangle list to remap in place</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <returns>For each new vertex position, the index of the old vertex that should go there</returns>
+	static std::vector<uint32_t> OptimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount);
+};
@@ -0,0 +1,257 @@
+#include "Utils/MeshSimplifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+namespace {
+	struct Position {
+		float X, Y, Z;
+	};
+
+	// A symmetric 4x4 error quadric, stored as its 10 unique values
+	struct Quadric {
+		double A00 = 0, A01 = 0, A02 = 0, A03 = 0;
+		double A11 = 0, A12 = 0, A13 = 0;
+		double A22 = 0, A23 = 0;
+		double A33 = 0;
+		// The total weight of the planes in this quadric
+		double Weight = 0;
+
+		// Adds the quadric for the squared distance to the plane ax + by + cz + d = 0
+		void AddPlane(double a, double b, double c, double d, double weight) {
+			A00 += weight * a * a; A01 += weight * a * b; A02 += weight * a * c; A03 += weight * a * d;
+			A11 += weight * b * b; A12 += weight * b * c; A13 += weight * b * d;
+			A22 += weight * c * c; A23 += weight * c * d;
+			A33 += weight * d * d;
+			Weight += weight;
+		}
+
+		void Add(const Quadric& other) {
+			A00 += other.A00; A01 += other.A01; A02 += other.A02; A03 += other.A03;
+			A11 += other.A11; A12 += other.A12; A13 += other.A13;
+			A22 += other.A22; A23 += other.A23;
+			A33 += other.A33;
+			Weight += other.Weight;
+		}
+
+		// Evaluates the weighted mean squared distance from the point to this quadric's planes
+		double Evaluate(const Position& p) const {
+			if (Weight <= 0.0) { return 0.0; }
+			const double x = p.X, y = p.Y, z = p.Z;
+			double result =
+				A00 * x * x + 2 * A01 * x * y + 2 * A02 * x * z + 2 * A03 * x +
+				A11 * y * y + 2 * A12 * y * z + 2 * A13 * y +
+				A22 * z * z + 2 * A23 * z +
+				A33;
+			// Rounding can push us slightly below zero
+			return std::max(result / Weight, 0.0);
+		}
+	};
+
+	// A candidate for collapsing the From vertex onto the To vertex
+	struct Collapse {
+		uint32_t From;
+		uint32_t To;
+		double   Cost;
+	};
+
+	inline void Cross(const Position& a, const Position& b, const Position& c, double out[3]) {
+		const double e1[3] = { (double)b.X - a.X, (double)b.Y - a.Y, (double)b.Z - a.Z };
+		const double e2[3] = { (double)c.X - a.X, (double)c.Y - a.Y, (double)c.Z - a.Z };
+		out[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		out[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		out[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	inline bool PositionLess(const Position& a, const Position& b) {
+		if (a.X != b.X) { return a.X < b.X; }
+		if (a.Y != b.Y) { return a.Y < b.Y; }
+		return a.Z < b.Z;
+	}
+
+	inline bool PositionEqual(const Position& a, const Position& b) {
+		return a.X == b.X && a.Y == b.Y && a.Z == b.Z;
+	}
+}
+
+std::vector<uint32_t> MeshSimplifier::Simplify(const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+											   size_t targetIndexCount, float* resultError) {
+	std::vector<uint32_t> result(indices, indices + (indexCount - indexCount % 3));
+	double maxCost = 0.0;
+
+	if (result.size() > targetIndexCount && vertexCount > 0) {
+		// Copy the positions out into a tightly packed list
+		std::vector<Position> points(vertexCount);
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			memcpy(&points[ix], reinterpret_cast<const uint8_t*>(positions) + ix * positionStride, sizeof(Position));
+		}
+
+		// Group together vertices that share a position, every vertex maps to the first vertex in its group
+		std::vector<uint32_t> sorted(vertexCount);
+		for (size_t ix = 0; ix < vertexCount; ix++) { sorted[ix] = static_cast<uint32_t>(ix); }
+		std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+			return PositionLess(points[a], points[b]) || (PositionEqual(points[a], points[b]) && a < b);
+		});
+		std::vector<uint32_t> group(vertexCount);
+		std::vector<bool> locked(vertexCount, false);
+		for (size_t ix = 0; ix < vertexCount; ) {
+			size_t end = ix + 1;
+			while (end < vertexCount && PositionEqual(points[sorted[ix]], points[sorted[end]])) { end++; }
+			for (size_t member = ix; member < end; member++) {
+				group[sorted[member]] = sorted[ix];
+				// Vertices on attribute seams can't move without tearing the seam open
+				locked[sorted[member]] = end - ix > 1;
+			}
+			ix = end;
+		}
+
+		// An edge is on a border if no triangle uses it in the opposite direction
+		std::unordered_set<uint64_t> directedEdges;
+		directedEdges.reserve(result.size());
+		for (size_t ix = 0; ix < result.size(); ix += 3) {
+			for (int edge = 0; edge < 3; edge++) {
+				uint64_t a = group[result[ix + edge]], b = group[result[ix + (edge + 1) % 3]];
+				directedEdges.insert((a << 32) | b);
+			}
+		}
+		std::vector<bool> borderGroup(vertexCount, false);
+		for (uint64_t edge : directedEdges) {
+			uint64_t a = edge >> 32, b = edge & 0xFFFFFFFF;
+			if (directedEdges.count((b << 32) | a) == 0) {
+				borderGroup[a] = borderGroup[b] = true;
+			}
+		}
+		for (size_t ix = 0; ix < vertexCount; ix++) {
+			locked[ix] = locked[ix] || borderGroup[group[ix]];
+		}
+
+		// Every vertex starts with the planes of the triangles around it, weighted by the triangle's area
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t ix = 0; ix < result.size(); ix += 3) {
+			double normal[3];
+			Cross(points[result[ix]], points[result[ix + 1]], points[result[ix + 2]], normal);
+			double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			if (length <= 0.0) { continue; }
+			normal[0] /= length; normal[1] /= length; normal[2] /= length;
+			const Position& p = points[result[ix]];
+			double d = -(normal[0] * p.X + normal[1] * p.Y + normal[2] * p.Z);
+
+			Quadric plane;
+			plane.AddPlane(normal[0], normal[1], normal[2], d, length * 0.5);
+			for (int corner = 0; corner < 3; corner++) {
+				quadrics[result[ix + corner]].Add(plane);
+			}
+		}
+
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<bool> touched(vertexCount);
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<Collapse> collapses;
+
+		// Each pass collapses a batch of the cheapest edges that don't interfere with each other
+		while (result.size() > targetIndexCount) {
+			const size_t triCount = result.size() / 3;
+
+			// Build the list of triangles around each vertex
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (uint32_t index : result) { adjacencyOffsets[index + 1]++; }
+			for (size_t ix = 0; ix < vertexCount; ix++) { adjacencyOffsets[ix + 1] += adjacencyOffsets[ix]; }
+			adjacency.resize(result.size());
+			{
+				std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t ix = 0; ix < result.size(); ix++) {
+					adjacency[fill[result[ix]]++] = static_cast<uint32_t>(ix / 3);
+				}
+			}
+
+			// Gather and rank every possible collapse along the edges of the mesh
+			collapses.clear();
+			for (size_t ix = 0; ix < result.size(); ix += 3) {
+				for (int edge = 0; edge < 3; edge++) {
+					uint32_t a = result[ix + edge], b = result[ix + (edge + 1) % 3];
+					if (!locked[a]) {
+						Quadric q = quadrics[a]; q.Add(quadrics[b]);
+						collapses.push_back({ a, b, q.Evaluate(points[b]) });
+					}
+					if (!locked[b]) {
+						Quadric q = quadrics[a]; q.Add(quadrics[b]);
+						collapses.push_back({ b, a, q.Evaluate(points[a]) });
+					}
+				}
+			}
+			if (collapses.empty()) { break; }
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+			for (size_t ix = 0; ix < vertexCount; ix++) { remap[ix] = static_cast<uint32_t>(ix); }
+			std::fill(touched.begin(), touched.end(), false);
+
+			// Most collapses remove two triangles, we stop as soon as we've hit the target
+			size_t removedTris = 0;
+			const size_t trisToRemove = triCount - targetIndexCount / 3;
+			for (const Collapse& collapse : collapses) {
+				if (removedTris >= trisToRemove) { break; }
+				if (touched[collapse.From] || touched[collapse.To]) { continue; }
+
+				// Make sure that none of the triangles that we're moving will flip over
+				const uint32_t* begin = adjacency.data() + adjacencyOffsets[collapse.From];
+				const uint32_t* end = adjacency.data() + adjacencyOffsets[collapse.From + 1];
+				bool valid = true;
+				size_t removed = 0;
+				for (const uint32_t* tri = begin; tri != end && valid; tri++) {
+					const uint32_t* corners = result.data() + *tri * 3;
+					if (corners[0] == collapse.To || corners[1] == collapse.To || corners[2] == collapse.To) {
+						removed++;
+						continue;
+					}
+
+					Position moved[3];
+					for (int corner = 0; corner < 3; corner++) {
+						moved[corner] = points[corners[corner] == collapse.From ? collapse.To : corners[corner]];
+					}
+					double before[3], after[3];
+					Cross(points[corners[0]], points[corners[1]], points[corners[2]], before);
+					Cross(moved[0], moved[1], moved[2], after);
+					valid = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] > 0.0;
+				}
+				if (!valid) { continue; }
+
+				remap[collapse.From] = collapse.To;
+				quadrics[collapse.To].Add(quadrics[collapse.From]);
+				maxCost = std::max(maxCost, collapse.Cost);
+				removedTris += removed;
+
+				// Everything around the collapse has changed, leave it alone until the next pass
+				for (const uint32_t* tri = begin; tri != end; tri++) {
+					for (int corner = 0; corner < 3; corner++) {
+						touched[result[*tri * 3 + corner]] = true;
+					}
+				}
+			}
+
+			// Apply the collapses, and throw out triangles that have become degenerate
+			size_t writeIx = 0;
+			for (size_t ix = 0; ix < result.size(); ix += 3) {
+				uint32_t a = remap[result[ix]], b = remap[result[ix + 1]], c = remap[result[ix + 2]];
+				if (a != b && b != c && a != c) {
+					result[writeIx++] = a;
+					result[writeIx++] = b;
+					result[writeIx++] = c;
+				}
+			}
+
+			// Nothing could be collapsed, the rest of the mesh is locked in place
+			if (writeIx == result.size()) {
+				break;
+			}
+			result.resize(writeIx);
+		}
+	}
+
+	if (resultError != nullptr) {
+		*resultError = static_cast<float>(std::sqrt(maxCost));
+	}
+	return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/// <summary>
+/// Simplifies triangle meshes using quadric error metrics (Garland and Heckbert, "Surface Simplification
+/// Using Quadric Error Metrics"). Edges are always collapsed onto one of their existing vertices, so the
+/// simplified index lists can keep using the original vertex buffer
+///
+/// Vertices that lie on an open border, or on an attribute seam (several vertices sharing a position, for
+/// instance where UVs are split) are never moved, so simplification does not open cracks in the mesh
+/// </summary>
+class MeshSimplifier {
+public:
+	/// <summary>
+	/// A single simplified level of detail for a mesh
+	/// </summary>
+	struct Lod {
+		// The triangle list for this level, referencing the vertices of the source mesh
+		std::vector<uint32_t> Indices;
+		// The approximate maximum distance between this level and the source mesh, in object space units
+		float                 Error = 0.0f;
+	};
+
+	MeshSimplifier() = delete;
+
+	/// <summary>
+	/// Simplifies a triangle list by collapsing edges until it has at most the target number of indices,
+	/// or until no more edges can be collapsed without damaging the mesh
+	/// </summary>
+	/// <param name="indices">The triangle list to simplify</param>
+	/// <param name="indexCount">The number of indices in the list</param>
+	/// <param name="positions">A pointer to the position (3 floats) of the first vertex</param>
+	/// <param name="vertexCount">The number of vertices that the indices refer to</param>
+	/// <param name="positionStride">The number of bytes between the positions of consecutive vertices</param>
+	/// <param name="targetIndexCount">The number of indices to simplify the mesh down to</param>
+	/// <param name="resultError">If set, receives the approximate error introduced by the simplification</param>
+	/// <returns>The simplified triangle list</returns>
+	static std::vector<uint32_t> Simplify(const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride,
+										  size_t targetIndexCount, float* resultError = nullptr);
+};
@@ -0,0 +1,409 @@
+#include "Utils/MipGenerator.h"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include <Logging.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_GENERATOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+	// Kaiser filter parameters, these match the defaults that NVIDIA's texture tools use
+	const float KAISER_HALF_WIDTH = 3.0f;
+	const float KAISER_ALPHA      = 4.0f;
+	const float PI                = 3.14159265358979f;
+
+	// The number of steps in our linear to sRGB table, enough that every 8 bit sRGB value can be reached
+	const uint32_t LINEAR_TO_SRGB_STEPS = 4096;
+
+	float SrgbToLinear(float value) {
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float value) {
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+	}
+
+	// Lookup tables for converting between sRGB and linear space, so we don't need a pow per channel
+	struct SrgbTables {
+		float   ToLinear[256];
+		uint8_t ToSrgb[LINEAR_TO_SRGB_STEPS + 1];
+
+		SrgbTables() {
+			for (int ix = 0; ix < 256; ix++) {
+				ToLinear[ix] = SrgbToLinear(ix / 255.0f);
+			}
+			for (uint32_t ix = 0; ix <= LINEAR_TO_SRGB_STEPS; ix++) {
+				ToSrgb[ix] = static_cast<uint8_t>(LinearToSrgb(ix / (float)LINEAR_TO_SRGB_STEPS) * 255.0f + 0.5f);
+			}
+		}
+	};
+
+	// Static locals are initialized once even if several workers get here at the same time
+	const SrgbTables& GetSrgbTables() {
+		static SrgbTables tables;
+		return tables;
+	}
+
+	// Modified Bessel function of the first kind, used by the Kaiser window
+	double BesselI0(double x) {
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; k++) {
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+			if (term < sum * 1e-12) {
+				break;
+			}
+		}
+		return sum;
+	}
+
+	float Sinc(float x) {
+		return std::abs(x) < 1e-6f ? 1.0f : std::sin(PI * x) / (PI * x);
+	}
+
+	// Evaluates the Kaiser windowed sinc, x is in destination texels
+	float Kaiser(float x) {
+		if (std::abs(x) >= KAISER_HALF_WIDTH) {
+			return 0.0f;
+		}
+		float ratio = x / KAISER_HALF_WIDTH;
+		return Sinc(x) * static_cast<float>(BesselI0(KAISER_ALPHA * std::sqrt(1.0 - ratio * ratio)) / BesselI0(KAISER_ALPHA));
+	}
+
+	// A source texel and how much it contributes to a destination texel
+	struct Tap {
+		uint32_t Index;
+		float    Weight;
+	};
+
+	// The taps for every destination texel along one axis, destination texel i uses taps Offsets[i] to Offsets[i + 1]
+	struct AxisFilter {
+		std::vector<Tap>      Taps;
+		std::vector<uint32_t> Offsets;
+		uint32_t              MaxTaps = 0;
+	};
+
+	uint32_t ResolveIndex(int64_t index, uint32_t size, bool wrap) {
+		if (wrap) {
+			int64_t result = index % (int64_t)size;
+			return static_cast<uint32_t>(result < 0 ? result + size : result);
+		}
+		return static_cast<uint32_t>(std::clamp<int64_t>(index, 0, (int64_t)size - 1));
+	}
+
+	// Works out the source texels and weights for every destination texel along an axis. Texels past the
+	// edge are resolved here, so the filtering loops never need to worry about them
+	AxisFilter BuildAxisFilter(uint32_t sourceSize, uint32_t destSize, MipFilter filter, bool wrap) {
+		AxisFilter result;
+		result.Offsets.reserve(destSize + 1);
+		const float scale = sourceSize / (float)destSize;
+
+		for (uint32_t x = 0; x < destSize; x++) {
+			const uint32_t first = static_cast<uint32_t>(result.Taps.size());
+			result.Offsets.push_back(first);
+
+			// If the axis isn't shrinking (ex: the height of a 4x1 image) there's nothing to filter
+			if (filter == MipFilter::Kaiser && scale > 1.0f) {
+				const float center = (x + 0.5f) * scale;
+				const float radius = KAISER_HALF_WIDTH * scale;
+				for (int64_t ix = (int64_t)std::floor(center - radius); ix <= (int64_t)std::ceil(center + radius); ix++) {
+					float weight = Kaiser((ix + 0.5f - center) / scale);
+					if (weight != 0.0f) {
+						result.Taps.push_back({ ResolveIndex(ix, sourceSize, wrap), weight });
+					}
+				}
+			}
+			else {
+				// Box filter, each source texel is weighted by how much of it the destination texel covers. For
+				// odd sizes this spreads the leftover texel across it's neighbours instead of dropping it
+				const float start = x * scale;
+				const float end   = start + scale;
+				for (int64_t ix = (int64_t)std::floor(start); ix < (int64_t)std::ceil(end); ix++) {
+					float overlap = std::min(end, (float)(ix + 1)) - std::max(start, (float)ix);
+					if (overlap > 0.0f) {
+						result.Taps.push_back({ ResolveIndex(ix, sourceSize, wrap), overlap });
+					}
+				}
+			}
+
+			// Normalize so that flat areas stay flat
+			float sum = 0.0f;
+			for (size_t ix = first; ix < result.Taps.size(); ix++) {
+				sum += result.Taps[ix].Weight;
+			}
+			for (size_t ix = first; ix < result.Taps.size(); ix++) {
+				result.Taps[ix].Weight /= sum;
+			}
+			result.MaxTaps = std::max(result.MaxTaps, static_cast<uint32_t>(result.Taps.size()) - first);
+		}
+		result.Offsets.push_back(static_cast<uint32_t>(result.Taps.size()));
+		return result;
+	}
+
+	// A level of the mip chain in linear floating point. Each level is filtered from the floating point
+	// copy of the level above it, so that rounding to 8 bits doesn't build up as we go down the chain
+	struct FloatLevel {
+		uint32_t           Width  = 0;
+		uint32_t           Height = 0;
+		std::vector<float> Data;
+	};
+
+	// Works out which channels are sRGB encoded, alpha is always linear
+	void GetSrgbChannels(uint32_t numChannels, const MipGenerator::Options& options, bool isSrgb[4]) {
+		const bool hasAlpha = numChannels == 2 || numChannels == 4;
+		for (uint32_t channel = 0; channel < 4; channel++) {
+			isSrgb[channel] = channel < numChannels && options.IsSrgb && !(hasAlpha && channel == numChannels - 1);
+		}
+	}
+
+	// Reads texels from an 8 bit image, converting them to linear values
+	struct ByteTexels {
+		const uint8_t* Data;
+		float          Decode[4][256];
+
+		ByteTexels(const uint8_t* data, uint32_t numChannels, const MipGenerator::Options& options) : Data(data) {
+			const SrgbTables& tables = GetSrgbTables();
+			bool isSrgb[4];
+			GetSrgbChannels(numChannels, options, isSrgb);
+			for (uint32_t channel = 0; channel < 4; channel++) {
+				for (int ix = 0; ix < 256; ix++) {
+					Decode[channel][ix] = isSrgb[channel] ? tables.ToLinear[ix] : ix / 255.0f;
+				}
+			}
+		}
+
+		float Get(size_t index, uint32_t channel) const {
+			return Decode[channel][Data[index]];
+		}
+	};
+
+	// Reads texels from a floating point level, which is already linear
+	struct FloatTexels {
+		const float* Data;
+
+		float Get(size_t index, uint32_t channel) const {
+			return Data[index];
+		}
+	};
+
+	// Halves an RGBA image with even dimensions using a 2x2 box filter. The sums are done in integers,
+	// and only converted to floating point at the end
+	void DownsampleBoxRgba8(const uint8_t* source, uint32_t width, FloatLevel& result) {
+		const size_t sourceStride = (size_t)width * 4;
+		const float scale = 1.0f / (4.0f * 255.0f);
+		for (uint32_t y = 0; y < result.Height; y++) {
+			const uint8_t* row0 = source + (size_t)y * 2 * sourceStride;
+			const uint8_t* row1 = row0 + sourceStride;
+			float* dest = result.Data.data() + (size_t)y * result.Width * 4;
+
+			uint32_t x = 0;
+			#ifdef MIP_GENERATOR_SSE2
+			// Two destination texels at a time, from four source texels on each row
+			const __m128i zero = _mm_setzero_si128();
+			const __m128 scaleSse = _mm_set1_ps(scale);
+			for (; x + 2 <= result.Width; x += 2) {
+				__m128i top    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + (size_t)x * 8));
+				__m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + (size_t)x * 8));
+				// Widen to 16 bits and add the rows together, lo holds source texels 0 and 1, hi holds 2 and 3
+				__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+				__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+				// Add each pair of neighbouring texels, the sums end up in the low half of each register
+				lo = _mm_add_epi16(lo, _mm_shuffle_epi32(lo, _MM_SHUFFLE(1, 0, 3, 2)));
+				hi = _mm_add_epi16(hi, _mm_shuffle_epi32(hi, _MM_SHUFFLE(1, 0, 3, 2)));
+				// Widen the sums of both destination texels to 32 bits, and scale them to the 0-1 range
+				__m128i sum = _mm_unpacklo_epi64(lo, hi);
+				_mm_storeu_ps(dest + (size_t)x * 4,     _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(sum, zero)), scaleSse));
+				_mm_storeu_ps(dest + (size_t)x * 4 + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(sum, zero)), scaleSse));
+			}
+			#endif
+			for (; x < result.Width; x++) {
+				for (int channel = 0; channel < 4; channel++) {
+					uint32_t sum = row0[x * 8 + channel] + row0[x * 8 + 4 + channel] + row1[x * 8 + channel] + row1[x * 8 + 4 + channel];
+					dest[x * 4 + channel] = sum * scale;
+				}
+			}
+		}
+	}
+
+	// Halves a floating point RGBA image with even dimensions using a 2x2 box filter
+	void DownsampleBoxRgbaFloat(const float* source, uint32_t width, FloatLevel& result) {
+		const size_t sourceStride = (size_t)width * 4;
+		for (uint32_t y = 0; y < result.Height; y++) {
+			const float* row0 = source + (size_t)y * 2 * sourceStride;
+			const float* row1 = row0 + sourceStride;
+			float* dest = result.Data.data() + (size_t)y * result.Width * 4;
+
+			uint32_t x = 0;
+			#ifdef MIP_GENERATOR_SSE2
+			// Each source texel is a whole register, so one destination texel is just four adds
+			const __m128 quarter = _mm_set1_ps(0.25f);
+			for (; x < result.Width; x++) {
+				__m128 top    = _mm_add_ps(_mm_loadu_ps(row0 + (size_t)x * 8), _mm_loadu_ps(row0 + (size_t)x * 8 + 4));
+				__m128 bottom = _mm_add_ps(_mm_loadu_ps(row1 + (size_t)x * 8), _mm_loadu_ps(row1 + (size_t)x * 8 + 4));
+				_mm_storeu_ps(dest + (size_t)x * 4, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+			}
+			#endif
+			for (; x < result.Width; x++) {
+				for (int channel = 0; channel < 4; channel++) {
+					float sum = row0[x * 8 + channel] + row0[x * 8 + 4 + channel] + row1[x * 8 + channel] + row1[x * 8 + 4 + channel];
+					dest[x * 4 + channel] = sum * 0.25f;
+				}
+			}
+		}
+	}
+
+	// Downsamples any image with separable filters in floating point. Rows are filtered horizontally as they
+	// are needed and cached, so we never hold more than a handful of filtered rows at a time. The channel count
+	// is a template parameter so that the per-texel loops can be unrolled and vectorized, and the source is
+	// read through Texels so that both 8 bit images and floating point levels can be filtered
+	template <uint32_t numChannels, typename Texels>
+	void DownsampleSeparable(const Texels& source, uint32_t width, uint32_t height,
+							 const MipGenerator::Options& options, FloatLevel& result) {
+		const AxisFilter filterX = BuildAxisFilter(width, result.Width, options.Filter, options.WrapX);
+		const AxisFilter filterY = BuildAxisFilter(height, result.Height, options.Filter, options.WrapY);
+
+		const size_t rowSize = (size_t)result.Width * numChannels;
+		const uint32_t numSlots = filterY.MaxTaps + 2;
+		std::vector<float> cache(numSlots * rowSize);
+		std::vector<int64_t> cachedRows(numSlots, -1);
+		uint32_t nextSlot = 0;
+
+		// Gets a source row filtered along x, rows are evicted oldest first. Rows are only ever needed by a
+		// few neighbouring destination rows, so this keeps every row from being filtered more than once
+		auto getRow = [&](uint32_t row) -> const float* {
+			for (uint32_t slot = 0; slot < numSlots; slot++) {
+				if (cachedRows[slot] == row) {
+					return cache.data() + slot * rowSize;
+				}
+			}
+
+			uint32_t slot = nextSlot;
+			nextSlot = (nextSlot + 1) % numSlots;
+			cachedRows[slot] = row;
+
+			float* dest = cache.data() + slot * rowSize;
+			const size_t sourceRow = (size_t)row * width * numChannels;
+			for (uint32_t x = 0; x < result.Width; x++) {
+				float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (uint32_t tap = filterX.Offsets[x]; tap < filterX.Offsets[x + 1]; tap++) {
+					const size_t texel = sourceRow + (size_t)filterX.Taps[tap].Index * numChannels;
+					const float weight = filterX.Taps[tap].Weight;
+					for (uint32_t channel = 0; channel < numChannels; channel++) {
+						sum[channel] += source.Get(texel + channel, channel) * weight;
+					}
+				}
+				for (uint32_t channel = 0; channel < numChannels; channel++) {
+					dest[x * numChannels + channel] = sum[channel];
+				}
+			}
+			return dest;
+		};
+
+		for (uint32_t y = 0; y < result.Height; y++) {
+			float* dest = result.Data.data() + (size_t)y * rowSize;
+			std::fill(dest, dest + rowSize, 0.0f);
+			for (uint32_t tap = filterY.Offsets[y]; tap < filterY.Offsets[y + 1]; tap++) {
+				const float* row = getRow(filterY.Taps[tap].Index);
+				const float weight = filterY.Taps[tap].Weight;
+				for (size_t ix = 0; ix < rowSize; ix++) {
+					dest[ix] += row[ix] * weight;
+				}
+			}
+
+			// Kaiser filters have negative lobes, so we clamp to the range that the stored level can hold
+			// before the next level is filtered from this one
+			if (options.Filter == MipFilter::Kaiser) {
+				for (size_t ix = 0; ix < rowSize; ix++) {
+					dest[ix] = std::clamp(dest[ix], 0.0f, 1.0f);
+				}
+			}
+		}
+	}
+
+	// Picks the fastest way to filter a level, the source is either an 8 bit image or a floating point level
+	template <typename Texels>
+	FloatLevel DownsampleToFloat(const Texels& source, uint32_t width, uint32_t height, uint32_t numChannels, const MipGenerator::Options& options) {
+		FloatLevel result;
+		result.Width  = std::max(width / 2, 1u);
+		result.Height = std::max(height / 2, 1u);
+		result.Data.resize((size_t)result.Width * result.Height * numChannels);
+
+		// Box filtered RGBA images with even sizes are by far the most common, so they get a fast path. Floating
+		// point levels are already linear, so their fast path doesn't care about sRGB
+		const bool isFloat = std::is_same<Texels, FloatTexels>::value;
+		if (options.Filter != MipFilter::Kaiser && (isFloat || !options.IsSrgb) && numChannels == 4 && width % 2 == 0 && height % 2 == 0) {
+			if constexpr (std::is_same<Texels, FloatTexels>::value) {
+				DownsampleBoxRgbaFloat(source.Data, width, result);
+			} else {
+				DownsampleBoxRgba8(source.Data, width, result);
+			}
+		} else {
+			switch (numChannels) {
+				case 1: DownsampleSeparable<1>(source, width, height, options, result); break;
+				case 2: DownsampleSeparable<2>(source, width, height, options, result); break;
+				case 3: DownsampleSeparable<3>(source, width, height, options, result); break;
+				case 4: DownsampleSeparable<4>(source, width, height, options, result); break;
+				default: LOG_ASSERT(false, "Mip generation only supports 1 to 4 channels, got {}", numChannels); break;
+			}
+		}
+		return result;
+	}
+
+	// Rounds a floating point level to 8 bits per channel for storage, converting sRGB channels back from linear
+	MipGenerator::Level EncodeLevel(const FloatLevel& level, uint32_t numChannels, const MipGenerator::Options& options) {
+		const SrgbTables& tables = GetSrgbTables();
+		bool isSrgb[4];
+		GetSrgbChannels(numChannels, options, isSrgb);
+
+		MipGenerator::Level result;
+		result.Width  = level.Width;
+		result.Height = level.Height;
+		result.Data.resize(level.Data.size());
+		for (size_t ix = 0; ix < level.Data.size(); ix++) {
+			float value = std::clamp(level.Data[ix], 0.0f, 1.0f);
+			result.Data[ix] = isSrgb[ix % numChannels] ?
+				tables.ToSrgb[static_cast<uint32_t>(value * LINEAR_TO_SRGB_STEPS + 0.5f)] :
+				static_cast<uint8_t>(value * 255.0f + 0.5f);
+		}
+		return result;
+	}
+}
+
+uint32_t MipGenerator::CalcLevelCount(uint32_t width, uint32_t height) {
+	uint32_t size = std::max(width, height);
+	uint32_t result = 1;
+	while (size > 1) {
+		size >>= 1;
+		result++;
+	}
+	return result;
+}
+
+std::vector<MipGenerator::Level> MipGenerator::Generate(const uint8_t* data, uint32_t width, uint32_t height, uint32_t numChannels, const Options& options) {
+	std::vector<Level> result;
+	if (width <= 1 && height <= 1) {
+		return result;
+	}
+	result.reserve(CalcLevelCount(width, height) - 1);
+
+	// The first level is filtered from the 8 bit image, every level after that is filtered from the
+	// floating point copy of the level above it instead of the rounded one we store
+	FloatLevel level = DownsampleToFloat(ByteTexels(data, numChannels, options), width, height, numChannels, options);
+	result.push_back(EncodeLevel(level, numChannels, options));
+	while (level.Width > 1 || level.Height > 1) {
+		level = DownsampleToFloat(FloatTexels{ level.Data.data() }, level.Width, level.Height, numChannels, options);
+		result.push_back(EncodeLevel(level, numChannels, options));
+	}
+	return result;
+}
+
+MipGenerator::Level MipGenerator::Downsample(const uint8_t* source, uint32_t width, uint32_t height, uint32_t numChannels, const Options& options) {
+	return EncodeLevel(DownsampleToFloat(ByteTexels(source, numChannels, options), width, height, numChannels, options), numChannels, options);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <EnumToString.h>
+
+/// <summary>
+/// The filter used to build the mip chain of a texture
+/// </summary>
+ENUM(MipFilter, uint8_t,
+	// Let the driver build the mip chain with glGenerateTextureMipmap
+	Driver = 0,
+	// Averages the texels covered by each destination texel, fast and never rings
+	Box    = 1,
+	// A Kaiser windowed sinc, keeps smaller levels sharper than a box filter at the cost of some ringing
+	Kaiser = 2
+);
+
+/// <summary>
+/// Builds the mip chain of an 8 bit per channel image on the CPU. Does not touch OpenGL, so
+/// mip levels can be generated on worker threads alongside image decoding
+///
+/// Levels are filtered in floating point, and sRGB encoded images are converted to linear
+/// space before filtering so that smaller levels don't get darker. The common case of a box
+/// filtered RGBA image with even dimensions has an SSE2 path
+/// </summary>
+class MipGenerator {
+public:
+	/// <summary>
+	/// A single level of the mip chain, texels are tightly packed with the same channels as the source
+	/// </summary>
+	struct Level {
+		uint32_t             Width  = 0;
+		uint32_t             Height = 0;
+		std::vector<uint8_t> Data;
+	};
+
+	/// <summary>
+	/// Controls how mip levels are generated
+	/// </summary>
+	struct Options {
+		// The filter to use, Driver is treated the same as Box
+		MipFilter Filter  = MipFilter::Box;
+		// True if the color channels are sRGB encoded. Alpha (the last channel of 2 and 4 channel
+		// images) is always treated as linear
+		bool      IsSrgb  = false;
+		// True if the texture repeats along each axis, otherwise texels past the edge are clamped
+		bool      WrapX   = false;
+		bool      WrapY   = false;
+	};
+
+	MipGenerator() = delete;
+
+	/// <summary>
+	/// Gets the number of mip levels for an image, including the full size image
+	/// </summary>
+	static uint32_t CalcLevelCount(uint32_t width, uint32_t height);
+
+	/// <summary>
+	/// Generates all of the mip levels below the full size image, each level is half the size of
+	/// the last (rounded down) until we reach a 1x1 image. Each level is filtered from a floating
+	/// point copy of the level above it, and only rounded to 8 bits for the result
+	/// </summary>
+	/// <param name="data">The full size image, tightly packed</param>
+	/// <param name="width">The width of the image in texels</param>
+	/// <param name="height">The height of the image in texels</param>
+	/// <param name="numChannels">The number of 8 bit channels per texel, 1 to 4</param>
+	/// <param name="options">Controls the filtering</param>
+	/// <returns>Levels 1 and up of the mip chain, empty if the image is already 1x1</returns>
+	static std::vector<Level> Generate(const uint8_t* data, uint32_t width, uint32_t height, uint32_t numChannels, const Options& options);
+
+	/// <summary>
+	/// Generates the next level of a mip chain from the level above it. When building a whole
+	/// chain prefer Generate, which doesn't round the levels it filters from to 8 bits
+	/// </summary>
+	/// <param name="source">The level to downsample, tightly packed</param>
+	/// <param name="width">The width of the source level</param>
+	/// <param name="height">The height of the source level</param>
+	/// <param name="numChannels">The number of 8 bit channels per texel, 1 to 4</param>
+	/// <param name="options">Controls the filtering</param>
+	/// <returns>The downsampled level</returns>
+	static Level Downsample(const uint8_t* source, uint32_t width, uint32_t height, uint32_t numChannels, const Options& options);
+};
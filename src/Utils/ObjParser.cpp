@@ -0,0 +1,467 @@
+#include "Utils/ObjParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <Logging.h>
+#include "Utils/MemoryMappedFile.h"
+#include "Utils/ThreadPool.h"
+
+namespace {
+	// Files are only split between threads if every thread gets at least this many bytes to parse
+	constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+	// Returns true for characters that separate tokens within a line
+	inline bool IsBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	// Advances past any blank characters, stopping at the end of the line
+	inline const char* SkipBlanks(const char* seek, const char* end) {
+		while (seek < end && IsBlank(*seek)) { seek++; }
+		return seek;
+	}
+
+	// Advances past the rest of the current line, including the newline character
+	inline const char* SkipLine(const char* seek, const char* end) {
+		const char* eol = reinterpret_cast<const char*>(memchr(seek, '\n', end - seek));
+		return eol != nullptr ? eol + 1 : end;
+	}
+
+	// Returns true if the given character ends a command token (ex: the space after "vn")
+	inline bool IsTokenEnd(const char* seek, const char* end) {
+		return seek >= end || IsBlank(*seek) || *seek == '\n';
+	}
+
+	// Parses a float from the stream, leaving the value at 0 if the token is not a number
+	inline const char* ParseFloat(const char* seek, const char* end, float& out) {
+		seek = SkipBlanks(seek, end);
+		// from_chars does not accept a leading plus sign
+		if (seek < end && *seek == '+') { seek++; }
+		auto [ptr, error] = std::from_chars(seek, end, out);
+		if (error != std::errc()) { out = 0.0f; }
+		return ptr;
+	}
+
+	// Parses an integer from the stream, leaving the value at 0 if the token is not a number
+	inline const char* ParseInt(const char* seek, const char* end, int& out) {
+		if (seek < end && *seek == '+') { seek++; }
+		auto [ptr, error] = std::from_chars(seek, end, out);
+		if (error != std::errc()) { out = 0; }
+		return ptr;
+	}
+
+	// Hashes the full 32 bit position, uv and normal indices of a face corner
+	inline uint64_t HashVertexIndices(const glm::ivec3& vertexIndices) {
+		uint64_t hash = static_cast<uint32_t>(vertexIndices.x) * 0x9E3779B97F4A7C15ull;
+		hash ^= static_cast<uint32_t>(vertexIndices.y) * 0xC2B2AE3D27D4EB4Full;
+		hash ^= static_cast<uint32_t>(vertexIndices.z) * 0x165667B19E3779F9ull;
+		hash ^= hash >> 31;
+		hash *= 0xBF58476D1CE4E5B9ull;
+		return hash ^ (hash >> 29);
+	}
+
+	// Selects which de-duplication shard owns a corner, using the high bits of the hash so that
+	// the slots used within a shard's map stay evenly distributed
+	inline size_t GetShard(uint64_t hash, size_t shardCount) {
+		return static_cast<size_t>(hash >> 40) % shardCount;
+	}
+
+	// A flat, open addressing hash map from a corner's attribute indices to the first corner that used
+	// them. Keying on the whole ivec3 means we support the full range of 32 bit attribute indices, and the
+	// flat storage avoids the per-entry allocations that std::unordered_map would make
+	class VertexIndexMap {
+	public:
+		VertexIndexMap(size_t expectedCount) :
+			_count(0)
+		{
+			size_t capacity = 16;
+			while (capacity < expectedCount * 2) { capacity *= 2; }
+			_slots.resize(capacity, Slot{ glm::ivec3(0), EMPTY });
+		}
+
+		// Returns the value stored for the given indices, storing the given value if they were not in the map yet
+		uint32_t FindOrInsert(const glm::ivec3& key, uint64_t hash, uint32_t value) {
+			// Keep the load factor under 70% so that probe sequences stay short
+			if ((_count + 1) * 10 > _slots.size() * 7) {
+				_Grow();
+			}
+
+			const size_t mask = _slots.size() - 1;
+			for (size_t ix = hash & mask; ; ix = (ix + 1) & mask) {
+				Slot& slot = _slots[ix];
+				if (slot.Value == EMPTY) {
+					slot.Key = key;
+					slot.Value = value;
+					_count++;
+					return value;
+				}
+				if (slot.Key == key) {
+					return slot.Value;
+				}
+			}
+		}
+
+	private:
+		// Marks an unused slot, values are corner indices so they will never reach this
+		static constexpr uint32_t EMPTY = ~0u;
+
+		struct Slot {
+			glm::ivec3 Key;
+			uint32_t   Value;
+		};
+
+		std::vector<Slot> _slots;
+		size_t            _count;
+
+		void _Grow() {
+			std::vector<Slot> oldSlots(_slots.size() * 2, Slot{ glm::ivec3(0), EMPTY });
+			_slots.swap(oldSlots);
+
+			const size_t mask = _slots.size() - 1;
+			for (const Slot& slot : oldSlots) {
+				if (slot.Value != EMPTY) {
+					size_t ix = HashVertexIndices(slot.Key) & mask;
+					while (_slots[ix].Value != EMPTY) { ix = (ix + 1) & mask; }
+					_slots[ix] = slot;
+				}
+			}
+		}
+	};
+
+	// Invokes func(0) through func(count - 1), spread across up to threadCount threads. The calling
+	// thread takes part, so only threadCount - 1 extra threads are started
+	template <typename Func>
+	void ParallelFor(size_t count, size_t threadCount, const Func& func) {
+		threadCount = std::min(threadCount, count);
+
+		std::atomic<size_t> next = 0;
+		auto work = [&]() {
+			for (size_t task = next++; task < count; task = next++) {
+				func(task);
+			}
+		};
+
+		std::vector<std::thread> workers;
+		workers.reserve(threadCount > 0 ? threadCount - 1 : 0);
+		for (size_t ix = 1; ix < threadCount; ix++) {
+			workers.emplace_back(work);
+		}
+		work();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	// Stores the data parsed from a line-aligned slice of an OBJ file
+	struct ObjChunk {
+		const char* Begin = nullptr;
+		const char* End   = nullptr;
+
+		std::vector<glm::vec3>  Positions;
+		std::vector<glm::vec3>  Normals;
+		std::vector<glm::vec2>  UVs;
+		// The 1-based (position, uv, normal) indices of every face corner, 0 for omitted attributes
+		std::vector<glm::ivec3> Corners;
+		// Bits 0-2 are set when that component of a corner was a negative index. Those were resolved against
+		// this chunk's attribute counts, and still need the chunk's attribute offsets added to them
+		std::vector<uint8_t>    RelativeMask;
+		// The number of corners in each face
+		std::vector<uint32_t>   FaceSizes;
+		// The first corner with an index outside of the file's attributes, or -1 if they were all valid
+		int64_t                 InvalidCorner = -1;
+
+		// The chunk's local corner indices, bucketed by the de-duplication shard that owns them
+		std::vector<std::vector<uint32_t>> ShardCorners;
+
+		// The offsets of this chunk's data within the merged result
+		glm::ivec3 AttribOffset = glm::ivec3(0);
+		size_t     CornerOffset = 0;
+		size_t     VertexOffset = 0;
+		size_t     IndexOffset  = 0;
+		size_t     NumVertices  = 0;
+		size_t     NumIndices   = 0;
+	};
+
+	// Parses the attributes and face corners in a chunk, without de-duplicating anything
+	void ParseChunk(ObjChunk& chunk) {
+		const char* end = chunk.End;
+		const char* seek = chunk.Begin;
+		glm::vec3 vecData;
+
+		// Read and process the entire chunk, one line at a time
+		while (seek < end) {
+			seek = SkipBlanks(seek, end);
+			if (seek >= end) { break; }
+
+			const char* command = seek;
+
+			// The v command defines a vertex's position
+			if (command[0] == 'v' && IsTokenEnd(command + 1, end)) {
+				seek = ParseFloat(command + 1, end, vecData.x);
+				seek = ParseFloat(seek, end, vecData.y);
+				seek = ParseFloat(seek, end, vecData.z);
+				chunk.Positions.push_back(vecData);
+			}
+			// The vn command defines a vertex normal
+			else if (command[0] == 'v' && command + 1 < end && command[1] == 'n' && IsTokenEnd(command + 2, end)) {
+				seek = ParseFloat(command + 2, end, vecData.x);
+				seek = ParseFloat(seek, end, vecData.y);
+				seek = ParseFloat(seek, end, vecData.z);
+				chunk.Normals.push_back(vecData);
+			}
+			// The vt command defines a texture coordinate, we ignore the optional w component
+			else if (command[0] == 'v' && command + 1 < end && command[1] == 't' && IsTokenEnd(command + 2, end)) {
+				seek = ParseFloat(command + 2, end, vecData.x);
+				seek = ParseFloat(seek, end, vecData.y);
+				chunk.UVs.push_back(glm::vec2(vecData.x, vecData.y));
+			}
+
+			// The f command defines a polygon in the mesh, which is triangulated during the merge
+			else if (command[0] == 'f' && IsTokenEnd(command + 1, end)) {
+				seek = command + 1;
+
+				uint32_t cornerCount = 0;
+
+				while (true) {
+					seek = SkipBlanks(seek, end);
+					// Stop at the end of the line, or at a trailing comment
+					if (seek >= end || *seek == '\n' || *seek == '#') { break; }
+
+					// Read the corner in the form v, v/t, v//n or v/t/n
+					glm::ivec3 vertexIndices = glm::ivec3(0);
+					const char* tokenStart = seek;
+					seek = ParseInt(seek, end, vertexIndices.x);
+					if (seek < end && *seek == '/') {
+						seek++;
+						if (seek < end && *seek != '/') {
+							seek = ParseInt(seek, end, vertexIndices.y);
+						}
+						if (seek < end && *seek == '/') {
+							seek = ParseInt(seek + 1, end, vertexIndices.z);
+						}
+					}
+
+					// Garbage in the face definition, skip the token so we can't get stuck on it
+					if (seek == tokenStart) {
+						while (!IsTokenEnd(seek, end)) { seek++; }
+						continue;
+					}
+
+					// The OBJ format can have negative values, which are a reference from the last added attributes.
+					// We only know how many attributes this chunk has added so far, so we flag these to be offset later
+					uint8_t relative = 0;
+					if (vertexIndices.x < 0) { vertexIndices.x = static_cast<int>(chunk.Positions.size()) + 1 + vertexIndices.x; relative |= 0b001; }
+					if (vertexIndices.y < 0) { vertexIndices.y = static_cast<int>(chunk.UVs.size())       + 1 + vertexIndices.y; relative |= 0b010; }
+					if (vertexIndices.z < 0) { vertexIndices.z = static_cast<int>(chunk.Normals.size())   + 1 + vertexIndices.z; relative |= 0b100; }
+
+					chunk.Corners.push_back(vertexIndices);
+					chunk.RelativeMask.push_back(relative);
+					cornerCount++;
+				}
+
+				if (cornerCount > 0) {
+					chunk.FaceSizes.push_back(cornerCount);
+				}
+			}
+
+			// Skip anything left on the line (comments, unsupported commands, extra components)
+			seek = SkipLine(seek, end);
+		}
+	}
+}
+
+void ObjParser::Result::Clear() {
+	Positions.clear();
+	Normals.clear();
+	UVs.clear();
+	Vertices.clear();
+	Indices.clear();
+}
+
+bool ObjParser::ParseFile(const std::string& filename, Result& result, uint32_t threadCount) {
+	// Map the file so we can walk it without copying it into our own buffers
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(filename);
+
+	// If our file fails to open, we will throw an error
+	if (file == nullptr) {
+		throw std::runtime_error("Failed to open file");
+	}
+
+	const char* data = reinterpret_cast<const char*>(file->GetData());
+	if (!Parse(data, data + file->GetSize(), result, threadCount)) {
+		LOG_WARN("Failed to parse OBJ file \"{}\"", filename);
+		return false;
+	}
+	return true;
+}
+
+bool ObjParser::Parse(const char* begin, const char* end, Result& result, uint32_t threadCount) {
+	result.Clear();
+
+	// Thread pool jobs (ex: meshes being loaded in the background) already have a worker per core,
+	// so spreading a single file across more threads would only oversubscribe the CPU
+	if (ThreadPool::IsWorkerThread()) {
+		threadCount = 1;
+	}
+	else if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// Split the data into line aligned chunks, small files will end up with a single chunk
+	const size_t size = static_cast<size_t>(end - begin);
+	const size_t numChunks = std::max<size_t>(1, std::min<size_t>(threadCount, size / MIN_CHUNK_SIZE));
+	std::vector<ObjChunk> chunks(numChunks);
+	const char* seek = begin;
+	for (size_t ix = 0; ix < numChunks; ix++) {
+		chunks[ix].Begin = seek;
+		seek = ix + 1 < numChunks ? SkipLine(std::max(seek, begin + (size / numChunks) * (ix + 1)), end) : end;
+		chunks[ix].End = seek;
+	}
+
+	// Tokenize all the chunks in parallel
+	ParallelFor(numChunks, numChunks, [&](size_t ix) {
+		ParseChunk(chunks[ix]);
+	});
+
+	// Determine where each chunk's attributes and corners land in the full file, and gather the attributes
+	glm::ivec3 attribCount = glm::ivec3(0);
+	size_t cornerCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.AttribOffset = attribCount;
+		chunk.CornerOffset = cornerCount;
+		attribCount += glm::ivec3(chunk.Positions.size(), chunk.UVs.size(), chunk.Normals.size());
+		cornerCount += chunk.Corners.size();
+	}
+	result.Positions.reserve(attribCount.x);
+	result.UVs.reserve(attribCount.y);
+	result.Normals.reserve(attribCount.z);
+	for (const ObjChunk& chunk : chunks) {
+		result.Positions.insert(result.Positions.end(), chunk.Positions.begin(), chunk.Positions.end());
+		result.UVs.insert(result.UVs.end(), chunk.UVs.begin(), chunk.UVs.end());
+		result.Normals.insert(result.Normals.end(), chunk.Normals.begin(), chunk.Normals.end());
+	}
+
+	// Resolve relative indices now that we know the offsets, and bucket the corners by their shard
+	const size_t numShards = numChunks;
+	ParallelFor(numChunks, numChunks, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		chunk.ShardCorners.resize(numShards);
+		for (size_t corner = 0; corner < chunk.Corners.size(); corner++) {
+			glm::ivec3& vertexIndices = chunk.Corners[corner];
+			const uint8_t relative = chunk.RelativeMask[corner];
+			if (relative & 0b001) { vertexIndices.x += chunk.AttribOffset.x; }
+			if (relative & 0b010) { vertexIndices.y += chunk.AttribOffset.y; }
+			if (relative & 0b100) { vertexIndices.z += chunk.AttribOffset.z; }
+
+			// Positions are required, the other attributes may be omitted (0), but every index must exist
+			if (vertexIndices.x < 1 || vertexIndices.x > attribCount.x ||
+				vertexIndices.y < 0 || vertexIndices.y > attribCount.y ||
+				vertexIndices.z < 0 || vertexIndices.z > attribCount.z) {
+				chunk.InvalidCorner = static_cast<int64_t>(corner);
+				return;
+			}
+			chunk.ShardCorners[GetShard(HashVertexIndices(vertexIndices), numShards)].push_back(static_cast<uint32_t>(corner));
+		}
+	});
+
+	// Reject the whole file if any face referenced an attribute that doesn't exist, rather than letting
+	// the loaders read past the end of the attributes
+	for (const ObjChunk& chunk : chunks) {
+		if (chunk.InvalidCorner >= 0) {
+			const glm::ivec3& vertexIndices = chunk.Corners[chunk.InvalidCorner];
+			LOG_WARN("OBJ face corner {} references an attribute that does not exist (v {}, vt {}, vn {} with {} positions, {} uvs and {} normals)",
+				chunk.CornerOffset + chunk.InvalidCorner, vertexIndices.x, vertexIndices.y, vertexIndices.z, attribCount.x, attribCount.y, attribCount.z);
+			result.Clear();
+			return false;
+		}
+	}
+
+	// Each shard walks its corners in file order, linking every corner to the first corner with the same
+	// attributes. Since a key always maps to the same shard, this gives the same result as a single map
+	std::vector<uint32_t> links(cornerCount);
+	ParallelFor(numShards, numShards, [&](size_t shard) {
+		// Most corners in a closed mesh are shared between several faces, so start with room for a
+		// quarter of this shard's corners and let the map grow from there
+		size_t shardCorners = 0;
+		for (const ObjChunk& chunk : chunks) {
+			shardCorners += chunk.ShardCorners[shard].size();
+		}
+
+		// Maps the obj indices of a corner to the first corner that used them
+		VertexIndexMap vertexMap(shardCorners / 4);
+		for (const ObjChunk& chunk : chunks) {
+			for (uint32_t corner : chunk.ShardCorners[shard]) {
+				const glm::ivec3& vertexIndices = chunk.Corners[corner];
+				const uint32_t index = static_cast<uint32_t>(chunk.CornerOffset + corner);
+				links[index] = vertexMap.FindOrInsert(vertexIndices, HashVertexIndices(vertexIndices), index);
+			}
+		}
+	});
+
+	// Corners that link to themselves are the first use of a vertex, count them so that vertices are
+	// numbered in the order they first appear in the file
+	std::vector<uint8_t> isNew(cornerCount);
+	ParallelFor(numChunks, numChunks, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		for (size_t corner = chunk.CornerOffset; corner < chunk.CornerOffset + chunk.Corners.size(); corner++) {
+			isNew[corner] = links[corner] == corner;
+			chunk.NumVertices += isNew[corner];
+		}
+		for (uint32_t faceSize : chunk.FaceSizes) {
+			chunk.NumIndices += faceSize > 2 ? (faceSize - 2) * 3 : 0;
+		}
+	});
+
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		chunk.VertexOffset = vertexCount;
+		chunk.IndexOffset = indexCount;
+		vertexCount += chunk.NumVertices;
+		indexCount += chunk.NumIndices;
+	}
+	result.Vertices.resize(vertexCount);
+	result.Indices.resize(indexCount);
+
+	// Number the new vertices, replacing their links with their vertex index
+	ParallelFor(numChunks, numChunks, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		uint32_t index = static_cast<uint32_t>(chunk.VertexOffset);
+		for (size_t corner = 0; corner < chunk.Corners.size(); corner++) {
+			if (isNew[chunk.CornerOffset + corner]) {
+				// Store as 0-based indices, omitted attributes will become -1
+				result.Vertices[index] = chunk.Corners[corner] - glm::ivec3(1);
+				links[chunk.CornerOffset + corner] = index++;
+			}
+		}
+	});
+
+	// Point the remaining corners at the vertex of the corner they link to, then triangulate the faces as
+	// a fan around the first corner (this matches the order blender and most exporters use)
+	ParallelFor(numChunks, numChunks, [&](size_t ix) {
+		ObjChunk& chunk = chunks[ix];
+		for (size_t corner = chunk.CornerOffset; corner < chunk.CornerOffset + chunk.Corners.size(); corner++) {
+			if (!isNew[corner]) {
+				links[corner] = links[links[corner]];
+			}
+		}
+
+		uint32_t* indices = result.Indices.data() + chunk.IndexOffset;
+		size_t corner = chunk.CornerOffset;
+		for (uint32_t faceSize : chunk.FaceSizes) {
+			// Emit a triangle for every corner after the second
+			for (uint32_t cornerIx = 2; cornerIx < faceSize; cornerIx++) {
+				*indices++ = links[corner];
+				*indices++ = links[corner + cornerIx - 1];
+				*indices++ = links[corner + cornerIx];
+			}
+			corner += faceSize;
+		}
+	});
+	return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <GLM/glm.hpp>
+
+/// <summary>
+/// A streaming tokenizer for Wavefront OBJ files that is shared between our OBJ loaders. The parser
+/// walks a memory mapped view of the file directly, without any per-line string or stream allocations,
+/// and parses numbers with std::from_chars.
+///
+/// Faces with any number of corners are fan-triangulated, and all four face index forms
+/// (v, v/t, v//n and v/t/n) are supported, as well as negative (relative) indices. Files with face
+/// indices that don't refer to an attribute in the file are rejected
+///
+/// Large files can be split into line aligned chunks that are parsed on separate threads. The chunks
+/// are then merged and de-duplicated in parallel, in a way that produces exactly the same output as
+/// parsing the file on a single thread
+/// </summary>
+class ObjParser {
+public:
+	/// <summary>
+	/// Stores the attribute streams and the de-duplicated vertex and index lists parsed from an OBJ file
+	/// </summary>
+	struct Result {
+		// The positions declared with the v command
+		std::vector<glm::vec3>  Positions;
+		// The normals declared with the vn command
+		std::vector<glm::vec3>  Normals;
+		// The texture coordinates declared with the vt command
+		std::vector<glm::vec2>  UVs;
+		// The unique combinations of (position, uv, normal) indices referenced by faces. Indices are
+		// zero based, with -1 indicating that the face did not reference that attribute
+		std::vector<glm::ivec3> Vertices;
+		// Indices into Vertices, 3 per triangle
+		std::vector<uint32_t>   Indices;
+
+		/// <summary>
+		/// Clears all data, without releasing the underlying memory
+		/// </summary>
+		void Clear();
+	};
+
+	ObjParser() = delete;
+
+	/// <summary>
+	/// Parses an OBJ file from disk
+	/// </summary>
+	/// <param name="filename">The path to the OBJ file to parse</param>
+	/// <param name="result">The result to store the parsed data into, will be cleared first</param>
+	/// <param name="threadCount">The maximum number of threads to parse with, or 0 to use all hardware threads. Thread pool workers always parse on their own thread</param>
+	/// <returns>True if the file was parsed, false if a face referenced an attribute that does not exist</returns>
+	static bool ParseFile(const std::string& filename, Result& result, uint32_t threadCount = 1);
+
+	/// <summary>
+	/// Parses OBJ data from a block of memory
+	/// </summary>
+	/// <param name="begin">A pointer to the first character to parse</param>
+	/// <param name="end">A pointer to one past the last character to parse</param>
+	/// <param name="result">The result to store the parsed data into, will be cleared first</param>
+	/// <param name="threadCount">The maximum number of threads to parse with, or 0 to use all hardware threads. Thread pool workers always parse on their own thread</param>
+	/// <returns>True if the data was parsed, false if a face referenced an attribute that does not exist</returns>
+	static bool Parse(const char* begin, const char* end, Result& result, uint32_t threadCount = 1);
+};
@@ -1,12 +1,22 @@
 #include "Utils/OptimizedObjLoader.h"
 
 #include "ObjLoader.h"
+#include "ObjParser.h"
 
 #include <string>
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include <zlib.h>
+#include <GLM/gtc/packing.hpp>
 
 #include "Utils/StringUtils.h"
 #include "GLFW/glfw3.h"
@@ -15,9 +25,71 @@
 const char HEADER_BYTES[4] = { 'B', 'O', 'B', 'J' };
 const std::string binaryExtension = ".bin";
 
+// The number of bytes of index and vertex data that are compressed together, keeping this bounded
+// means a block never needs more than a small, fixed amount of memory to compress or decompress
+const uint32_t COMPRESSION_BLOCK_SIZE = 256 * 1024;
+
+namespace {
+	// Returns true if every vertex has the exact same bytes for the given attribute
+	bool IsAttributeConstant(const uint8_t* vertexData, uint32_t numVertices, const BufferAttribute& attrib) {
+		const size_t size = GetAttributeByteSize(attrib.Type, attrib.Size);
+		const uint8_t* first = vertexData + attrib.Offset;
+		for (uint32_t ix = 1; ix < numVertices; ix++) {
+			if (memcmp(first, first + (size_t)ix * attrib.Stride, size) != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Returns true if every component of a float attribute is within [0, 1]
+	bool IsAttributeUnitRange(const uint8_t* vertexData, uint32_t numVertices, const BufferAttribute& attrib) {
+		for (uint32_t ix = 0; ix < numVertices; ix++) {
+			const float* value = reinterpret_cast<const float*>(vertexData + (size_t)ix * attrib.Stride + attrib.Offset);
+			for (int component = 0; component < attrib.Size; component++) {
+				if (!(value[component] >= 0.0f && value[component] <= 1.0f)) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	// Gets the lock for converting the OBJ file at a path, so that two workers loading the same mesh don't
+	// both convert it. Locks are never removed, there is only one per mesh file we've loaded
+	std::mutex& GetConversionLock(const std::filesystem::path& binPath) {
+		static std::mutex mapLock;
+		static std::unordered_map<std::string, std::unique_ptr<std::mutex>> locks;
+
+		std::error_code error;
+		std::filesystem::path key = std::filesystem::absolute(binPath, error).lexically_normal();
+		std::lock_guard<std::mutex> lock(mapLock);
+		std::unique_ptr<std::mutex>& result = locks[key.generic_string()];
+		if (result == nullptr) {
+			result = std::make_unique<std::mutex>();
+		}
+		return *result;
+	}
+
+	// Reads up to 4 floats out of an attribute, filling the rest in with (0, 0, 0, 1) like OpenGL does
+	glm::vec4 ReadFloatAttribute(const uint8_t* vertex, const BufferAttribute& attrib) {
+		glm::vec4 result = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		memcpy(&result.x, vertex + attrib.Offset, std::min(attrib.Size, 4) * sizeof(float));
+		return result;
+	}
+}
+
 namespace fs = std::filesystem;
 
-VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename) {
+VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& filename, MeshDetails* details) {
+	std::string binFile = ResolveBinaryFile(filename);
+	if (binFile.empty()) {
+		return nullptr;
+	}
+	return _LoadFromBinFile(binFile, details);
+}
+
+std::string OptimizedObjLoader::ResolveBinaryFile(const std::string& filename) {
 	// Get the file extension and lowercase it
 	fs::path filePath = std::filesystem::path(filename);
 	std::string extension = filePath.extension().string();
@@ -27,27 +99,35 @@ VertexArrayObject::Sptr OptimizedObjLoader::LoadFromFile(const std::string& file
 	if (extension == ".obj") {
 		// Get the binary path
 		fs::path binPath = filePath.replace_extension(binaryExtension);
-		// If the file does not exist, convert the OBJ file to a binary file
-		if (!fs::exists(binPath)) {
-			ConvertToBinary(filename, binPath.string());
+		// If the file does not exist or is out of date, convert the OBJ file to a binary file. Only one worker
+		// converts a file at a time, the others wait and then find the file up to date
+		std::lock_guard<std::mutex> lock(GetConversionLock(binPath));
+		if (!fs::exists(binPath) || _IsBinaryFileStale(filename, binPath.string())) {
+			if (!ConvertToBinary(filename, binPath.string())) {
+				return "";
+			}
 		}
 		// Load the corresponding binary file
-		return _LoadFromBinFile(binPath.string());
+		return binPath.string();
 	} 
 	// Load our fancy binary files
 	else if (extension == ".bin") {
-		return _LoadFromBinFile(filename);
+		return filename;
 	}
 	// We've never met this extension in our life
 	else {
 		LOG_WARN("Cannot load model from \"{}\"", filename);
-		return nullptr;
+		return "";
 	}
 }
 
-void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile) {
+bool OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::string& outFile, BinaryMeshCompression compression) {
 	// Load in the input file
 	MeshBuilder<VertexPosNormTexColTangents>* mesh = _LoadFromObjFile(inFile);
+	if (mesh == nullptr) {
+		LOG_WARN("Cannot convert \"{}\" to a binary mesh", inFile);
+		return false;
+	}
 
 	float startTime = static_cast<float>(glfwGetTime());
 
@@ -62,163 +142,261 @@ void OptimizedObjLoader::ConvertToBinary(const std::string& inFile, const std::s
 		outFileName = path.string();
 	}
 
+	// Reorder the mesh for the GPU's vertex caches before we save it, since we only pay for this once
+	MeshOptimizer::Report cacheReport = mesh->Optimize();
+	LOG_TRACE("Optimized \"{}\" for vertex cache: ACMR {} -> {}, ATVR {} -> {}", inFile,
+		cacheReport.Before.ACMR, cacheReport.After.ACMR, cacheReport.Before.ATVR, cacheReport.After.ATVR);
+
+	// Generate the simplified levels of detail, these share the vertex data so they only cost us the extra indices
+	std::vector<MeshSimplifier::Lod> lods = mesh->GenerateLods();
+	for (size_t ix = 0; ix < lods.size(); ix++) {
+		LOG_TRACE("Generated LOD {} for \"{}\" with {} triangles (error {})", ix + 1, inFile, lods[ix].Indices.size() / 3, lods[ix].Error);
+	}
+
 	// Save the mesh to the file
-	SaveBinaryFile(*mesh, outFileName);
+	SaveBinaryFile(*mesh, outFileName, compression, lods);
 
 	float endTime = static_cast<float>(glfwGetTime());
 	LOG_TRACE("Converted OBJ file to binary \"{}\" in {} seconds ({} vertices, {} indices)", inFile, endTime - startTime, mesh->GetVertexCount(), mesh->GetIndexCount());
 
 	// We no longer need the mesh data, free it
 	delete mesh;
+	return true;
 }
 
-MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
-	// Open our file in binary mode
-	std::ifstream file;
-	file.open(filename, std::ios::binary);
+void OptimizedObjLoader::_SaveBinaryFile(const uint8_t* vertexData, uint32_t numVertices, const std::vector<BufferAttribute>& vDecl,
+										 const uint32_t* indexData, uint32_t numIndices, const std::string& outFilename, BinaryMeshCompression compression,
+										 const std::vector<MeshSimplifier::Lod>& lods) {
+	// Work out how we'll store each attribute, the source and output declarations are kept in sync
+	std::vector<BufferAttribute> sourceDecl;
+	std::vector<BufferAttribute> outputDecl;
+	std::vector<ConstantAttribute> constants;
+	uint16_t stride = 0;
+	for (const BufferAttribute& attrib : vDecl) {
+		const bool isFloat = attrib.Type == AttributeType::Float && attrib.Size <= 4;
+
+		// Attributes that are the same for every vertex (like the white color our OBJ files get) don't need
+		// to be stored per vertex. We always keep positions so that the file has a valid vertex layout
+		if (isFloat && attrib.Usage != AttribUsage::Position && numVertices > 0 && IsAttributeConstant(vertexData, numVertices, attrib)) {
+			ConstantAttribute constant;
+			constant.Slot  = attrib.Slot;
+			constant.Usage = attrib.Usage;
+			constant.Value = ReadFloatAttribute(vertexData, attrib);
+			constants.push_back(constant);
+			continue;
+		}
 
-	// If our file fails to open, we will throw an error
-	if (!file) {
-		throw std::runtime_error("Failed to open file");
+		BufferAttribute packed = attrib;
+		// Directions only need 10 bits per component, and the GPU will unpack them for us
+		if (isFloat && attrib.Size == 3 && (attrib.Usage == AttribUsage::Normal || attrib.Usage == AttribUsage::Tangent || attrib.Usage == AttribUsage::BiTangent)) {
+			packed.Type = AttributeType::Int_2_10_10_10_Rev;
+			packed.Size = 4;
+			packed.Normalized = true;
+		}
+		// UVs within [0, 1] can be stored as 16 bit fixed point, anything else (ex: tiled UVs) gets half floats
+		else if (isFloat && attrib.Usage == AttribUsage::Texture) {
+			const bool unitRange = IsAttributeUnitRange(vertexData, numVertices, attrib);
+			packed.Type = unitRange ? AttributeType::UShort : AttributeType::HalfFloat;
+			packed.Normalized = unitRange;
+		}
+		// Colors only need 8 bits per channel
+		else if (isFloat && attrib.Usage == AttribUsage::Color && IsAttributeUnitRange(vertexData, numVertices, attrib)) {
+			packed.Type = AttributeType::UByte;
+			packed.Normalized = true;
+		}
+
+		// Keep every attribute 4 byte aligned
+		packed.Offset = stride;
+		stride += static_cast<uint16_t>((GetAttributeByteSize(packed.Type, packed.Size) + 3) & ~3ull);
+
+		sourceDecl.push_back(attrib);
+		outputDecl.push_back(packed);
+	}
+	for (BufferAttribute& attrib : outputDecl) {
+		attrib.Stride = stride;
 	}
 
-	// Could also take this in as a parameter
-	glm::vec4 color = glm::vec4(1.0f);
+	// 16 bit indices are enough to address the first 65536 vertices
+	const IndexType indexType = numVertices <= 65536 ? IndexType::UShort : IndexType::UInt;
+	const size_t indexSize = GetIndexTypeSize(indexType);
+
+	// The levels of detail are stored right after the mesh's indices, using the same index type
+	std::vector<LodHeader> lodHeaders;
+	size_t totalIndices = numIndices;
+	for (const MeshSimplifier::Lod& lod : lods) {
+		LodHeader lodHeader;
+		lodHeader.NumIndices = static_cast<uint32_t>(lod.Indices.size());
+		lodHeader.Error      = lod.Error;
+		lodHeaders.push_back(lodHeader);
+		totalIndices += lod.Indices.size();
+	}
+	const size_t indexBytes = totalIndices * indexSize;
+
+	// Build the index and vertex data that will be stored in the file
+	std::vector<uint8_t> payload(indexBytes + (size_t)stride * numVertices);
+	uint8_t* outIndices = payload.data();
+	auto writeIndices = [&](const uint32_t* data, size_t count) {
+		if (indexType == IndexType::UShort) {
+			uint16_t* indices = reinterpret_cast<uint16_t*>(outIndices);
+			for (size_t ix = 0; ix < count; ix++) {
+				indices[ix] = static_cast<uint16_t>(data[ix]);
+			}
+		} else if (count > 0) {
+			memcpy(outIndices, data, count * indexSize);
+		}
+		outIndices += count * indexSize;
+	};
+	writeIndices(indexData, numIndices);
+	for (const MeshSimplifier::Lod& lod : lods) {
+		writeIndices(lod.Indices.data(), lod.Indices.size());
+	}
 
-	// Our attributes
-	std::vector<glm::vec3>  positions;
-	std::vector<glm::vec3>  normals;
-	std::vector<glm::vec2>  uvs;
-	std::vector<glm::ivec3> vertices;
-	std::vector<uint32_t>   indices;
+	uint8_t* outVertex = payload.data() + indexBytes;
+	for (uint32_t ix = 0; ix < numVertices; ix++, outVertex += stride) {
+		for (size_t attribIx = 0; attribIx < outputDecl.size(); attribIx++) {
+			const BufferAttribute& source = sourceDecl[attribIx];
+			const BufferAttribute& packed = outputDecl[attribIx];
+			const uint8_t* in = vertexData + (size_t)ix * source.Stride;
+			uint8_t* out = outVertex + packed.Offset;
+
+			// Attributes we are not re-packing are copied as-is
+			if (packed.Type == source.Type) {
+				memcpy(out, in + source.Offset, GetAttributeByteSize(source.Type, source.Size));
+				continue;
+			}
 
-	// Maps a key generated from obj indices to a vertex index that
-	// has been added to the mesh already
-	std::unordered_map<uint64_t, uint32_t> vertexMap;
+			glm::vec4 value = ReadFloatAttribute(in, source);
+			switch (packed.Type) {
+				case AttributeType::Int_2_10_10_10_Rev: {
+					glm::vec3 direction = glm::vec3(value);
+					float length = glm::length(direction);
+					uint32_t result = glm::packSnorm3x10_1x2(glm::vec4(length > 0.0f ? direction / length : direction, 0.0f));
+					memcpy(out, &result, sizeof(uint32_t));
+					break;
+				}
+				case AttributeType::UShort:
+					for (int component = 0; component < packed.Size; component++) {
+						reinterpret_cast<uint16_t*>(out)[component] = static_cast<uint16_t>(glm::round(glm::clamp(value[component], 0.0f, 1.0f) * 65535.0f));
+					}
+					break;
+				case AttributeType::HalfFloat:
+					for (int component = 0; component < packed.Size; component++) {
+						reinterpret_cast<uint16_t*>(out)[component] = glm::packHalf1x16(value[component]);
+					}
+					break;
+				case AttributeType::UByte:
+					for (int component = 0; component < packed.Size; component++) {
+						out[component] = static_cast<uint8_t>(glm::round(glm::clamp(value[component], 0.0f, 1.0f) * 255.0f));
+					}
+					break;
+				default:
+					break;
+			}
+		}
+	}
 
-	// We'll use the mesh builder since it supports easily adding
-	// vertices and indices
-	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
+	// Compress the payload in fixed size blocks, storing the compressed size of each one
+	BinaryHeaderV2 headerV2 = BinaryHeaderV2();
+	headerV2.NumConstants = static_cast<uint8_t>(constants.size());
+	headerV2.NumLods      = static_cast<uint8_t>(lodHeaders.size());
+	std::vector<uint32_t> blockSizes;
+	std::vector<uint8_t> compressed;
+	if (compression == BinaryMeshCompression::Deflate && !payload.empty()) {
+		for (size_t offset = 0; offset < payload.size(); offset += COMPRESSION_BLOCK_SIZE) {
+			uLong rawSize = static_cast<uLong>(std::min<size_t>(COMPRESSION_BLOCK_SIZE, payload.size() - offset));
+			uLongf blockSize = compressBound(rawSize);
+			size_t start = compressed.size();
+			compressed.resize(start + blockSize);
+			if (compress2(compressed.data() + start, &blockSize, payload.data() + offset, rawSize, Z_BEST_COMPRESSION) != Z_OK) {
+				throw std::runtime_error("Failed to compress mesh data");
+			}
+			compressed.resize(start + blockSize);
+			blockSizes.push_back(static_cast<uint32_t>(blockSize));
+		}
 
-	// Storage for temporary data
-	std::string line;
-	glm::vec3 vecData;
-	glm::ivec3 vertexIndices;
+		headerV2.Compression = BinaryMeshCompression::Deflate;
+		headerV2.BlockSize   = COMPRESSION_BLOCK_SIZE;
+		headerV2.NumBlocks   = static_cast<uint32_t>(blockSizes.size());
+	}
 
-	float startTime = static_cast<float>(glfwGetTime());
+	// Create the fixed size header for our output file
+	BinaryHeader header  = BinaryHeader();
+	header.Version       = 0x02; // Version 1 files are still supported by the loader, but we no longer write them
+	header.NumIndices    = numIndices;
+	header.IndicesType   = indexType;
+	header.NumVertices   = numVertices;
+	header.VertexStride  = stride;
+	header.NumAttributes = static_cast<uint8_t>(outputDecl.size());
+
+	// The file is written to a temporary file that is moved over the output once it's complete, so that a
+	// crash or a worker reading the file never sees half of it. Each thread gets it's own temporary file
+	const std::string tempFilename = outFilename + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	std::ofstream file(tempFilename, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open output file");
+	}
 
-	// Read and process the entire file
-	while (file.peek() != EOF) {
-		// Read in the first part of the line (ex: f, v, vn, etc...)
-		std::string command;
-		file >> command;
+	// Write the headers, followed by the vertex declaration, the attributes we dropped and the levels of detail
+	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+	file.write(reinterpret_cast<const char*>(&headerV2), sizeof(BinaryHeaderV2));
+	file.write(reinterpret_cast<const char*>(outputDecl.data()), outputDecl.size() * sizeof(BufferAttribute));
+	file.write(reinterpret_cast<const char*>(constants.data()), constants.size() * sizeof(ConstantAttribute));
+	file.write(reinterpret_cast<const char*>(lodHeaders.data()), lodHeaders.size() * sizeof(LodHeader));
+
+	// Write the index and vertex data, or the compressed blocks and their sizes
+	if (headerV2.Compression == BinaryMeshCompression::Deflate) {
+		file.write(reinterpret_cast<const char*>(blockSizes.data()), blockSizes.size() * sizeof(uint32_t));
+		file.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+	} else {
+		file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+	}
 
-		// We will ignore the rest of the line for comment lines
-		if (command == "#") {
-			std::getline(file, line);
-		}
+	if (!file.good()) {
+		file.close();
+		fs::remove(tempFilename);
+		throw std::runtime_error("Failed to write output file");
+	}
+	file.close();
 
-		// The v command defines a vertex's position
-		else if (command == "v") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			positions.push_back(vecData);
-		}
-		// TODO: handle normals and textures
-		else if (command == "vn") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y >> vecData.z;
-			normals.push_back(vecData);
-		} else if (command == "vt") {
-			// Read in and store a position
-			file >> vecData.x >> vecData.y;
-			uvs.push_back(vecData);
-		}
+	std::error_code error;
+	fs::rename(tempFilename, outFilename, error);
+	if (error) {
+		fs::remove(tempFilename, error);
+		throw std::runtime_error("Failed to move the output file into place");
+	}
+}
 
-		// The f command defines a polygon in the mesh
-		// NOTE: make sure you triangulate in blender, otherwise it will
-		// output quads instead of triangles
-		else if (command == "f") {
-			// Read the rest of the line from the file
-			std::getline(file, line);
-			// Trim whitespace from either end of the line
-			StringTools::Trim(line);
-			// Create a string stream so we can use streaming operators on it
-			std::stringstream stream = std::stringstream(line);
-
-			uint32_t edges[4];
-			int ix = 0;
-			// Iterate over up to 4 sets of attributes
-			for (; ix < 4; ix++) {
-				if (stream.peek() != EOF) {
-					// Load in the faces, split up by slashes
-					char tempChar;
-					vertexIndices = glm::ivec3(0);
-					stream >> vertexIndices.x >> tempChar >> vertexIndices.y >> tempChar >> vertexIndices.z;
-					// The OBJ format can have negative values, which are a reference from the last added attributes
-					if (vertexIndices.x < 0) { vertexIndices.x = positions.size() + 1 + vertexIndices.x; }
-					if (vertexIndices.y < 0) { vertexIndices.y = uvs.size()       + 1 + vertexIndices.y; }
-					if (vertexIndices.z < 0) { vertexIndices.z = normals.size()   + 1 + vertexIndices.z; }
-
-					// We can construct a key using a bitmask of the attribute indices
-					// This let's us quickly look up a combination of attributes to see if it's already been added
-					// Note that this limits us to 2,097,150 unique attributes for positions, normals and textures
-					const uint64_t mask = 0b0'000000000000000000000'000000000000000000000'111111111111111111111;
-					uint64_t key = ((vertexIndices.x & mask) << 42) | ((vertexIndices.y & mask) << 21) | (vertexIndices.z & mask);
-
-					// Find the index associated with the combination of attributes
-					auto it = vertexMap.find(key);
-
-					// If it exists, we push the index to our indices
-					if (it != vertexMap.end()) {
-						edges[ix] = it->second;
-					} else {
-						vertices.push_back(vertexIndices - glm::ivec3(1));
-						uint32_t index = static_cast<uint32_t>(vertices.size()) - 1;
-
-						// Cache the index based on our key
-						vertexMap[key] = index;
-						// Add index to mesh, and add to edges list for if we are using quads
-						edges[ix] = index;
-					}
-				}
-				// We've reached the end of the line, break out of the loop
-				else { break; }
-			}
+MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(const std::string& filename) {
+	// Could also take this in as a parameter
+	glm::vec4 color = glm::vec4(1.0f);
 
-			// Handling for triangle faces
-			if (ix == 3) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-			}
-			// Handling for quad faces
-			else if (ix == 4) {
-				indices.push_back(edges[0]);
-				indices.push_back(edges[1]);
-				indices.push_back(edges[2]);
-
-				indices.push_back(edges[0]);
-				indices.push_back(edges[2]);
-				indices.push_back(edges[3]);
-			}
-		}
+	float startTime = static_cast<float>(glfwGetTime());
+
+	// Parse the attributes and de-duplicated vertices out of the file, large files will be split across all our cores.
+	// Files with faces that reference missing attributes are rejected by the parser
+	ObjParser::Result obj;
+	if (!ObjParser::ParseFile(filename, obj, 0)) {
+		return nullptr;
 	}
 
-	mesh->ReserveVertexSpace(vertices.size());
-	for (const auto& vertexIndices : vertices) {
+	// We'll use the mesh builder since it supports easily adding
+	// vertices and indices
+	MeshBuilder<VertexPosNormTexColTangents>* mesh = new MeshBuilder<VertexPosNormTexColTangents>();
+
+	mesh->ReserveVertexSpace(obj.Vertices.size());
+	for (const auto& vertexIndices : obj.Vertices) {
 		// Construct a new vertex using the indices for the vertex
 		VertexPosNormTexColTangents vertex;
-		vertex.Position = positions[vertexIndices.x];
-		vertex.UV       = vertexIndices.y != 0 ? uvs[vertexIndices.y] : glm::vec2(0.0f);
-		vertex.Normal   = vertexIndices.z != 0 ? normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
+		vertex.Position = obj.Positions[vertexIndices.x];
+		vertex.UV       = vertexIndices.y >= 0 ? obj.UVs[vertexIndices.y] : glm::vec2(0.0f);
+		vertex.Normal   = vertexIndices.z >= 0 ? obj.Normals[vertexIndices.z] : glm::vec3(0.0f, 0.0f, 1.0f);
 		vertex.Color    = color;
 
 		// Add to the mesh, get index of the added vertex
 		mesh->AddVertex(vertex);
 	}
-	mesh->ReserveIndexSpace(indices.size());
-	for (uint32_t ix : indices) {
+	mesh->ReserveIndexSpace(obj.Indices.size());
+	for (uint32_t ix : obj.Indices) {
 		mesh->AddIndex(ix);
 	}
 
@@ -233,96 +411,271 @@ MeshBuilder<VertexPosNormTexColTangents>* OptimizedObjLoader::_LoadFromObjFile(c
 	return mesh;
 }
 
-VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename) {
+OptimizedObjLoader::BinaryMeshView OptimizedObjLoader::InspectBinaryFile(const std::string& filename) {
+	BinaryMeshView result = BinaryMeshView();
 
-	// Open the output file
-	std::ifstream file(filename, std::ios::binary);
+	// Map the file into memory, the OS will page it in as we touch it
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(filename);
 	// If our file fails to open, we will throw an error
-	if (!file) { throw std::runtime_error("Failed to open file"); }
+	if (file == nullptr) { throw std::runtime_error("Failed to open file"); }
 
-	float startTime = static_cast<float>(glfwGetTime());
+	// Make sure we can at least read the header
+	size_t size = file->GetSize();
+	if (size < sizeof(BinaryHeader)) {
+		LOG_ERROR("Not enough data in the file!");
+		return result;
+	}
 
-	// Get the file size so we can avoid reading past the end
-	file.seekg(0, std::ios::end);
-	size_t size = file.tellg();
-	file.seekg(0, std::ios::beg);
+	// The header lives at the start of the mapping, we can use it in place
+	const BinaryHeader* header = reinterpret_cast<const BinaryHeader*>(file->GetData());
+	if (!_ValidateBinaryHeader(*header, size)) {
+		return result;
+	}
 
-	// Read the header from the file
-	BinaryHeader header = BinaryHeader();
-	if (size >= sizeof(BinaryHeader)) {
-		file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader));
-	} else {
-		LOG_ERROR("Not enough data in the file!");
-		return nullptr;
+	const uint8_t* seek = file->GetData() + sizeof(BinaryHeader);
+	const uint8_t* end  = file->GetData() + size;
+
+	// Version 2 files have a second header describing the constant attributes and compression
+	const BinaryHeaderV2* headerV2 = nullptr;
+	if (header->Version >= 0x02) {
+		headerV2 = reinterpret_cast<const BinaryHeaderV2*>(seek);
+		seek += sizeof(BinaryHeaderV2);
 	}
 
-	// TODO: validate header
+	// The attributes follow the headers
+	result.Attributes = Span<const BufferAttribute>(reinterpret_cast<const BufferAttribute*>(seek), header->NumAttributes);
+	seek += header->NumAttributes * sizeof(BufferAttribute);
+
+	// Make sure none of the attributes are going to read outside of a vertex
+	for (const BufferAttribute& attrib : result.Attributes) {
+		if (attrib.Offset < 0 || (size_t)attrib.Offset + GetAttributeByteSize(attrib.Type, attrib.Size) > header->VertexStride) {
+			LOG_ERROR("Vertex attribute in slot {} is outside the bounds of the vertex!", attrib.Slot);
+			return result;
+		}
+	}
 
-	// Handle our version
-	if (header.Version == 0x01) {
-		// Determine how many bytes we need in the file
-		size_t requiredBytes =
-			sizeof(BinaryHeader) +
-			(header.NumAttributes * sizeof(BufferAttribute)) +
-			(header.VertexStride * (size_t)header.NumVertices) +
-			(header.NumIndices * GetIndexTypeSize(header.IndicesType));
+	size_t indexBytes    = header->NumIndices * GetIndexTypeSize(header->IndicesType);
+	size_t lodIndexBytes = 0;
+	size_t vertexBytes   = header->NumVertices * (size_t)header->VertexStride;
 
-		// Make sure there's enough data in the file
-		if (size < requiredBytes) {
+	if (headerV2 != nullptr) {
+		// Version 2 files store the constant attributes, levels of detail and the table of compressed block sizes next
+		const size_t numBlocks = headerV2->Compression == BinaryMeshCompression::Deflate ? headerV2->NumBlocks : 0;
+		if ((size_t)(end - seek) < headerV2->NumConstants * sizeof(ConstantAttribute) + headerV2->NumLods * sizeof(LodHeader) + numBlocks * sizeof(uint32_t)) {
 			LOG_ERROR("Not enough data in the file!");
-			return nullptr;
+			return result;
 		}
+		result.Constants = Span<const ConstantAttribute>(reinterpret_cast<const ConstantAttribute*>(seek), headerV2->NumConstants);
+		seek += headerV2->NumConstants * sizeof(ConstantAttribute);
 
-		// Read all attributes from the file, this is basically our VDECL
-		std::vector<BufferAttribute> vertexDeclaration;
-		vertexDeclaration.resize(header.NumAttributes);
-		for (int ix = 0; ix < header.NumAttributes; ix++) {
-			file.read(reinterpret_cast<char*>(&vertexDeclaration[ix]), sizeof(BufferAttribute));
+		result.Lods = Span<const LodHeader>(reinterpret_cast<const LodHeader*>(seek), headerV2->NumLods);
+		seek += headerV2->NumLods * sizeof(LodHeader);
+		for (const LodHeader& lod : result.Lods) {
+			lodIndexBytes += lod.NumIndices * GetIndexTypeSize(header->IndicesType);
 		}
 
-		// These will have the buffer pointers
-		IndexBuffer::Sptr indices = nullptr;
-		VertexBuffer::Sptr vertices = nullptr;
-
-		// If we have index data, load it
-		if (header.NumIndices > 0) {
-			// Create index buffer
-			indices = IndexBuffer::Create(BufferUsage::StaticDraw);
-
-			// Create memory to store indices, then read from the file
-			void* dataStore = malloc(header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			file.read(reinterpret_cast<char*>(dataStore), header.NumIndices * GetIndexTypeSize(header.IndicesType));
-			
-			// Load data into OpenGL and free the CPU memory we allocated
-			indices->LoadData(dataStore, GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
-			free(dataStore);
+		if (headerV2->Compression == BinaryMeshCompression::Deflate) {
+			Span<const uint32_t> blockSizes = Span<const uint32_t>(reinterpret_cast<const uint32_t*>(seek), numBlocks);
+			seek += numBlocks * sizeof(uint32_t);
+
+			// Decompress the blocks back to back into a buffer, which the data spans will point into
+			std::shared_ptr<std::vector<uint8_t>> data = std::make_shared<std::vector<uint8_t>>(indexBytes + lodIndexBytes + vertexBytes);
+			size_t offset = 0;
+			for (uint32_t blockSize : blockSizes) {
+				uLongf rawSize = static_cast<uLongf>(std::min<size_t>(headerV2->BlockSize, data->size() - offset));
+				if ((size_t)(end - seek) < blockSize || rawSize == 0 ||
+					uncompress(data->data() + offset, &rawSize, seek, blockSize) != Z_OK) {
+					LOG_ERROR("Failed to decompress mesh data!");
+					return result;
+				}
+				offset += rawSize;
+				seek += blockSize;
+			}
+			if (offset != data->size()) {
+				LOG_ERROR("Compressed mesh data does not match the size in the header!");
+				return result;
+			}
+
+			result.DecompressedData = data;
+			seek = data->data();
+			end  = data->data() + data->size();
+		}
+		else if (headerV2->Compression != BinaryMeshCompression::None) {
+			LOG_ERROR("Unsupported binary mesh compression {}", (int)headerV2->Compression);
+			return result;
 		}
+	}
 
-		// Create a new VBO
-		vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	// Make sure there's enough data left for the indices and vertices
+	if ((size_t)(end - seek) < indexBytes + lodIndexBytes + vertexBytes) {
+		LOG_ERROR("Not enough data in the file!");
+		return result;
+	}
 
-		// Create memory to store vertices and load from file
-		void* vertexStore = malloc(header.NumVertices * (size_t)header.VertexStride);
-		file.read(reinterpret_cast<char*>(vertexStore), header.NumVertices * (size_t)header.VertexStride);
+	// The index data is followed by the level of detail indices, then the vertex data
+	result.IndexData = Span<const uint8_t>(seek, indexBytes);
+	seek += indexBytes;
 
-		// Load data into OpenGL and free the CPU copy
-		vertices->LoadData(vertexStore, header.VertexStride, header.NumVertices);
-		free(vertexStore);
+	result.LodIndexData = Span<const uint8_t>(seek, lodIndexBytes);
+	seek += lodIndexBytes;
 
-		// Create the VAO and attach our index and vertex buffers
-		VertexArrayObject::Sptr result = VertexArrayObject::Create();
-		result->SetIndexBuffer(indices);
-		result->AddVertexBuffer(vertices, vertexDeclaration);
+	result.VertexData = Span<const uint8_t>(seek, vertexBytes);
 
-		// Copy in the vertex declaration we loaded
-		result->SetVDecl(vertexDeclaration);
+	result.Header = header;
+	result.HeaderV2 = headerV2;
+	result.Source = file;
+	return result;
+}
 
-		// Calculate and trace out how long it took us to load
-		float endTime = static_cast<float>(glfwGetTime());
-		LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, header.NumVertices, header.NumIndices);
+bool OptimizedObjLoader::_IsBinaryFileStale(const std::string& objFile, const std::string& binFile) {
+	std::error_code error;
+	if (fs::last_write_time(binFile, error) < fs::last_write_time(objFile, error)) {
+		return true;
+	}
 
-		return result;
+	// Version 1 files were written before we packed and optimized our meshes, we can do better now that we have the OBJ
+	BinaryHeader header;
+	std::ifstream file(binFile, std::ios::binary);
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(BinaryHeader))) {
+		return true;
+	}
+	return memcmp(header.HeaderBytes, HEADER_BYTES, 4) != 0 || header.Version < 0x02;
+}
+
+bool OptimizedObjLoader::_ValidateBinaryHeader(const BinaryHeader& header, size_t fileSize) {
+	// Make sure we're actually looking at a binary mesh file
+	if (memcmp(header.HeaderBytes, HEADER_BYTES, sizeof(HEADER_BYTES)) != 0) {
+		LOG_ERROR("File is not a binary mesh file!");
+		return false;
+	}
+
+	// Handle our version, version 2 extends version 1 with a second header
+	if (header.Version != 0x01 && header.Version != 0x02) {
+		LOG_ERROR("Unsupported binary mesh version {}", header.Version);
+		return false;
+	}
+
+	// Indices must be one of the types that OpenGL can draw with
+	size_t indexSize = GetIndexTypeSize(header.IndicesType);
+	if (header.NumIndices > 0 && indexSize == 0) {
+		LOG_ERROR("Invalid index type in binary mesh file!");
+		return false;
 	}
 
-	return nullptr;
+	if (header.VertexStride == 0 || header.NumAttributes == 0) {
+		LOG_ERROR("Binary mesh file does not contain a valid vertex declaration!");
+		return false;
+	}
+
+	// Make sure there's enough data in the file for the headers and vertex declaration, the rest is
+	// checked once we know how the data is stored
+	size_t requiredBytes =
+		sizeof(BinaryHeader) +
+		(header.Version >= 0x02 ? sizeof(BinaryHeaderV2) : 0) +
+		(header.NumAttributes * sizeof(BufferAttribute));
+
+	if (fileSize < requiredBytes) {
+		LOG_ERROR("Not enough data in the file!");
+		return false;
+	}
+
+	return true;
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::_LoadFromBinFile(const std::string& filename, MeshDetails* details) {
+	float startTime = static_cast<float>(glfwGetTime());
+
+	// Map and validate the file, we'll upload directly out of the mapping
+	BinaryMeshView view = InspectBinaryFile(filename);
+	if (!view.IsValid()) {
+		return nullptr;
+	}
+
+	VertexArrayObject::Sptr result = UploadBinaryView(view, details);
+	if (details != nullptr) {
+		CalculateBounds(view, *details);
+	}
+
+	// Calculate and trace out how long it took us to load
+	float endTime = static_cast<float>(glfwGetTime());
+	LOG_TRACE("Loaded OBJ file \"{}\" in {} seconds ({} vertices, {} indices)", filename, endTime - startTime, view.Header->NumVertices, view.Header->NumIndices);
+
+	return result;
+}
+
+VertexArrayObject::Sptr OptimizedObjLoader::UploadBinaryView(const BinaryMeshView& view, MeshDetails* details) {
+	LOG_ASSERT(view.IsValid(), "Cannot upload an invalid binary mesh!");
+	const BinaryHeader& header = *view.Header;
+
+	// These will have the buffer pointers
+	IndexBuffer::Sptr indices = nullptr;
+	VertexBuffer::Sptr vertices = nullptr;
+
+	// If we have index data, load it
+	if (header.NumIndices > 0) {
+		indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+		indices->LoadData(view.IndexData.data(), GetIndexTypeSize(header.IndicesType), header.NumIndices, header.IndicesType);
+	}
+
+	// Create a new VBO and load the vertices into OpenGL
+	vertices = VertexBuffer::Create(BufferUsage::StaticDraw);
+	vertices->LoadData(view.VertexData.data(), header.VertexStride, header.NumVertices);
+
+	// Copy the attributes out of the file, this is basically our VDECL
+	std::vector<BufferAttribute> vertexDeclaration(view.Attributes.begin(), view.Attributes.end());
+
+	// Create the VAO and attach our index and vertex buffers
+	VertexArrayObject::Sptr result = VertexArrayObject::Create();
+	result->SetIndexBuffer(indices);
+	result->AddVertexBuffer(vertices, vertexDeclaration);
+
+	// Copy in the vertex declaration we loaded
+	result->SetVDecl(vertexDeclaration);
+
+	// Attributes that were the same for every vertex aren't in the vertex buffer
+	for (const ConstantAttribute& constant : view.Constants) {
+		result->SetConstantAttribute(constant.Slot, constant.Value);
+	}
+
+	if (details != nullptr) {
+		// Upload the index buffers for each level of detail, these will be drawn with the mesh's vertex buffer
+		details->Lods.clear();
+		const size_t indexSize = GetIndexTypeSize(header.IndicesType);
+		const uint8_t* lodIndices = view.LodIndexData.data();
+		for (const LodHeader& lod : view.Lods) {
+			LodLevel level;
+			level.Indices = IndexBuffer::Create(BufferUsage::StaticDraw);
+			level.Indices->LoadData(lodIndices, static_cast<uint32_t>(indexSize), lod.NumIndices, header.IndicesType);
+			level.Error = lod.Error;
+			details->Lods.push_back(level);
+			lodIndices += lod.NumIndices * indexSize;
+		}
+	}
+
+	return result;
+}
+
+void OptimizedObjLoader::CalculateBounds(const BinaryMeshView& view, MeshDetails& details) {
+	const BinaryHeader& header = *view.Header;
+
+	// Positions are never packed, so we can find the bounds straight from the vertex data
+	details.BoundsMin = glm::vec3(0.0f);
+	details.BoundsMax = glm::vec3(0.0f);
+	details.HasBounds = false;
+	for (const BufferAttribute& attrib : view.Attributes) {
+		if (attrib.Usage == AttribUsage::Position && attrib.Type == AttributeType::Float && attrib.Size >= 3 && header.NumVertices > 0) {
+			glm::vec3 minimum = glm::vec3(std::numeric_limits<float>::max());
+			glm::vec3 maximum = glm::vec3(std::numeric_limits<float>::lowest());
+			for (uint32_t ix = 0; ix < header.NumVertices; ix++) {
+				glm::vec3 position;
+				memcpy(&position.x, view.VertexData.data() + (size_t)ix * header.VertexStride + attrib.Offset, sizeof(glm::vec3));
+				minimum = glm::min(minimum, position);
+				maximum = glm::max(maximum, position);
+			}
+			details.BoundsMin = minimum;
+			details.BoundsMax = maximum;
+			details.HasBounds = true;
+			break;
+		}
+	}
 }
@@ -7,11 +7,26 @@
  */
 #pragma once
 #include <fstream>
+#include <memory>
+
+#include <EnumToString.h>
 
 #include "Graphics/VertexArrayObject.h"
 #include "Graphics/VertexTypes.h"
 
 #include "Utils/MeshBuilder.h"
+#include "Utils/MeshSimplifier.h"
+#include "Utils/MemoryMappedFile.h"
+#include "Utils/Span.h"
+
+/// <summary>
+/// The compression applied to the index and vertex data of a binary mesh file
+/// </summary>
+ENUM(BinaryMeshCompression, uint8_t,
+	None    = 0,
+	// zlib deflate, applied to fixed size blocks of the index and vertex data
+	Deflate = 1
+);
 
 /// <summary>
 /// An optimized OBJ loader that can convert an OBJ file to a binary representation
@@ -19,30 +34,6 @@
 /// </summary>
 class OptimizedObjLoader {
 public:
-	/// <summary>
-	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file 
-	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
-	/// </summary>
-	/// <param name="filename">The path to the .obj or .bin file to load</param>
-	/// <returns>A VAO loaded from disk</returns>
-	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename);
-	/// <summary>
-	/// Manually converts an OBJ file into a binary mesh file
-	/// </summary>
-	/// <param name="inFile">The path to OBJ file to convert</param>
-	/// <param name="outFile">The output path for the bin file, or empty to use the inFile path and replace the extension with .bin</param>
-	static void ConvertToBinary(const std::string& inFile, const std::string& outFile = "");
-
-	/// <summary>
-	/// Saves a mesh builder of the given type to a binary file
-	/// </summary>
-	/// <typeparam name="VertexType"></typeparam>
-	/// <param name="mesh"></param>
-	/// <param name="outFilename"></param>
-	template <typename VertexType>
-	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename);
-
-protected:
 	// Will be put at the start of the binary file, contains info about the contents of the file
 	struct BinaryHeader {
 		// A check value so we can ensure that we're loading in the right file type
@@ -61,42 +52,206 @@ protected:
 		uint8_t   NumAttributes = 0;
 	};
 
+	// Follows the BinaryHeader in version 2 files, describes how the rest of the file is laid out
+	struct BinaryHeaderV2 {
+		// How the index and vertex data is compressed
+		BinaryMeshCompression Compression = BinaryMeshCompression::None;
+		// The number of attributes that were dropped because every vertex had the same value
+		uint8_t  NumConstants = 0;
+		// The number of simplified index lists stored after the mesh's indices, this used to be padding
+		// so older version 2 files will read it as 0
+		uint8_t  NumLods = 0;
+		// The number of bytes of index and vertex data in each compressed block, the last block may be smaller
+		uint32_t BlockSize = 0;
+		// The number of compressed blocks, their compressed sizes are stored in a table after the constants
+		uint32_t NumBlocks = 0;
+	};
+
+	// Stores the value of an attribute that was the same for every vertex in a version 2 file
+	struct ConstantAttribute {
+		// The slot of the attribute that was dropped
+		uint32_t    Slot = 0;
+		// The usage hint of the attribute that was dropped
+		AttribUsage Usage = AttribUsage::Unknown;
+		// The value of the attribute, with missing components filled in from (0, 0, 0, 1) like OpenGL does
+		glm::vec4   Value = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	};
+
+	// Describes a simplified level of detail in a version 2 file, stored in a table after the constants
+	struct LodHeader {
+		// The number of indices in this level, stored with the same index type as the mesh
+		uint32_t NumIndices = 0;
+		// The approximate distance between this level and the full mesh, in object space units
+		float    Error = 0.0f;
+	};
+
+	/// <summary>
+	/// A level of detail for a mesh loaded from a binary file, the index buffer should be drawn
+	/// with the vertex buffers of the mesh it was loaded with
+	/// </summary>
+	struct LodLevel {
+		IndexBuffer::Sptr Indices = nullptr;
+		float             Error = 0.0f;
+	};
+
+	/// <summary>
+	/// Extra information that can be loaded alongside a mesh's VAO
+	/// </summary>
+	struct MeshDetails {
+		// The simplified levels of detail for the mesh, from most to least detailed
+		std::vector<LodLevel> Lods;
+		// The object space bounds of the mesh's positions
+		glm::vec3             BoundsMin = glm::vec3(0.0f);
+		glm::vec3             BoundsMax = glm::vec3(0.0f);
+		// True if the file had float positions that the bounds could be calculated from
+		bool                  HasBounds = false;
+	};
+
+	/// <summary>
+	/// A CPU-side view of a binary mesh file that has been mapped into memory. Unless the file is
+	/// compressed, the spans point directly into the mapping, so no copies of the mesh data are made.
+	/// The view keeps the mapping alive for as long as it (or a copy of it) exists
+	/// </summary>
+	struct BinaryMeshView {
+		// Points to the header at the start of the mapped file
+		const BinaryHeader*           Header = nullptr;
+		// Points to the header following Header in version 2 files, or nullptr for version 1 files
+		const BinaryHeaderV2*         HeaderV2 = nullptr;
+		// The vertex declaration stored in the file
+		Span<const BufferAttribute>   Attributes;
+		// Attributes that are not in the vertex data, since every vertex had the same value
+		Span<const ConstantAttribute> Constants;
+		// The simplified levels of detail stored in the file
+		Span<const LodHeader>         Lods;
+		// The raw index data, see Header->IndicesType for the element type
+		Span<const uint8_t>           IndexData;
+		// The index data for all the levels of detail, back to back in the same order as Lods
+		Span<const uint8_t>           LodIndexData;
+		// The raw vertex data, see Header->VertexStride for the size of an element
+		Span<const uint8_t>           VertexData;
+		// The mapping that the spans are pointing into
+		MemoryMappedFile::Sptr        Source = nullptr;
+		// Holds the index and vertex data of compressed files, in which case the data spans point into this instead
+		std::shared_ptr<std::vector<uint8_t>> DecompressedData = nullptr;
+
+		/// <summary>
+		/// Returns true if the file was mapped and passed validation
+		/// </summary>
+		bool IsValid() const { return Source != nullptr && Header != nullptr; }
+
+		/// <summary>
+		/// Gets the index data as an array of the given type
+		/// </summary>
+		/// <typeparam name="IndexT">The index type, must match the size of Header->IndicesType</typeparam>
+		template <typename IndexT>
+		Span<const IndexT> GetIndices() const {
+			if (sizeof(IndexT) != GetIndexTypeSize(Header->IndicesType)) {
+				throw std::runtime_error("Index type does not match the type stored in the file");
+			}
+			return Span<const IndexT>(reinterpret_cast<const IndexT*>(IndexData.data()), Header->NumIndices);
+		}
+
+		/// <summary>
+		/// Gets the vertex data as an array of the given vertex type
+		/// </summary>
+		/// <typeparam name="VertexType">The vertex type, must match the stride stored in the file</typeparam>
+		template <typename VertexType>
+		Span<const VertexType> GetVertices() const {
+			if (sizeof(VertexType) != Header->VertexStride) {
+				throw std::runtime_error("Vertex type does not match the stride stored in the file");
+			}
+			return Span<const VertexType>(reinterpret_cast<const VertexType*>(VertexData.data()), Header->NumVertices);
+		}
+	};
+
+	/// <summary>
+	/// Loads a VAO from an OBJ file. On the first time this is called for an OBJ file, will convert the OBJ file 
+	/// to a binary file and load that instead. On subsequent runs, the binary file will be loaded instead
+	/// </summary>
+	/// <param name="filename">The path to the .obj or .bin file to load</param>
+	/// <param name="details">If set, receives the levels of detail and bounds of the mesh</param>
+	/// <returns>A VAO loaded from disk</returns>
+	static VertexArrayObject::Sptr LoadFromFile(const std::string& filename, MeshDetails* details = nullptr);
+	/// <summary>
+	/// Manually converts an OBJ file into a binary mesh file
+	/// </summary>
+	/// <param name="inFile">The path to OBJ file to convert</param>
+	/// <param name="outFile">The output path for the bin file, or empty to use the inFile path and replace the extension with .bin</param>
+	/// <param name="compression">The compression to apply to the index and vertex data</param>
+	/// <returns>True if the file was converted, false if the OBJ file could not be parsed</returns>
+	static bool ConvertToBinary(const std::string& inFile, const std::string& outFile = "", BinaryMeshCompression compression = BinaryMeshCompression::None);
+
+	/// <summary>
+	/// Maps a binary mesh file into memory and validates it, without touching OpenGL. Useful for
+	/// tools and tests that need to look at mesh data without a GL context
+	/// </summary>
+	/// <param name="filename">The path to the .bin file to inspect</param>
+	/// <returns>A view into the file's data, check IsValid() before use</returns>
+	static BinaryMeshView InspectBinaryFile(const std::string& filename);
+	/// <summary>
+	/// Gets the binary file that LoadFromFile would load for the given path, converting an OBJ file
+	/// to a binary file first if it has not been converted yet. Does not touch OpenGL
+	/// </summary>
+	/// <param name="filename">The path to the .obj or .bin file</param>
+	/// <returns>The path to the .bin file, or an empty string if the file is not a mesh we can load</returns>
+	static std::string ResolveBinaryFile(const std::string& filename);
+	/// <summary>
+	/// Finds the bounds of a mapped binary mesh from it's float positions. Does not touch OpenGL
+	/// </summary>
+	/// <param name="view">The mesh to find the bounds of</param>
+	/// <param name="details">Receives the bounds of the mesh, HasBounds will be false if the mesh has no float positions</param>
+	static void CalculateBounds(const BinaryMeshView& view, MeshDetails& details);
+	/// <summary>
+	/// Uploads the contents of a mapped binary mesh to OpenGL, must be called on the main thread. Lets
+	/// the mapping and validation happen on a worker thread via InspectBinaryFile
+	/// </summary>
+	/// <param name="view">The valid view to upload</param>
+	/// <param name="details">If set, receives the levels of detail of the mesh. Bounds are not touched, see CalculateBounds</param>
+	/// <returns>A VAO containing the mesh data</returns>
+	static VertexArrayObject::Sptr UploadBinaryView(const BinaryMeshView& view, MeshDetails* details = nullptr);
+
+	/// <summary>
+	/// Saves a mesh builder of the given type to a version 2 binary file. Indices are stored as
+	/// 16 bit values when possible, normals and tangents are packed into 10 bits per component,
+	/// UVs and colors are stored as 16 and 8 bit values, and attributes that are the same for
+	/// every vertex are dropped from the vertex data entirely
+	/// </summary>
+	/// <typeparam name="VertexType">The type of vertex stored in the mesh</typeparam>
+	/// <param name="mesh">The mesh to save</param>
+	/// <param name="outFilename">The path to the file to write</param>
+	/// <param name="compression">The compression to apply to the index and vertex data</param>
+	/// <param name="lods">The simplified levels of detail to store with the mesh, see MeshBuilder::GenerateLods</param>
+	template <typename VertexType>
+	static void SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, BinaryMeshCompression compression = BinaryMeshCompression::None,
+							   const std::vector<MeshSimplifier::Lod>& lods = std::vector<MeshSimplifier::Lod>());
+
+protected:
 	OptimizedObjLoader() = default;
 	~OptimizedObjLoader() = default;
 
+	/// <summary>
+	/// Loads an OBJ file into a new mesh builder that the caller takes ownership of, or returns nullptr if
+	/// the file could not be parsed
+	/// </summary>
 	static MeshBuilder<VertexPosNormTexColTangents>* _LoadFromObjFile(const std::string& filename);
-	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename);
+	static VertexArrayObject::Sptr _LoadFromBinFile(const std::string& filename, MeshDetails* details);
+	static bool _ValidateBinaryHeader(const BinaryHeader& header, size_t fileSize);
+	/// <summary>
+	/// Returns true if a binary file converted from an OBJ file should be converted again, because the
+	/// OBJ file has since changed or the binary file uses an older version of our format
+	/// </summary>
+	static bool _IsBinaryFileStale(const std::string& objFile, const std::string& binFile);
+	static void _SaveBinaryFile(const uint8_t* vertexData, uint32_t numVertices, const std::vector<BufferAttribute>& vDecl,
+								const uint32_t* indexData, uint32_t numIndices, const std::string& outFilename, BinaryMeshCompression compression,
+								const std::vector<MeshSimplifier::Lod>& lods);
 };
 
 template <typename VertexType>
-void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename) {
-	// Open the output file
-	std::ofstream file(outFilename, std::ios::binary);
-	if (!file) {
-		throw std::runtime_error("Failed to open output file");
-	}
-
-	// Create the fixed size header for our output file
-	BinaryHeader header  = BinaryHeader();
-	header.Version       = 0x01; // This is version 1! Update this and implement different readers if changes to format are made
-	header.NumIndices    = mesh.GetIndexCount();
-	header.IndicesType   = IndexType::UInt;
-	header.NumVertices   = mesh.GetVertexCount();
-	header.VertexStride  = sizeof(VertexType);
-	header.NumAttributes = VertexType::V_DECL.size();
-
-	// Write header bytes to the stream
-	file.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
-
-	// Write which attributes we have to the stream
-	for (int ix = 0; ix < VertexType::V_DECL.size(); ix++) {
-		file.write(reinterpret_cast<const char*>(&VertexType::V_DECL[ix]), sizeof(BufferAttribute));
-	}
-	// Write any index data to the file
-	if (mesh.GetIndexCount() > 0) {
-		file.write(reinterpret_cast<const char*>(mesh.GetIndexDataPtr()), mesh.GetIndexCount() * sizeof(uint32_t));
-	}
-
-	// Write vertex data to file
-	file.write(reinterpret_cast<const char*>(mesh.GetVertexDataPtr()), mesh.GetVertexCount() * sizeof(VertexType));
+void OptimizedObjLoader::SaveBinaryFile(MeshBuilder<VertexType>& mesh, const std::string& outFilename, BinaryMeshCompression compression,
+										const std::vector<MeshSimplifier::Lod>& lods) {
+	_SaveBinaryFile(
+		reinterpret_cast<const uint8_t*>(mesh.GetVertexDataPtr()), static_cast<uint32_t>(mesh.GetVertexCount()), VertexType::V_DECL,
+		mesh.GetIndexDataPtr(), static_cast<uint32_t>(mesh.GetIndexCount()),
+		outFilename, compression, lods
+	);
 }
@@ -33,6 +33,19 @@ public:
 
 	virtual void ResolveReferences() {};
 
+	/// <summary>
+	/// Called on a worker thread by ResourceManager::LoadAsync, after the resource was created as a placeholder
+	/// by its static FromJsonAsync method. Should do all the file IO and decoding that does not need OpenGL, and
+	/// hold onto the results until FinishAsyncLoad. Must not touch anything the main thread may be using
+	/// </summary>
+	/// <returns>True if the data was decoded and can be uploaded</returns>
+	virtual bool DecodeAsync() { return true; }
+	/// <summary>
+	/// Called on the main thread once DecodeAsync has succeeded, should upload the decoded data to OpenGL
+	/// and release it, after which the resource is no longer a placeholder
+	/// </summary>
+	virtual void FinishAsyncLoad() { }
+
 	/// <summary>
 	/// Converts this resource into it's JSON manifest format
 	/// Should contain all the data required to reconstruct the
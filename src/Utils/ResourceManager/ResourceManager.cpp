@@ -1,14 +1,44 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 
+#include <list>
+#include <thread>
+#include <filesystem>
+#include <Logging.h>
+
 #include "Utils/ObjLoader.h"
+#include "Utils/BlobStore.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
 
 std::map<std::type_index, std::map<Guid, IResource::Sptr>> ResourceManager::_resources;
 std::map<std::string, std::function<Guid(const nlohmann::json&)>> ResourceManager::_typeLoaders;
+std::map<std::string, std::function<IResource::Sptr(const nlohmann::json&)>> ResourceManager::_asyncTypeLoaders;
 
 nlohmann::ordered_json ResourceManager::_manifest;
 
+namespace {
+	// A resource that is being decoded on the load pool, or is waiting to be uploaded
+	struct PendingLoad {
+		IResource::Sptr                 Resource;
+		std::future<bool>               Decode;
+		std::promise<ResourceLoadState> Result;
+	};
+
+	// Created on the first async load, so apps that never use it don't spin up any threads
+	ThreadPool::Uptr LoadPool = nullptr;
+	// Loads in the order they were requested, these are only touched from the main thread
+	std::list<PendingLoad> PendingLoads;
+	// The states of loads that have not succeeded yet, anything in the resource pool that isn't in here is ready
+	std::map<Guid, std::shared_future<ResourceLoadState>> LoadStates;
+
+	std::shared_future<ResourceLoadState> MakeLoadState(ResourceLoadState state) {
+		std::promise<ResourceLoadState> result;
+		result.set_value(state);
+		return result.get_future().share();
+	}
+}
+
 void ResourceManager::Init() {
 	// TODO: initialize the resource manager once it's a bit more complex
 	//_manifest["textures"]  = std::vector<nlohmann::json>();
@@ -27,18 +57,127 @@ void ResourceManager::LoadManifest(const std::string& path, bool preloadAssets)
 	_manifest = blob;
 
 	if (preloadAssets) {
+		// Types that support it are decoded on the load pool, while the rest are loaded here as we go. Since
+		// placeholders are added to the resource pool right away, later types can still reference them
 		for (auto& [typeName, items] : blob.items()) {
-			auto& func = _typeLoaders[typeName];
-			if (func) {
+			if (_typeLoaders[typeName]) {
 				for (auto& [guid, blob] : items.items()) {
-					func(blob);
+					_LoadAsync(typeName, blob);
 				}
 			}
 		}
+
+		// Everything that was handed off to the workers still needs to be uploaded
+		WaitForAll();
+	}
+}
+
+std::shared_future<ResourceLoadState> ResourceManager::_LoadAsync(const std::string& typeName, const nlohmann::json& data) {
+	auto asyncLoader = _asyncTypeLoaders.find(typeName);
+
+	// Types that don't support async loading are loaded immediately
+	if (asyncLoader == _asyncTypeLoaders.end() || !asyncLoader->second) {
+		auto& func = _typeLoaders[typeName];
+		if (func) {
+			func(data);
+			return MakeLoadState(ResourceLoadState::Ready);
+		}
+		return MakeLoadState(ResourceLoadState::Failed);
+	}
+
+	if (LoadPool == nullptr) {
+		LoadPool = std::make_unique<ThreadPool>();
+	}
+
+	// Create the placeholder here, then do the heavy lifting on the pool
+	PendingLoads.emplace_back();
+	PendingLoad& load = PendingLoads.back();
+	load.Resource = asyncLoader->second(data);
+
+	IResource::Sptr resource = load.Resource;
+	load.Decode = LoadPool->Submit([resource]() { return resource->DecodeAsync(); });
+
+	std::shared_future<ResourceLoadState> state = load.Result.get_future().share();
+	LoadStates[resource->GetGUID()] = state;
+	return state;
+}
+
+std::shared_future<ResourceLoadState> ResourceManager::_GetLoadState(Guid id) {
+	auto it = LoadStates.find(id);
+	return it != LoadStates.end() ? it->second : MakeLoadState(ResourceLoadState::Ready);
+}
+
+uint32_t ResourceManager::PumpUploads(double budgetSeconds) {
+	const auto startTime = std::chrono::steady_clock::now();
+
+	uint32_t count = 0;
+	for (auto it = PendingLoads.begin(); it != PendingLoads.end(); ) {
+		if (it->Decode.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+
+		// Stop once we've used up our budget, but always make some progress
+		if (count > 0 && budgetSeconds >= 0.0 &&
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count() >= budgetSeconds) {
+			break;
+		}
+
+		Guid id = it->Resource->GetGUID();
+		ResourceLoadState state = ResourceLoadState::Failed;
+		try {
+			if (it->Decode.get()) {
+				it->Resource->FinishAsyncLoad();
+				state = ResourceLoadState::Ready;
+			} else {
+				LOG_WARN("Failed to load resource {}, it will remain a placeholder", id.str());
+			}
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR("Failed to load resource {}: {}", id.str(), e.what());
+		}
+
+		// Failed loads stay in the state map, so handles requested later still see the failure
+		it->Result.set_value(state);
+		if (state == ResourceLoadState::Ready) {
+			LoadStates.erase(id);
+		}
+		it = PendingLoads.erase(it);
+		count++;
+	}
+
+	return count;
+}
+
+void ResourceManager::WaitForAll() {
+	while (!PendingLoads.empty()) {
+		if (PumpUploads(-1.0) == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+}
+
+size_t ResourceManager::GetPendingLoadCount() {
+	return PendingLoads.size();
+}
+
+ResourceLoadState ResourceManager::_Wait(const std::shared_future<ResourceLoadState>& state) {
+	if (!state.valid()) {
+		return ResourceLoadState::Failed;
+	}
+	while (state.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		if (PumpUploads(-1.0) == 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
 	}
+	return state.get();
 }
 
 void ResourceManager::SaveManifest(const std::string& path) {
+	// Binary data (ex: generated textures) goes in a folder next to the manifest, instead of in the manifest itself
+	std::filesystem::path manifestPath = std::filesystem::path(path);
+	BlobStore::SetDirectory((manifestPath.parent_path() / (manifestPath.stem().string() + "-blobs")).generic_string());
+
 	// Update all resources in the manifest so they match their current representation
 	for (auto& [type, map] : _resources) {
 		std::string typeName = StringTools::SanitizeClassName(type.name());
@@ -49,10 +188,30 @@ void ResourceManager::SaveManifest(const std::string& path) {
 			}
 		}
 	}
+
+	// Resources that were never loaded still reference their blobs, those may need to be copied if we're saving somewhere new
+	for (auto& [typeName, items] : _manifest.items()) {
+		for (auto& [guid, item] : items.items()) {
+			if (item.is_object() && item.contains("blob")) {
+				item["blob"] = BlobStore::Keep(item["blob"]);
+			}
+		}
+	}
+	BlobStore::RemoveUnused();
+
 	FileHelpers::WriteContentsToFile(path, _manifest.dump(1,'\t'));
 }
 
 void ResourceManager::Cleanup() {
+	// Let the workers finish up, but there's no point uploading anything
+	for (PendingLoad& load : PendingLoads) {
+		load.Decode.wait();
+		load.Result.set_value(ResourceLoadState::Failed);
+	}
+	PendingLoads.clear();
+	LoadStates.clear();
+	LoadPool = nullptr;
+
 	for (auto& [type, map] : _resources) {
 		map.clear();
 	}
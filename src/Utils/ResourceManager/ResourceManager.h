@@ -3,11 +3,66 @@
 #include <json.hpp>
 #include <unordered_map>
 #include <typeindex>
+#include <future>
+#include <chrono>
+#include <EnumToString.h>
 
 #include "Utils/GUID.hpp"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/StringUtils.h"
 
+/// <summary>
+/// The state of a resource that was requested through ResourceManager::LoadAsync
+/// </summary>
+ENUM(ResourceLoadState, uint8_t,
+	// The resource is a placeholder, and is still being decoded or waiting to be uploaded
+	Pending = 0,
+	// The resource is fully loaded
+	Ready   = 1,
+	// The resource could not be decoded, and will stay a placeholder
+	Failed  = 2
+);
+
+/// <summary>
+/// A handle to a resource that is being loaded in the background. The resource is usable right away as a
+/// placeholder (ex: a 1x1 texture, or a mesh with no VAO), and is filled in place once loading finishes, so
+/// anything holding onto the resource will pick up the real data without needing to check the handle
+/// </summary>
+template <typename T>
+class ResourceHandle {
+public:
+	ResourceHandle() : _resource(nullptr), _state() {}
+	ResourceHandle(const std::shared_ptr<T>& resource, const std::shared_future<ResourceLoadState>& state) :
+		_resource(resource), _state(state) {}
+
+	/// <summary>
+	/// Gets the resource, which may still be a placeholder. Will be nullptr if the resource does not exist
+	/// </summary>
+	const std::shared_ptr<T>& Get() const { return _resource; }
+	T* operator->() const { return _resource.get(); }
+
+	/// <summary>
+	/// Gets the state of the load without blocking
+	/// </summary>
+	ResourceLoadState GetState() const {
+		if (!_state.valid()) {
+			return _resource != nullptr ? ResourceLoadState::Ready : ResourceLoadState::Failed;
+		}
+		return _state.wait_for(std::chrono::seconds(0)) == std::future_status::ready ? _state.get() : ResourceLoadState::Pending;
+	}
+	bool IsReady() const { return GetState() == ResourceLoadState::Ready; }
+
+	/// <summary>
+	/// Gets the future that completes when the load has finished. Note that uploads happen on the main thread
+	/// in ResourceManager::PumpUploads, so the main thread must use ResourceManager::Wait instead of blocking on this
+	/// </summary>
+	const std::shared_future<ResourceLoadState>& GetFuture() const { return _state; }
+
+private:
+	std::shared_ptr<T>                     _resource;
+	std::shared_future<ResourceLoadState> _state;
+};
+
 /// <summary>
 /// Utility class for managing and loading resources from JSON
 /// manifest files
@@ -75,6 +130,57 @@ public:
 		return result;
 	}
 
+	/// <summary>
+	/// Starts loading the resource with the given type and GUID in the background, if it isn't loaded already
+	/// Types that provide a static FromJsonAsync method get a placeholder right away, and have their data decoded
+	/// on a worker thread and uploaded by PumpUploads. Other types are loaded immediately, like with Get
+	/// </summary>
+	/// <typeparam name="T">The type of resource to retrieve</typeparam>
+	/// <param name="id">The ID of the resource to load</param>
+	/// <returns>A handle to the resource, or an empty handle if none exists</returns>
+	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
+	static ResourceHandle<T> LoadAsync(Guid id) {
+		std::shared_ptr<T> result = std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]);
+
+		// Either already loaded, or already on it's way
+		if (result != nullptr) {
+			return ResourceHandle<T>(result, _GetLoadState(id));
+		}
+
+		std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
+		if (_manifest[typeName].contains(id)) {
+			std::shared_future<ResourceLoadState> state = _LoadAsync(typeName, _manifest[typeName][id]);
+			return ResourceHandle<T>(std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]), state);
+		}
+
+		return ResourceHandle<T>();
+	}
+
+	/// <summary>
+	/// Blocks until the given resource has finished loading, uploading anything that is ready in the meantime
+	/// Must be called from the main thread
+	/// </summary>
+	template <typename T>
+	static ResourceLoadState Wait(const ResourceHandle<T>& handle) {
+		return _Wait(handle.GetFuture());
+	}
+
+	/// <summary>
+	/// Uploads resources that have finished decoding on the worker threads, should be called once per frame from
+	/// the main thread. Will stop once the time budget has been used, but always uploads at least one resource
+	/// </summary>
+	/// <param name="budgetSeconds">The time to spend uploading this frame, or a negative value to upload everything that's ready</param>
+	/// <returns>The number of resources that were uploaded</returns>
+	static uint32_t PumpUploads(double budgetSeconds = 0.002);
+	/// <summary>
+	/// Blocks until all background loads have finished, must be called from the main thread
+	/// </summary>
+	static void WaitForAll();
+	/// <summary>
+	/// Gets the number of resources that are still being decoded or waiting to be uploaded
+	/// </summary>
+	static size_t GetPendingLoadCount();
+
 	/// <summary>
 	/// Registers a resource type with the resource manager, only types that have been registered
 	/// can be loaded from JSON manifest files!
@@ -94,6 +200,16 @@ public:
 			return res->GetGUID();
 		};
 
+		// Types that can decode off of the main thread create their placeholders with FromJsonAsync
+		if constexpr (test_json_async<T, const nlohmann::json&>::value) {
+			_asyncTypeLoaders[typeName] = [](const nlohmann::json& data) {
+				IResource::Sptr res = T::FromJsonAsync(data);
+				res->OverrideGUID(Guid(data["guid"]));
+				_resources[std::type_index(typeid(T))][res->GetGUID()] = res;
+				return res;
+			};
+		}
+
 		// Make sure we haven't registered the type yet, then add an empty object
 		// to the manifest to ensure it can be saved
 		if (!_manifest.contains(typeName)) {
@@ -131,7 +247,7 @@ public:
 	static const nlohmann::ordered_json& GetManifest();
 	/// <summary>
 	/// Loads a manifest file into the resource manager. Note that this will not perform load on the assets themselves 
-	/// unless preloadAssets is set to true
+	/// unless preloadAssets is set to true, in which case assets that support it are decoded in parallel
 	/// </summary>
 	/// <param name="path">The path to the JSON manifest file</param>
 	/// <param name="preloadAssets">True if all assets should be loaded into memory</param>
@@ -143,7 +259,7 @@ public:
 	static void SaveManifest(const std::string& path);
 
 	/// <summary>
-	/// Releases all resources held by the resource manager
+	/// Releases all resources held by the resource manager, waiting on any loads that are still in progress
 	/// </summary>
 	static void Cleanup();
 
@@ -158,10 +274,25 @@ protected:
 	/// This map stores registered types, so we can load them from JSON files
 	/// </summary>
 	static std::map<std::string, std::function<Guid(const nlohmann::json&)>> _typeLoaders;
+	/// <summary>
+	/// Creates placeholders for types that support LoadAsync, the data is loaded by the resource's DecodeAsync
+	/// and FinishAsyncLoad methods
+	/// </summary>
+	static std::map<std::string, std::function<IResource::Sptr(const nlohmann::json&)>> _asyncTypeLoaders;
 
 	/// <summary>
 	/// We use an ORDERED JSON file to allow serializing types in the order they are registered.
 	/// This allows us to register dependencies before the dependent resource
 	/// </summary>
 	static nlohmann::ordered_json _manifest;
+
+	/// <summary>
+	/// Creates the resource from the manifest data, and starts decoding it on the load pool if the type supports it
+	/// </summary>
+	static std::shared_future<ResourceLoadState> _LoadAsync(const std::string& typeName, const nlohmann::json& data);
+	/// <summary>
+	/// Gets the state of a resource that is already in the resource pool
+	/// </summary>
+	static std::shared_future<ResourceLoadState> _GetLoadState(Guid id);
+	static ResourceLoadState _Wait(const std::shared_future<ResourceLoadState>& state);
 };
\ No newline at end of file
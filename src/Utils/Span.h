@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+
+/// <summary>
+/// A lightweight, non-owning view over a contiguous range of elements (a stand-in
+/// for std::span until we move to C++20). The memory being viewed must outlive the span
+/// </summary>
+/// <typeparam name="T">The type of element being viewed</typeparam>
+template <typename T>
+struct Span {
+	Span() : _data(nullptr), _count(0) {}
+	Span(T* data, size_t count) : _data(data), _count(count) {}
+
+	/// <summary>
+	/// Returns a pointer to the first element in the range
+	/// </summary>
+	T* data() const { return _data; }
+	/// <summary>
+	/// Returns the number of elements in the range
+	/// </summary>
+	size_t size() const { return _count; }
+	/// <summary>
+	/// Returns the size of the range, in bytes
+	/// </summary>
+	size_t size_bytes() const { return _count * sizeof(T); }
+	/// <summary>
+	/// Returns true if the range contains no elements
+	/// </summary>
+	bool empty() const { return _count == 0; }
+
+	T* begin() const { return _data; }
+	T* end() const { return _data + _count; }
+
+	T& operator[](size_t index) const { return _data[index]; }
+
+	/// <summary>
+	/// Gets the element at the given index, throwing if the index is out of range
+	/// </summary>
+	T& at(size_t index) const {
+		if (index >= _count) {
+			throw std::out_of_range("Index is outside the bounds of the span");
+		}
+		return _data[index];
+	}
+
+private:
+	T*     _data;
+	size_t _count;
+};
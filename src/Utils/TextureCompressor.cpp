@@ -0,0 +1,652 @@
+#include "Utils/TextureCompressor.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+
+#include <Logging.h>
+#include "Utils/MemoryMappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+	// A 4x4 block of texels, expanded to RGBA
+	struct Block {
+		float Texels[16][4];
+	};
+
+	// Copies a 4x4 block out of an image, texels past the edges of the image are clamped
+	void FetchBlock(const uint8_t* data, uint32_t width, uint32_t height, uint32_t numChannels, uint32_t blockX, uint32_t blockY, Block& block) {
+		for (uint32_t y = 0; y < 4; y++) {
+			const uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; x++) {
+				const uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				const uint8_t* texel = data + ((size_t)sourceY * width + sourceX) * numChannels;
+				float* dest = block.Texels[y * 4 + x];
+				dest[0] = texel[0];
+				dest[1] = numChannels > 1 ? texel[1] : 0.0f;
+				dest[2] = numChannels > 2 ? texel[2] : 0.0f;
+				dest[3] = numChannels > 3 ? texel[3] : 255.0f;
+			}
+		}
+	}
+
+	float DistanceSq(const float* a, const float* b, int numDims) {
+		float result = 0.0f;
+		for (int dim = 0; dim < numDims; dim++) {
+			result += (a[dim] - b[dim]) * (a[dim] - b[dim]);
+		}
+		return result;
+	}
+
+	// Picks starting endpoints for a block, by projecting the texels onto the principal axis of the block
+	// and taking the extremes. The axis is found with a few rounds of power iteration on the covariance matrix
+	void InitialEndpoints(const Block& block, int numDims, float e0[4], float e1[4]) {
+		float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int ix = 0; ix < 16; ix++) {
+			for (int dim = 0; dim < numDims; dim++) {
+				mean[dim] += block.Texels[ix][dim] / 16.0f;
+			}
+		}
+
+		float covariance[4][4] = { 0.0f };
+		for (int ix = 0; ix < 16; ix++) {
+			for (int row = 0; row < numDims; row++) {
+				for (int col = 0; col < numDims; col++) {
+					covariance[row][col] += (block.Texels[ix][row] - mean[row]) * (block.Texels[ix][col] - mean[col]);
+				}
+			}
+		}
+
+		float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float largest = 0.0f;
+			for (int row = 0; row < numDims; row++) {
+				for (int col = 0; col < numDims; col++) {
+					next[row] += covariance[row][col] * axis[col];
+				}
+				largest = std::max(largest, std::abs(next[row]));
+			}
+			// Flat blocks have no spread at all, every texel will sit on the mean
+			if (largest < 1e-6f) {
+				std::fill(axis, axis + 4, 0.0f);
+				break;
+			}
+			for (int dim = 0; dim < numDims; dim++) {
+				axis[dim] = next[dim] / largest;
+			}
+		}
+
+		float minT = std::numeric_limits<float>::max();
+		float maxT = std::numeric_limits<float>::lowest();
+		for (int ix = 0; ix < 16; ix++) {
+			float t = 0.0f;
+			for (int dim = 0; dim < numDims; dim++) {
+				t += (block.Texels[ix][dim] - mean[dim]) * axis[dim];
+			}
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		// The projection was onto an axis that isn't unit length, so scale back by it's squared length
+		float lengthSq = 0.0f;
+		for (int dim = 0; dim < numDims; dim++) {
+			lengthSq += axis[dim] * axis[dim];
+		}
+		const float scale = lengthSq > 0.0f ? 1.0f / lengthSq : 0.0f;
+		for (int dim = 0; dim < numDims; dim++) {
+			e0[dim] = std::clamp(mean[dim] + axis[dim] * minT * scale, 0.0f, 255.0f);
+			e1[dim] = std::clamp(mean[dim] + axis[dim] * maxT * scale, 0.0f, 255.0f);
+		}
+	}
+
+	// Refits the endpoints with least squares, given how far along the line between them each texel sits
+	bool RefineEndpoints(const Block& block, int numDims, const float weights[16], float e0[4], float e1[4]) {
+		float a = 0.0f, b = 0.0f, c = 0.0f;
+		float x0[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float x1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int ix = 0; ix < 16; ix++) {
+			const float w = weights[ix];
+			a += (1.0f - w) * (1.0f - w);
+			b += (1.0f - w) * w;
+			c += w * w;
+			for (int dim = 0; dim < numDims; dim++) {
+				x0[dim] += (1.0f - w) * block.Texels[ix][dim];
+				x1[dim] += w * block.Texels[ix][dim];
+			}
+		}
+
+		// Happens when every texel picked the same index, there's no line to fit
+		const float determinant = a * c - b * b;
+		if (std::abs(determinant) < 1e-6f) {
+			return false;
+		}
+		for (int dim = 0; dim < numDims; dim++) {
+			e0[dim] = std::clamp((c * x0[dim] - b * x1[dim]) / determinant, 0.0f, 255.0f);
+			e1[dim] = std::clamp((a * x1[dim] - b * x0[dim]) / determinant, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	// Picks the closest palette entry for every texel in the block, returns the total squared error
+	float AssignIndices(const Block& block, int numDims, const float palette[][4], int paletteSize, uint8_t indices[16]) {
+		float total = 0.0f;
+		for (int ix = 0; ix < 16; ix++) {
+			float best = std::numeric_limits<float>::max();
+			for (int entry = 0; entry < paletteSize; entry++) {
+				float error = DistanceSq(block.Texels[ix], palette[entry], numDims);
+				if (error < best) {
+					best = error;
+					indices[ix] = static_cast<uint8_t>(entry);
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	uint16_t PackRgb565(const float color[4]) {
+		uint16_t r = static_cast<uint16_t>(color[0] * 31.0f / 255.0f + 0.5f);
+		uint16_t g = static_cast<uint16_t>(color[1] * 63.0f / 255.0f + 0.5f);
+		uint16_t b = static_cast<uint16_t>(color[2] * 31.0f / 255.0f + 0.5f);
+		return (r << 11) | (g << 5) | b;
+	}
+
+	void UnpackRgb565(uint16_t value, float color[4]) {
+		uint32_t r = (value >> 11) & 31;
+		uint32_t g = (value >> 5) & 63;
+		uint32_t b = value & 31;
+		color[0] = static_cast<float>((r << 3) | (r >> 2));
+		color[1] = static_cast<float>((g << 2) | (g >> 4));
+		color[2] = static_cast<float>((b << 3) | (b >> 2));
+		color[3] = 255.0f;
+	}
+
+	// Encodes the RGB channels of a block as a BC1 color block (8 bytes), always in 4 color mode
+	void EncodeColorBlock(const Block& block, uint8_t* out) {
+		// How far towards the second endpoint each index sits
+		const float indexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+		float e0[4], e1[4];
+		InitialEndpoints(block, 3, e0, e1);
+
+		uint16_t bestColors[2] = { 0, 0 };
+		uint8_t  bestIndices[16] = { 0 };
+		float    bestError = std::numeric_limits<float>::max();
+
+		for (int iteration = 0; iteration < 3; iteration++) {
+			uint16_t c0 = PackRgb565(e0);
+			uint16_t c1 = PackRgb565(e1);
+			// 4 color mode needs the first endpoint to be larger
+			if (c0 < c1) {
+				std::swap(c0, c1);
+				std::swap(e0, e1);
+			}
+
+			float palette[4][4];
+			UnpackRgb565(c0, palette[0]);
+			UnpackRgb565(c1, palette[1]);
+			for (int dim = 0; dim < 3; dim++) {
+				palette[2][dim] = (2.0f * palette[0][dim] + palette[1][dim]) / 3.0f;
+				palette[3][dim] = (palette[0][dim] + 2.0f * palette[1][dim]) / 3.0f;
+			}
+
+			uint8_t indices[16];
+			// With equal endpoints we'd be in 3 color mode, but every index can just use the first color
+			float error = AssignIndices(block, 3, palette, c0 == c1 ? 1 : 4, indices);
+			if (error < bestError) {
+				bestError = error;
+				bestColors[0] = c0;
+				bestColors[1] = c1;
+				std::copy(indices, indices + 16, bestIndices);
+			}
+			if (error == 0.0f || c0 == c1) {
+				break;
+			}
+
+			float weights[16];
+			for (int ix = 0; ix < 16; ix++) {
+				weights[ix] = indexWeights[indices[ix]];
+			}
+			if (!RefineEndpoints(block, 3, weights, e0, e1)) {
+				break;
+			}
+		}
+
+		uint32_t packedIndices = 0;
+		for (int ix = 0; ix < 16; ix++) {
+			packedIndices |= (uint32_t)bestIndices[ix] << (ix * 2);
+		}
+		out[0] = bestColors[0] & 0xFF;
+		out[1] = bestColors[0] >> 8;
+		out[2] = bestColors[1] & 0xFF;
+		out[3] = bestColors[1] >> 8;
+		std::memcpy(out + 4, &packedIndices, 4);
+	}
+
+	// Encodes a single channel of a block as a BC4 block (8 bytes), using the 8 value mode
+	void EncodeSingleChannelBlock(const Block& block, int channel, uint8_t* out) {
+		float low = 255.0f, high = 0.0f;
+		for (int ix = 0; ix < 16; ix++) {
+			low  = std::min(low, block.Texels[ix][channel]);
+			high = std::max(high, block.Texels[ix][channel]);
+		}
+		const uint8_t e0 = static_cast<uint8_t>(high + 0.5f);
+		const uint8_t e1 = static_cast<uint8_t>(low + 0.5f);
+		out[0] = e0;
+		out[1] = e1;
+		std::memset(out + 2, 0, 6);
+		if (e0 == e1) {
+			return;
+		}
+
+		// Index 0 and 1 are the endpoints, 2 to 7 step from the first endpoint towards the second
+		float palette[8];
+		palette[0] = e0;
+		palette[1] = e1;
+		for (int ix = 2; ix < 8; ix++) {
+			palette[ix] = ((8 - ix) * e0 + (ix - 1) * e1) / 7.0f;
+		}
+
+		uint64_t packedIndices = 0;
+		for (int ix = 0; ix < 16; ix++) {
+			uint64_t bestIndex = 0;
+			float best = std::numeric_limits<float>::max();
+			for (int entry = 0; entry < 8; entry++) {
+				float error = std::abs(block.Texels[ix][channel] - palette[entry]);
+				if (error < best) {
+					best = error;
+					bestIndex = entry;
+				}
+			}
+			packedIndices |= bestIndex << (ix * 3);
+		}
+		for (int ix = 0; ix < 6; ix++) {
+			out[2 + ix] = static_cast<uint8_t>(packedIndices >> (ix * 8));
+		}
+	}
+
+	// The interpolation weights for 4 bit BC7 indices, out of 64
+	const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// A BC7 endpoint, 7 bits per channel plus a p-bit shared by all channels (the p-bit becomes the lowest bit)
+	struct Bc7Endpoint {
+		uint8_t Channels[4];
+		uint8_t PBit;
+
+		int Get(int channel) const { return (Channels[channel] << 1) | PBit; }
+	};
+
+	// Quantizes an endpoint for mode 6, trying both p-bits and keeping whichever is closer
+	Bc7Endpoint QuantizeBc7Endpoint(const float endpoint[4]) {
+		Bc7Endpoint result = {};
+		float bestError = std::numeric_limits<float>::max();
+		for (uint8_t pBit = 0; pBit < 2; pBit++) {
+			Bc7Endpoint candidate = {};
+			candidate.PBit = pBit;
+			float error = 0.0f;
+			for (int channel = 0; channel < 4; channel++) {
+				int value = static_cast<int>(std::floor((endpoint[channel] - pBit) / 2.0f + 0.5f));
+				candidate.Channels[channel] = static_cast<uint8_t>(std::clamp(value, 0, 127));
+				float difference = candidate.Get(channel) - endpoint[channel];
+				error += difference * difference;
+			}
+			if (error < bestError) {
+				bestError = error;
+				result = candidate;
+			}
+		}
+		return result;
+	}
+
+	// Writes values into a 128 bit block, starting from the lowest bit
+	struct BitWriter {
+		uint8_t* Data;
+		uint32_t Position;
+
+		void Write(uint32_t value, uint32_t numBits) {
+			for (uint32_t bit = 0; bit < numBits; bit++, Position++) {
+				if ((value >> bit) & 1) {
+					Data[Position >> 3] |= 1 << (Position & 7);
+				}
+			}
+		}
+	};
+
+	// Encodes a block as a BC7 mode 6 block (16 bytes), a single RGBA line with 16 steps
+	void EncodeBc7Block(const Block& block, uint8_t* out) {
+		float e0[4], e1[4];
+		InitialEndpoints(block, 4, e0, e1);
+
+		Bc7Endpoint best[2] = {};
+		uint8_t     bestIndices[16] = { 0 };
+		float       bestError = std::numeric_limits<float>::max();
+
+		for (int iteration = 0; iteration < 3; iteration++) {
+			Bc7Endpoint endpoints[2] = { QuantizeBc7Endpoint(e0), QuantizeBc7Endpoint(e1) };
+
+			float palette[16][4];
+			for (int entry = 0; entry < 16; entry++) {
+				for (int channel = 0; channel < 4; channel++) {
+					palette[entry][channel] = static_cast<float>(((64 - BC7_WEIGHTS[entry]) * endpoints[0].Get(channel) + BC7_WEIGHTS[entry] * endpoints[1].Get(channel) + 32) >> 6);
+				}
+			}
+
+			uint8_t indices[16];
+			float error = AssignIndices(block, 4, palette, 16, indices);
+			if (error < bestError) {
+				bestError = error;
+				best[0] = endpoints[0];
+				best[1] = endpoints[1];
+				std::copy(indices, indices + 16, bestIndices);
+			}
+			if (error == 0.0f) {
+				break;
+			}
+
+			float weights[16];
+			for (int ix = 0; ix < 16; ix++) {
+				weights[ix] = BC7_WEIGHTS[indices[ix]] / 64.0f;
+			}
+			if (!RefineEndpoints(block, 4, weights, e0, e1)) {
+				break;
+			}
+		}
+
+		// The first texel's index is stored without it's top bit, so we flip the line around if it needs it
+		if (bestIndices[0] & 8) {
+			std::swap(best[0], best[1]);
+			for (int ix = 0; ix < 16; ix++) {
+				bestIndices[ix] = 15 - bestIndices[ix];
+			}
+		}
+
+		std::memset(out, 0, 16);
+		BitWriter writer = { out, 0 };
+		// Mode 6 is 6 zero bits followed by a one
+		writer.Write(1 << 6, 7);
+		for (int channel = 0; channel < 4; channel++) {
+			writer.Write(best[0].Channels[channel], 7);
+			writer.Write(best[1].Channels[channel], 7);
+		}
+		writer.Write(best[0].PBit, 1);
+		writer.Write(best[1].PBit, 1);
+		writer.Write(bestIndices[0], 3);
+		for (int ix = 1; ix < 16; ix++) {
+			writer.Write(bestIndices[ix], 4);
+		}
+	}
+
+	// The parts of the DDS file format that we use
+	// https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dx-graphics-dds-pguide
+	const uint32_t DDS_MAGIC            = 0x20534444; // "DDS "
+	const uint32_t DDS_FOURCC_DX10      = 0x30315844; // "DX10"
+	const uint32_t DDSD_REQUIRED        = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+	const uint32_t DDSD_MIPMAPCOUNT     = 0x20000;
+	const uint32_t DDSD_LINEARSIZE      = 0x80000;
+	const uint32_t DDPF_FOURCC          = 0x4;
+	const uint32_t DDSCAPS_TEXTURE      = 0x1000;
+	const uint32_t DDSCAPS_MIPMAP       = 0x400000 | 0x8; // MIPMAP | COMPLEX
+	const uint32_t DDS_DIMENSION_2D     = 3;
+	// Stored in the first reserved field so we know the settings key in the next field is ours
+	const uint32_t DDS_SETTINGS_TAG     = 0x43544147; // "GATC"
+
+	struct DdsPixelFormat {
+		uint32_t Size = sizeof(DdsPixelFormat);
+		uint32_t Flags = DDPF_FOURCC;
+		uint32_t FourCC = DDS_FOURCC_DX10;
+		uint32_t RgbBitCount = 0;
+		uint32_t BitMasks[4] = { 0 };
+	};
+
+	struct DdsHeader {
+		uint32_t       Size = sizeof(DdsHeader);
+		uint32_t       Flags = DDSD_REQUIRED;
+		uint32_t       Height = 0;
+		uint32_t       Width = 0;
+		uint32_t       PitchOrLinearSize = 0;
+		uint32_t       Depth = 0;
+		uint32_t       MipMapCount = 0;
+		uint32_t       Reserved1[11] = { 0 };
+		DdsPixelFormat PixelFormat;
+		uint32_t       Caps = DDSCAPS_TEXTURE;
+		uint32_t       Caps2 = 0;
+		uint32_t       Caps3 = 0;
+		uint32_t       Caps4 = 0;
+		uint32_t       Reserved2 = 0;
+	};
+
+	struct DdsHeaderDx10 {
+		uint32_t DxgiFormat = 0;
+		uint32_t ResourceDimension = DDS_DIMENSION_2D;
+		uint32_t MiscFlag = 0;
+		uint32_t ArraySize = 1;
+		uint32_t MiscFlags2 = 0;
+	};
+
+	static_assert(sizeof(DdsHeader) == 124, "DDS header must be 124 bytes");
+	static_assert(sizeof(DdsHeaderDx10) == 20, "DDS DX10 header must be 20 bytes");
+
+	// DXGI_FORMAT values for the formats we support, the sRGB variant is always 1 higher
+	uint32_t GetDxgiFormat(TextureCompression format, bool isSrgb) {
+		switch (format) {
+			case TextureCompression::BC1: return isSrgb ? 72 : 71;
+			case TextureCompression::BC3: return isSrgb ? 78 : 77;
+			case TextureCompression::BC4: return 80;
+			case TextureCompression::BC5: return 83;
+			case TextureCompression::BC7: return isSrgb ? 99 : 98;
+			default: return 0;
+		}
+	}
+
+	TextureCompression FromDxgiFormat(uint32_t dxgiFormat, bool& isSrgb) {
+		isSrgb = dxgiFormat == 72 || dxgiFormat == 78 || dxgiFormat == 99;
+		switch (dxgiFormat) {
+			case 71: case 72: return TextureCompression::BC1;
+			case 77: case 78: return TextureCompression::BC3;
+			case 80: return TextureCompression::BC4;
+			case 83: return TextureCompression::BC5;
+			case 98: case 99: return TextureCompression::BC7;
+			default: return TextureCompression::None;
+		}
+	}
+}
+
+TextureCompression TextureCompressor::ResolveFormat(TextureCompression format, uint32_t numChannels) {
+	if (format != TextureCompression::Auto) {
+		return format;
+	}
+	switch (numChannels) {
+		case 1: return TextureCompression::BC4;
+		case 2: return TextureCompression::BC5;
+		case 3: return TextureCompression::BC1;
+		default: return TextureCompression::BC7;
+	}
+}
+
+uint32_t TextureCompressor::GetBlockSize(TextureCompression format) {
+	switch (format) {
+		case TextureCompression::BC1:
+		case TextureCompression::BC4:
+			return 8;
+		case TextureCompression::BC3:
+		case TextureCompression::BC5:
+		case TextureCompression::BC7:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+size_t TextureCompressor::CalcLevelSize(TextureCompression format, uint32_t width, uint32_t height) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+}
+
+std::vector<uint8_t> TextureCompressor::Compress(TextureCompression format, const uint8_t* data, uint32_t width, uint32_t height, uint32_t numChannels) {
+	LOG_ASSERT(GetBlockSize(format) > 0, "Cannot compress to {}, a block format must be specified", ~format);
+	LOG_ASSERT(numChannels >= 1 && numChannels <= 4, "Texture compression only supports 1 to 4 channels, got {}", numChannels);
+
+	const uint32_t blocksX = (width + 3) / 4;
+	const uint32_t blocksY = (height + 3) / 4;
+	const uint32_t blockSize = GetBlockSize(format);
+	std::vector<uint8_t> result((size_t)blocksX * blocksY * blockSize);
+
+	Block block;
+	for (uint32_t blockY = 0; blockY < blocksY; blockY++) {
+		for (uint32_t blockX = 0; blockX < blocksX; blockX++) {
+			FetchBlock(data, width, height, numChannels, blockX, blockY, block);
+			uint8_t* out = result.data() + ((size_t)blockY * blocksX + blockX) * blockSize;
+
+			switch (format) {
+				case TextureCompression::BC1:
+					EncodeColorBlock(block, out);
+					break;
+				case TextureCompression::BC3:
+					EncodeSingleChannelBlock(block, 3, out);
+					EncodeColorBlock(block, out + 8);
+					break;
+				case TextureCompression::BC4:
+					EncodeSingleChannelBlock(block, 0, out);
+					break;
+				case TextureCompression::BC5:
+					EncodeSingleChannelBlock(block, 0, out);
+					EncodeSingleChannelBlock(block, 1, out + 8);
+					break;
+				case TextureCompression::BC7:
+					EncodeBc7Block(block, out);
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	return result;
+}
+
+bool TextureCompressor::SaveDds(const std::string& path, const CompressedImage& image) {
+	if (image.Levels.empty() || GetBlockSize(image.Format) == 0) {
+		LOG_WARN("Cannot save \"{}\", the image has no levels or is not block compressed", path);
+		return false;
+	}
+
+	DdsHeader header;
+	header.Flags |= DDSD_LINEARSIZE | (image.Levels.size() > 1 ? DDSD_MIPMAPCOUNT : 0);
+	header.Width = image.Levels[0].Width;
+	header.Height = image.Levels[0].Height;
+	header.PitchOrLinearSize = static_cast<uint32_t>(image.Levels[0].Data.size());
+	header.MipMapCount = static_cast<uint32_t>(image.Levels.size());
+	header.Reserved1[0] = DDS_SETTINGS_TAG;
+	header.Reserved1[1] = image.SettingsKey;
+	header.Caps |= image.Levels.size() > 1 ? DDSCAPS_MIPMAP : 0;
+
+	DdsHeaderDx10 extendedHeader;
+	extendedHeader.DxgiFormat = GetDxgiFormat(image.Format, image.IsSrgb);
+
+	// Several workers could be writing the same file, so each one gets it's own temporary file
+	const std::string tempPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary);
+		if (!file.is_open()) {
+			LOG_WARN("Failed to open \"{}\" for writing", tempPath);
+			return false;
+		}
+		file.write(reinterpret_cast<const char*>(&DDS_MAGIC), sizeof(DDS_MAGIC));
+		file.write(reinterpret_cast<const char*>(&header), sizeof(DdsHeader));
+		file.write(reinterpret_cast<const char*>(&extendedHeader), sizeof(DdsHeaderDx10));
+		for (const MipGenerator::Level& level : image.Levels) {
+			file.write(reinterpret_cast<const char*>(level.Data.data()), level.Data.size());
+		}
+		if (!file.good()) {
+			LOG_WARN("Failed to write \"{}\"", tempPath);
+			file.close();
+			fs::remove(tempPath);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	fs::rename(tempPath, path, error);
+	if (error) {
+		LOG_WARN("Failed to move \"{}\" to \"{}\": {}", tempPath, path, error.message());
+		fs::remove(tempPath, error);
+		return false;
+	}
+	return true;
+}
+
+bool TextureCompressor::LoadDds(const std::string& path, CompressedImage& image) {
+	MemoryMappedFile::Sptr file = MemoryMappedFile::Open(path);
+	if (file == nullptr) {
+		return false;
+	}
+
+	const uint8_t* data = file->GetData();
+	const size_t size = file->GetSize();
+	const size_t headerSize = sizeof(DDS_MAGIC) + sizeof(DdsHeader) + sizeof(DdsHeaderDx10);
+	if (size < headerSize) {
+		LOG_WARN("\"{}\" is too small to be a DDS file", path);
+		return false;
+	}
+
+	uint32_t magic;
+	DdsHeader header;
+	DdsHeaderDx10 extendedHeader;
+	std::memcpy(&magic, data, sizeof(magic));
+	std::memcpy(&header, data + sizeof(magic), sizeof(DdsHeader));
+	std::memcpy(&extendedHeader, data + sizeof(magic) + sizeof(DdsHeader), sizeof(DdsHeaderDx10));
+
+	if (magic != DDS_MAGIC || header.Size != sizeof(DdsHeader) || header.PixelFormat.FourCC != DDS_FOURCC_DX10) {
+		LOG_WARN("\"{}\" is not a DDS file with a DX10 header", path);
+		return false;
+	}
+	if (extendedHeader.ResourceDimension != DDS_DIMENSION_2D || extendedHeader.ArraySize != 1 || header.Width == 0 || header.Height == 0) {
+		LOG_WARN("\"{}\" is not a single 2D texture", path);
+		return false;
+	}
+
+	image.Format = FromDxgiFormat(extendedHeader.DxgiFormat, image.IsSrgb);
+	if (image.Format == TextureCompression::None) {
+		LOG_WARN("\"{}\" uses DXGI format {}, which we don't support", path, extendedHeader.DxgiFormat);
+		return false;
+	}
+	image.SettingsKey = header.Reserved1[0] == DDS_SETTINGS_TAG ? header.Reserved1[1] : 0;
+
+	const uint32_t numLevels = std::max(header.MipMapCount, 1u);
+	image.Levels.clear();
+	image.Levels.reserve(numLevels);
+	size_t offset = headerSize;
+	for (uint32_t ix = 0; ix < numLevels; ix++) {
+		MipGenerator::Level& level = image.Levels.emplace_back();
+		level.Width = std::max(header.Width >> ix, 1u);
+		level.Height = std::max(header.Height >> ix, 1u);
+		const size_t levelSize = CalcLevelSize(image.Format, level.Width, level.Height);
+		if (offset + levelSize > size) {
+			LOG_WARN("\"{}\" is truncated, expected {} levels", path, numLevels);
+			image.Levels.clear();
+			return false;
+		}
+		level.Data.assign(data + offset, data + offset + levelSize);
+		offset += levelSize;
+	}
+
+	return true;
+}
+
+bool TextureCompressor::LoadCachedDds(const std::string& path, uint32_t settingsKey, CompressedImage& image) {
+	if (!LoadDds(path, image)) {
+		image = CompressedImage();
+		return false;
+	}
+	if (image.SettingsKey != settingsKey) {
+		LOG_INFO("\"{}\" was compressed with different settings, it will be compressed again", path);
+		image = CompressedImage();
+		return false;
+	}
+	return true;
+}
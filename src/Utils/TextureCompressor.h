@@ -0,0 +1,103 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <EnumToString.h>
+#include "Utils/MipGenerator.h"
+
+/// <summary>
+/// The block compressed formats that textures can be stored in on the GPU
+/// </summary>
+ENUM(TextureCompression, uint8_t,
+	// Stored uncompressed
+	None = 0,
+	// Picks a format based on the number of channels, BC4 for 1, BC5 for 2, BC1 for 3 and BC7 for 4
+	Auto = 1,
+	// 4 bits per texel RGB, alpha is dropped
+	BC1  = 2,
+	// 8 bits per texel RGBA, with the alpha stored the same way as BC4
+	BC3  = 3,
+	// 4 bits per texel, red channel only
+	BC4  = 4,
+	// 8 bits per texel, red and green stored separately. Good for normal maps, where z can be rebuilt in the shader
+	BC5  = 5,
+	// 8 bits per texel RGBA, much higher quality than BC1 or BC3
+	BC7  = 6
+);
+
+/// <summary>
+/// Encodes 8 bit per channel images to block compressed (BCn) formats on the CPU, and stores
+/// them with their mip chains in DDS files. Does not touch OpenGL, so encoding can happen on
+/// worker threads, and can be checked without a GPU
+///
+/// The encoders aim to be quick enough to run on first load rather than for the best possible
+/// quality. Endpoints are picked along the principal axis of each block, then refined with a
+/// least squares fit. BC7 only uses mode 6 (a single subset with 4 bit indices)
+/// </summary>
+class TextureCompressor {
+public:
+	/// <summary>
+	/// A block compressed image and all of it's mip levels
+	/// </summary>
+	struct CompressedImage {
+		TextureCompression              Format = TextureCompression::None;
+		// True if the color channels are sRGB encoded
+		bool                            IsSrgb = false;
+		// An opaque value that is stored with the image, used to check if a cached file is still valid
+		uint32_t                        SettingsKey = 0;
+		// Level 0 is the full size image, each level holds it's blocks tightly packed
+		std::vector<MipGenerator::Level> Levels;
+	};
+
+	TextureCompressor() = delete;
+
+	/// <summary>
+	/// Resolves Auto to a concrete format based on the number of channels in the image
+	/// </summary>
+	static TextureCompression ResolveFormat(TextureCompression format, uint32_t numChannels);
+
+	/// <summary>
+	/// Gets the number of bytes a single 4x4 block takes up in the given format
+	/// </summary>
+	static uint32_t GetBlockSize(TextureCompression format);
+	/// <summary>
+	/// Gets the number of bytes needed to store an image of the given size, partial blocks are rounded up
+	/// </summary>
+	static size_t CalcLevelSize(TextureCompression format, uint32_t width, uint32_t height);
+
+	/// <summary>
+	/// Encodes an image to a block compressed format. Images with fewer channels than the format
+	/// expects are expanded the same way OpenGL would when sampling (missing color is 0, missing alpha is 1)
+	/// </summary>
+	/// <param name="format">The format to encode to, must not be None or Auto</param>
+	/// <param name="data">The image to encode, tightly packed</param>
+	/// <param name="width">The width of the image in texels</param>
+	/// <param name="height">The height of the image in texels</param>
+	/// <param name="numChannels">The number of 8 bit channels per texel, 1 to 4</param>
+	/// <returns>The encoded blocks, left to right then row by row</returns>
+	static std::vector<uint8_t> Compress(TextureCompression format, const uint8_t* data, uint32_t width, uint32_t height, uint32_t numChannels);
+
+	/// <summary>
+	/// Writes a compressed image to a DDS file, using the DX10 extended header. The file is written to
+	/// a temporary path first, so other threads never see a partially written file
+	/// </summary>
+	/// <returns>True if the file was written</returns>
+	static bool SaveDds(const std::string& path, const CompressedImage& image);
+	/// <summary>
+	/// Reads a compressed image from a DDS file written by SaveDds
+	/// </summary>
+	/// <param name="path">The path of the file to read</param>
+	/// <param name="image">The image to read into</param>
+	/// <returns>True if the file was read, false if it was missing, invalid or in a format we don't support</returns>
+	static bool LoadDds(const std::string& path, CompressedImage& image);
+	/// <summary>
+	/// Reads a cached image from a DDS file written by SaveDds, rejecting it if it was written with
+	/// different settings than the ones we would encode it with now
+	/// </summary>
+	/// <param name="path">The path of the file to read</param>
+	/// <param name="settingsKey">The settings key that the cached image must have been saved with</param>
+	/// <param name="image">The image to read into, left empty if the file is rejected</param>
+	/// <returns>True if the file was read and has a matching settings key</returns>
+	static bool LoadCachedDds(const std::string& path, uint32_t settingsKey, CompressedImage& image);
+};
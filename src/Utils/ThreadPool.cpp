@@ -0,0 +1,62 @@
+#include "Utils/ThreadPool.h"
+
+namespace {
+	// Set for the lifetime of a worker thread, see ThreadPool::IsWorkerThread
+	thread_local bool IsPoolWorker = false;
+}
+
+ThreadPool::ThreadPool(uint32_t numThreads) :
+	_workers(),
+	_jobs(),
+	_mutex(),
+	_signal(),
+	_isStopping(false)
+{
+	if (numThreads == 0) {
+		// hardware_concurrency may return 0 if it can't tell
+		uint32_t cores = std::thread::hardware_concurrency();
+		numThreads = cores > 1 ? cores - 1 : 1;
+	}
+	_workers.reserve(numThreads);
+	for (uint32_t ix = 0; ix < numThreads; ix++) {
+		_workers.emplace_back(&ThreadPool::_WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_isStopping = true;
+	}
+	_signal.notify_all();
+	for (std::thread& worker : _workers) {
+		worker.join();
+	}
+}
+
+size_t ThreadPool::GetQueuedCount() {
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _jobs.size();
+}
+
+bool ThreadPool::IsWorkerThread() {
+	return IsPoolWorker;
+}
+
+void ThreadPool::_WorkerLoop() {
+	IsPoolWorker = true;
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_signal.wait(lock, [this]() { return _isStopping || !_jobs.empty(); });
+			// We only stop once the queue has drained, so nothing that was submitted gets dropped
+			if (_jobs.empty()) {
+				return;
+			}
+			job = std::move(_jobs.front());
+			_jobs.pop();
+		}
+		job();
+	}
+}
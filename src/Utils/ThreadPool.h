@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <cstdint>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// A fixed set of worker threads that run jobs from a shared queue, in the order they were submitted
+/// Jobs must not touch OpenGL, since the context only lives on the main thread
+/// </summary>
+class ThreadPool {
+public:
+	DEFINE_RESOURCE(ThreadPool);
+
+	/// <summary>
+	/// Starts a new pool of worker threads
+	/// </summary>
+	/// <param name="numThreads">The number of workers to start, or 0 to leave one core free for the main thread</param>
+	ThreadPool(uint32_t numThreads = 0);
+	/// <summary>
+	/// Finishes all queued jobs, then stops the workers
+	/// </summary>
+	~ThreadPool();
+
+	/// <summary>
+	/// Queues a job to run on one of the workers
+	/// </summary>
+	/// <typeparam name="Func">The type of the callable, must take no arguments</typeparam>
+	/// <param name="func">The job to run</param>
+	/// <returns>A future that will receive the result of the job, or any exception it throws</returns>
+	template <typename Func>
+	auto Submit(Func&& func) -> std::future<decltype(func())> {
+		typedef decltype(func()) ResultType;
+		// std::function needs to be copyable, so the task lives behind a shared pointer
+		std::shared_ptr<std::packaged_task<ResultType()>> task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Func>(func));
+		std::future<ResultType> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_jobs.push([task]() { (*task)(); });
+		}
+		_signal.notify_one();
+		return result;
+	}
+
+	/// <summary>
+	/// Gets the number of worker threads in the pool
+	/// </summary>
+	uint32_t GetThreadCount() const { return static_cast<uint32_t>(_workers.size()); }
+	/// <summary>
+	/// Gets the number of jobs that are waiting for a worker
+	/// </summary>
+	size_t GetQueuedCount();
+
+	/// <summary>
+	/// Returns true if the calling thread is a worker of any thread pool. Jobs can use this to avoid
+	/// starting threads of their own, since the pool is already keeping every core busy
+	/// </summary>
+	static bool IsWorkerThread();
+
+protected:
+	std::vector<std::thread>          _workers;
+	std::queue<std::function<void()>> _jobs;
+	std::mutex                        _mutex;
+	std::condition_variable           _signal;
+	bool                              _isStopping;
+
+	void _WorkerLoop();
+};
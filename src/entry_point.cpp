@@ -4,9 +4,9 @@
 int main(int argc, char** args) {
 	Logger::Init();
 
-	// TODO: parse arguments?
-
-	Application::Start(argc, args);
+	int result = Application::Start(argc, args);
 
 	Logger::Uninitialize();
+
+	return result;
 }
\ No newline at end of file